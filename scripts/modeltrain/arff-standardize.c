@@ -3,6 +3,14 @@
 read in one ARFF file, compute mean and variance and standardize + save normadta 
 compute mean and variance 
 
+the file is memory mapped and parsed by several threads, mean and variance are
+computed in a single pass over the file, a second pass writes the standardised file
+(only one pass if normdata is loaded)
+
+optionally saves mean and variance as LibSVM scale file (-s) for cLibsvmLiveSink
+
+compile with:  gcc -O2 -o arff-standardize arff-standardize.c -lm -lpthread
+
 */
 
 
@@ -13,6 +21,11 @@ compute mean and variance
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 
@@ -50,7 +63,7 @@ typedef struct {
 typedef sMatrix2DFloat * matrix2DFloat;
 
 
-inline vector vectorCreate(long dim, int elSize) // elSize : size of vector element in bytes
+static inline vector vectorCreate(long dim, int elSize) // elSize : size of vector element in bytes
 {
   vector ret = (vector)malloc(sizeof(sVector));
   if (ret == NULL) return NULL;
@@ -59,7 +72,7 @@ inline vector vectorCreate(long dim, int elSize) // elSize : size of vector elem
   return ret;
 }
 
-inline vectorFloat vectorFloatCreate(long dim) 
+static inline vectorFloat vectorFloatCreate(long dim) 
 {
   vectorFloat ret = (vectorFloat)malloc(sizeof(sVectorFloat));
   if (ret == NULL) return NULL;
@@ -68,7 +81,7 @@ inline vectorFloat vectorFloatCreate(long dim)
   return ret;
 }
 
-inline vectorDouble vectorDoubleCreate(long dim) 
+static inline vectorDouble vectorDoubleCreate(long dim) 
 {
   vectorDouble ret = (vectorDouble)malloc(sizeof(sVectorDouble));
   if (ret == NULL) return NULL;
@@ -77,7 +90,7 @@ inline vectorDouble vectorDoubleCreate(long dim)
   return ret;
 }
 
-inline vectorFloat vectorFloatDestroy(vectorFloat vec)
+static inline vectorFloat vectorFloatDestroy(vectorFloat vec)
 {
   if (vec != NULL) {
     if (vec->x != NULL) free(vec->x);
@@ -86,7 +99,7 @@ inline vectorFloat vectorFloatDestroy(vectorFloat vec)
   return NULL;       
 }
 
-inline vectorDouble vectorDoubleDestroy(vectorDouble vec)
+static inline vectorDouble vectorDoubleDestroy(vectorDouble vec)
 {
   if (vec != NULL) {
     if (vec->x != NULL) free(vec->x);
@@ -130,13 +143,13 @@ matrix2DFloat matrix2DFloatDestroy(matrix2DFloat mat)
 
 
 
-inline float minFloat(float a, float b)
+static inline float minFloat(float a, float b)
 {
   if (a < b) return a;
   else return b;         
 }
 
-inline long minLong(long a, long b)
+static inline long minLong(long a, long b)
 {
   if (a < b) return a;
   else return b;         
@@ -392,242 +405,493 @@ char *myvprint(const char *fmt, ...) {
   return s;
 }
 
-    //  matRowsNormaliseMean(data,mean);
-    //  matRowsStandardiseVariance(data,stddev);
+/***************************************************************************/
+/*   chunked, multithreaded ARFF reader                                    */
+/***************************************************************************/
+
+/* The input file is memory mapped and the data section is split into
+   chunks at line boundaries. Worker threads parse the chunks, for the
+   statistics each chunk has its own Welford accumulator (mean and sum of
+   squared deviations), the chunk accumulators are merged pairwise in
+   chunk order, so the result does not depend on the number of threads.
+   For the standardisation each chunk is formatted into a text buffer,
+   the buffers are written in chunk order, a few chunks at a time. */
+
+#define CHUNK_MIN (1<<20)
+#define CHUNK_MAX (64<<20)
+#define FIELD_MAXLEN 63
+
+typedef struct {
+  const char *start, *end;   // chunk text (end is just after a '\n' or at the end of the file)
+  long long n;               // number of data rows
+  long nShort;               // number of rows with less elements than expected
+  double *mean, *m2;         // Welford accumulators (statistics pass)
+  char *out;                 // standardised text (standardisation pass)
+  size_t outLen, outSize;
+} sChunk;
+
+typedef struct {
+  sChunk *chunk;
+  long next, last;           // next chunk to process, end of the current range
+  pthread_mutex_t mtx;
+  int startft, vlen;
+  const double *mean, *stddev;
+  void (*fn)(void *ctx, sChunk *c, double *x);
+} sChunkJob;
+
+/* split the next line off [*p,end), strip '\r', leading and trailing spaces;
+   returns 0 at the end of the text */
+static int nextLine(const char **p, const char *end, const char **ls, const char **le)
+{
+  const char *s = *p;
+  const char *e;
+  if (s >= end) return 0;
+  e = (const char *)memchr(s, '\n', end-s);
+  if (e == NULL) { *p = end; e = end; }
+  else *p = e+1;
+  while ((e>s)&&((e[-1]=='\r')||(e[-1]==' '))) e--;
+  while ((s<e)&&(s[0]==' ')) s++;
+  *ls = s; *le = e;
+  return 1;
+}
+
+static const double pow10tab[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/* convert one field like atof(), the field is not 0 terminated in the mapped file;
+   plain decimal numbers with up to 15 digits are converted directly (one correctly
+   rounded multiplication or division by an exact power of 10, thus the same result
+   as strtod), anything else is passed to strtod */
+static double parseField(const char *s, const char *e)
+{
+  char buf[FIELD_MAXLEN+1];
+  const char *p = s;
+  unsigned long long m = 0;
+  int neg = 0, nd = 0, x = 0;
+  size_t l;
+  if ((p<e)&&((*p=='-')||(*p=='+'))) { neg = (*p=='-'); p++; }
+  for (; (p<e)&&(*p>='0')&&(*p<='9'); p++, nd++) m = m*10 + (*p-'0');
+  if ((p<e)&&(*p=='.')) {
+    for (p++; (p<e)&&(*p>='0')&&(*p<='9'); p++, nd++, x--) m = m*10 + (*p-'0');
+  }
+  if ((p<e)&&(nd>0)&&((*p=='e')||(*p=='E'))) {
+    int eneg = 0, ex = 0, ne = 0;
+    p++;
+    if ((p<e)&&((*p=='-')||(*p=='+'))) { eneg = (*p=='-'); p++; }
+    for (; (p<e)&&(*p>='0')&&(*p<='9')&&(ne<4); p++, ne++) ex = ex*10 + (*p-'0');
+    if (ne == 0) p = s;  // not a plain number, use strtod
+    x += eneg ? -ex : ex;
+  }
+  if ((p == e)&&(nd > 0)&&(nd <= 15)) {
+    double v = (double)m;
+    if (m == 0) return neg ? -0.0 : 0.0;
+    if ((x >= 0)&&(x <= 22)) { v *= pow10tab[x]; return neg ? -v : v; }
+    if ((x < 0)&&(x >= -22)) { v /= pow10tab[-x]; return neg ? -v : v; }
+  }
+  l = e-s;
+  if (l > FIELD_MAXLEN) {
+    char *lbuf = (char *)malloc(l+1);
+    double v;
+    memcpy(lbuf, s, l);
+    lbuf[l] = 0;
+    v = strtod(lbuf, NULL);
+    free(lbuf);
+    return v;
+  }
+  memcpy(buf, s, l);
+  buf[l] = 0;
+  return strtod(buf, NULL);
+}
+
+/* print v like sprintf(b,"%f",v): values below 1e6 are rounded to 6 decimals in integer
+   arithmetic, halfway cases (which depend on the exact binary value) and large values
+   are passed to sprintf; returns the length of the string */
+static int formatF(char *b, double v)
+{
+  double a = fabs(v);
+  double sc, fl, fr;
+  unsigned long long u, ip;
+  char tmp[24];
+  int n = 0, l = 0, i;
+  if (!(a < 1e6)) return sprintf(b, "%f", v);
+  sc = a*1e6;
+  fl = floor(sc);
+  fr = sc - fl;
+  if (fabs(fr-0.5) < 1e-3) return sprintf(b, "%f", v);
+  u = (unsigned long long)fl + (fr > 0.5);
+  if (signbit(v)) b[n++] = '-';
+  ip = u / 1000000;
+  do { tmp[l++] = (char)('0' + ip%10); ip /= 10; } while (ip > 0);
+  while (l > 0) b[n++] = tmp[--l];
+  b[n++] = '.';
+  u %= 1000000;
+  for (i=5; i>=0; i--) { b[n+i] = (char)('0' + u%10); u /= 10; }
+  n += 6;
+  b[n] = 0;
+  return n;
+}
+
+/* parse the standardised range of one data line into x[0..vlen-1] (missing elements are 0),
+   *pre is set to the end of the leading fields, *post to the start of the trailing fields (NULL if none),
+   returns the number of elements found in the range */
+static int parseLine(const char *s, const char *e, int startft, int vlen, double *x, const char **pre, const char **post)
+{
+  int fti = 1;
+  int found = 0;
+  const char *fs = s;
+  *pre = e+1; *post = NULL;  // no leading fields outside the line, if the range is not reached
+  memset(x, 0, sizeof(double)*vlen);
+  while (1) {
+    const char *fe = (const char *)memchr(fs, ',', e-fs);
+    if (fe == NULL) fe = e;
+    if (fti == startft) *pre = fs;
+    if (fti >= startft) {
+      if (fti < vlen+startft) {
+        x[fti-startft] = parseField(fs, fe);
+        found++;
+      } else {
+        *post = fs;
+        break;
+      }
+    }
+    fti++;
+    if (fe >= e) break;
+    fs = fe+1;
+  }
+  return found;
+}
+
+static int isDataLine(const char *s, const char *e)
+{
+  return ((e > s)&&(s[0] != '%'));
+}
+
+static void chunkStats(void *ctx, sChunk *c, double *x)
+{
+  sChunkJob *job = (sChunkJob *)ctx;
+  int vlen = job->vlen;
+  const char *p = c->start;
+  const char *s, *e, *pre, *post;
+  long i;
+  c->mean = (double *)calloc(vlen, sizeof(double));
+  c->m2 = (double *)calloc(vlen, sizeof(double));
+  while (nextLine(&p, c->end, &s, &e)) {
+    double r;
+    if (!isDataLine(s,e)) continue;
+    if (parseLine(s, e, job->startft, vlen, x, &pre, &post) < vlen) c->nShort++;
+    c->n++;
+    r = 1.0/(double)c->n;
+    for (i=0; i<vlen; i++) {
+      double d = x[i] - c->mean[i];
+      c->mean[i] += d*r;
+      c->m2[i] += d*(x[i] - c->mean[i]);
+    }
+  }
+}
+
+static void outAppend(sChunk *c, const char *s, size_t l)
+{
+  if (c->outLen + l + 1 > c->outSize) {
+    c->outSize = (c->outLen + l + 1)*2;
+    c->out = (char *)realloc(c->out, c->outSize);
+  }
+  memcpy(c->out+c->outLen, s, l);
+  c->outLen += l;
+}
+
+static void chunkStandardise(void *ctx, sChunk *c, double *x)
+{
+  sChunkJob *job = (sChunkJob *)ctx;
+  int vlen = job->vlen;
+  const char *p = c->start;
+  const char *s, *e, *pre, *post;
+  char num[400];
+  long i;
+  c->outSize = (c->end - c->start) + 1024;
+  c->out = (char *)malloc(c->outSize);
+  c->outLen = 0;
+  while (nextLine(&p, c->end, &s, &e)) {
+    int prev = 0;
+    if (!isDataLine(s,e)) continue;
+    if (parseLine(s, e, job->startft, vlen, x, &pre, &post) < vlen) c->nShort++;
+    c->n++;
+    // leading fields, standardised range, trailing fields
+    if (pre > s) {
+      outAppend(c, s, pre-1-s);
+      prev = 1;
+    }
+    for (i=0; i<vlen; i++) {
+      double v = x[i] - job->mean[i];
+      if (job->stddev[i] != 0.0) v /= job->stddev[i];
+      else v = 0.0;
+      if (prev) num[0] = ',';
+      outAppend(c, num, formatF(num+prev, v)+prev);
+      prev = 1;
+    }
+    if (post != NULL) {
+      if (prev) outAppend(c, ",", 1);
+      outAppend(c, post, e-post);
+    }
+    outAppend(c, "\n", 1);
+  }
+}
+
+static void * chunkWorker(void *ctx)
+{
+  sChunkJob *job = (sChunkJob *)ctx;
+  double *x = (double *)malloc(sizeof(double)*(job->vlen+1));
+  while (1) {
+    long i;
+    pthread_mutex_lock(&job->mtx);
+    i = job->next++;
+    pthread_mutex_unlock(&job->mtx);
+    if (i >= job->last) break;
+    job->fn(ctx, job->chunk+i, x);
+  }
+  free(x);
+  return NULL;
+}
+
+/* process chunks first..last-1 with nThreads threads */
+static void runChunks(sChunkJob *job, long first, long last, int nThreads)
+{
+  pthread_t *th;
+  int i;
+  job->next = first;
+  job->last = last;
+  if (nThreads > last-first) nThreads = last-first;
+  if (nThreads <= 1) { chunkWorker(job); return; }
+  th = (pthread_t *)malloc(sizeof(pthread_t)*nThreads);
+  for (i=0; i<nThreads; i++) {
+    if (pthread_create(th+i, NULL, chunkWorker, job) != 0) break;
+  }
+  if (i == 0) chunkWorker(job);
+  while (i>0) pthread_join(th[--i], NULL);
+  free(th);
+}
+
+/* merge Welford accumulator b into a (Chan et al.) */
+static void mergeStats(sChunk *a, sChunk *b, int vlen)
+{
+  long i;
+  long long n = a->n + b->n;
+  if (b->n == 0) return;
+  if (a->n == 0) {
+    memcpy(a->mean, b->mean, sizeof(double)*vlen);
+    memcpy(a->m2, b->m2, sizeof(double)*vlen);
+  } else {
+    double fb = (double)b->n / (double)n;
+    double fab = (double)a->n * fb;
+    for (i=0; i<vlen; i++) {
+      double d = b->mean[i] - a->mean[i];
+      a->mean[i] += d*fb;
+      a->m2[i] += b->m2[i] + d*d*fab;
+    }
+  }
+  a->n = n;
+  a->nShort += b->nShort;
+}
+
+/* the memory mapped input: header end (start of the data section) and number of attributes */
+typedef struct {
+  int fd;
+  char *map;
+  size_t size;
+  const char *data;
+  int Natt;
+} sArffMap;
+
+static int arffMapOpen(sArffMap *a, const char *filename)
+{
+  struct stat st;
+  const char *p, *s, *e;
+  memset(a, 0, sizeof(sArffMap));
+  a->fd = open(filename, O_RDONLY);
+  if (a->fd < 0) { fprintf(stderr, "ERROR: cannot open '%s'\n", filename); return 0; }
+  if ((fstat(a->fd, &st) != 0)||(st.st_size == 0)) {
+    fprintf(stderr, "ERROR: cannot read '%s' (empty file?)\n", filename);
+    close(a->fd); return 0;
+  }
+  a->size = (size_t)st.st_size;
+  a->map = (char *)mmap(NULL, a->size, PROT_READ, MAP_PRIVATE, a->fd, 0);
+  if (a->map == MAP_FAILED) {
+    fprintf(stderr, "ERROR: cannot map '%s'\n", filename);
+    close(a->fd); return 0;
+  }
+  madvise(a->map, a->size, MADV_SEQUENTIAL);
+  // header: count the attributes up to the @data line
+  p = a->map;
+  a->data = a->map + a->size;
+  while (nextLine(&p, a->map+a->size, &s, &e)) {
+    if ((e-s >= 10)&&(!strncmp(s,"@attribute",10))) a->Natt++;
+    else if ((e-s >= 5)&&(!strncmp(s,"@data",5))) { a->data = p; break; }
+  }
+  return 1;
+}
+
+static void arffMapClose(sArffMap *a)
+{
+  munmap(a->map, a->size);
+  close(a->fd);
+}
+
+/* split the data section into chunks at line boundaries,
+   the chunks do not depend on the number of threads (see above) */
+static long makeChunks(const sArffMap *a, sChunk **chunks)
+{
+  const char *end = a->map + a->size;
+  const char *p = a->data;
+  size_t len = end - p;
+  size_t csize = len / 64 + 1;
+  long n = 0, nAlloc = 64;
+  sChunk *c = (sChunk *)malloc(sizeof(sChunk)*nAlloc);
+  if (csize < CHUNK_MIN) csize = CHUNK_MIN;
+  if (csize > CHUNK_MAX) csize = CHUNK_MAX;
+  while (p < end) {
+    const char *q = p + csize;
+    if ((q >= end)||(q < p)) q = end;
+    else {
+      q = (const char *)memchr(q, '\n', end-q);
+      q = (q == NULL) ? end : q+1;
+    }
+    if (n >= nAlloc) { nAlloc *= 2; c = (sChunk *)realloc(c, sizeof(sChunk)*nAlloc); }
+    memset(c+n, 0, sizeof(sChunk));
+    c[n].start = p; c[n].end = q;
+    n++;
+    p = q;
+  }
+  *chunks = c;
+  return n;
+}
+
+/* write mean and stddev as LibSVM scale file (svm-scale -s format), which cLibsvmLiveSink loads with its 'scale' option:
+   [-1,1] scaling of the range [mean-stddev, mean+stddev] is the standardisation (x-mean)/stddev */
+static int saveSvmScale(const char *filename, vectorDouble mean, vectorDouble stddev)
+{
+  long i;
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) return 0;
+  fprintf(f, "x\n%.16g %.16g\n", -1.0, 1.0);
+  for (i=0; i<mean->dim; i++) {
+    double sd = stddev->x[i];
+    if (sd == 0.0) sd = 1.0;  // constant attribute: x-mean, which is 0 on the training data
+    fprintf(f, "%ld %.16g %.16g\n", i+1, mean->x[i]-sd, mean->x[i]+sd);
+  }
+  fclose(f);
+  return 1;
+}
 
 int main(int argc, char *argv[])
 {
+  int nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  const char *scalefile = NULL;
+
+  // options: [-j threads] [-s svm_scale_file]
+  while ((argc > 2)&&(argv[1][0]=='-')&&(argv[1][1]!=0)&&(argv[1][2]==0)) {
+    if (argv[1][1] == 'j') nThreads = atoi(argv[2]);
+    else if (argv[1][1] == 's') scalefile = argv[2];
+    else break;
+    argc -= 2; argv += 2;
+  }
+  if (nThreads < 1) nThreads = 1;
+
   if (argc < 5) {
-    fprintf(stderr, "USAGE: %s <input_arff_file> <output_arff_file(or'-')> <start ft#> <rel.end ft.#> [normdata.dat_file_to_load OR -normdata_file_to_saveTo]\n",argv[0]);
+    fprintf(stderr, "USAGE: %s [-j threads] [-s svm_scale_file_to_saveTo] <input_arff_file> <output_arff_file(or'-')> <start ft#> <rel.end ft.#> [normdata.dat_file_to_load OR -normdata_file_to_saveTo]\n",argv[0]);
     return -1;
   }
   
-  vectorDouble sum = NULL; 
-  vectorDouble var = NULL; 
   vectorDouble mean = NULL;
   vectorDouble stddev = NULL;
-  vectorFloat meanF = NULL;
-  vectorFloat stddevF = NULL;
-  long long n = 0;
-  FILE *iarff;
+  sArffMap arff;
+  sChunk *chunk = NULL;
+  sChunkJob job;
+  long nChunks, i;
   
   int startft = atoi(argv[3]); 
   int endft = atoi(argv[4]); 
+
+  if (!arffMapOpen(&arff, argv[1])) return -1;
+  int vlen = (arff.Natt-endft)-startft+1;
+  if ((vlen < 0)||(startft < 1)) {
+    fprintf(stderr, "ERROR: invalid feature range %i..%i (%i attributes)\n", startft, arff.Natt-endft, arff.Natt);
+    arffMapClose(&arff);
+    return -1;
+  }
+  nChunks = makeChunks(&arff, &chunk);
+  memset(&job, 0, sizeof(job));
+  pthread_mutex_init(&job.mtx, NULL);
+  job.chunk = chunk;
+  job.startft = startft;
+  job.vlen = vlen;
+
   if ((argc == 5)||(argv[5][0]=='-')) { // no normdata file given, create normadata from input arff
- 
-  /*** mean ****/
-  iarff = fopen(argv[1],"r");
-  int read;
-  char *line=NULL;
-  char *nline=NULL;
-  size_t len=0;
-  int data = 0;
-  int Natt = 0;
-  while ((read = getline(&line, &len, iarff)) != -1) {
-    int llen = strlen(line);
-    if (llen <= 0) continue;
-//printf("llen=%i\n",llen);
-    if (line[llen-1] == '\n') {
-      line[llen-1] = 0; // strip \n character
-      llen--;
-    }
-    if (llen <= 0) continue;
-    if (line[llen-1] == '\r') {
-      line[llen-1] = 0; // strip \r character
-      llen--;
-    }
-    if (llen <= 0) continue;
-    // ignore non-data lines...
-    if (data == 0) {
-      if (llen >= 5) {
-        data = 1;
-        if (line[0] != '@') data = 0;
-	else if (line[1] != 'd') data = 0;
-	else if (line[2] != 'a') data = 0;
-	else if (line[3] != 't') data = 0;
-	else if (line[4] != 'a') data = 0;
-//printf("data=%i line='%s'\n",data,line);
-      }
-      if (llen >= 10) {
-        int att = 1;
-        if (line[0] != '@') att = 0;
-	else if (line[1] != 'a') att = 0;
-	else if (line[2] != 't') att = 0;
-	else if (line[3] != 't') att = 0;
-	else if (line[4] != 'r') att = 0;
-	else if (line[5] != 'i') att = 0;
-	else if (line[6] != 'b') att = 0;
-	else if (line[7] != 'u') att = 0;
-	else if (line[8] != 't') att = 0;
-	else if (line[9] != 'e') att = 0;
-        if (att) Natt++;
-      }
-      nline = NULL;
-    } else {
-      nline = line;
-      // remove spaces
-      while ((llen>0)&&(nline[0]==' ')) { nline++; llen--; }
-      while ((llen>0)&&(nline[llen-1]==' ')) { nline[llen-1]=0; llen--; }
-      // convert line to vecotr
-      char *el=NULL;
-      int vlen = (Natt-endft)-startft+1;
-      vectorDouble d = vectorDoubleCreate(vlen);
-      if (sum == NULL) {
-        sum = vectorDoubleCreate(vlen);
-printf("create sum vlen=%i\n",vlen); fflush(stdout);
+
+    /*** mean and variance, single pass ****/
+    printf("computing mean and variance of %i attributes (%i threads, %ld chunks)\n", vlen, nThreads, nChunks); fflush(stdout);
+    job.fn = chunkStats;
+    runChunks(&job, 0, nChunks, nThreads);
+    // pairwise merge of the chunk accumulators
+    long step;
+    for (step=1; step<nChunks; step*=2) {
+      for (i=0; i+step<nChunks; i+=2*step) {
+        mergeStats(chunk+i, chunk+i+step, vlen);
       }
-      int fti=1;
-      if (llen > 0) {
-        do {
-  	  el=strchr(nline,',');
-          if (el!=NULL) 
-  	    el[0] = 0;
-	  if (fti>=startft) 
-            if (fti<vlen+startft)
-              d->x[fti-startft] = atof(nline);
-          fti++;
-	  if (el!=NULL) {
-	    nline = el+1;             
-          }
-        } while (el!=NULL);
+    }
+    mean = vectorDoubleCreate(vlen);
+    stddev = vectorDoubleCreate(vlen);
+    if (nChunks > 0) {
+      long long n = chunk[0].n;
+      if (chunk[0].nShort > 0) { printf("warning: less elements than expected on %li lines!!\n",chunk[0].nShort); }
+      for (i=0; i<vlen; i++) {
+        mean->x[i] = chunk[0].mean[i];
+        if (n>0) stddev->x[i] = sqrt(chunk[0].m2[i]/(double)n);
       }
-      if (fti-startft < vlen) { printf("warning: less elements on line than expected!!\n"); }
-      // add vector to sum...
-      vectorDoubleAdd(sum,d);
-      vectorDoubleDestroy(d);
-      n++;
     }
-    free(line); line=NULL;
-
-  }
-  fclose(iarff);
-
-  // compute means:
-  if (n>0)
-    vectorDoubleScalarDiv(sum,n);
-  mean = sum;
-  
-  /**** variance ****/
-  vectorDouble var = NULL;
-  iarff = fopen(argv[1],"r");
-  read = 0;
-  line=NULL;
-  nline=NULL;
-  len=0;
-  data = 0;
-  Natt = 0;
-  while ((read = getline(&line, &len, iarff)) != -1) {
-    int llen = strlen(line);
-    if (llen <= 0) continue;
-    if (line[llen-1] == '\n') {
-      line[llen-1] = 0; // strip \n character
-      llen--;
+    for (i=0; i<nChunks; i++) {
+      free(chunk[i].mean); chunk[i].mean = NULL;
+      free(chunk[i].m2); chunk[i].m2 = NULL;
+      chunk[i].n = 0; chunk[i].nShort = 0;
     }
-    if (llen <= 0) continue;
-    if (line[llen-1] == '\r') {
-      line[llen-1] = 0; // strip \r character
-      llen--;
+  
+    // save normdata file in current path 
+    FILE *nd ;
+    if ((argc>5)&&(argv[5][0]=='-')) {
+      nd = fopen((argv[5]+1),"wb");
+    } else {
+      nd = fopen("normdata.dat","wb");
     }
-    if (llen <= 0) continue;
-    // ignore non-data lines...
-    if (data == 0) {
-      if (llen >= 5) {
-        data = 1;
-        if (line[0] != '@') data = 0;
-        else if (line[1] != 'd') data = 0;
-        else if (line[2] != 'a') data = 0;
-        else if (line[3] != 't') data = 0;
-        else if (line[4] != 'a') data = 0;
-      }
-      if (llen >= 10) {
-        int att = 1;
-        if (line[0] != '@') att = 0;
-        else if (line[1] != 'a') att = 0;
-        else if (line[2] != 't') att = 0;
-        else if (line[3] != 't') att = 0;
-        else if (line[4] != 'r') att = 0;
-        else if (line[5] != 'i') att = 0;
-        else if (line[6] != 'b') att = 0;
-        else if (line[7] != 'u') att = 0;
-        else if (line[8] != 't') att = 0;
-        else if (line[9] != 'e') att = 0;
-        if (att) Natt++;
-      }
-      nline = NULL;
+    if (nd != NULL) {
+      fwrite(mean->x, sizeof(double)*mean->dim, 1, nd);
+      fwrite(stddev->x, sizeof(double)*stddev->dim, 1, nd);
+      fclose(nd);  
     } else {
-      nline = line;
-      // remove spaces
-      while ((llen>0)&&(nline[0]==' ')) { nline++; llen--; }
-      while ((llen>0)&&(nline[llen-1]==' ')) { nline[llen-1]=0; llen--; }
-      // convert line to vecotr
-      char *el=NULL;
-      int vlen = (Natt-endft)-startft+1;
-      vectorDouble d = vectorDoubleCreate(vlen);
-      if (var == NULL) {
-        var = vectorDoubleCreate(vlen);
-      }
-      int fti=1;
-      if (llen > 0) {
-        do {
-          el=strchr(nline,',');
-          if (el != NULL) 
-            el[0] = 0;
-          if (fti>=startft)
-            if (fti<vlen+startft)
-              d->x[fti-startft] = atof(nline);
-          fti++;
-          if (el!=NULL) {
-            nline = el+1;
-          }
-        } while (el!=NULL);
-      }
-      if (fti-startft < vlen) { printf("warning: less elements on line than expected!!\n"); }
-      // add vector var to variance sum...
-//...
-      vectorDoubleSub(d,mean);
-      vectorDoubleElemSqr(d);
-      vectorDoubleAdd(var,d);
-      vectorDoubleDestroy(d); d=NULL;
-      //n++;
+      fprintf(stderr,"ERROR saving normdata\n");       
     }
-    free(line); line=NULL;
 
-  }
-  fclose(iarff);
+  } else {
 
+    mean = vectorDoubleCreate(vlen);
+    stddev = vectorDoubleCreate(vlen);
+    FILE *nd = fopen(argv[5],"rb");
+    if (nd != NULL) {
+      if ((fread(mean->x, sizeof(double)*mean->dim, 1, nd) != 1)||(fread(stddev->x, sizeof(double)*stddev->dim, 1, nd) != 1))
+        fprintf(stderr,"ERROR loading normdata (file too short for %i attributes)\n",vlen);
+      fclose(nd);  
+    } else {
+      fprintf(stderr,"ERROR loading normdata\n");       
+    }
 
-  if (n>0)
-    vectorDoubleScalarDiv(var,n);
-  stddev = var;
-  vectorDoubleElemSqrt(stddev);
-  
-  //printf("var0: %f (dim=%i)\n",var->x[0],var->dim);
-  // save normdata file in current path 
-  
-  FILE *nd ;
-  if ((argc>5)&&(argv[5][0]=='-')) {
-    nd = fopen((argv[5]+1),"wb");
-  } else {
-    nd = fopen("normdata.dat","wb");
-  }
-  if (nd != NULL) {
-    fwrite(mean->x, sizeof(double)*mean->dim, 1, nd);
-    fwrite(stddev->x, sizeof(double)*stddev->dim, 1, nd);
-    fclose(nd);  
-  } else {
-    fprintf(stderr,"ERROR saving normdata\n");       
   }
 
-  //meanF = vectorDoubleToVectorFloat(mean);
-  //stddevF = vectorDoubleToVectorFloat(stddev);
-
+  if (scalefile != NULL) {
+    if (!saveSvmScale(scalefile, mean, stddev))
+      fprintf(stderr,"ERROR saving svm scale file '%s'\n",scalefile);
   }
 
 /* do actual standardisation::: */
 /***************************************************************************/
 
   FILE * oarff=NULL;
-  iarff = fopen(argv[1],"r");
   if (!(argv[2][0] == '-')) {
     oarff = fopen(argv[2],"w");
   } else {
@@ -635,164 +899,54 @@ printf("create sum vlen=%i\n",vlen); fflush(stdout);
     oarff = fopen(tmp,"w");
     free(tmp);
   }
-  int read = 0;
-  char *line=NULL;
-  char *nline=NULL;
-  size_t len=0;
-  int data = 0;
-  int Natt = 0;
-  while ((read = getline(&line, &len, iarff)) != -1) {
-    int llen = strlen(line);
-    if (line[llen-1] == '\n') {
-      line[llen-1] = 0; // strip \n character
-      llen--;
-    }
-    if (line[llen-1] == '\r') {
-      line[llen-1] = 0; // strip \r character
-      llen--;
-    }
-    // ignore non-data lines...
-    if (data == 0) {
-      if (llen >= 5) {
-        data = 1;
-        if (line[0] != '@') data = 0;
-        else if (line[1] != 'd') data = 0;
-        else if (line[2] != 'a') data = 0;
-        else if (line[3] != 't') data = 0;
-        else if (line[4] != 'a') data = 0;
-      }
-      if (llen >= 10) {
-        int att = 1;
-        if (line[0] != '@') att = 0;
-        else if (line[1] != 'a') att = 0;
-        else if (line[2] != 't') att = 0;
-        else if (line[3] != 't') att = 0;
-        else if (line[4] != 'r') att = 0;
-        else if (line[5] != 'i') att = 0;
-        else if (line[6] != 'b') att = 0;
-        else if (line[7] != 'u') att = 0;
-        else if (line[8] != 't') att = 0;
-        else if (line[9] != 'e') att = 0;
-        if (att) Natt++;
-      }
-      nline = NULL;
-      fprintf(oarff,"%s\n",line);
-    } else {
-      int vlen = (Natt-endft)-startft+1;
-      if ((mean == NULL)&&(argc > 5)) {
-        mean = vectorDoubleCreate(vlen);
-        stddev = vectorDoubleCreate(vlen);
-//  FILE *nd = fopen("normdata.dat","rb");
-        FILE *nd = fopen(argv[5],"rb");
-        if (nd != NULL) {
-          fread(mean->x, sizeof(double)*mean->dim, 1, nd);
-          fread(stddev->x, sizeof(double)*stddev->dim, 1, nd);
-          fclose(nd);  
-        } else {
-          fprintf(stderr,"ERROR loading normdata\n");       
-        }
-      }
-
-
-      nline = line;
-      // remove spaces
-      while ((llen>0)&&(nline[0]==' ')) { nline++; llen--; }
-      while ((llen>0)&&(nline[llen-1]==' ')) { nline[llen-1]=0; llen--; }
-      // convert line to vecotr
-      char *el=NULL;
-      vectorDouble d = vectorDoubleCreate(vlen);
-      if (var == NULL) {
-        var = vectorDoubleCreate(vlen);
-      }
-      int fti=1;
-      char *oline0=NULL;
-      char *oline1=NULL;
-      char *oline0e=NULL;
-      char *oline1e=NULL;
-      if (llen > 0) {
-        do {
-          el=strchr(nline,',');
-          if (el!=NULL) 
-            el[0] = 0;
-          if (fti>=startft)
-            if (fti<vlen+startft)
-              d->x[fti-startft] = atof(nline);
-            else {
-              if (oline0e != NULL) {
-                oline1e = myvprint("%s,%s",oline0e,nline);
-                free(oline0e); oline0e=oline1e;
-              } else {
-                oline0e = strdup(nline);
-              }
-            }
-          else {
-            if (oline0 != NULL) {
-              oline1 = myvprint("%s,%s",oline0,nline);
-              free(oline0); oline0=oline1;
-            } else {
-              oline0 = strdup(nline);
-            }
-	  }
-          fti++;
-          if (el!=NULL) {
-            nline = el+1;
-          }
-        } while (el!=NULL);
-      if (fti-startft < vlen) { printf("warning: less elements on line than expected!!\n"); }
-      // add vector var to variance sum...
-//...
-      vectorDoubleSub(d,mean);
-      vectorDoubleElemSafeDiv(d,stddev);
-      // rebuild line and write to file...
-      int prev = 0;
-      if (oline0 != NULL) {
-        fprintf(oarff,"%s",oline0);
-        free(oline0);
-        prev = 1;
-      }
-      long i;
-      for (i=0; i<vlen; i++) {
-        if (prev)
-          fprintf(oarff,",%f",d->x[i]);
-        else
-          fprintf(oarff,"%f",d->x[i]);
-        prev = 1;
-      }
-      if (oline0e != NULL) {
-        if (prev) fprintf(oarff,",");
-        fprintf(oarff,"%s",oline0e);
-        free(oline0e);
-      }
-      fprintf(oarff,"\n");
-
-/*
+  if (oarff == NULL) {
+    fprintf(stderr,"ERROR: cannot open output file\n");
+    return -1;
+  }
 
-      char *oline=strdup(oline0);
-      int i;
-      for (i=0; i<vlen; i++) {
-        char *tmp = myvprint("%s,%f",oline,d->x[i]);
-        free(oline); oline=tmp;
-      }
-      char *tmp = myvprint("%s,%s",oline,oline0e);
-      free(oline); oline=tmp;
-      fprintf(oarff,"%s\n",oline);*/
-      //n++;
-      }
+  // header lines are copied unchanged (without '\r')
+  {
+    const char *p = arff.map;
+    while (p < arff.data) {
+      const char *e = (const char *)memchr(p, '\n', arff.data-p);
+      const char *next;
+      if (e == NULL) { e = arff.data; next = e; }
+      else next = e+1;
+      if ((e > p)&&(e[-1] == '\r')) e--;
+      fwrite(p, 1, e-p, oarff);
+      fputc('\n', oarff);
+      p = next;
     }
-    free(line); line=NULL;
+  }
 
+  job.mean = mean->x;
+  job.stddev = stddev->x;
+  job.fn = chunkStandardise;
+  long nShort = 0;
+  for (i=0; i<nChunks; i+=nThreads) {
+    long j, last = i+nThreads;
+    if (last > nChunks) last = nChunks;
+    runChunks(&job, i, last, nThreads);
+    for (j=i; j<last; j++) {
+      fwrite(chunk[j].out, 1, chunk[j].outLen, oarff);
+      free(chunk[j].out); chunk[j].out = NULL;
+      nShort += chunk[j].nShort;
+    }
+    // release the pages of the processed input
+    {
+      size_t pg = (size_t)sysconf(_SC_PAGESIZE);
+      size_t off = ((size_t)(chunk[i].start - arff.map)) / pg * pg;
+      size_t end = ((size_t)(chunk[last-1].end - arff.map)) / pg * pg;
+      if (end > off) madvise(arff.map+off, end-off, MADV_DONTNEED);
+    }
   }
+  if (nShort > 0) { printf("warning: less elements than expected on %li lines!!\n",nShort); }
   fclose(oarff);
-  fclose(iarff);
 
- 
- 
+  arffMapClose(&arff);
+  free(chunk);
+  pthread_mutex_destroy(&job.mtx);
   vectorDoubleDestroy(mean);  // at the end...
   vectorDoubleDestroy(stddev);  
-  vectorFloatDestroy(meanF);  // at the end...
-  vectorFloatDestroy(stddevF);  
-  
-  //printf("Hello World!\n");
+  return 0;
 }
-
-
@@ -4,6 +4,9 @@
 #include <ctype.h>
 #include <errno.h>
 #include "svm.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #define Malloc(type,n) (type *)malloc((n)*sizeof(type))
 
 void print_null(const char *s) {}
@@ -37,6 +40,8 @@ void exit_with_help()
 	"-b probability_estimates : whether to train a SVC or SVR model for probability estimates, 0 or 1 (default 0)\n"
 	"-wi weight : set the parameter C of class i to weight*C, for C-SVC (default 1)\n"
 	"-v n: n-fold cross validation mode\n"
+	"-j threads : number of threads (default: all processors, if built with OpenMP)\n"
+	"-D dense : use the dense kernel code path for dense data, 0 or 1 (default 1)\n"
 	"-q : quiet mode (no outputs)\n"
 	);
 	exit(1);
@@ -220,6 +225,17 @@ void parse_command_line(int argc, char **argv, char *input_file_name, char *mode
 			case 'b':
 				param.probability = atoi(argv[i]);
 				break;
+			case 'j':
+#ifdef _OPENMP
+				if(atoi(argv[i]) > 0)
+					omp_set_num_threads(atoi(argv[i]));
+#else
+				fprintf(stderr,"warning: built without OpenMP, -j is ignored\n");
+#endif
+				break;
+			case 'D':
+				svm_dense_kernel = atoi(argv[i]);
+				break;
 			case 'q':
 				svm_print_string = &print_null;
 				i--;
@@ -6,7 +6,11 @@
 #include <string.h>
 #include <stdarg.h>
 #include "svm.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 int libsvm_version = LIBSVM_VERSION;
+int svm_dense_kernel = 1;
 typedef float Qfloat;
 typedef signed char schar;
 #ifndef min
@@ -56,6 +60,17 @@ static void info(const char *fmt,...)
 static void info(const char *fmt,...) {}
 #endif
 
+// number of threads available to a parallel loop started here;
+// 1 if we already are inside a parallel region (nested regions are inactive)
+static int num_threads()
+{
+#ifdef _OPENMP
+	if(!omp_in_parallel())
+		return omp_get_max_threads();
+#endif
+	return 1;
+}
+
 //
 // Kernel Cache
 //
@@ -209,6 +224,7 @@ public:
 	virtual void swap_index(int i, int j) const	// no so const...
 	{
 		swap(x[i],x[j]);
+		if(xd) swap(xd[i],xd[j]);
 		if(x_square) swap(x_square[i],x_square[j]);
 	}
 protected:
@@ -219,6 +235,12 @@ private:
 	const svm_node **x;
 	double *x_square;
 
+	// dense copy of x, used instead of the sparse dot if the data is dense
+	// (rows are zero padded to a multiple of 4 elements)
+	const double **xd;
+	double *xd_space;
+	int xd_dim;
+
 	// svm_parameter
 	const int kernel_type;
 	const int degree;
@@ -226,6 +248,8 @@ private:
 	const double coef0;
 
 	static double dot(const svm_node *px, const svm_node *py);
+	static double dot_dense(const double *px, const double *py, int n);
+	void init_dense(int l);
 	double kernel_linear(int i, int j) const
 	{
 		return dot(x[i],x[j]);
@@ -246,6 +270,22 @@ private:
 	{
 		return x[i][(int)(x[j][0].value)].value;
 	}
+	double kernel_linear_dense(int i, int j) const
+	{
+		return dot_dense(xd[i],xd[j],xd_dim);
+	}
+	double kernel_poly_dense(int i, int j) const
+	{
+		return powi(gamma*dot_dense(xd[i],xd[j],xd_dim)+coef0,degree);
+	}
+	double kernel_rbf_dense(int i, int j) const
+	{
+		return exp(-gamma*(x_square[i]+x_square[j]-2*dot_dense(xd[i],xd[j],xd_dim)));
+	}
+	double kernel_sigmoid_dense(int i, int j) const
+	{
+		return tanh(gamma*dot_dense(xd[i],xd[j],xd_dim)+coef0);
+	}
 };
 
 Kernel::Kernel(int l, svm_node * const * x_, const svm_parameter& param)
@@ -273,11 +313,36 @@ Kernel::Kernel(int l, svm_node * const * x_, const svm_parameter& param)
 
 	clone(x,x_,l);
 
+	xd = 0;
+	xd_space = 0;
+	xd_dim = 0;
+	if(svm_dense_kernel && kernel_type != PRECOMPUTED)
+		init_dense(l);
+
+	if(xd)
+	{
+		switch(kernel_type)
+		{
+			case LINEAR:
+				kernel_function = &Kernel::kernel_linear_dense;
+				break;
+			case POLY:
+				kernel_function = &Kernel::kernel_poly_dense;
+				break;
+			case RBF:
+				kernel_function = &Kernel::kernel_rbf_dense;
+				break;
+			case SIGMOID:
+				kernel_function = &Kernel::kernel_sigmoid_dense;
+				break;
+		}
+	}
+
 	if(kernel_type == RBF)
 	{
 		x_square = new double[l];
 		for(int i=0;i<l;i++)
-			x_square[i] = dot(x[i],x[i]);
+			x_square[i] = xd ? dot_dense(xd[i],xd[i],xd_dim) : dot(x[i],x[i]);
 	}
 	else
 		x_square = 0;
@@ -286,9 +351,43 @@ Kernel::Kernel(int l, svm_node * const * x_, const svm_parameter& param)
 Kernel::~Kernel()
 {
 	delete[] x;
+	delete[] xd;
+	delete[] xd_space;
 	delete[] x_square;
 }
 
+// build the dense copy of x if at least half of the elements are present,
+// the dense rows then take no more memory than the sparse nodes
+void Kernel::init_dense(int l)
+{
+	int i, max_index = 0;
+	long int nnz = 0;
+	for(i=0;i<l;i++)
+	{
+		const svm_node *p = x[i];
+		for(;p->index != -1;p++)
+		{
+			if(p->index < 0) return;
+			if(p->index > max_index) max_index = p->index;
+			nnz++;
+		}
+	}
+	if(l == 0 || max_index == 0 || 2*nnz < (long int)l*max_index)
+		return;
+
+	xd_dim = (max_index+4)&~3;
+	xd_space = new double[(size_t)l*xd_dim];
+	xd = new const double *[l];
+	memset(xd_space,0,sizeof(double)*(size_t)l*xd_dim);
+	for(i=0;i<l;i++)
+	{
+		double *row = xd_space+(size_t)i*xd_dim;
+		for(const svm_node *p = x[i];p->index != -1;p++)
+			row[p->index] = p->value;
+		xd[i] = row;
+	}
+}
+
 double Kernel::dot(const svm_node *px, const svm_node *py)
 {
 	double sum = 0;
@@ -311,6 +410,17 @@ double Kernel::dot(const svm_node *px, const svm_node *py)
 	return sum;
 }
 
+// four independent partial sums, which the compiler maps to SIMD lanes;
+// the summation order differs from dot(), so results may differ in the last bits
+double Kernel::dot_dense(const double *px, const double *py, int n)
+{
+	double s[4] = { 0, 0, 0, 0 };
+	for(int i=0;i<n;i+=4)
+		for(int k=0;k<4;k++)
+			s[k] += px[i+k] * py[i+k];
+	return (s[0]+s[2])+(s[1]+s[3]);
+}
+
 double Kernel::k_function(const svm_node *x, const svm_node *y,
 			  const svm_parameter& param)
 {
@@ -1267,6 +1377,7 @@ public:
 		int start, j;
 		if((start = cache->get_data(i,&data,len)) < len)
 		{
+#pragma omp parallel for private(j) schedule(guided)
 			for(j=start;j<len;j++)
 				data[j] = (Qfloat)(y[i]*y[j]*(this->*kernel_function)(i,j));
 		}
@@ -1316,6 +1427,7 @@ public:
 		int start, j;
 		if((start = cache->get_data(i,&data,len)) < len)
 		{
+#pragma omp parallel for private(j) schedule(guided)
 			for(j=start;j<len;j++)
 				data[j] = (Qfloat)(this->*kernel_function)(i,j);
 		}
@@ -1382,6 +1494,7 @@ public:
 		int j, real_i = index[i];
 		if(cache->get_data(real_i,&data,l) < l)
 		{
+#pragma omp parallel for private(j) schedule(guided)
 			for(j=0;j<l;j++)
 				data[j] = (Qfloat)(this->*kernel_function)(real_i,j);
 		}
@@ -1897,23 +2010,30 @@ void multiclass_probability(int k, double **r, double *p)
 	free(Qp);
 }
 
+// random permutation of 0..l-1
+static void random_perm(int *perm, int l)
+{
+	int i;
+	for(i=0;i<l;i++) perm[i]=i;
+	for(i=0;i<l;i++)
+	{
+		int j = i+rand()%(l-i);
+		swap(perm[i],perm[j]);
+	}
+}
+
 // Cross-validation decision values for probability estimates
+// perm is a random permutation of the data (see random_perm()); it is
+// drawn by the caller, so that sub-problems can be trained in parallel
+// with the same sequence of rand() calls as the serial trainer
 void svm_binary_svc_probability(
 	const svm_problem *prob, const svm_parameter *param,
-	double Cp, double Cn, double& probA, double& probB)
+	double Cp, double Cn, double& probA, double& probB, const int *perm)
 {
 	int i;
 	int nr_fold = 5;
-	int *perm = Malloc(int,prob->l);
 	double *dec_values = Malloc(double,prob->l);
 
-	// random shuffle
-	for(i=0;i<prob->l;i++) perm[i]=i;
-	for(i=0;i<prob->l;i++)
-	{
-		int j = i+rand()%(prob->l-i);
-		swap(perm[i],perm[j]);
-	}
 	for(i=0;i<nr_fold;i++)
 	{
 		int begin = i*prob->l/nr_fold;
@@ -1981,7 +2101,6 @@ void svm_binary_svc_probability(
 	}		
 	sigmoid_train(prob->l,dec_values,prob->y,probA,probB);
 	free(dec_values);
-	free(perm);
 }
 
 // Return parameter of a Laplace distribution 
@@ -2174,43 +2293,84 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 			probB=Malloc(double,nr_class*(nr_class-1)/2);
 		}
 
+		// the pairs are independent and are trained in parallel, each
+		// with an equal share of the kernel cache; the random permutations
+		// for the probability estimates are drawn beforehand in pair order
+
+		int nr_pair = nr_class*(nr_class-1)/2;
+		int *pair_i = Malloc(int,nr_pair);
+		int *pair_j = Malloc(int,nr_pair);
+		int **pair_perm = NULL;
 		int p = 0;
 		for(i=0;i<nr_class;i++)
 			for(int j=i+1;j<nr_class;j++)
 			{
-				svm_problem sub_prob;
-				int si = start[i], sj = start[j];
-				int ci = count[i], cj = count[j];
-				sub_prob.l = ci+cj;
-				sub_prob.x = Malloc(svm_node *,sub_prob.l);
-				sub_prob.y = Malloc(double,sub_prob.l);
-				int k;
-				for(k=0;k<ci;k++)
-				{
-					sub_prob.x[k] = x[si+k];
-					sub_prob.y[k] = +1;
-				}
-				for(k=0;k<cj;k++)
-				{
-					sub_prob.x[ci+k] = x[sj+k];
-					sub_prob.y[ci+k] = -1;
-				}
+				pair_i[p] = i;
+				pair_j[p] = j;
+				++p;
+			}
+		if(param->probability)
+		{
+			pair_perm = Malloc(int *,nr_pair);
+			for(p=0;p<nr_pair;p++)
+			{
+				int n = count[pair_i[p]]+count[pair_j[p]];
+				pair_perm[p] = Malloc(int,n);
+				random_perm(pair_perm[p],n);
+			}
+		}
 
-				if(param->probability)
-					svm_binary_svc_probability(&sub_prob,param,weighted_C[i],weighted_C[j],probA[p],probB[p]);
+		int nr_thread = max(min(num_threads(),nr_pair),1);
+		svm_parameter pair_param = *param;
+		pair_param.cache_size = param->cache_size/nr_thread;
 
-				f[p] = svm_train_one(&sub_prob,param,weighted_C[i],weighted_C[j]);
-				for(k=0;k<ci;k++)
-					if(!nonzero[si+k] && fabs(f[p].alpha[k]) > 0)
-						nonzero[si+k] = true;
-				for(k=0;k<cj;k++)
-					if(!nonzero[sj+k] && fabs(f[p].alpha[ci+k]) > 0)
-						nonzero[sj+k] = true;
-				free(sub_prob.x);
-				free(sub_prob.y);
-				++p;
+#pragma omp parallel for schedule(dynamic,1) if(nr_thread > 1) num_threads(nr_thread)
+		for(p=0;p<nr_pair;p++)
+		{
+			svm_problem sub_prob;
+			int pi = pair_i[p], pj = pair_j[p];
+			int si = start[pi], sj = start[pj];
+			int ci = count[pi], cj = count[pj];
+			sub_prob.l = ci+cj;
+			sub_prob.x = Malloc(svm_node *,sub_prob.l);
+			sub_prob.y = Malloc(double,sub_prob.l);
+			int k;
+			for(k=0;k<ci;k++)
+			{
+				sub_prob.x[k] = x[si+k];
+				sub_prob.y[k] = +1;
+			}
+			for(k=0;k<cj;k++)
+			{
+				sub_prob.x[ci+k] = x[sj+k];
+				sub_prob.y[ci+k] = -1;
 			}
 
+			if(param->probability)
+				svm_binary_svc_probability(&sub_prob,&pair_param,weighted_C[pi],weighted_C[pj],probA[p],probB[p],pair_perm[p]);
+
+			f[p] = svm_train_one(&sub_prob,&pair_param,weighted_C[pi],weighted_C[pj]);
+			free(sub_prob.x);
+			free(sub_prob.y);
+		}
+
+		for(p=0;p<nr_pair;p++)
+		{
+			int si = start[pair_i[p]], sj = start[pair_j[p]];
+			int ci = count[pair_i[p]], cj = count[pair_j[p]];
+			int k;
+			for(k=0;k<ci;k++)
+				if(!nonzero[si+k] && fabs(f[p].alpha[k]) > 0)
+					nonzero[si+k] = true;
+			for(k=0;k<cj;k++)
+				if(!nonzero[sj+k] && fabs(f[p].alpha[ci+k]) > 0)
+					nonzero[sj+k] = true;
+			if(pair_perm) free(pair_perm[p]);
+		}
+		free(pair_perm);
+		free(pair_i);
+		free(pair_j);
+
 		// build output
 
 		model->nr_class = nr_class;
@@ -2377,16 +2537,18 @@ void svm_cross_validation(const svm_problem *prob, const svm_parameter *param, i
 	}
 	else
 	{
-		for(i=0;i<l;i++) perm[i]=i;
-		for(i=0;i<l;i++)
-		{
-			int j = i+rand()%(l-i);
-			swap(perm[i],perm[j]);
-		}
+		random_perm(perm,l);
 		for(i=0;i<=nr_fold;i++)
 			fold_start[i]=i*l/nr_fold;
 	}
 
+	// the folds are trained in parallel, unless probability estimates
+	// are requested: these draw random numbers within each fold
+	int nr_thread = param->probability ? 1 : max(min(num_threads(),nr_fold),1);
+	svm_parameter fold_param = *param;
+	fold_param.cache_size = param->cache_size/nr_thread;
+
+#pragma omp parallel for schedule(dynamic,1) if(nr_thread > 1) num_threads(nr_thread)
 	for(i=0;i<nr_fold;i++)
 	{
 		int begin = fold_start[i];
@@ -2411,7 +2573,7 @@ void svm_cross_validation(const svm_problem *prob, const svm_parameter *param, i
 			subprob.y[k] = prob->y[perm[j]];
 			++k;
 		}
-		struct svm_model *submodel = svm_train(&subprob,param);
+		struct svm_model *submodel = svm_train(&subprob,&fold_param);
 		if(param->probability && 
 		   (param->svm_type == C_SVC || param->svm_type == NU_SVC))
 		{
@@ -69,6 +69,11 @@ int svm_check_probability_model(const struct svm_model *model);
 
 extern void (*svm_print_string) (const char *);
 
+/* use a dense copy of the training vectors for kernel evaluations if most
+   elements are present (default 1); results may differ from the sparse
+   code path in the last bits */
+extern int svm_dense_kernel;
+
 #ifdef __cplusplus
 }
 #endif
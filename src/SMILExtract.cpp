@@ -41,6 +41,7 @@ This is the main commandline application
 #include <configManager.hpp>
 #include <commandlineParser.hpp>
 #include <componentManager.hpp>
+#include <shardRunner.hpp>
 
 #define MODULE "SMILExtract"
 
@@ -88,6 +89,7 @@ int main(int argc, char *argv[])
     cmdline.addBoolean( "nologfile", 0, "don't write to a log file (e.g. on a read-only filesystem)", 0 );
     cmdline.addBoolean( "noconsoleoutput", 0, "don't output any messages to the console (log file is not affected by this option)", 0 );
     cmdline.addBoolean( "appendLogfile", 0, "append log messages to an existing logfile instead of overwriting the logfile at every start", 0 );
+    cmdline.addInt( "shards", 0, "Split the input of the cWaveSource into N time shards, which are processed in parallel processes (the output is the same as for a serial run, only csv, arff, and htk sinks are supported) (0/1 = no sharding)", 1 );
 
     int help = 0;
     if (cmdline.doParse() == -1) {
@@ -151,17 +153,32 @@ int main(int argc, char *argv[])
       return -1;
     }
 
-    /* create all instances specified in the config file */
-    cMan->createInstances(0); // 0 = do not read config (we already did that above..)
-
-    /*
-    MAIN TICK LOOP :
-    */
     cmanGlob = cMan;
     signal(SIGINT, INThandler); // install Ctrl+C signal handler
 
-    /* run single or mutli-threaded, depending on componentManager config in config file */
-    long long nTicks = cMan->runMultiThreaded(cmdline.getInt("nticks"));
+    /* sharded processing: each shard runs the graph in its own process, serial processing if the graph cannot be sharded */
+    int sharded = -1;
+    if (cmdline.getInt("shards") > 1) {
+      cShardRunner shards(configManager, cMan, cmdline.getInt("shards"));
+      sharded = shards.run(cmdline.getInt("nticks"));
+      if (sharded == 0) {
+        delete configManager;
+        delete cMan;
+        return EXIT_ERROR;
+      }
+    }
+
+    if (sharded == -1) {
+      /* create all instances specified in the config file */
+      cMan->createInstances(0); // 0 = do not read config (we already did that above..)
+
+      /*
+      MAIN TICK LOOP :
+      */
+
+      /* run single or mutli-threaded, depending on componentManager config in config file */
+      long long nTicks = cMan->runMultiThreaded(cmdline.getInt("nticks"));
+    }
 
     /* it is important that configManager is deleted BEFORE componentManger! 
       (since component Manger unregisters plugin Dlls, which might have allocated configTypes, etc.) */
@@ -70,6 +70,7 @@ SMILECOMPONENT_REGCOMP(cArffSink)
     ct->setField("instanceBase","if not empty, print instance name attribute <instanceBase_Nr>","");
     ct->setField("instanceName","if not empty, print instance name attribute <instanceName>","");
     ct->setField("number","print instance number (= frameIndex) attribute (1/0 = yes/no)",1);
+    ct->setField("precision","number of significant digits to print for each value (exponent notation, 7 = printf's %e), 0 = print the shortest text that reads back as the exact value",0);
 
     ConfigType * classType = new ConfigType("arffClass");
     classType->setField("name", "name of target", "class");
@@ -95,8 +96,10 @@ SMILECOMPONENT_CREATE(cArffSink)
 cArffSink::cArffSink(const char *_name) :
   cDataSink(_name),
   prname(0),
-  filehandle(NULL),
+  writer(NULL),
   filename(NULL),
+  precision(0),
+  rowLen(0),
   nInst(0),
   nClasses(0),
   inr(0),
@@ -124,6 +127,9 @@ void cArffSink::fetchConfig()
   number = getInt("number");
   if (append) SMILE_DBG(3,"printing instance number (=frame number) attribute enabled");
 
+  precision = getInt("precision");
+  SMILE_DBG(3,"precision = %i",precision);
+
   relation = getStr("relation");
   SMILE_DBG(3,"ARFF relation = '%s'",relation);
 
@@ -202,20 +208,23 @@ int cArffSink::myFinaliseInstance()
   int ret = cDataSink::myFinaliseInstance();
   if (ret==0) return 0;
 
+  // the numeric attributes are formatted directly into the output buffer, thus it must hold all of them
+  rowLen = (reader->getLevelN()+2) * SMILEUTIL_NUMSTR_MAX;
+  writer = createFileWriter(rowLen);
   if (append) {
     // check if file exists:
-    filehandle = fopen(filename, "r");
-    if (filehandle != NULL) {
-      fclose(filehandle);
-      filehandle = fopen(filename, "a");
+    FILE *f = fopen(filename, "r");
+    if (f != NULL) {
+      fclose(f);
+      writer->open(filename, "a");
       ap=1;
     } else {
-      filehandle = fopen(filename, "w");
+      writer->open(filename, "w");
     }
   } else {
-    filehandle = fopen(filename, "w");
+    writer->open(filename, "w");
   }
-  if (filehandle == NULL) {
+  if (!writer->isOpen()) {
     COMP_ERR("Error opening file '%s' for writing (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
   }
 
@@ -223,40 +232,42 @@ int cArffSink::myFinaliseInstance()
   if ((instanceName!=NULL)&&(strlen(instanceName)>0)) prname = 1;
   long _N = reader->getLevelN();
 
-  if (!ap) {
+  // per instance targets of a shard start at the first instance of the shard
+  if ((shardIndex > 0)&&(shardFrameStart > 0)) inr = shardFrameStart;
+
+  if ((!ap)&&(shardWriteHeader())) {
     // write arff header ....
-    fprintf(filehandle, "@relation %s%s%s",relation,NEWLINE,NEWLINE);
+    writer->printf("@relation %s%s%s",relation,NEWLINE,NEWLINE);
     if (prname) {
-      fprintf(filehandle, "@attribute name string%s",NEWLINE);
+      writer->printf("@attribute name string%s",NEWLINE);
     }
     if (number) {
-      fprintf(filehandle, "@attribute frameIndex numeric%s",NEWLINE);
+      writer->printf("@attribute frameIndex numeric%s",NEWLINE);
     }
     if (timestamp) {
-      fprintf(filehandle, "@attribute frameTime numeric%s",NEWLINE);
+      writer->printf("@attribute frameTime numeric%s",NEWLINE);
     }
 
     long i;
     for(i=0; i<_N; i++) {
       char *tmp = reader->getElementName(i);
-      fprintf(filehandle, "@attribute %s numeric%s",tmp,NEWLINE);
+      writer->printf("@attribute %s numeric%s",tmp,NEWLINE);
       free(tmp);
     }
 
     // TODO: classes..... as config file options...
     if (nClasses > 0) {
       for (i=0; i<nClasses; i++) {
-        if (classtype[i] == NULL) fprintf(filehandle, "@attribute %s numeric%s",classname[i],NEWLINE);
-        else fprintf(filehandle, "@attribute %s %s%s",classname[i],classtype[i],NEWLINE);
+        if (classtype[i] == NULL) writer->printf("@attribute %s numeric%s",classname[i],NEWLINE);
+        else writer->printf("@attribute %s %s%s",classname[i],classtype[i],NEWLINE);
       }
     } else {
       // default dummy class attribute...
-      fprintf(filehandle, "@attribute class {0,1,2,3}%s",NEWLINE);
+      writer->printf("@attribute class {0,1,2,3}%s",NEWLINE);
     }
 
-    fprintf(filehandle, "%s@data%s%s",NEWLINE,NEWLINE,NEWLINE);
+    writer->printf("%s@data%s%s",NEWLINE,NEWLINE,NEWLINE);
 
-    fflush(filehandle);
   }
 
   return ret;
@@ -265,31 +276,38 @@ int cArffSink::myFinaliseInstance()
 
 int cArffSink::myTick(long long t)
 {
-  if (filehandle == NULL) return 0;
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
 
   SMILE_DBG(4,"tick # %i, reading value vector (lag=%i):",t,lag);
   cVector *vec= reader->getFrameRel(lag);  //new cVector(nValues+1);
   if (vec == NULL) return 0;
   //else reader->nextFrame();
 
-  long vi = vec->tmeta->vIdx;
-  double tm = vec->tmeta->time;
+  long vi; double tm;
+  if (!shardMapFrame(vec, &vi, &tm)) return 1; // frame belongs to another shard
 
   if (prname==1) {
-    fprintf(filehandle,"'%s',",instanceName);
+    writer->printf("'%s',",instanceName);
   } else if (prname==2) {
-    fprintf(filehandle,"'%s_%i',",instanceBase,vi);
+    writer->printf("'%s_%i',",instanceBase,vi);
   }
-  if (number) fprintf(filehandle,"%i,",vi);
-  if (timestamp) fprintf(filehandle,"%f,",tm);
+
+  // number, timestamp, and the vector are formatted directly into the output buffer:
+  char *b = writer->reserve(rowLen);
+  if (b == NULL) return 0;
+  char *c = b;
+  if (number) { c += smileUtil_formatLong(c,vi); *(c++) = ','; }
+  if (timestamp) { c += sprintf(c,"%f,",tm); }
   
   // now print the vector:
   int i;
-  fprintf(filehandle,"%e",vec->dataF[0]);
+  c += smileUtil_formatFloat(c,vec->dataF[0],precision);
   for (i=1; i<vec->N; i++) {
-    fprintf(filehandle,",%e",vec->dataF[i]);
+    *(c++) = ',';
+    c += smileUtil_formatFloat(c,vec->dataF[i],precision);
     //printf("  (a=%i vi=%i, tm=%fs) %s.%s = %f\n",reader->getCurR(),vi,tm,reader->getLevelName(),vec->name(i),vec->dataF[i]);
   }
+  writer->commit(c - b);
 
   // classes: TODO:::
   if (nClasses > 0) {
@@ -299,19 +317,19 @@ int cArffSink::myTick(long long t)
         if (targetall != NULL) {
           for (i=0; i<nClasses; i++) {
             if (targetall[i] != NULL)
-              fprintf(filehandle,",%s",targetall[i]);
+              writer->printf(",%s",targetall[i]);
             else
-              fprintf(filehandle,",NULL");
+              writer->printf(",NULL");
           }
         } else {
           for (i=0; i<nClasses; i++) {
-            fprintf(filehandle,",NULL");
+            writer->printf(",NULL");
           }
         }
 		//inr++;
       } else {
         for (i=0; i<nClasses; i++) {
-          fprintf(filehandle,",%s",targetinst[i][inr]);
+          writer->printf(",%s",targetinst[i][inr]);
         }
 		inr++;
       }
@@ -319,24 +337,23 @@ int cArffSink::myTick(long long t)
       if (targetall != NULL) {
         for (i=0; i<nClasses; i++) {
           if (targetall[i] != NULL)
-            fprintf(filehandle,",%s",targetall[i]);
+            writer->printf(",%s",targetall[i]);
           else
-            fprintf(filehandle,",NULL");
+            writer->printf(",NULL");
         }
       } else {
         for (i=0; i<nClasses; i++) {
-          fprintf(filehandle,",NULL");
+          writer->printf(",NULL");
         }
       }
     }
   } else {
     // dummy class attribute, always 0
-    fprintf(filehandle,",0");
+    writer->printf(",0");
   }
 
-  fprintf(filehandle,"%s",NEWLINE);
+  writer->printf("%s",NEWLINE);
 
-  fflush(filehandle);
 
   // tick success
   return 1;
@@ -345,7 +362,7 @@ int cArffSink::myTick(long long t)
 
 cArffSink::~cArffSink()
 {
-  fclose(filehandle);
+  if (writer != NULL) delete writer;
   int i;
   if (classname!=NULL) {
     for (i=0; i<nClasses; i++) if (classname[i] != NULL) free(classname[i]);
@@ -49,10 +49,12 @@ ARFF file output (for WEKA)
 
 class cArffSink : public cDataSink {
   private:
-    FILE * filehandle;
+    cSmileFileWriter * writer;
     const char *filename;
     int lag;
     int append, timestamp, number, prname;
+    int precision;
+    long rowLen;  // max. length of the text of the numeric attributes of one instance
     const char *relation;
     const char *instanceBase, *instanceName;
     
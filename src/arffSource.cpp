@@ -42,12 +42,19 @@ writes data to data memory...
 #include <arffSource.hpp>
 #define MODULE "cArffSource"
 
+#ifndef __WINDOWS
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
 /*Library:
 sComponentInfo * registerMe(cConfigManager *_confman) {
   cDataSource::registerComponent(_confman);
 }
 */
 #define N_ALLOC_BLOCK 50
+#define READBUF_SIZE  (1<<20)
 
 SMILECOMPONENT_STATICS(cArffSource)
 
@@ -74,6 +81,9 @@ SMILECOMPONENT_REGCOMP(cArffSource)
   SMILECOMPONENT_IFNOTREGAGAIN(
     ct->setField("filename","arff file to read","input.arff");
     ct->setField("skipClasses","number of numeric(!) attributes (values) at end of each instance to skip",0);
+    ct->setField("blocksize", NULL, 100);
+    ct->setField("mmap","1 = memory map the arff file (if supported by the OS), 0 = read the file block by block",1);
+    ct->setField("parseThread","1 = parse the next block of instances in a background thread, while the current block is written to the data memory",1);
   )
 
 /*
@@ -92,10 +102,18 @@ SMILECOMPONENT_CREATE(cArffSource)
 
 cArffSource::cArffSource(const char *_name) :
   cDataSource(_name),
+  filehandle(NULL),
   field(NULL),
   fieldNalloc(0),
   lineNr(0),
-  eof(0)
+  eof(0),
+  useMmap(1), parseThread(1),
+  text(NULL), textLen(0), textPos(0),
+  mapData(NULL), mapSize(0),
+  readBuf(NULL), readBufSize(0),
+  textEof(0),
+  lastLine(NULL),
+  queue(NULL)
 {
 }
 
@@ -107,6 +125,8 @@ void cArffSource::fetchConfig()
   SMILE_DBG(2,"filename = '%s'",filename);
   skipClasses = getInt("skipClasses");
   SMILE_DBG(2,"skipClasses = %i",skipClasses);
+  useMmap = getInt("mmap");
+  parseThread = getInt("parseThread");
 }
 
 /*
@@ -123,82 +143,249 @@ int cArffSource::myConfigureInstance()
 }
 */
 
+// map the whole arff file into memory, returns 0 if this is not possible (then fread is used)
+int cArffSource::mapFile()
+{
+#ifndef __WINDOWS
+  struct stat st;
+  if (filehandle == NULL) return 0;
+  if (fstat(fileno(filehandle), &st) != 0) return 0;
+  if (st.st_size <= 0) return 0;
+  void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(filehandle), 0);
+  if (p == MAP_FAILED) return 0;
+#ifdef MADV_SEQUENTIAL
+  madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+  mapData = (const unsigned char *)p;
+  mapSize = (long)st.st_size;
+  text = (const char *)mapData;
+  textLen = mapSize;
+  textEof = 1;
+  // the mapping stays valid after the file is closed
+  fclose(filehandle); filehandle = NULL;
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+void cArffSource::closeFile()
+{
+  if (filehandle != NULL) { fclose(filehandle); filehandle = NULL; }
+#ifndef __WINDOWS
+  if (mapData != NULL) { munmap((void *)mapData, (size_t)mapSize); mapData = NULL; }
+#endif
+}
+
+/* return the next line of the file (without line end), *len is set to its length,
+   returns NULL at the end of the file; the line is terminated by a character which is not part of a number */
+const char * cArffSource::nextLine(long *len)
+{
+  const char *nl;
+  do {
+    nl = NULL;
+    if (textPos < textLen) nl = (const char *)memchr(text+textPos, '\n', textLen-textPos);
+    if ((nl == NULL)&&(!textEof)) {
+      // refill the read buffer: keep the incomplete line, grow the buffer if the line fills it completely
+      long rem = textLen - textPos;
+      if (rem > 0) memmove(readBuf, readBuf+textPos, rem);
+      if (rem >= readBufSize) {
+        readBuf = (char *)realloc(readBuf, readBufSize*2+1);
+        if (readBuf == NULL) OUT_OF_MEMORY;
+        readBufSize *= 2;
+      }
+      long n = (long)fread(readBuf+rem, 1, readBufSize-rem, filehandle);
+      if (n <= 0) textEof = 1;
+      textLen = rem + (n > 0 ? n : 0);
+      textPos = 0;
+      readBuf[textLen] = 0;
+      text = readBuf;
+    }
+  } while ((nl == NULL)&&(!textEof));
+
+  if (textPos >= textLen) return NULL;
+  const char *line = text+textPos;
+  if (nl != NULL) {
+    *len = (long)(nl - line);
+    textPos += *len + 1;
+  } else {
+    // last line without a line end
+    *len = textLen - textPos;
+    textPos = textLen;
+    if (mapData != NULL) {
+      // the mapped file is not terminated, work on a terminated copy
+      if (lastLine != NULL) free(lastLine);
+      lastLine = (char *)malloc(*len+1);
+      if (lastLine == NULL) OUT_OF_MEMORY;
+      memcpy(lastLine, line, *len);
+      lastLine[*len] = 0;
+      line = lastLine;
+    }
+  }
+  lineNr++;
+  if ((*len > 0)&&(line[*len-1] == '\r')) (*len)--;
+  return line;
+}
+
 int cArffSource::setupNewNames(long nEl)
 {
   // read header lines...
   int ret=1;
-  size_t n,read;
-  char *line=NULL;
+  long len;
+  const char *l;
   int head=1;
   int fnr = 0;
   int nnr = 0;
+  char **names = NULL;  // names of the numeric attributes, fields are added after skipClasses is applied
   do {
-    read = getline(&line, &n, filehandle);
-    if ((read > 0)&&(line!=NULL)) {
-      lineNr++;
-      if ( (!strncmp(line,"@attribute ",11))||(!strncmp(line,"@Attribute ",11))||(!strncmp(line,"@ATTRIBUTE ",11)) ) {
+    l = nextLine(&len);
+    if (l != NULL) {
+      // work on a terminated copy of the header line
+      char *line = (char *)malloc(len+1);
+      if (line == NULL) OUT_OF_MEMORY;
+      memcpy(line, l, len); line[len] = 0;
+      if (!strncasecmp(line,"@attribute ",11)) {
         char *name = line+11;
-        char *type = strchr(name,' ');
+        while ((*name == ' ')||(*name == '\t')) name++;
+        char *type;
+        if ((*name == '\'')||(*name == '"')) { // quoted name
+          type = strchr(name+1,*name);
+          name++;
+          if (type != NULL) *(type++) = 0;
+        } else {
+          type = strpbrk(name," \t");
+          if (type != NULL) *(type++) = 0;
+        }
         if (type != NULL) {
-          *(type++) = 0;
-          if (!strncmp(type,"numeric",7)) { // add numeric attribute:
-            writer->addField(name,1);
+          while ((*type == ' ')||(*type == '\t')) type++;
+          if ((!strncasecmp(type,"numeric",7))||(!strncasecmp(type,"real",4))||(!strncasecmp(type,"integer",7))) { // add numeric attribute:
             if (fnr >= fieldNalloc) {
               field = (int*)crealloc( field, sizeof(int)*(fieldNalloc+N_ALLOC_BLOCK), sizeof(int)*(fieldNalloc) );
+              names = (char**)crealloc( names, sizeof(char*)*(fieldNalloc+N_ALLOC_BLOCK), sizeof(char*)*(fieldNalloc) );
               fieldNalloc += N_ALLOC_BLOCK;
             }
             field[fnr] = 1;
+            names[fnr] = strdup(name);
             nnr++;
 
             // TODO: detect array fields [X]
+          } else { // nominal, string, or date attribute: skipped
+            if (fnr >= fieldNalloc) {
+              field = (int*)crealloc( field, sizeof(int)*(fieldNalloc+N_ALLOC_BLOCK), sizeof(int)*(fieldNalloc) );
+              names = (char**)crealloc( names, sizeof(char*)*(fieldNalloc+N_ALLOC_BLOCK), sizeof(char*)*(fieldNalloc) );
+              fieldNalloc += N_ALLOC_BLOCK;
+            }
+            field[fnr] = 0;
+            names[fnr] = NULL;
           }
           fnr++;
 
         } else { // ERROR:...
           ret=0;
         }
-      } else if ( (!strncmp(line,"@data",5))||(!strncmp(line,"@Data",5))||(!strncmp(line,"@DATA",5)) ) {
+      } else if (!strncasecmp(line,"@data",5)) {
         head = 0;
       }
+      free(line);
     } else {
       head = 0; eof=1;
       SMILE_ERR(1,"incomplete arff file '%s', could not find '@data' line!",filename);
       ret=0;
     } // ERROR: EOF in header!!!
   } while (head);
-  if (line!=NULL) free(line);
 
   // skip 'skipClasses' numeric classes from end
+  int i;
   if (skipClasses) {
-    int i;
     int s=skipClasses;
-    for (i=fnr-1; i>=0; i++) {
+    for (i=fnr-1; i>=0; i--) {
       if (field[i]) { field[i]=0; s--; nnr--; }
       if (s<=0) break;
     }
   }
+
+  for (i=0; i<fnr; i++) {
+    if (field[i]) writer->addField(names[i],1);
+    if (names[i] != NULL) free(names[i]);
+  }
+  if (names != NULL) free(names);
  
   nFields = fnr;
   nNumericFields = nnr;
 
-  allocVec(nnr);
-
   namesAreSet=1;
   return 1;
 }
 
+// parse the values of one data line, returns 0 if the line is empty or a comment
+int cArffSource::parseRow(const char *line, long len, FLOAT_DMEM *out)
+{
+  const char *p = line, *lineEnd = line+len;
+  while ((p < lineEnd)&&((*p == ' ')||(*p == '\t'))) p++;
+  if ((p >= lineEnd)||(*p == '%')) return 0;
+
+  int i = 0, ncnt = 0;
+  while ((p <= lineEnd)&&(i < nFields)) {
+    while ((p < lineEnd)&&((*p == ' ')||(*p == '\t'))) p++;
+    if (field[i]) { // if this field is numeric
+      const char *ep = p;
+      double val = 0.0;
+      if (p < lineEnd) val = smileUtil_parseDouble(p, &ep);
+      if ((ep == p)||(ep > lineEnd)) { SMILE_ERR(1,"error parsing value in arff file '%s' (line %i), expected double value (element %i).",filename,lineNr,i); val = 0.0; }
+      out[ncnt++] = (FLOAT_DMEM)val;
+      p = ep;
+    }
+    // find the next separator, skipping quoted values
+    while ((p < lineEnd)&&(*p != ',')) {
+      if ((*p == '\'')||(*p == '"')) {
+        const char *q = (const char *)memchr(p+1, *p, lineEnd-p-1);
+        p = (q != NULL) ? q+1 : lineEnd;
+      } else p++;
+    }
+    p++; i++;
+  }
+  // missing values at the end of the line
+  while (ncnt < nNumericFields) out[ncnt++] = 0.0;
+  return 1;
+}
+
+// parse up to m->nT instances into m, returns the number of instances parsed (0 at the end of the file)
+long cArffSource::parseBlock(void *_obj, cMatrix *m)
+{
+  cArffSource *obj = (cArffSource *)_obj;
+  long n = 0, len;
+  const char *line;
+  while (n < m->nT) {
+    line = obj->nextLine(&len);
+    if (line == NULL) break;
+    if (obj->parseRow(line, len, m->dataF + n*obj->nNumericFields)) n++;
+  }
+  return n;
+}
+
 int cArffSource::myFinaliseInstance()
 {
-  filehandle = fopen(filename, "r");
+  filehandle = fopen(filename, "rb");
   if (filehandle == NULL) {
     COMP_ERR("Error opening file '%s' for reading (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
   }
+  if ((!useMmap)||(!mapFile())) {
+    readBufSize = READBUF_SIZE;
+    readBuf = (char *)malloc(readBufSize+1);
+    if (readBuf == NULL) OUT_OF_MEMORY;
+    text = readBuf;
+    textLen = 0; textPos = 0;
+  }
 
   int ret = cDataSource::myFinaliseInstance();
 
   if (ret == 0) {
-    fclose(filehandle); filehandle = NULL;
+    closeFile();
+    return ret;
   }
+
+  queue = new cSmilePrefetchQueue(parseBlock, this, nNumericFields, blocksizeW, 2, parseThread);
+  queue->start();
   return ret;
   
 }
@@ -208,65 +395,34 @@ int cArffSource::myTick(long long t)
 {
   if (isEOI()) return 0;
   
-  SMILE_DBG(4,"tick # %i, reading value vector from arff file",t);
+  SMILE_DBG(4,"tick # %i, reading value vectors from arff file",t);
   if (eof) {
     SMILE_DBG(4,"(inst '%s') EOF, no more data to read",getInstName());
     return 0;
   }
 
-  if (!(writer->checkWrite(1))) return 0;
-  
-  size_t n,read;
-  char *line=NULL;
-  int l=1;
-  int len=0;
-  int i=0, ncnt=0;
-  // get next non-empty line
-  do {
-    read = getline(&line, &n, filehandle);
-    if ((read != -1)&&(line!=NULL)) {
-      lineNr++;
-      len=strlen(line);
-      if (len>0) { if (line[len-1] == '\n') { line[len-1] = 0; len--; } }
-      if (len>0) { if (line[len-1] == '\r') { line[len-1] = 0; len--; } }
-      while (((line[0] == ' ')||(line[0] == '\t'))&&(len>=0)) { line[0] = 0; line++; len--; }
-      if (len > 0) {
-        l=0;
-        char *x, *x0=line;
-        do {
-          x = strchr(x0,',');
-          if (x!=NULL) {
-            *(x++)=0;
-          }
-          if (field[i]) { // if this field is numeric
-            // convert value in x0
-            char *ep=NULL;
-            double val = strtod( x0, &ep );
-            if ((val==0.0)&&(ep==x0)) { SMILE_ERR(1,"error parsing value in arff file '%s' (line %i), expected double value (element %i).",filename,lineNr,i); }
-            vec->dataF[ncnt++] = (FLOAT_DMEM)val;
-          }
-          if (x!=NULL) {
-            i++;
-            x0=x;
-          }
-        } while (x!=NULL);
-      }
-    } else {
-      l=0; // EOF....  signal EOF...???
-      eof=1;
-    }
-  } while (l);
-
-  if (!eof) {
-    writer->setNextFrame(vec);
-    return 1;
+  // get the next parsed block
+  cMatrix *m = queue->front();
+  if (m == NULL) {
+    eof=1;
+    return 0;
   }
-  
-  return 0;
+
+  if (!(writer->checkWrite(m->nT))) return 0;
+  writer->setNextMatrix(m);
+
+  // hand the block back to the parser
+  queue->pop();
+  return 1;
 }
 
 
 cArffSource::~cArffSource()
 {
-  if (filehandle!=NULL) fclose(filehandle);
+  // stop the parser before the file is closed
+  if (queue != NULL) delete queue;
+  closeFile();
+  if (readBuf != NULL) free(readBuf);
+  if (lastLine != NULL) free(lastLine);
+  if (field != NULL) free(field);
 }
@@ -42,6 +42,7 @@
 
 #include <smileCommon.hpp>
 #include <dataSource.hpp>
+#include <smilePrefetchQueue.hpp>
 
 #define COMPONENT_DESCRIPTION_CARFFSOURCE "arff file reader"
 #define COMPONENT_NAME_CARFFSOURCE "cArffSource"
@@ -57,6 +58,26 @@ class cArffSource : public cDataSource {
     int eof;
     int skipClasses;
     long lineNr;
+    int useMmap, parseThread;
+
+    // input text: the memory mapped file, or a window of the file in readBuf (refilled with fread)
+    const char *text;
+    long textLen, textPos;
+    const unsigned char *mapData;
+    long mapSize;
+    char *readBuf;
+    long readBufSize;
+    int textEof;
+    char *lastLine;  // copy of an unterminated last line of a mapped file
+
+    // parsed frames: the parser thread fills the next block while the current one is written to the data memory
+    cSmilePrefetchQueue *queue;
+
+    int mapFile();
+    void closeFile();
+    const char * nextLine(long *len);
+    int parseRow(const char *line, long len, FLOAT_DMEM *out);
+    static long parseBlock(void *_obj, cMatrix *m);
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
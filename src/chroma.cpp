@@ -177,26 +177,11 @@ int cChroma::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsr
   // do domething to data in *src, save result to *dst
   // NOTE: *src and *dst may be the same...
 
-  int i,j,k;
-  double sum = 0.0;
-  
   nOctaves = Nsrc / octaveSize;
   if (Nsrc % octaveSize == 0)
   {
-    for (i = 0;i < octaveSize; i++)
-    {
-      dst[i] = 0.0;
-      for (j = 0;j < nOctaves; j++)
-      {
-        dst[i] += src[j * octaveSize + i];
-      }
-      sum += dst[i]*dst[i];
-    }
-    if (sum != 0.0) {
-      double power = sqrt(sum);
-      for (i = 0;i < octaveSize; i++)
-        dst[i] = dst[i] / power;
-    }
+    // sum up the octaves and normalise to unit length
+    smileDsp_chromaFold(src, dst, nOctaves, octaveSize);
   }
 
   return 1;
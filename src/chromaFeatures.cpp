@@ -168,179 +168,74 @@ int cExampleVectorProcessor::myFinaliseInstance()
   //return 1;
 //}
 
+/* key templates: weight of each semi-tone relative to the root note, for
+   scale, chords, PTR major, and PTR minor features */
+static const float chromaKeyTemplate[4][12] = {
+  { 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f },
+  { 3.0f, 0.0f, 1.0f, 0.0f, 2.0f, 1.0f, 0.0f, 2.0f, 0.0f, 2.0f, 0.0f, 1.0f },
+  { 6.6f, 2.2f, 3.5f, 2.4f, 4.8f, 4.2f, 2.6f, 5.5f, 2.0f, 3.8f, 2.4f, 3.3f },
+  { 6.5f, 2.7f, 3.0f, 5.2f, 2.8f, 3.3f, 2.6f, 4.8f, 4.2f, 3.0f, 3.5f, 3.0f }
+};
+
+// normalise 12 values to unit length (all zero values are left unchanged)
+static void chromaNormalise(FLOAT_DMEM *x)
+{
+  int i;
+  float power=0;
+  for (i=0;i<12;i++) power += x[i]*x[i];
+  if (power > 0) {
+    power = sqrt(power);
+    for (i=0;i<12;i++) x[i] /= power;
+  }
+}
+
 // a derived class should override this method, in order to implement the actual processing
 int cChromaFeatures::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
 {
   // do domething to data in *src, save result to *dst
   // NOTE: *src and *dst may be the same...
-  
-  float chroma[12];
-  int i,j;
-  float power=0;
-  j=12;
+  float chroma2[24];  // chroma vector, twice, to avoid modulo operations on the circular index
+  int i,j,k;
   FLOAT_DMEM *chromafeatures = dst;
+
+  if (Nsrc < 12) return 0;
   for (i=0;i<12;i++)  //get Chroma values from src
   {
-      chroma[i]=src[i];
+      chroma2[i]=chroma2[i+12]=src[i];
       chromafeatures[i]=src[i];
-
-  }
-  for (i=0;i<12;i++) //Scale Feature 12<j<23
-  {  
-      chromafeatures[j]=chroma[i]+chroma[(i+2)%12]+chroma[(i+4)%12]+chroma[(i+5)%12]+chroma[(i+7)%12]+chroma[(i+9)%12]+chroma[(i+11)%12];      
-      power+=chromafeatures[j]*chromafeatures[j];
-      j++;
-
-  }
-  power=sqrt(power);
-  for (j=12;j<24;j++) //Normalization of Scale
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-  
-  for (j=24;j<36;j++) //Scale Dominant Feature  24<=j<=35
-  {
-      chromafeatures[j]=chromafeatures[j-12]+chromafeatures[(j+7)%12+12];      
-      power+=chromafeatures[j]*chromafeatures[j];
-        }
-  power=sqrt(power);
-  for (j=24;j<36;j++) //Normalization of Scale Dominant
-  {
-      chromafeatures[j]=chromafeatures[j]/power; 
-  }
-  power=0;
-  
-  for (j=36;j<48;j++) //Scale Cadence Feature  36<j<47
-  {
-      chromafeatures[j]=chromafeatures[j-24]+chromafeatures[(j+5)%12+12]+chromafeatures[(j+7)%12+12];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=36;j<48;j++) //Normalization of Scale Cadence
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-
-
-  j=48;
-  for (i=0;i<12;i++) //Chords Feature  48<j<59
-  {  
-      chromafeatures[j]=3*chroma[i]+chroma[(i+2)%12]+2*chroma[(i+4)%12]+chroma[(i+5)%12]+2*chroma[(i+7)%12]+2*chroma[(i+9)%12]+chroma[(i+11)%12];     
-      power+=chromafeatures[j]*chromafeatures[j];
-      j++;
-  }
-  power=sqrt(power);
-  for (j=48;j<60;j++) //Normalization of Chords
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-
-  for (j=60;j<72;j++) //Chords Dominant Feature  60<j<71
-  {
-      chromafeatures[j]=chromafeatures[j-12]+chromafeatures[(j+7)%12+48];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=60;j<72;j++) //Normalization of Chords Dominant
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
   }
-  power=0;
 
-  for (j=72;j<84;j++) //Chords Cadence Feature  72<j<83
-  {
-      chromafeatures[j]=chromafeatures[j-24]+chromafeatures[(j+5)%12+48]+chromafeatures[(j+7)%12+48];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=72;j<84;j++) //Normalization of Chords Cadence
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
+  // for each key template: feature (e.g. scale), dominant, and cadence: 3 x 12 values
+  for (k=0;k<4;k++)
+  {
+    const float *tmpl = chromaKeyTemplate[k];
+    FLOAT_DMEM *f = chromafeatures + 12 + k*36;
+    FLOAT_DMEM *dom = f + 12;
+    FLOAT_DMEM *cad = f + 24;
+    float f2[24];
+
+    for (i=0;i<12;i++) // circular correlation of chroma and template
+    {
+      float sum = 0;
+      for (j=0;j<12;j++) sum += tmpl[j]*chroma2[i+j];
+      f[i] = sum;
+    }
+    chromaNormalise(f);
+
+    for (i=0;i<12;i++) f2[i]=f2[i+12]=f[i];
+    for (i=0;i<12;i++) //Dominant: root + fifth
+    {
+      dom[i] = f2[i] + f2[i+7];
+    }
+    chromaNormalise(dom);
+    for (i=0;i<12;i++) //Cadence: root + fourth + fifth
+    {
+      cad[i] = f2[i] + f2[i+5] + f2[i+7];
+    }
+    chromaNormalise(cad);
   }
-  power=0;
-
-  j=84;
-  for (i=0;i<12;i++) //PTR Major  84<j<95
-  {  
-      chromafeatures[j]=6.6*chroma[i]+2.2*chroma[(i+1)%12]+3.5*chroma[(i+2)%12]+2.4*chroma[(i+3)%12]+4.8*chroma[(i+4)%12]+4.2*chroma[(i+5)%12]+2.6*chroma[(i+6)%12]+5.5*chroma[(i+7)%12]+2*chroma[(i+8)%12]+3.8*chroma[(i+9)%12]+2.4*chroma[(i+10)%12]+3.3*chroma[(i+11)%12];     
-      power+=chromafeatures[j]*chromafeatures[j];
-      j++;
-  }
-  power=sqrt(power);
-  for (j=84;j<96;j++) //Normalization of PTR Major
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
 
-  for (j=96;j<108;j++) //PTR Major Dominant Feature  96<j<107
-  {
-      chromafeatures[j]=chromafeatures[j-12]+chromafeatures[(j+7)%12+84];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=96;j<108;j++) //Normalization of PTR Major Dominant
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-  
-  for (j=108;j<120;j++) //PTR Major Cadence Feature  108<j<119
-  {
-      chromafeatures[j]=chromafeatures[j-24]+chromafeatures[(j+5)%12+84]+chromafeatures[(j+7)%12+84];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=108;j<120;j++) //Normalization of PTR Major Cadence
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-
-  j=120;  
-  for (i=0;i<12;i++) //PTR Minor  120<j<131
-  {  
-      chromafeatures[j]=6.5*chroma[i]+2.7*chroma[(i+1)%12]+3*chroma[(i+2)%12]+5.2*chroma[(i+3)%12]+2.8*chroma[(i+4)%12]+3.3*chroma[(i+5)%12]+2.6*chroma[(i+6)%12]+4.8*chroma[(i+7)%12]+4.2*chroma[(i+8)%12]+3*chroma[(i+9)%12]+3.5*chroma[(i+10)%12]+3*chroma[(i+11)%12];     
-      power+=chromafeatures[j]*chromafeatures[j];      
-      j++;
-  }
-  power=sqrt(power);
-  for (j=120;j<132;j++) //Normalization of PTR Minor
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-  
-  for (j=132;j<144;j++) //PTR Minor Dominant Feature  132<j<143
-  {
-      chromafeatures[j]=chromafeatures[j-12]+chromafeatures[(j+7)%12+120];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=132;j<144;j++) //Normalization of PTR Minor Dominant
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-  
-  for (j=144;j<156;j++) //PTR Major Cadence Feature  144<j<155
-  {
-      chromafeatures[j]=chromafeatures[j-24]+chromafeatures[(j+5)%12+120]+chromafeatures[(j+7)%12+120];      
-      power+=chromafeatures[j]*chromafeatures[j];
-  }
-  power=sqrt(power);
-  for (j=144;j<156;j++) //Normalization of PTR Minor Cadence
-  {
-      chromafeatures[j]=chromafeatures[j]/power;      
-  }
-  power=0;
-
- // *dst=chromafeatures[0];  //????Syntax
   return 1;
-
 }
 
 cChromaFeatures::~cChromaFeatures()
@@ -42,13 +42,14 @@
 
 #define MODULE "commandlineParser"
 
-cCommandlineParser::cCommandlineParser(int _argc, char ** _argv) :
+cCommandlineParser::cCommandlineParser(int _argc, char ** _argv, const char *_progname) :
   active(0),
   N(0),
   opt(NULL),
   argc(0),
   argv(NULL),
-  Nalloc(0)
+  Nalloc(0),
+  progname(_progname)
 {
   if (_argc > 0) {
     argc = _argc;
@@ -339,7 +340,6 @@ int cCommandlineParser::doParse(int ignDupl, int ignUnknown)
     }
   }
 
-  // TODO: from argv[0] get correct 'binname' to pass to showUsage
   if (showusage) {
     showUsage();
     return -1;
@@ -362,6 +362,7 @@ int cCommandlineParser::doParse(int ignDupl, int ignUnknown)
 void cCommandlineParser::showUsage(const char *binname)
 {
   smilePrintHeader();
+  if (binname == NULL) binname = progname;
   if (binname == NULL) {
     SMILE_PRINT("Usage: SMILExtract [-option (value)] ...");
   } else {
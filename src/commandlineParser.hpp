@@ -77,6 +77,7 @@ class cCommandlineParser {
     int N,Nalloc;
     int active;
     struct sCmdlineOpt * opt;
+    const char *progname;  // program name shown in the usage (NULL = SMILExtract)
 
     int getWrIdx();
     int addOpt( const char *name, char abbr, const char *description, int argMandatory, int isMandatory);
@@ -86,7 +87,7 @@ class cCommandlineParser {
 
   public:
 
-    cCommandlineParser(int _argc, char ** _argv);
+    cCommandlineParser(int _argc, char ** _argv, const char *_progname=NULL);
 
     int addBoolean( const char *name, char abbr, const char *description , int dflt=0, int argMandatory=0, int isMandatory=0 );
     int addInt( const char *name, char abbr, const char *description , int dflt=0, int argMandatory=1, int isMandatory=0 );
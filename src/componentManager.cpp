@@ -112,6 +112,8 @@ Also be sure to include the necessary component header files
 // sources:
 #include <waveSource.hpp>
 #include <arffSource.hpp>
+#include <featureStoreSource.hpp>
+#include <compressedFeatureSource.hpp>
 #include <portaudioSource.hpp>
 // network sources:
 #include <activeMqSource.hpp>
@@ -121,6 +123,7 @@ Also be sure to include the necessary component header files
 #include <datadumpSink.hpp>
 #include <arffSink.hpp>
 #include <htkSink.hpp>
+#include <featureStoreSink.hpp>
 #include <libsvmSink.hpp>
 #include <waveSink.hpp>
 #include <waveSinkCut.hpp>
@@ -128,6 +131,8 @@ Also be sure to include the necessary component header files
 
 // live sinks (classifiers):
 #include <libsvmliveSink.hpp>
+#include <libsvmMultiSink.hpp>
+#include <nnSink.hpp>
 #include <tumkwsaSink.hpp>
 #include <tumkwsjSink.hpp>
 #include <portaudioSink.hpp>
@@ -143,10 +148,12 @@ Also be sure to include the necessary component header files
 // low-level signal processing:
 #include <transformFft.hpp>
 #include <fftmagphase.hpp>
+#include <fftFrontend.hpp>   // fused pre-emphasis, window, fft, magnitude
 #include <amdf.hpp>
 #include <acf.hpp>
 #include <preemphasis.hpp>
 #include <vectorPreemphasis.hpp>  // htk compatible (sloppy) pre-emphasis
+#include <nnProcessor.hpp>
 #include <mzcr.hpp>
 #include <echoAttenuator.hpp>
 #include <echoCanceller.hpp>
@@ -156,6 +163,7 @@ Also be sure to include the necessary component header files
 // LLD (low-level descriptors):
 #include <energy.hpp>
 #include <intensity.hpp>
+#include <timeLld.hpp>     // fused energy, intensity, zcr
 #include <dbA.hpp>
 #include <melspec.hpp>
 #include <mfcc.hpp>       // mfcc from melspec
@@ -216,6 +224,8 @@ DLLEXPORT const registerFunction componentlist[] = {
 
   cWaveSource::registerComponent,
   cArffSource::registerComponent,
+  cFeatureStoreSource::registerComponent,
+  cCompressedFeatureSource::registerComponent,
 
 #ifdef HAVE_PORTAUDIO
   cPortaudioSource::registerComponent,
@@ -229,11 +239,15 @@ DLLEXPORT const registerFunction componentlist[] = {
   cLibsvmSink::registerComponent,
   cCsvSink::registerComponent,
   cHtkSink::registerComponent,
+  cFeatureStoreSink::registerComponent,
   cDatadumpSink::registerComponent,
   cWaveSink::registerComponent,
   cWaveSinkCut::registerComponent,
 
   cLibsvmLiveSink::registerComponent,
+  cLibsvmMultiSink::registerComponent,
+  cNnSink::registerComponent,
+  cNnProcessor::registerComponent,
 
 #ifdef HAVE_RTNNLLIB
   nnlPlugin::registerComponent,
@@ -262,8 +276,10 @@ DLLEXPORT const registerFunction componentlist[] = {
   cTurnDetector::registerComponent,
   cEnergy::registerComponent,
   cIntensity::registerComponent,
+  cTimeLld::registerComponent,
   cTransformFFT::registerComponent,
   cFFTmagphase::registerComponent,
+  cFFTfrontend::registerComponent,
   cDbA::registerComponent,
   cMelspec::registerComponent,
   cTonespec::registerComponent,
@@ -336,6 +352,7 @@ void cComponentManager::registerType(cConfigManager *_confman) {
       comp, 1 );
     complist->setField( "printLevelStats", "1 = print detailed information about data memory level configuration, 2 = print even more details (?)",1);
     complist->setField( "nThreads", "number of threads to run (0=auto(=one thread per component), >0 = actual number of threads",1);
+    complist->setField( "pruneOutputs", "1 = dead output elimination: after setting up the component graph, determine the output elements which are not consumed by any sink (or by the selections of data selectors and classifiers), and set up the graph again, so that components read only the elements they consume and functionals and spectral features which are never used are not computed",0);
     ConfigInstance *Tdflt = new ConfigInstance( "cComponentManagerInst", complist, 1 );
     _confman->registerType(Tdflt);
     //confman->registerType( complist );
@@ -756,6 +773,7 @@ abortRequest(0),
 componentThreadId(NULL),
 EOI(0),
 isConfigured(0), isFinalised(0), printLevelStats(0),
+pruneOutputs(0), nPrunedLevels(0), nPrunedInputs(0), prunedLevel(NULL), prunedInput(NULL),
 messageCounter(0)
 {
   if (confman == NULL) COMP_ERR("cannot create component manager with _confman == NULL!");
@@ -1030,6 +1048,7 @@ void cComponentManager::createInstances(int readConfig)
   char *tmp = myvprint("%s.printLevelStats",CM_CONF_INST);
   printLevelStats = confman->getInt(tmp);
   free(tmp);
+  pruneOutputs = confman->getInt_f(myvprint("%s.pruneOutputs",CM_CONF_INST));
 
   // create component instances (datamemory, readers, writers, and the rest)
   //     const char **getArrayKeys(const char *_name, int *N=NULL) const;
@@ -1039,54 +1058,19 @@ void cComponentManager::createInstances(int readConfig)
   if (tmp!=NULL) free(tmp);
   if ((insts!=NULL)&&(_N>0)) {
     SMILE_DBG(2,"found %i component instances in config to create.",_N);
-    int i;
 
     // prepare threads:
     nThreads = confman->getInt_f(myvprint("%s.nThreads",CM_CONF_INST));
 
-    // create compnent objects and register them
-    for (i=0; i<_N; i++) {
-      const char *k = insts[i];
-      if (k!=NULL) {
-        const char *tp = confman->getStr_f(myvprint("%s.instance[%s].type",CM_CONF_INST,k));
-        const char *ci = confman->getStr_f(myvprint("%s.instance[%s].configInstance",CM_CONF_INST,k));
-        // check config:
-        if (tp == NULL) CONF_INVALID_ERR("%s.instance[%s].type is missing!",CM_CONF_INST,k);
-        if (ci == NULL) ci = k;
-        SMILE_DBG(2," adding %i. component instance: name '%s', type '%s', configInstance '%s'",i,k,tp,ci);
-        int tmpId = confman->getInt_f(myvprint("%s.instance[%s].threadId",CM_CONF_INST,k));
-        if (tmpId < -2) tmpId = -1;  // NOTE: threadId = -2 => do not tick this component at all!!
-        if (tmpId >= nThreads) {
-          CONF_INVALID_ERR("%s.instance[%s].threadId must be < %s.nThreads (first Id = 0)!",CM_CONF_INST,k,CM_CONF_INST);
-        }
-        int a = addComponent(k,tp,ci,tmpId);
-        if (a>=0) {
-          SMILE_DBG(4," added %i. component instance at index %i (lc=%i)",i,a,lastComponent);
-          // set configInstance name...
-          //          setConfigInstanceName..ok!
-        } else {
-          COMP_ERR("error during addComponent (returnVal=%i)!",a);
-        }
-      }
-    }
-
-    // configure and finalise components in turn:
-    // 1a. register (components, NON dataMemory)
-    // 1b. register (dataMemories)
-    // 2a. configure (components, NON dataMemory)
-    // 2b. configure (dataMemories)
-    // 3a. finalise (components, NON dataMemory)
-    // 3b. finalise (dataMemories)
-
-    // we need to do this so the readers of e.g. dataProcessors can be configured after the writers for the corresponding levels have been finalised
-
-    if (ciRegisterComps(0)) COMP_ERR("createInstances: failed registering component instances");
-    if (ciRegisterComps(1)) COMP_ERR("createInstances: failed registering dataMemory instances");
-
     int nFinC = 0, nFinD = 0;
-    if (ciConfFinComps(0,&nFinC)) COMP_ERR("createInstances: failed configuring&finalising component instances");
-    //if (ciConfigureComps(0)) COMP_ERR("createInstances: failed configuring component instances");
-    //if (ciFinaliseComps(0,&nFinC)) COMP_ERR("createInstances: failed finalising component instances");
+    setupInstances(insts, _N, &nFinC);
+
+    if ((pruneOutputs)&&(pruneDeadOutputs())) {
+      // set up the graph again, now the components read and compute only the elements which are consumed
+      SMILE_MSG(3,"dead output elimination: setting up the component instances again");
+      resetInstances();
+      setupInstances(insts, _N, &nFinC);
+    }
     isConfigured=1;
 
     if (ciConfigureComps(1)) COMP_ERR("createInstances: failed configuring dataMemory instances");
@@ -1098,6 +1082,54 @@ void cComponentManager::createInstances(int readConfig)
   }
 }
 
+// create the component objects and register, configure and finalise them (but not the dataMemories)
+void cComponentManager::setupInstances(char **insts, int _N, int *nFinC)
+{
+  int i;
+  // create compnent objects and register them
+  for (i=0; i<_N; i++) {
+    const char *k = insts[i];
+    if (k!=NULL) {
+      const char *tp = confman->getStr_f(myvprint("%s.instance[%s].type",CM_CONF_INST,k));
+      const char *ci = confman->getStr_f(myvprint("%s.instance[%s].configInstance",CM_CONF_INST,k));
+      // check config:
+      if (tp == NULL) CONF_INVALID_ERR("%s.instance[%s].type is missing!",CM_CONF_INST,k);
+      if (ci == NULL) ci = k;
+      SMILE_DBG(2," adding %i. component instance: name '%s', type '%s', configInstance '%s'",i,k,tp,ci);
+      int tmpId = confman->getInt_f(myvprint("%s.instance[%s].threadId",CM_CONF_INST,k));
+      if (tmpId < -2) tmpId = -1;  // NOTE: threadId = -2 => do not tick this component at all!!
+      if (tmpId >= nThreads) {
+        CONF_INVALID_ERR("%s.instance[%s].threadId must be < %s.nThreads (first Id = 0)!",CM_CONF_INST,k,CM_CONF_INST);
+      }
+      int a = addComponent(k,tp,ci,tmpId);
+      if (a>=0) {
+        SMILE_DBG(4," added %i. component instance at index %i (lc=%i)",i,a,lastComponent);
+        // set configInstance name...
+        //          setConfigInstanceName..ok!
+      } else {
+        COMP_ERR("error during addComponent (returnVal=%i)!",a);
+      }
+    }
+  }
+
+  // configure and finalise components in turn:
+  // 1a. register (components, NON dataMemory)
+  // 1b. register (dataMemories)
+  // 2a. configure (components, NON dataMemory)
+  // 2b. configure (dataMemories)
+  // 3a. finalise (components, NON dataMemory)
+  // 3b. finalise (dataMemories)
+
+  // we need to do this so the readers of e.g. dataProcessors can be configured after the writers for the corresponding levels have been finalised
+
+  if (ciRegisterComps(0)) COMP_ERR("createInstances: failed registering component instances");
+  if (ciRegisterComps(1)) COMP_ERR("createInstances: failed registering dataMemory instances");
+
+  if (ciConfFinComps(0,nFinC)) COMP_ERR("createInstances: failed configuring&finalising component instances");
+  //if (ciConfigureComps(0)) COMP_ERR("createInstances: failed configuring component instances");
+  //if (ciFinaliseComps(0,&nFinC)) COMP_ERR("createInstances: failed finalising component instances");
+}
+
 int cComponentManager::getNextComponentId()
 {
   if (lastComponent >= nComponentsAlloc) {  // reallocate a larger component array
@@ -1233,6 +1265,281 @@ void cComponentManager::resetInstances()
   EOI=0;
 }
 
+/******** dead output elimination ********/
+
+sDeadOutputInfo::sDeadOutputInfo(const char *_name, long _N) :
+  name(NULL), N(_N), el(NULL), need(NULL), srt(NULL)
+{
+  if (_name != NULL) name = strdup(_name);
+  if (N > 0) {
+    el = (char **)calloc(1,sizeof(char *)*N);
+    need = (char *)calloc(1,sizeof(char)*N);
+    if ((el == NULL)||(need == NULL)) OUT_OF_MEMORY;
+  }
+}
+
+static int deadOutputNameCmp(const void *a, const void *b)
+{
+  return strcmp(((const sDeadOutputName *)a)->name, ((const sDeadOutputName *)b)->name);
+}
+
+void sDeadOutputInfo::sortNames()
+{
+  long i;
+  if (N <= 0) return;
+  if (srt == NULL) srt = (sDeadOutputName *)malloc(sizeof(sDeadOutputName)*N);
+  if (srt == NULL) OUT_OF_MEMORY;
+  for (i=0; i<N; i++) {
+    srt[i].name = (el[i] != NULL) ? el[i] : "";
+    srt[i].idx = i;
+  }
+  qsort(srt, N, sizeof(sDeadOutputName), deadOutputNameCmp);
+}
+
+long sDeadOutputInfo::findElement(const char *n) const
+{
+  if ((srt == NULL)||(n == NULL)) return -1;
+  long lo=0, hi=N-1;
+  while (lo <= hi) {
+    long mid = (lo+hi)/2;
+    int c = strcmp(n, srt[mid].name);
+    if (c == 0) return srt[mid].idx;
+    if (c < 0) hi = mid-1;
+    else lo = mid+1;
+  }
+  return -1;
+}
+
+sDeadOutputInfo::~sDeadOutputInfo()
+{
+  long i;
+  if (el != NULL) {
+    for (i=0; i<N; i++) { if (el[i] != NULL) free(el[i]); }
+    free(el);
+  }
+  if (need != NULL) free(need);
+  if (srt != NULL) free(srt);
+  if (name != NULL) free(name);
+}
+
+const sDeadOutputInfo * cComponentManager::getPrunedLevel(const char *level)
+{
+  int i;
+  if (level == NULL) return NULL;
+  for (i=0; i<nPrunedLevels; i++) {
+    if (!strcmp(prunedLevel[i]->name,level)) return prunedLevel[i];
+  }
+  return NULL;
+}
+
+const sDeadOutputInfo * cComponentManager::getPrunedInput(const char *instname)
+{
+  int i;
+  if (instname == NULL) return NULL;
+  for (i=0; i<nPrunedInputs; i++) {
+    if (!strcmp(prunedInput[i]->name,instname)) return prunedInput[i];
+  }
+  return NULL;
+}
+
+void cComponentManager::freeDeadOutputInfo()
+{
+  int i;
+  for (i=0; i<nPrunedLevels; i++) delete prunedLevel[i];
+  for (i=0; i<nPrunedInputs; i++) delete prunedInput[i];
+  if (prunedLevel != NULL) free(prunedLevel);
+  if (prunedInput != NULL) free(prunedInput);
+  prunedLevel = NULL; prunedInput = NULL;
+  nPrunedLevels = 0; nPrunedInputs = 0;
+}
+
+// a level in one of the data memories, as seen by pruneDeadOutputs
+typedef struct {
+  cDataMemory *dm;
+  int idx;
+  long N;
+  char *need;
+  int nCons;      // number of consumers among the component instances
+  int nConsDone;  // number of consumers whose demand has been propagated
+  int full;       // all elements are needed (there are readers which are not known to us)
+} sDeadOutputLevel;
+
+static sDeadOutputLevel * findDeadOutputLevel(sDeadOutputLevel *lv, int nLv, const cDataMemory *dm, int idx)
+{
+  int i;
+  for (i=0; i<nLv; i++) {
+    if ((lv[i].dm == dm)&&(lv[i].idx == idx)) return lv+i;
+  }
+  return NULL;
+}
+
+/*
+  dead output elimination: starting from the sinks, propagate the sets of consumed elements backwards through
+  the component graph (cSmileComponent::markInputDemand). For each level of which only a part is consumed,
+  and for each component which consumes only a part of its input, the consumed element names are stored.
+  When the component instances are set up again, the readers present only the consumed elements of their input
+  (cDataReader::setDeadOutputInfo), and components like cFunctionals or cSpectral skip the outputs which are not consumed
+  (getPrunedLevel).
+  Returns 1 if anything can be pruned (the graph must then be set up again), 0 otherwise.
+*/
+int cComponentManager::pruneDeadOutputs()
+{
+  int i,k;
+  long n;
+  freeDeadOutputInfo();
+  int nComp = lastComponent;
+  if (nComp <= 0) return 0;
+
+  // collect the levels of all data memories
+  int nLv = 0;
+  for (i=0; i<nComp; i++) {
+    if ((component[i] != NULL)&&(compIsDm(component[i]->getTypeName()))) nLv += ((cDataMemory *)component[i])->getNLevels();
+  }
+  if (nLv <= 0) return 0;
+  sDeadOutputLevel *lv = (sDeadOutputLevel *)calloc(1,sizeof(sDeadOutputLevel)*nLv);
+  if (lv == NULL) OUT_OF_MEMORY;
+  nLv = 0;
+  for (i=0; i<nComp; i++) {
+    if ((component[i] != NULL)&&(compIsDm(component[i]->getTypeName()))) {
+      cDataMemory *dm = (cDataMemory *)component[i];
+      int l;
+      for (l=0; l<dm->getNLevels(); l++) {
+        const sDmLevelConfig *c = dm->getLevelConfig(l);
+        lv[nLv].dm = dm;
+        lv[nLv].idx = l;
+        lv[nLv].N = (c != NULL) ? c->N : 0;
+        if (lv[nLv].N > 0) lv[nLv].need = (char *)calloc(1,sizeof(char)*lv[nLv].N);
+        nLv++;
+      }
+    }
+  }
+
+  // count the consumers of each level
+  for (i=0; i<nComp; i++) {
+    if ((component[i] == NULL)||(compIsDm(component[i]->getTypeName()))) continue;
+    cDataReader *rd = component[i]->getInputReader();
+    if (rd == NULL) continue;
+    for (k=0; k<rd->getNLevels(); k++) {
+      sDeadOutputLevel *l = findDeadOutputLevel(lv, nLv, rd->getDmObj(), rd->getLevelIdx(k));
+      if (l != NULL) l->nCons++;
+    }
+  }
+  for (i=0; i<nLv; i++) {
+    if (lv[i].dm->getNreaders(lv[i].idx) > lv[i].nCons) lv[i].full = 1;
+  }
+
+  // propagate the demand backwards: a component is processed once all consumers of its output level are done
+  char *done = (char *)calloc(1,sizeof(char)*nComp);
+  char **inNeed = (char **)calloc(1,sizeof(char *)*nComp);
+  if ((done == NULL)||(inNeed == NULL)) OUT_OF_MEMORY;
+  int nTodo = 0;
+  for (i=0; i<nComp; i++) {
+    if ((component[i] == NULL)||(compIsDm(component[i]->getTypeName()))) done[i] = 1;
+    else nTodo++;
+  }
+  int progress = 1;
+  while ((nTodo > 0)&&(progress)) {
+    progress = 0;
+    for (i=0; i<nComp; i++) {
+      if (done[i]) continue;
+      cSmileComponent *c = component[i];
+      cDataWriter *wr = c->getOutputWriter();
+      sDeadOutputLevel *out = NULL;
+      if (wr != NULL) {
+        out = findDeadOutputLevel(lv, nLv, wr->getDmObj(), wr->getLevelIdx());
+        if ((out != NULL)&&(out->nConsDone < out->nCons)) continue;
+      }
+      done[i] = 1; nTodo--; progress = 1;
+
+      cDataReader *rd = c->getInputReader();
+      if (rd == NULL) continue;
+      long nIn = rd->getInputLevelOffset(rd->getNLevels());
+      if (nIn <= 0) continue;
+      const char *outNeed = NULL;
+      long nOut = 0;
+      if ((out != NULL)&&(!out->full)&&(out->need != NULL)) {
+        for (n=0; n<out->N; n++) { if (out->need[n]) break; }
+        // nothing of the output is consumed (the output is a dead end): keep the component as it is
+        if (n < out->N) { outNeed = out->need; nOut = out->N; }
+      }
+      inNeed[i] = (char *)calloc(1,sizeof(char)*nIn);
+      if (inNeed[i] == NULL) OUT_OF_MEMORY;
+      // sinks (no output) state their demand themselves, e.g. by the projection of their reader
+      if ((outNeed != NULL)||(wr == NULL)) c->markInputDemand(outNeed, nOut, inNeed[i], nIn);
+      else memset(inNeed[i], 1, nIn);
+      for (n=0; n<nIn; n++) { if (inNeed[i][n]) break; }
+      if (n == nIn) memset(inNeed[i], 1, nIn);
+
+      for (k=0; k<rd->getNLevels(); k++) {
+        sDeadOutputLevel *l = findDeadOutputLevel(lv, nLv, rd->getDmObj(), rd->getLevelIdx(k));
+        if (l == NULL) continue;
+        long off = rd->getInputLevelOffset(k);
+        for (n=0; (n<l->N)&&(off+n<nIn); n++) {
+          if (inNeed[i][off+n]) l->need[n] = 1;
+        }
+        l->nConsDone++;
+      }
+    }
+  }
+
+  int ret = 0;
+  if (nTodo > 0) {
+    SMILE_WRN(2,"dead output elimination: the component graph contains a cycle, not pruning any outputs");
+  } else {
+    long nPrunedEl = 0;
+    // levels of which only a part is consumed
+    prunedLevel = (sDeadOutputInfo **)calloc(1,sizeof(sDeadOutputInfo *)*nLv);
+    if (prunedLevel == NULL) OUT_OF_MEMORY;
+    for (i=0; i<nLv; i++) {
+      if ((lv[i].full)||(lv[i].need == NULL)) continue;
+      long nNeed = 0;
+      for (n=0; n<lv[i].N; n++) nNeed += lv[i].need[n];
+      if ((nNeed == 0)||(nNeed == lv[i].N)) continue;
+      sDeadOutputInfo *info = new sDeadOutputInfo(lv[i].dm->getLevelName(lv[i].idx), lv[i].N);
+      for (n=0; n<lv[i].N; n++) {
+        info->el[n] = lv[i].dm->getElementName(lv[i].idx, n);
+        info->need[n] = lv[i].need[n];
+      }
+      info->sortNames();
+      prunedLevel[nPrunedLevels++] = info;
+      nPrunedEl += lv[i].N - nNeed;
+      SMILE_MSG(3,"dead output elimination: %li of %li elements of level '%s' are consumed",nNeed,lv[i].N,info->name);
+    }
+    // components which consume only a part of their input, or whose input is pruned
+    prunedInput = (sDeadOutputInfo **)calloc(1,sizeof(sDeadOutputInfo *)*nComp);
+    if (prunedInput == NULL) OUT_OF_MEMORY;
+    for (i=0; i<nComp; i++) {
+      if (inNeed[i] == NULL) continue;
+      cDataReader *rd = component[i]->getInputReader();
+      long nIn = rd->getInputLevelOffset(rd->getNLevels());
+      int partial = 0;
+      for (n=0; n<nIn; n++) { if (!inNeed[i][n]) { partial = 1; break; } }
+      for (k=0; (k<rd->getNLevels())&&(!partial); k++) {
+        if (getPrunedLevel(rd->getInputLevelName(k)) != NULL) partial = 1;
+      }
+      if (!partial) continue;
+      sDeadOutputInfo *info = new sDeadOutputInfo(component[i]->getInstName(), nIn);
+      for (n=0; n<nIn; n++) {
+        info->el[n] = rd->getElementName(n);
+        info->need[n] = inNeed[i][n];
+      }
+      info->sortNames();
+      prunedInput[nPrunedInputs++] = info;
+    }
+    if ((nPrunedLevels > 0)||(nPrunedInputs > 0)) {
+      SMILE_MSG(2,"dead output elimination: %li elements in %i levels are not consumed, %i components read only a part of their input",nPrunedEl,nPrunedLevels,nPrunedInputs);
+      ret = 1;
+    }
+  }
+
+  for (i=0; i<nComp; i++) { if (inNeed[i] != NULL) free(inNeed[i]); }
+  free(inNeed);
+  free(done);
+  for (i=0; i<nLv; i++) { if (lv[i].need != NULL) free(lv[i].need); }
+  free(lv);
+  return ret;
+}
+
 int cComponentManager::findComponentInstance(const char *_compname) const
 {
   int i;
@@ -1549,6 +1856,7 @@ cComponentManager::~cComponentManager()
   int i;
 
   resetInstances();
+  freeDeadOutputInfo();
 
   for (i=0; i<lastComponent; i++) {
     //    unregisterComponentInstance(i);
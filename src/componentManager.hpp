@@ -56,6 +56,31 @@ extern DLLEXPORT const registerFunction componentlist[];
 #define MAX_CONF_ITER 4
 #define MAX_FIN_ITER  4
 
+/* dead output elimination (see cComponentManager::pruneDeadOutputs):
+   the elements of a level (or of a component's input) with a flag for each element that is consumed downstream */
+typedef struct {
+  const char *name;
+  long idx;
+} sDeadOutputName;
+
+class sDeadOutputInfo {
+  public:
+    char *name;   // level name or component instance name
+    long N;       // number of elements
+    char **el;    // element names
+    char *need;   // 1 = element is consumed
+    sDeadOutputName *srt;  // element names, sorted by sortNames()
+
+    sDeadOutputInfo(const char *_name, long _N);
+    // sort the element names, must be called once all names are set and before findElement()
+    void sortNames();
+    // index of element with name n, -1 if not found
+    long findElement(const char *n) const;
+    // 1 if element with name n is consumed (or is unknown)
+    int isNeeded(const char *n) const { long i = findElement(n); return ((i<0)||(need[i])); }
+    ~sDeadOutputInfo();
+};
+
 typedef struct {
   cComponentManager *obj;
   long long maxtick;
@@ -132,6 +157,7 @@ public:
   int registerComponentInstance(cSmileComponent * _component, const char *_typename, int _threadId=-1);  // register a component, return value: component id
   void unregisterComponentInstance(int id, int noDM=0);  // unregister and free component object
   int findComponentInstance(const char *_compname) const;
+  int getNComponentInstances() { return lastComponent; }
   cSmileComponent * getComponentInstance(int n);
   const char * getComponentInstanceType(int n);
   cSmileComponent * getComponentInstance(const char *_compname);
@@ -146,6 +172,11 @@ public:
   double getSmileTime();
 
   void resetInstances(void);  // delete all component instances and reset componentManger to state before createInstances
+
+  // dead output elimination: elements of level 'level' / of the input of component 'instname' which are consumed downstream,
+  // NULL if all elements are consumed (or pruneOutputs is disabled)
+  const sDeadOutputInfo * getPrunedLevel(const char *level);
+  const sDeadOutputInfo * getPrunedInput(const char *instname);
   void waitForAllThreads(int threadID);
   void decreaseNActive();
 
@@ -156,7 +187,7 @@ public:
     smileMutexUnlock(abortMtx);
   }
 
-  ~cComponentManager();              // unregister and free all component objects
+  virtual ~cComponentManager();              // unregister and free all component objects
 
 private:
   cConfigManager *confman;
@@ -164,6 +195,16 @@ private:
 
   int printLevelStats;
 
+  // dead output elimination
+  int pruneOutputs;
+  int nPrunedLevels, nPrunedInputs;
+  sDeadOutputInfo **prunedLevel;
+  sDeadOutputInfo **prunedInput;
+  int pruneDeadOutputs();
+  void freeDeadOutputInfo();
+
+  void setupInstances(char **insts, int _N, int *nFinC);
+
   struct timeval startTime;
   int nCompTs, nCompTsAlloc;
   sComponentInfo *compTs; // component types
@@ -0,0 +1,148 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component: compressedFeatureSource
+
+reads compressed feature files written by cHtkSink or cDatadumpSink
+with compress=1, see smileFeatureCodec.h for the file layout
+
+*/
+
+
+#include <compressedFeatureSource.hpp>
+#define MODULE "cCompressedFeatureSource"
+
+SMILECOMPONENT_STATICS(cCompressedFeatureSource)
+
+SMILECOMPONENT_REGCOMP(cCompressedFeatureSource)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CCOMPRESSEDFEATURESOURCE;
+  sdescription = COMPONENT_DESCRIPTION_CCOMPRESSEDFEATURESOURCE;
+
+  // we inherit cDataSource configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cDataSource")
+  
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->setField("filename","compressed feature file to read","input.htk");
+    ct->setField("featureName","name of the (array) field the feature vectors are stored in (the compressed file does not contain feature names)","fc");
+    ct->setField("blocksize", NULL, 100);
+  )
+
+  SMILECOMPONENT_MAKEINFO(cCompressedFeatureSource);
+}
+
+SMILECOMPONENT_CREATE(cCompressedFeatureSource)
+
+//-----
+
+cCompressedFeatureSource::cCompressedFeatureSource(const char *_name) :
+  cDataSource(_name),
+  filename(NULL),
+  featureName(NULL),
+  eof(0),
+  fc(NULL),
+  vecBuf(NULL)
+{
+}
+
+void cCompressedFeatureSource::fetchConfig()
+{
+  cDataSource::fetchConfig();
+  
+  filename = getStr("filename");
+  SMILE_DBG(2,"filename = '%s'",filename);
+  featureName = getStr("featureName");
+}
+
+int cCompressedFeatureSource::configureWriter(sDmLevelConfig &c)
+{
+  fc = smileFc_open(filename);
+  if (fc == NULL) {
+    COMP_ERR("Error opening file '%s' for reading, or file is not a compressed feature file (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
+  }
+  // the period from the config overrides the period stored in the file
+  if (period == 0.0) c.T = fc->h.period;
+  return 1;
+}
+
+int cCompressedFeatureSource::setupNewNames(long nEl)
+{
+  writer->addField(featureName, fc->h.vecSize);
+  namesAreSet = 1;
+  return 1;
+}
+
+int cCompressedFeatureSource::myFinaliseInstance()
+{
+  int ret = cDataSource::myFinaliseInstance();
+  if (ret == 0) return 0;
+  if (blocksizeW < 1) blocksizeW = 1;
+  vecBuf = (float *)malloc(sizeof(float)*fc->h.vecSize*blocksizeW);
+  if (vecBuf == NULL) OUT_OF_MEMORY;
+  return ret;
+}
+
+int cCompressedFeatureSource::myTick(long long t)
+{
+  if (isEOI()) return 0;
+  
+  SMILE_DBG(4,"tick # %i, reading value vectors from compressed feature file",t);
+  if (eof) {
+    SMILE_DBG(4,"(inst '%s') EOF, no more data to read",getInstName());
+    return 0;
+  }
+
+  long n = (long)blocksizeW;
+  if (!(writer->checkWrite(n))) return 0;
+  n = smileFc_read(fc, vecBuf, n);
+  if (n < 0) {
+    SMILE_IERR(1,"corrupt data in compressed feature file '%s' after %ld vectors",filename,fc->nRead);
+    eof = 1; return 0;
+  }
+  if (n == 0) { eof = 1; return 0; }
+  if ((mat == NULL)||(mat->nT != n)) allocMat(fc->h.vecSize, n);
+
+  long i, N = n*(long)fc->h.vecSize;
+  for (i=0; i<N; i++) mat->dataF[i] = (FLOAT_DMEM)vecBuf[i];
+
+  writer->setNextMatrix(mat);
+  return 1;
+}
+
+
+cCompressedFeatureSource::~cCompressedFeatureSource()
+{
+  if (fc != NULL) smileFc_close(fc);
+  if (vecBuf != NULL) free(vecBuf);
+}
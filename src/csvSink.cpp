@@ -69,6 +69,7 @@ SMILECOMPONENT_REGCOMP(cCsvSink)
     ct->setField("timestamp","print timestamp attribute (1/0 = yes/no)",1);
     ct->setField("number","print instance number (= frameIndex) attribute (1/0 = yes/no)",1);
     ct->setField("printHeader","print header with attribute names (1/0 = yes/no)",1);
+    ct->setField("precision","number of significant digits to print for each value (exponent notation, 7 = printf's %e), 0 = print the shortest text that reads back as the exact value",0);
 
 //    ct->setField("instanceBase","if not empty, print instance name attribute <instanceBase_Nr>","");
 //    ct->setField("instanceName","if not empty, print instance name attribute <instanceName>","");
@@ -84,10 +85,12 @@ SMILECOMPONENT_CREATE(cCsvSink)
 
 cCsvSink::cCsvSink(const char *_name) :
   cDataSink(_name),
-  filehandle(NULL),
+  writer(NULL),
   filename(NULL),
   printHeader(0),
-  delimChar(';')
+  delimChar(';'),
+  precision(0),
+  rowLen(0)
 {
 }
 
@@ -116,6 +119,9 @@ void cCsvSink::fetchConfig()
   timestamp = getInt("timestamp");
   if (append) SMILE_DBG(3,"printing timestamp attribute (index 1) enabled");
 
+  precision = getInt("precision");
+  SMILE_DBG(3,"precision = %i",precision);
+
 /*
   instanceBase = getStr("instanceBase");
   SMILE_DBG(3,"instanceBase = '%s'",instanceBase);
@@ -145,41 +151,44 @@ int cCsvSink::myFinaliseInstance()
   int ret = cDataSink::myFinaliseInstance();
   if (ret==0) return 0;
   
+  // each row is formatted directly into the output buffer, thus it must hold one complete row
+  rowLen = (reader->getLevelN()+2) * SMILEUTIL_NUMSTR_MAX + (long)strlen(NEWLINE);
+  writer = createFileWriter(rowLen);
   if (append) {
     // check if file exists:
-    filehandle = fopen(filename, "r");
-    if (filehandle != NULL) {
-      fclose(filehandle);
-      filehandle = fopen(filename, "a");
+    FILE *f = fopen(filename, "r");
+    if (f != NULL) {
+      fclose(f);
+      writer->open(filename, "a");
       ap=1;
     } else {
-      filehandle = fopen(filename, "w");
+      writer->open(filename, "w");
     }
   } else {
-    filehandle = fopen(filename, "w");
+    writer->open(filename, "w");
   }
-  if (filehandle == NULL) {
+  if (!writer->isOpen()) {
     COMP_ERR("Error opening file '%s' for writing (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
   }
   
-  if ((!ap)&&(printHeader)) {
+  if ((!ap)&&(printHeader)&&(shardWriteHeader())) {
     // write header ....
     if (number) {
-      fprintf(filehandle, "frameIndex%c",delimChar);
+      writer->printf("frameIndex%c",delimChar);
     }
     if (timestamp) {
-      fprintf(filehandle, "frameTime%c",delimChar);
+      writer->printf("frameTime%c",delimChar);
     }
 
     long _N = reader->getLevelN();
     long i;
     for(i=0; i<_N-1; i++) {
       char *tmp = reader->getElementName(i);
-      fprintf(filehandle, "%s%c",tmp,delimChar);
+      writer->printf("%s%c",tmp,delimChar);
       free(tmp);
     }
     char *tmp = reader->getElementName(i);
-    fprintf(filehandle, "%s%s",tmp,NEWLINE);
+    writer->printf("%s%s",tmp,NEWLINE);
     free(tmp);
   }
   
@@ -189,34 +198,41 @@ int cCsvSink::myFinaliseInstance()
 
 int cCsvSink::myTick(long long t)
 {
-  if (filehandle == NULL) return 0;
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
 
   SMILE_DBG(4,"tick # %i, writing to CSV file (lag=%i):",t,lag);
   cVector *vec= reader->getFrameRel(lag);  //new cVector(nValues+1);
   if (vec == NULL) return 0;
   //else reader->nextFrame();
 
-  long vi = vec->tmeta->vIdx;
-  double tm = vec->tmeta->time;
+  long vi; double tm;
+  if (!shardMapFrame(vec, &vi, &tm)) return 1; // frame belongs to another shard
   
 /*
   if (prname==1) {
-    fprintf(filehandle,"'%s',",instanceName);
+    writer->printf("'%s',",instanceName);
   } else if (prname==2) {
-    fprintf(filehandle,"'%s_%i',",instanceBase,vi);
+    writer->printf("'%s_%i',",instanceBase,vi);
   }
   */
   
 
-  if (number) fprintf(filehandle,"%i%c",vi,delimChar);
-  if (timestamp) fprintf(filehandle,"%f%c",tm,delimChar);
+  // the row is formatted directly into the output buffer:
+  char *b = writer->reserve(rowLen);
+  if (b == NULL) return 0;
+  char *c = b;
+  if (number) { c += smileUtil_formatLong(c,vi); *(c++) = delimChar; }
+  if (timestamp) { c += sprintf(c,"%f",tm); *(c++) = delimChar; }
 
   // now print the vector:
   int i;
-  for (i=0; i<vec->N-1; i++) {
-    fprintf(filehandle,"%e%c",vec->dataF[i],delimChar);
+  for (i=0; i<vec->N; i++) {
+    c += smileUtil_formatFloat(c,vec->dataF[i],precision);
+    *(c++) = delimChar;
   }
-  fprintf(filehandle,"%e%s",vec->dataF[0],NEWLINE);
+  if (vec->N > 0) c--;
+  memcpy(c,NEWLINE,strlen(NEWLINE));
+  writer->commit(c - b + strlen(NEWLINE));
 
   // tick success
   return 1;
@@ -225,6 +241,6 @@ int cCsvSink::myTick(long long t)
 
 cCsvSink::~cCsvSink()
 {
-  fclose(filehandle);
+  if (writer != NULL) delete writer;
 }
 
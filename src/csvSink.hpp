@@ -49,11 +49,13 @@ Comma Separated Value file output (CSV)
 
 class cCsvSink : public cDataSink {
   private:
-    FILE * filehandle;
+    cSmileFileWriter * writer;
     const char *filename;
     char delimChar;
     int lag;
     int append, timestamp, number, printHeader;
+    int precision;
+    long rowLen;  // max. length of the text of one row
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
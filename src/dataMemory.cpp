@@ -410,6 +410,20 @@ void cDataMemoryLevel::frameRd(long rIdx, INT_DMEM *_data)
   }
 }
 
+void cDataMemoryLevel::frameRd(long rIdx, FLOAT_DMEM *_data, const long *sel, long nSel)
+{
+  const FLOAT_DMEM *f = data->dataF + rIdx*lcfg.N;
+  long i;
+  for (i=0; i<nSel; i++) _data[i] = f[sel[i]];
+}
+
+void cDataMemoryLevel::frameRd(long rIdx, INT_DMEM *_data, const long *sel, long nSel)
+{
+  const INT_DMEM *f = data->dataI + rIdx*lcfg.N;
+  long i;
+  for (i=0; i<nSel; i++) _data[i] = f[sel[i]];
+}
+
 /*
 const sDmLevelConfig * cDataMemoryLevel::getConfig()
 {
@@ -441,6 +455,7 @@ void cDataMemoryLevel::printLevelStats(int detail)
 {
   if (detail) {
     SMILE_PRINT("==> LEVEL '%s'  +++  Buffersize(frames) = %i  +++  nReaders = %i",getName(),lcfg.nT,nReaders);
+    if (vSrc != NULL) SMILE_PRINT("     virtual level on '%s' : frameStep = %i  frameSize = %i  (frames)",vSrc->getName(),vStep,vSize);
     if (detail >= 2) {
     // TODO: more details  AND warn if nReaders == 0 or size == 0, etc.
       SMILE_PRINT("     Period(in seconds) = %f \t frameSize(in seconds) = %f",lcfg.T,lcfg.frameSizeSec);
@@ -621,6 +636,33 @@ int cDataMemoryLevel::finaliseLevel()   // finalize config and allocate data mem
     //if (lcfg.blocksizeIsSet) return 1;
   if (lcfg.finalised) return 1;
 
+  if (vSrc != NULL) {
+    // a virtual level has no buffer, its size follows from the source level's buffer
+    if (!vSrc->finaliseLevel()) return 0;
+    if (!lcfg.namesAreSet) {
+      COMP_ERR("cannot finalise level '%s' : namesAreSet=0",getName());
+    }
+    if (lcfg.N != vSrc->lcfg.N * vSize) COMP_ERR("cDataMemoryLevel::finaliseLevel: virtual level '%s' has %i elements, but source level '%s' provides %i x %i elements!",getName(),lcfg.N,vSrc->getName(),vSrc->lcfg.N,vSize);
+    lcfg.isRb = vSrc->lcfg.isRb;
+    lcfg.growDyn = 0;
+    if (lcfg.isRb) {
+      // the source keeps the frames of our slowest reader (see syncVirtual), frames published beyond those
+      // must still be inside our buffer, otherwise the reader's index would be moved ahead
+      lcfg.nT = (vSrc->lcfg.nT - vSize - MIN(vPre,0)) / vStep + 1;
+    } else {
+      lcfg.nT = (vSrc->lcfg.nT - vSize - vPre) / vStep + 1;
+    }
+    if (lcfg.nT < 1) COMP_ERR("cDataMemoryLevel::finaliseLevel: buffer of level '%s' (%i frames) is too small for the frames (size %i) of virtual level '%s'!",vSrc->getName(),vSrc->lcfg.nT,vSize,getName());
+    lcfg.blocksizeIsSet = 1;
+
+    smileMutexCreate(RWptrMtx);
+    smileMutexCreate(RWmtx);
+    smileMutexCreate(RWstatMtx);
+
+    lcfg.finalised = 1;
+    return 1;
+  }
+
   // TODO: what is the actual minimum buffersize, given blocksizeRead and blocksizeWrite??
   long minBuf;  // = blocksizeRead + 2*blocksizeWrite;
   if (lcfg.blocksizeReader <= lcfg.blocksizeWriter) {
@@ -660,6 +702,148 @@ int cDataMemoryLevel::finaliseLevel()   // finalize config and allocate data mem
   return 1;
 }
 
+int cDataMemoryLevel::setVirtualSource(cDataMemoryLevel *src, int srcRdId, long step, long size, long pre)
+{
+  if (lcfg.finalised) { SMILE_ERR(2,"cannot make level '%s' virtual, it is already finalised!",getName()); return 0; }
+  if ((src == NULL)||(src == this)||(step < 1)||(size < 1)) return 0;
+  if (src->isVirtual()) { SMILE_DBG(2,"virtual level '%s' cannot be the source of virtual level '%s'!",src->getName(),getName()); return 0; }
+  if ((src->lcfg.type != DMEM_FLOAT)||(lcfg.type != DMEM_FLOAT)) { SMILE_ERR(2,"virtual level '%s': only float levels are supported!",getName()); return 0; }
+  if (src->lcfg.growDyn) { SMILE_ERR(2,"virtual level '%s': source level '%s' must not grow dynamically!",getName(),src->getName()); return 0; }
+  vSrc = src;
+  vSrcRdId = srcRdId;
+  vStep = step;
+  vSize = size;
+  vPre = pre;
+  return 1;
+}
+
+void cDataMemoryLevel::updateVirtualSourceBlocksize()
+{
+  if ((vSrc != NULL)&&(!vSrc->lcfg.blocksizeIsSet)) {
+    // the source keeps the frame before our slowest reader's read index (see syncVirtual), and the reader's
+    // next block may start one frame after its read index
+    long need = (lcfg.blocksizeReader+2)*vStep + vSize;
+    vSrc->queryReadConfig( need );
+    // the source writer must be able to write a full block while these frames are kept
+    if (vSrc->lcfg.nT < need + vSrc->lcfg.blocksizeWriter) vSrc->lcfg.nT = need + vSrc->lcfg.blocksizeWriter;
+  }
+}
+
+int cDataMemoryLevel::syncVirtual()
+{
+  if ((vSrc == NULL)||(!lcfg.finalised)) return 0;
+
+  int ret = 0;
+  long srcW = vSrc->getCurW();
+  long w = 0, r;
+  if (srcW-vPre-vSize >= 0) w = (srcW-vPre-vSize)/vStep + 1;
+
+  smileMutexLock(RWptrMtx);
+  if (w > curW) { curW = w; ret = 1; }
+  // keep the frame before the slowest reader's read index, it may still be in the process of being read
+  if (nReaders > 0) r = (curR-1)*vStep + vPre;
+  else r = srcW;
+  smileMutexUnlock(RWptrMtx);
+
+  if ((r > 0)&&(r > vSrc->getCurR(vSrcRdId))) {
+    vSrc->catchupCurR(vSrcRdId, r);
+    ret = 1;
+  }
+  return ret;
+}
+
+void cDataMemoryLevel::readLock()
+{
+  smileMutexLock(RWstatMtx);
+  // check for urgent write request:
+  while (writeReqFlag) { // wait until write request has been served!
+    smileMutexUnlock(RWstatMtx);
+    smileYield();
+    smileMutexLock(RWstatMtx);
+  }
+  if (nCurRdr == 0) {
+    nCurRdr++;
+    smileMutexUnlock(RWstatMtx);
+    smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
+    smileMutexLock(RWstatMtx);
+  } else {
+    nCurRdr++;
+  }
+  smileMutexUnlock(RWstatMtx);
+}
+
+void cDataMemoryLevel::readUnlock()
+{
+  smileMutexLock(RWstatMtx);
+  nCurRdr--;
+  if (nCurRdr < 0) { // ERROR!!
+    SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
+    nCurRdr = 0;
+  }
+  if (nCurRdr==0) smileMutexUnlock(RWmtx);
+  smileMutexUnlock(RWstatMtx);
+}
+
+// copy frame vIdx of virtual level v directly from our buffer, the frame data is strided by lcfg.N in our buffer,
+// and is split in two parts if it wraps around the end of the ring buffer
+int cDataMemoryLevel::readStrided(const cDataMemoryLevel *v, long vIdx, FLOAT_DMEM *_data, TimeMetaInfo *tm)
+{
+  long start = vIdx*v->vStep + v->vPre;
+  long len = v->vSize;
+  long first = start;
+  if (first < 0) first = 0;
+  if (first >= start+len) return 0;
+
+  readLock();
+
+  smileMutexLock(RWptrMtx);
+  long minR = 0;
+  if ((lcfg.isRb)&&(curW > lcfg.nT)) minR = curW-lcfg.nT;
+  int ok = ((first >= minR)&&(start+len <= curW));
+  smileMutexUnlock(RWptrMtx);
+
+  if (ok) {
+    long N = lcfg.N;
+    long i0 = first-start;                  // frames before the beginning of the input, the first frame is repeated
+    long r0 = first % lcfg.nT;
+    long n1 = MIN(len-i0, lcfg.nT-r0);      // frames up to the end of the buffer
+    long n2 = len-i0-n1;                    // frames wrapped to the beginning of the buffer
+    long e,k;
+    if (N == 1) {
+      FLOAT_DMEM *x = data->dataF;
+      for (k=0; k<i0; k++) _data[k] = x[r0];
+      memcpy(_data+i0, x+r0, sizeof(FLOAT_DMEM)*n1);
+      if (n2 > 0) memcpy(_data+i0+n1, x, sizeof(FLOAT_DMEM)*n2);
+    } else {
+      for (e=0; e<N; e++) {
+        FLOAT_DMEM *y = _data + e*len;
+        FLOAT_DMEM *x = data->dataF + r0*N + e;
+        for (k=0; k<i0; k++) *(y++) = *x;
+        for (k=0; k<n1; k++) { *(y++) = *x; x += N; }
+        x = data->dataF + e;
+        for (k=0; k<n2; k++) { *(y++) = *x; x += N; }
+      }
+    }
+
+    if (tm != NULL) {
+      // equivalent to cMatrix::tmetaSquash() on the matrix of the frames read
+      TimeMetaInfo *t0 = tmeta + r0;
+      TimeMetaInfo *t1 = tmeta + (start+len-1)%lcfg.nT;
+      memcpy( tm, t0, sizeof(TimeMetaInfo) );
+      tm->framePeriod = t0->period;
+      tm->lengthSec = t1->time - t0->time + t1->lengthSec;
+      tm->vLengthSec = tm->lengthSec;
+      tm->lengthFrames = (long)ceil(tm->lengthSec / tm->framePeriod);
+      tm->vLengthFrames = (long)ceil(tm->vLengthSec / tm->framePeriod);
+      tm->lengthSamples = (long)ceil(tm->lengthSec / tm->samplePeriod);
+      tm->vLengthSamples = (long)ceil(tm->vLengthSec / tm->samplePeriod);
+    }
+  }
+
+  readUnlock();
+  return ok;
+}
+
 void cDataMemoryLevel::catchupCurR(int rdId, int _curR) 
 {
   smileMutexLock(RWptrMtx);
@@ -679,6 +863,7 @@ void cDataMemoryLevel::catchupCurR(int rdId, int _curR)
 int cDataMemoryLevel::setFrame(long vIdx, const cVector *vec, int special)  // id must already be resolved...!
 {
   if (!lcfg.finalised) { COMP_ERR("cannot set frame in non-finalised level! call finalise() first!"); }
+  if (vSrc != NULL) { SMILE_ERR(2,"setFrame: cannot write to virtual level '%s'!",getName()); return 0; }
   if (vec == NULL) {
     SMILE_ERR(3,"cannot set frame in dataMemory from a NULL cVector object!");
     return 0;
@@ -719,6 +904,7 @@ int cDataMemoryLevel::setFrame(long vIdx, const cVector *vec, int special)  // i
 int cDataMemoryLevel::setMatrix(long vIdx, const cMatrix *mat, int special)  // id must already be resolved...!
 {
   if (!lcfg.finalised) { COMP_ERR("cannot set matrix in non-finalised level '%s'! call finalise() first!",getName()); }
+  if (vSrc != NULL) { SMILE_ERR(2,"setMatrix: cannot write to virtual level '%s'!",getName()); return 0; }
   if (mat == NULL) {
     SMILE_ERR(3,"cannot set frame in dataMemory from a NULL cMatrix object!");
     return 0;
@@ -780,9 +966,23 @@ int cDataMemoryLevel::setMatrix(long vIdx, const cMatrix *mat, int special)  //
 //                repeat first/last possible frames...
 
 // NOTE: caller must free the returned vector!!
-cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *result)
+cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *result, const long *sel, long nSel)
 {
   if (!lcfg.finalised) { COMP_ERR("cannot get frame from non-finalised level '%s'! call finalise() first!",getName()); }
+  if (vSrc != NULL) {
+    cVector *vf = getVirtualFrame(vIdx, special, rdId, result);
+    if ((vf == NULL)||(sel == NULL)) return vf;
+    // virtual frames are assembled from the source level, select the elements afterwards
+    cVector *vec = new cVector(nSel,lcfg.type);
+    if (vec == NULL) OUT_OF_MEMORY;
+    long i;
+    if (lcfg.type == DMEM_FLOAT) { for (i=0; i<nSel; i++) vec->dataF[i] = vf->dataF[sel[i]]; }
+    else if (lcfg.type == DMEM_INT) { for (i=0; i<nSel; i++) vec->dataI[i] = vf->dataI[sel[i]]; }
+    vec->tmetaClone(vf->tmeta);
+    vec->fmeta = vf->fmeta;
+    delete vf;
+    return vec;
+  }
 
 //****** acquire read lock.... *******
   smileMutexLock(RWstatMtx);
@@ -811,10 +1011,17 @@ cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *resu
 
   cVector *vec=NULL;
   if (rIdx>=0) {
-    vec = new cVector(lcfg.N,lcfg.type);
-    if (vec == NULL) OUT_OF_MEMORY;
-    if (lcfg.type == DMEM_FLOAT) frameRd(rIdx, vec->dataF);
-    else if (lcfg.type == DMEM_INT) frameRd(rIdx, vec->dataI);
+    if (sel != NULL) {
+      vec = new cVector(nSel,lcfg.type);
+      if (vec == NULL) OUT_OF_MEMORY;
+      if (lcfg.type == DMEM_FLOAT) frameRd(rIdx, vec->dataF, sel, nSel);
+      else if (lcfg.type == DMEM_INT) frameRd(rIdx, vec->dataI, sel, nSel);
+    } else {
+      vec = new cVector(lcfg.N,lcfg.type);
+      if (vec == NULL) OUT_OF_MEMORY;
+      if (lcfg.type == DMEM_FLOAT) frameRd(rIdx, vec->dataF);
+      else if (lcfg.type == DMEM_INT) frameRd(rIdx, vec->dataI);
+    }
     getTimeMeta(rIdx,vec->tmeta);
     vec->fmeta = &(fmeta);
     if (result!=NULL) *result=DMRES_OK;
@@ -845,6 +1052,7 @@ cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *resu
 cMatrix * cDataMemoryLevel::getMatrix(long vIdx, long vIdxEnd, int special, int rdId, int *result)
 {
   if (!lcfg.finalised) { COMP_ERR("cannot get matrix from non-finalised level! call finalise() first!"); }
+  if (vSrc != NULL) return getVirtualMatrix(vIdx, vIdxEnd, special, rdId, result);
 
   // TODO: if vIdx < 0 but vIdxEnd > 0 and range 0..vIdxEnd is valid, then zeroPad!
   long vIdxold=vIdx;
@@ -940,6 +1148,84 @@ cMatrix * cDataMemoryLevel::getMatrix(long vIdx, long vIdxEnd, int special, int
   return mat;
 }
 
+// the source level is locked by readStrided(), the index pointers of this level are only changed by validateIdx*R() and syncVirtual()
+cVector * cDataMemoryLevel::getVirtualFrame(long vIdx, int special, int rdId, int *result)
+{
+  smileMutexLock(RWptrMtx);
+  long rIdx = validateIdxR(&vIdx,special,rdId);
+  smileMutexUnlock(RWptrMtx);
+
+  cVector *vec=NULL;
+  if (rIdx>=0) {
+    vec = new cVector(lcfg.N,lcfg.type);
+    if (vec == NULL) OUT_OF_MEMORY;
+    if (vSrc->readStrided(this, vIdx, vec->dataF, vec->tmeta)) {
+      vec->tmeta->level = myId;
+      vec->tmeta->vIdx = vIdx;
+      vec->tmeta->period = lcfg.T;
+      if (vec->tmeta->time == 0.0) vec->tmeta->time = (double)vIdx * lcfg.T;
+      vec->fmeta = &(fmeta);
+      if (result!=NULL) *result=DMRES_OK;
+    } else {
+      // source frames were overwritten already
+      delete vec; vec = NULL;
+      rIdx = -2;
+    }
+  }
+  if (rIdx < 0) {
+    SMILE_DBG(4,"getFrame: frame index (vIdx %i -> rIdx %i) out of range, frame cannot be read (virtual level '%s')!",vIdx,rIdx,getName());
+    if (result!=NULL) {
+      if (rIdx == -2) *result=DMRES_OORleft|DMRES_ERR;
+      else if (rIdx == -3) *result=DMRES_OORright|DMRES_ERR;
+      else if (rIdx == -4) *result=DMRES_OORbs|DMRES_ERR;
+      else *result=DMRES_ERR;
+    }
+  }
+  return vec;
+}
+
+cMatrix * cDataMemoryLevel::getVirtualMatrix(long vIdx, long vIdxEnd, int special, int rdId, int *result)
+{
+  long vIdxold=vIdx;
+  if (vIdx < 0) vIdx = 0;
+  int padEnd = 0;
+
+  smileMutexLock(RWptrMtx);
+  long rIdx = validateIdxRangeR(&vIdx, vIdxEnd, special, rdId, 0, &padEnd);
+  smileMutexUnlock(RWptrMtx);
+
+  cMatrix *mat=NULL;
+  if (rIdx>=0) {
+    long i0 = 0;
+    if (vIdxold < 0) { i0 = -vIdxold; mat = new cMatrix(lcfg.N,vIdxEnd-vIdxold,lcfg.type); }
+    else mat = new cMatrix(lcfg.N,vIdxEnd-vIdx,lcfg.type);
+    if (mat == NULL) OUT_OF_MEMORY;
+    long nRd = vIdxEnd-vIdx-padEnd; // number of frames actually available
+    if (nRd < 1) nRd = 1;
+    long i,j;
+    // same padding as getMatrix: repeat first frame at the beginning and last frame at the end, or pad with zeros
+    for (i=0; i<mat->nT; i++) {
+      j = i-i0;
+      if (j < 0) j = 0;
+      else if (j >= nRd) j = nRd-1;
+      if (!vSrc->readStrided(this, vIdx+j, mat->dataF + i*lcfg.N, mat->tmeta + i)) {
+        delete mat; mat = NULL;
+        break;
+      }
+      if ((special == DMEM_PAD_ZERO)&&(j != i-i0)) memset(mat->dataF + i*lcfg.N, 0, sizeof(FLOAT_DMEM)*lcfg.N);
+      mat->tmeta[i].level = myId;
+      mat->tmeta[i].vIdx = vIdx+j;
+      mat->tmeta[i].period = lcfg.T;
+      if (mat->tmeta[i].time == 0.0) mat->tmeta[i].time = (double)(vIdx+j) * lcfg.T;
+    }
+    if (mat != NULL) mat->fmeta = &(fmeta);
+  }
+  if (mat == NULL) {
+    SMILE_ERR(4,"getMatrix: frame index range (vIdxStart %i - vIdxEnd %i  => rIdxStart %i) out of range, matrix cannot be read (virtual level '%s')!",vIdx,vIdxEnd,rIdx,getName());
+  }
+  return mat;
+}
+
 // methods to get info about current level fill status (e.g. number of frames written, curW, curR(global) and freeSpace, etc.)
 long cDataMemoryLevel::getMaxR() 
 { 
@@ -1206,6 +1492,10 @@ int cDataMemory::myFinaliseInstance()
   // now finalise the levels (allocate storage memory and finalise config):
   if (nLevels>=0) {
     int i;
+    // virtual levels must report their readers' blocksize to their source levels first
+    for (i=0; i<=nLevels; i++) {
+      level[i]->updateVirtualSourceBlocksize();
+    }
     for (i=0; i<=nLevels; i++) {
       // actually finalise now
       SMILE_DBG(3,"finalising level %i (allocating buffer, etc.)",i);
@@ -554,6 +554,11 @@ int  noHang;
 
     int EOI;
     
+    /* virtual framed level: if vSrc is set, this level has no buffer of its own. frame vIdx is a view of
+       frames vIdx*vStep+vPre .. vIdx*vStep+vPre+vSize-1 of level vSrc (vSize values per element of vSrc) */
+    cDataMemoryLevel *vSrc;
+    int vSrcRdId;   // our reader id in vSrc, its read index follows the slowest reader of this level
+    long vStep, vSize, vPre;
 
 
     /*
@@ -765,10 +770,23 @@ int  noHang;
     // write frame data from level's data matrix at pos rIdx to *_data
     void frameRd(long rIdx, FLOAT_DMEM *_data);
     void frameRd(long rIdx, INT_DMEM *_data);
+    // read only the elements sel[0..nSel-1] of the frame at pos rIdx
+    void frameRd(long rIdx, FLOAT_DMEM *_data, const long *sel, long nSel);
+    void frameRd(long rIdx, INT_DMEM *_data, const long *sel, long nSel);
 
     void setTimeMeta(long rIdx, long vIdx, const TimeMetaInfo *tm);
     void getTimeMeta(long rIdx, TimeMetaInfo *tm);
 
+    // acquire / release a shared read lock on the level data (writes are excluded while held)
+    void readLock();
+    void readUnlock();
+
+    // getFrame / getMatrix for virtual levels
+    cVector * getVirtualFrame(long vIdx, int special, int rdId, int *result);
+    cMatrix * getVirtualMatrix(long vIdx, long vIdxEnd, int special, int rdId, int *result);
+    // read the frame vIdx of virtual level v (geometry from v) from this level into _data, and its squashed time meta into *tm
+    int readStrided(const cDataMemoryLevel *v, long vIdx, FLOAT_DMEM *_data, TimeMetaInfo *tm);
+
   public:
 
     // create level from given level configuration struct, the name in &cfg will be overwritten via _name parameter
@@ -777,7 +795,8 @@ int  noHang;
       lcfg(_name, cfg), fmetaNalloc(0),
       data(NULL), tmeta(NULL), EOI(0),
       curW(0), curR(0), curRr(NULL), nReaders(0), 
-      nCurRdr(0), writeReqFlag(0)
+      nCurRdr(0), writeReqFlag(0),
+      vSrc(NULL), vSrcRdId(-1), vStep(1), vSize(1), vPre(0)
     {
       //if ((nT == 0)&&(cfg.lenSec > 0.0)&&(cfg.T>0.0)) { nT = (long)ceil( cfg.lenSec / cfg.T ); }
       if (lcfg.T < 0.0) COMP_ERR("cannot create dataMemoryLevel with period (%f) < 0.0",lcfg.T);
@@ -793,7 +812,8 @@ int  noHang;
       data(NULL),  tmeta(NULL), EOI(0),
       curW(0), curR(0), curRr(NULL), nReaders(0),
       //,RWptrMtx(NULL), RWstatMtx(NULL), RWmtx(NULL),
-      nCurRdr(0), writeReqFlag(0)
+      nCurRdr(0), writeReqFlag(0),
+      vSrc(NULL), vSrcRdId(-1), vStep(1), vSize(1), vPre(0)
     {
       if (lcfg.nT <= 0) COMP_ERR("temporal size of dataMemoryLevel cannot be <= 0  (= %i)!",lcfg.nT);
       if (lcfg.nT < 2) lcfg.nT = 2;
@@ -828,6 +848,17 @@ int  noHang;
     // allocate config for the readers and initialize it with standard values
     void allocReaders();
 
+    /* turn this level into a virtual framed level over level src (call before finalising):
+       frame vIdx will be frames vIdx*step+pre .. vIdx*step+pre+size-1 of src, for each element of src,
+       indicies < 0 repeat the first frame of src. src must be a float level, srcRdId is a reader id registered in src */
+    int setVirtualSource(cDataMemoryLevel *src, int srcRdId, long step, long size, long pre);
+    int isVirtual() const { return (vSrc != NULL); }
+    /* report the source blocksize required by the readers of this virtual level (call before any level is finalised) */
+    void updateVirtualSourceBlocksize();
+    /* publish the frames that are now complete in the source level and let the source level
+       advance past frames no longer needed by any of our readers, returns 1 if a pointer changed */
+    int syncVirtual();
+
     // configure level (check buffersize and config)
     int configureLevel();   
     // finalize config and allocate data memory
@@ -853,7 +884,8 @@ int  noHang;
     // int special = special index, e.g. DMEM_IDX_CURR, DMEM_IDX_CURW
     // *result (if not NULL) will contain a result code indicating success or reason of failure (left or right buffer margin exceeded, etc.)
     // rdId is the id of the current reader (or -1 for an unregistered or global reader)
-    cVector * getFrame(long vIdx, int special=-1, int rdId=-1, int *result=NULL);  
+    // if sel is not NULL, only the elements sel[0..nSel-1] are read (the returned vector has nSel elements, fmeta describes the full frame)
+    cVector * getFrame(long vIdx, int special=-1, int rdId=-1, int *result=NULL, const long *sel=NULL, long nSel=0);  
     cMatrix * getMatrix(long vIdx, long vIdxEnd, int special=-1, int rdId=-1, int *result=NULL);  
 
     /* check if a read of length "len" at vIdx or "special" will succeed for reader rdId */
@@ -1182,6 +1214,8 @@ class cDataMemory : public cSmileComponent {
 
     // get index of level 'name'
     int findLevel(const char *name);
+    // number of levels in this data memory
+    int getNLevels() { return nLevels+1; }
 
     /**** functions which will be forwarded to the corresponding level *****/
 
@@ -1207,6 +1241,12 @@ class cDataMemory : public cSmileComponent {
     // finalise level n, return 1 on success, 0 on failure
     int finaliseLevel(int n);
 
+    /* make level _level a virtual framed level over _srcLevel (see cDataMemoryLevel::setVirtualSource) */
+    int setVirtualSource(int _level, int _srcLevel, int _srcRdId, long _step, long _size, long _pre)
+      { if ((_level>=0)&&(_level<=nLevels)&&(_srcLevel>=0)&&(_srcLevel<=nLevels)&&(_level!=_srcLevel)) return level[_level]->setVirtualSource(level[_srcLevel],_srcRdId,_step,_size,_pre); else return 0; }
+    int syncVirtual(int _level)
+      { if ((_level>=0)&&(_level<=nLevels)) return level[_level]->syncVirtual(); else return 0; }
+
     int setFrame(int _level, long vIdx, const cVector *vec, int special=-1/*, int *result=NULL*/)
       { if ((_level>=0)&&(_level<=nLevels)) return level[_level]->setFrame(vIdx,vec,special/*, result*/); else return 0; }
     int setMatrix(int _level, long vIdx, const cMatrix *mat, int special=-1/*, int *result=NULL*/)
@@ -1219,8 +1259,8 @@ class cDataMemory : public cSmileComponent {
     // the memory pointed to by the return value must be freed via delete() by the calling code!!
     // TODO: optimise this... don't allocate a new frame everytime something is returned!! maybe provide an option
          // for passing a buffer frame or so...
-    cVector * getFrame(int _level, long vIdx, int special=-1, int rdId=-1, int *result=NULL)
-      { if ((_level>=0)&&(_level<=nLevels)) return level[_level]->getFrame(vIdx,special,rdId,result); else return NULL; }
+    cVector * getFrame(int _level, long vIdx, int special=-1, int rdId=-1, int *result=NULL, const long *sel=NULL, long nSel=0)
+      { if ((_level>=0)&&(_level<=nLevels)) return level[_level]->getFrame(vIdx,special,rdId,result,sel,nSel); else return NULL; }
     cMatrix * getMatrix(int _level, long vIdx, long vIdxEnd, int special=-1, int rdId=-1, int *result=NULL)
       { if ((_level>=0)&&(_level<=nLevels)) return level[_level]->getMatrix(vIdx,vIdxEnd,special,rdId,result); else return NULL; }
 
@@ -40,6 +40,7 @@ write data to data memory...
 
 
 #include <dataProcessor.hpp>
+#include <componentManager.hpp>
 
 #define MODULE "cDataProcessor"
 
@@ -203,6 +204,8 @@ int cDataProcessor::configureReader()
 int cDataProcessor::myConfigureInstance()
 {
   if (!(reader->configureInstance())) return 0;
+  // read only the input elements that are consumed downstream (if dead output elimination has pruned our input)
+  reader->setDeadOutputInfo(getCompMan()->getPrunedInput(getInstName()), 1);
   // finalise the reader first. this makes sure that the names in the input level are set up correctly
   if (!(reader->finaliseInstance())) return 0;
 
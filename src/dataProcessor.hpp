@@ -106,6 +106,10 @@ class cDataProcessor : public cSmileComponent {
     SMILECOMPONENT_STATIC_DECL
     
     cDataProcessor(const char *_name);
+
+    virtual cDataReader * getInputReader() { return reader; }
+    virtual cDataWriter * getOutputWriter() { return writer; }
+
     virtual ~cDataProcessor();
 };
 
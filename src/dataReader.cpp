@@ -35,6 +35,7 @@
 
 
 #include <dataReader.hpp>
+#include <componentManager.hpp>
 
 #define MODULE "cDataReader"
 
@@ -68,6 +69,12 @@ cDataReader::cDataReader(const char *_name) : cSmileComponent(_name),
   dmLevel(NULL),
   level(NULL),
   V(NULL),
+  projIdx(NULL),
+  projN(0),
+  Vp(NULL),
+  pruneInfo(NULL),
+  pruneView(0),
+  curNames(NULL),
   m(NULL),
   curR(0),
   stepM(1),
@@ -304,6 +311,8 @@ int cDataReader::myFinaliseInstance()
     }
   }
 
+  if ((pruneInfo != NULL)&&(pruneView)) setupPrunedView();
+
   //----- DONE: ???
   // todo .. MANUALLY update other values in myLcfg, e.g. blocksizeWriter, etc...
 
@@ -313,6 +322,110 @@ int cDataReader::myFinaliseInstance()
   return 1;
 }
 
+/* select the input elements which are consumed downstream (pruneInfo) and present only these:
+   the projection is set to the consumed elements and myfmeta, myLcfg->N and Nf are replaced by the
+   names and sizes of the view. Consecutive elements of a field are kept together in one field,
+   single elements of array fields are extended to two elements, so that the view keeps the array element names */
+int cDataReader::setupPrunedView()
+{
+  long Nfull = Le[nLevels];
+  long n;
+  char *keep = (char *)calloc(1,sizeof(char)*Nfull);
+  if (keep == NULL) OUT_OF_MEMORY;
+
+  long nKeep = 0;
+  for (n=0; n<Nfull; n++) {
+    char *el = dm->getElementName(level[eToL[n]],n-Le[eToL[n]]);
+    if ((el == NULL)||(pruneInfo->isNeeded(el))) { keep[n] = 1; nKeep++; }
+    if (el != NULL) free(el);
+  }
+  if ((nKeep == Nfull)||(nKeep == 0)) {
+    free(keep); return 0;
+  }
+
+  // extend single elements of array fields
+  long f, e=0;
+  for (f=0; f<myfmeta->N; f++) {
+    long fN = myfmeta->field[f].N;
+    if (fN > 1) {
+      for (n=e; n<e+fN; n++) {
+        if ((keep[n])&&((n==e)||(!keep[n-1]))&&((n==e+fN-1)||(!keep[n+1]))) {
+          if (n<e+fN-1) keep[n+1] = 1;
+          else keep[n-1] = 1;
+        }
+      }
+    }
+    e += fN;
+  }
+
+  // count the runs of kept elements within the fields
+  long nRuns=0;
+  nKeep = 0; e = 0;
+  for (f=0; f<myfmeta->N; f++) {
+    for (n=e; n<e+myfmeta->field[f].N; n++) {
+      if (keep[n]) {
+        nKeep++;
+        if ((n==e)||(!keep[n-1])) nRuns++;
+      }
+    }
+    e += myfmeta->field[f].N;
+  }
+
+  long *idx = (long *)malloc(sizeof(long)*nKeep);
+  FrameMetaInfo *fm = new FrameMetaInfo();
+  if ((idx == NULL)||(fm == NULL)) OUT_OF_MEMORY;
+  fm->N = nRuns;
+  fm->field = (FieldMetaInfo *)calloc(1,sizeof(FieldMetaInfo)*nRuns);
+  if (fm->field == NULL) OUT_OF_MEMORY;
+
+  long r=-1, k=0;
+  e = 0;
+  for (f=0; f<myfmeta->N; f++) {
+    const FieldMetaInfo *src = myfmeta->field+f;
+    for (n=e; n<e+src->N; n++) {
+      if (keep[n]) {
+        if ((n==e)||(!keep[n-1])) {
+          r++;
+          fm->field[r].name = strdup(src->name);
+          fm->field[r].Nstart = k;
+          fm->field[r].N = 0;
+          fm->field[r].arrNameOffset = src->arrNameOffset + (int)(n-e);
+        }
+        fm->field[r].N++;
+        idx[k++] = n;
+      }
+    }
+    e += src->N;
+  }
+  free(keep);
+
+  if (projIdx != NULL) free(projIdx);
+  projIdx = idx;
+  projN = nKeep;
+  delete myfmeta;
+  myfmeta = fm;
+  myLcfg->fmeta = myfmeta;
+  myLcfg->N = nKeep;
+  myLcfg->Nf = nRuns;
+  SMILE_IMSG(3,"dead output elimination: reading %li of %li input elements",nKeep,Nfull);
+  return 1;
+}
+
+long cDataReader::mapUnprunedIndex(long idx)
+{
+  if (pruneInfo == NULL) return idx;
+  if ((idx < 0)||(idx >= pruneInfo->N)) return -1;
+  if (curNames == NULL) {
+    long n;
+    curNames = new sDeadOutputInfo(getInstName(), myLcfg->N);
+    for (n=0; n<myLcfg->N; n++) {
+      curNames->el[n] = getElementName(n);
+    }
+    curNames->sortNames();
+  }
+  return curNames->findElement(pruneInfo->el[idx]);
+}
+
 long cDataReader::getMinR()
 { 
   // NOTE: "minimum index that is readable", thus we must take the MAX among all input levels!!
@@ -355,7 +468,7 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
       if (result != NULL) *result |= myResult;
     }
     if (r) {
-      if (_V==NULL) _V = new cVector(myLcfg->N,myLcfg->type);
+      if (_V==NULL) _V = new cVector(Le[nLevels],myLcfg->type);
       int fmetaUpdate = 0;
       if (myfmeta == NULL) { 
         fmetaUpdate = 1;
@@ -409,6 +522,20 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
         }
       }
 
+      if (projIdx != NULL) {
+        // select the projected elements from the concatenated frame
+        cVector *pv = new cVector(projN,myLcfg->type);
+        if (pv == NULL) OUT_OF_MEMORY;
+        if (myLcfg->type == DMEM_FLOAT) { for (i=0; i<projN; i++) pv->dataF[i] = _V->dataF[projIdx[i]]; }
+        else if (myLcfg->type == DMEM_INT) { for (i=0; i<projN; i++) pv->dataI[i] = _V->dataI[projIdx[i]]; }
+        pv->tmetaClone(_V->tmeta);
+        pv->fmeta = myfmeta;
+        if (privateVec) { delete _V; return pv; }
+        V = _V;
+        if (Vp != NULL) delete Vp;
+        Vp = pv;
+        return pv;
+      }
       if (!privateVec) V=_V;
       //if ((_V != NULL)&&(vIdx>curR)) curR=vIdx;
       return _V;
@@ -417,7 +544,8 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
     }
   
   } else {
-    cVector *f2 = dm->getFrame(level[0],vIdx, special, rdId[0], result);
+    cVector *f2 = dm->getFrame(level[0],vIdx, special, rdId[0], result, projIdx, projN);
+    if ((f2 != NULL)&&(isPruned())) f2->fmeta = myfmeta;
     if ((f2 != NULL)&&(!privateVec)) {
       if (V != NULL) delete V;
       V = f2;
@@ -428,6 +556,37 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
 }
 
 cMatrix * cDataReader::getMatrix(long vIdx, long _length, int special, int privateVec) // vIdx: start index of matrix (absolute)
+{
+  if (!isPruned()) return readMatrix(vIdx, _length, special, privateVec);
+
+  // pruned view: read the full input and select the consumed elements
+  cMatrix *full = readMatrix(vIdx, _length, special, 1);
+  if (full == NULL) return NULL;
+  cMatrix *pm = new cMatrix(projN,full->nT,full->type);
+  if (pm == NULL) OUT_OF_MEMORY;
+  long t,i;
+  for (t=0; t<full->nT; t++) {
+    if (full->type == DMEM_FLOAT) {
+      FLOAT_DMEM *s = full->dataF + t*full->N;
+      FLOAT_DMEM *d = pm->dataF + t*projN;
+      for (i=0; i<projN; i++) d[i] = s[projIdx[i]];
+    } else if (full->type == DMEM_INT) {
+      INT_DMEM *s = full->dataI + t*full->N;
+      INT_DMEM *d = pm->dataI + t*projN;
+      for (i=0; i<projN; i++) d[i] = s[projIdx[i]];
+    }
+  }
+  pm->tmetaClone(full->tmeta, full->nT);
+  pm->fmeta = myfmeta;
+  delete full;
+  if (!privateVec) {
+    if (m != NULL) delete m;
+    m = pm;
+  }
+  return pm;
+}
+
+cMatrix * cDataReader::readMatrix(long vIdx, long _length, int special, int privateVec)
 {
          // XXX TODO: get multiple frames, concat them
          // PROBLEM::: only return success, if all frames were read successfully
@@ -451,7 +610,7 @@ cMatrix * cDataReader::getMatrix(long vIdx, long _length, int special, int priva
           _m=NULL;
         }
       }
-      if (_m == NULL) _m = new cMatrix(myLcfg->N,_length,myLcfg->type);
+      if (_m == NULL) _m = new cMatrix(Le[nLevels],_length,myLcfg->type);
       
       int fmetaUpdate = 0;
       if (myfmeta == NULL) { 
@@ -465,7 +624,7 @@ cMatrix * cDataReader::getMatrix(long vIdx, long _length, int special, int priva
 
       FLOAT_DMEM*df = _m->dataF;
       INT_DMEM*di = _m->dataI;
-      long N = myLcfg->N;
+      long N = Le[nLevels];
       long f=0;
       for (i=0; i<nLevels; i++) {
 
@@ -502,7 +661,7 @@ cMatrix * cDataReader::getMatrix(long vIdx, long _length, int special, int priva
       }
 
       if (!privateVec) m=_m;
-      return m;
+      return _m;
     } else {
       return NULL;
     }
@@ -521,6 +680,34 @@ cMatrix * cDataReader::getMatrix(long vIdx, long _length, int special, int priva
 
 // relative: (vIdxRelE is positive and indicates the number of frames to go back from the last read frame)
 // noInc: 1=do not increase current read counter (DEFAULT is to INCREASE READ COUNTER!)
+int cDataReader::setProjection(const long *idx, long n)
+{
+  long i;
+  if (isPruned()) {
+    SMILE_IERR(1,"setProjection: the reader already presents a pruned view of its input (dead output elimination)");
+    return 0;
+  }
+  if (projIdx != NULL) { free(projIdx); projIdx = NULL; }
+  projN = 0;
+  if ((idx == NULL)||(n <= 0)) return 1;
+  if ((myLcfg == NULL)||(Le == NULL)) {
+    SMILE_IERR(1,"setProjection: the reader must be finalised before a projection can be set");
+    return 0;
+  }
+  for (i=0; i<n; i++) {
+    if ((idx[i] < 0)||(idx[i] >= Le[nLevels])) {
+      SMILE_IERR(1,"setProjection: element index %li out of range (input has %li elements)",idx[i],(long)Le[nLevels]);
+      return 0;
+    }
+  }
+  projIdx = (long *)malloc(sizeof(long)*n);
+  if (projIdx == NULL) OUT_OF_MEMORY;
+  memcpy(projIdx, idx, sizeof(long)*n);
+  projN = n;
+  SMILE_IDBG(3,"reading %li of %li elements (projection)",projN,myLcfg->N);
+  return 1;
+}
+
 cVector * cDataReader::getFrameRel(long vIdxRelE, int privateVec, int noInc, int *result)
 {
   cVector * ret = getFrame(curR-vIdxRelE,-1,privateVec,result);
@@ -663,6 +850,8 @@ int cDataReader::setupSequentialMatrixReading(double step, double length, double
 
 cDataReader::~cDataReader() {
   if (V!=NULL) delete V;
+  if (Vp!=NULL) delete Vp;
+  if (projIdx!=NULL) free(projIdx);
   if (m!=NULL) delete m;
   if (dmLevel!=NULL) free(dmLevel);
   if (rdId != NULL) free(rdId);
@@ -673,4 +862,5 @@ cDataReader::~cDataReader() {
   if (eToL!=NULL) free(eToL);
   if (myfmeta!=NULL) delete myfmeta;
   if (myLcfg != NULL) delete myLcfg;
+  if (curNames != NULL) delete curNames;
 }
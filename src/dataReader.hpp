@@ -45,6 +45,8 @@
 #define COMPONENT_DESCRIPTION_CDATAREADER  "basic interface component that reads data as vector or matrix from dataMemory component"
 #define COMPONENT_NAME_CDATAREADER  "cDataReader"
 
+class sDeadOutputInfo;
+
 class cDataReader : public cSmileComponent {
   private:
     
@@ -67,6 +69,13 @@ class cDataReader : public cSmileComponent {
     
     // temporary vector...
     cVector *V;
+    // projection: getFrame() returns only the elements projIdx[0..projN-1]
+    long *projIdx, projN;
+    cVector *Vp;  // temporary projected vector (multiple levels)
+    // dead output elimination: elements of the input consumed downstream (see setDeadOutputInfo)
+    const sDeadOutputInfo *pruneInfo;
+    int pruneView;
+    sDeadOutputInfo *curNames;  // names of the current input elements, for mapUnprunedIndex()
     // temporary matrix...
     cMatrix *m;
 
@@ -87,6 +96,10 @@ class cDataReader : public cSmileComponent {
     FrameMetaInfo *myfmeta;
     sDmLevelConfig *myLcfg; //??
 
+    // set up the projection and the reduced names of the pruned view of the input (see setDeadOutputInfo)
+    int setupPrunedView();
+    cMatrix * readMatrix(long vIdx, long length, int special, int privateVec);
+
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
 
@@ -234,6 +247,11 @@ class cDataReader : public cSmileComponent {
 	  const char * getFieldName(int n, int *_N=NULL, int *arrNameOffset=NULL)    // name of field n
     { 
         if ((n>=0)&&(n<myLcfg->Nf)) {
+          if (isPruned()) {
+            if (_N!=NULL) *_N = myfmeta->field[n].N;
+            if (arrNameOffset!=NULL) *arrNameOffset = myfmeta->field[n].arrNameOffset;
+            return myfmeta->field[n].name;
+          }
           return dm->getFieldName(level[fToL[n]],n-Lf[fToL[n]],_N,arrNameOffset);
         } else { return NULL; }
     }
@@ -241,6 +259,12 @@ class cDataReader : public cSmileComponent {
     char * getElementName(int n)    // name of element n , // caller must free() returned string!!
     { 
         if ((n>=0)&&(n<myLcfg->N)) {
+          if (isPruned()) {
+            int idx=0;
+            const char *tmp = myfmeta->getName(n,&idx);
+            if (idx >= 0) return myvprint("%s[%i]",tmp,idx);
+            else return myvprint("%s",tmp);
+          }
           return dm->getElementName(level[eToL[n]],n-Le[eToL[n]]);
         } else { return NULL; }
     }
@@ -252,6 +276,33 @@ class cDataReader : public cSmileComponent {
     }
     
     const cDataMemory * getDmObj() const { return dm; }
+
+    // number of input levels, data memory index of input level i and the reader id we hold in it
+    int getNLevels() { return nLevels; }
+    int getLevelIdx(int i=0) { if ((i>=0)&&(i<nLevels)) return level[i]; else return -1; }
+    int getReaderId(int i=0) { if ((i>=0)&&(i<nLevels)) return rdId[i]; else return -1; }
+
+    /* restrict getFrame/getFrameRel/getNextFrame to the elements idx[0..n-1] (element indices of the full input frame),
+       only these are read from the data memory. idx=NULL removes the projection. getMatrix is not affected.
+       must be called after finalise, returns 0 if an index is out of range */
+    int setProjection(const long *idx, long n);
+    // number of projected elements (0 = no projection), and their indices in the full input frame
+    long getProjectionN() { return projN; }
+    const long * getProjection() { return projIdx; }
+
+    /* dead output elimination (see cComponentManager::pruneDeadOutputs): the input elements that were consumed downstream
+       when the component graph was first set up, must be set before finalise.
+       view=1 : the reader presents only the consumed elements of its input (names, sizes, frames and matrices),
+       view=0 : the info is only used by mapUnprunedIndex() */
+    void setDeadOutputInfo(const sDeadOutputInfo *info, int view=1) { pruneInfo = info; pruneView = view; }
+    // 1 if the reader presents only a part of its input (see setDeadOutputInfo)
+    int isPruned() { return ((pruneView)&&(projIdx != NULL)); }
+    /* index in the current input of element idx of the input when the component graph was first set up,
+       -1 if this element does not exist anymore (without dead output info, idx is returned) */
+    long mapUnprunedIndex(long idx);
+    // name of input level i, and the index of its first element in the concatenated input frame (i = getNLevels(): its size)
+    const char * getInputLevelName(int i) { if ((i>=0)&&(i<nLevels)) return dmLevel[i]; else return NULL; }
+    long getInputLevelOffset(int i) { if ((Le!=NULL)&&(i>=0)&&(i<=nLevels)) return Le[i]; else return 0; }
     
     virtual ~cDataReader();
 };
@@ -207,6 +207,19 @@ int cDataSelector::myFinaliseInstance()
 }
 */
 
+void cDataSelector::markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn)
+{
+  if ((!elementMode)||(mapping == NULL)||(nOut != nElSel)) {
+    memset(inNeed, 1, nIn);
+    return;
+  }
+  int i;
+  memset(inNeed, 0, nIn);
+  for (i=0; i<nElSel; i++) {
+    if (((outNeed == NULL)||(outNeed[i]))&&(mapping[i].eIdx < nIn)) inNeed[mapping[i].eIdx] = 1;
+  }
+}
+
 int cDataSelector::myTick(long long t)
 {
   SMILE_DBG(4,"tick # %i, processing value vector",t);
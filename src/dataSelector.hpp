@@ -82,6 +82,9 @@ class cDataSelector : public cDataProcessor {
     
     cDataSelector(const char *_name);
 
+    // only the selected input elements are needed
+    virtual void markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn);
+
     virtual ~cDataSelector();
 };
 
@@ -40,6 +40,7 @@ write data to data memory...
 
 
 #include <dataSink.hpp>
+#include <componentManager.hpp>
 
 #define MODULE "cDataSink"
 
@@ -63,6 +64,14 @@ SMILECOMPONENT_REGCOMP(cDataSink)
   ct->setField("blocksizeR", "size of data blocks to read in frames (overwrites blocksize!) (this option is provided for compatibility only... it is exactly the same as 'blocksize')", 0);
   ct->setField("blocksize_sec", "size of data blocks to read in seconds", 0);
   ct->setField("blocksizeR_sec", "size of data blocks to read in seconds (overwrites blocksize!) (this option is provided for compatibility only... it is exactly the same as 'blocksize')", 0);
+  ct->setField("writeBufferSize", "(file sinks only) size of the output buffer in bytes, data is written to the file in blocks of this size", SMILE_FILEWRITER_BUFSIZE);
+  ct->setField("writeThread", "(file sinks only) 1 = write full output buffers in a background thread, while the next buffer is filled", 0);
+
+  // these options are set by SMILExtract -shards for the sinks that support sharded output (csv, arff, htk)
+  ct->setField("shardIndex", "(internal, set by SMILExtract -shards) index of the time shard processed by this instance (-1 = no sharding), shards > 0 do not write a file header", -1);
+  ct->setField("shardStart", "(internal, set by SMILExtract -shards) time in seconds (in the full input) of the first frame to write", 0.0);
+  ct->setField("shardEnd", "(internal, set by SMILExtract -shards) time in seconds (in the full input) where output ends (-1 = end of input)", -1.0);
+  ct->setField("shardOffset", "(internal, set by SMILExtract -shards) time in seconds of the beginning of this shard's input in the full input", 0.0);
 
 
   // TODO: derived class dataSinkChunk (receives turn start/end messages), -> dataSinkChunkFile (writes data to files)
@@ -82,7 +91,11 @@ cDataSink::cDataSink(const char *_name) :
   cSmileComponent(_name),
   reader(NULL),
   blocksizeR(1),
-  blocksizeR_sec(-1.0)
+  blocksizeR_sec(-1.0),
+  writeBufferSize(SMILE_FILEWRITER_BUFSIZE), writeThread(0),
+  shardIndex(-1),
+  shardStart(0.0), shardEnd(-1.0), shardOffset(0.0),
+  shardFrameStart(0), shardFrameEnd(-1), shardFrameOffset(0)
 {
   char *tmp = myvprint("%s.reader",getInstName());
   reader = (cDataReader *)(cDataReader::create(tmp));
@@ -116,6 +129,17 @@ void cDataSink::fetchConfig()
   if ( (blocksizeR <= 0) || (isSet("blocksizeR")) ) {
     blocksizeR = getInt("blocksizeR");
   }
+
+  writeBufferSize = getInt("writeBufferSize");
+  writeThread = getInt("writeThread");
+
+  shardIndex = getInt("shardIndex");
+  if (shardIndex >= 0) {
+    shardStart = getDouble("shardStart");
+    shardEnd = getDouble("shardEnd");
+    shardOffset = getDouble("shardOffset");
+    SMILE_IDBG(2,"shard %i: output range %f - %f s, input offset %f s",shardIndex,shardStart,shardEnd,shardOffset);
+  }
 }
 
 int cDataSink::myRegisterInstance(int *runMe)
@@ -160,7 +184,54 @@ int cDataSink::myConfigureInstance()
 
 int cDataSink::myFinaliseInstance()
 {
-  return reader->finaliseInstance();
+  // sinks read their full input, the dead output info only maps element indices of the unpruned input (mapUnprunedIndex)
+  reader->setDeadOutputInfo(getCompMan()->getPrunedInput(getInstName()), 0);
+  int ret = reader->finaliseInstance();
+  if ((ret)&&(shardIndex >= 0)) {
+    // the shard boundaries are aligned to the frame period of all levels, thus these are exact frame indices
+    double TT = reader->getLevelT();
+    if (TT <= 0.0) {
+      SMILE_IERR(1,"sharded output requires a level with a constant frame period (level '%s' has period 0)",reader->getLevelName());
+      return 0;
+    }
+    shardFrameOffset = (long)round(shardOffset / TT);
+    shardFrameStart = (long)round(shardStart / TT);
+    if (shardEnd >= 0.0) shardFrameEnd = (long)round(shardEnd / TT);
+    else shardFrameEnd = -1;
+  }
+  return ret;
+}
+
+// a sink consumes its full input, or only the elements of its projection
+void cDataSink::markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn)
+{
+  long np = reader->getProjectionN();
+  const long *p = reader->getProjection();
+  if ((np > 0)&&(p != NULL)) {
+    long i;
+    memset(inNeed, 0, nIn);
+    for (i=0; i<np; i++) {
+      if ((p[i]>=0)&&(p[i]<nIn)) inNeed[p[i]] = 1;
+    }
+  } else {
+    memset(inNeed, 1, nIn);
+  }
+}
+
+int cDataSink::shardMapFrame(const cVector *vec, long *vIdx, double *time)
+{
+  long vi = vec->tmeta->vIdx;
+  if (shardIndex < 0) {
+    if (vIdx != NULL) *vIdx = vi;
+    if (time != NULL) *time = vec->tmeta->time;
+    return 1;
+  }
+  vi += shardFrameOffset;
+  if (vIdx != NULL) *vIdx = vi;
+  if (time != NULL) *time = vec->tmeta->time + (double)shardFrameOffset * reader->getLevelT();
+  if (vi < shardFrameStart) return 0;
+  if ((shardFrameEnd >= 0)&&(vi >= shardFrameEnd)) return 0;
+  return 1;
 }
 
 cDataSink::~cDataSink()
@@ -44,6 +44,7 @@ dataSink
 #include <smileCommon.hpp>
 #include <smileComponent.hpp>
 #include <dataReader.hpp>
+#include <smileFileWriter.hpp>
 
 #define COMPONENT_DESCRIPTION_CDATASINK "dataSink, base class for all components reading from dataMemory"
 #define COMPONENT_NAME_CDATASINK "cDataSink"
@@ -57,6 +58,26 @@ class cDataSink : public cSmileComponent {
     long blocksizeR;
     double blocksizeR_sec;
 
+    // output buffer of file sinks
+    long writeBufferSize;
+    int writeThread;
+    // create a buffered file writer with the writeBufferSize and writeThread options of this sink,
+    // the buffer is enlarged to minBufsize bytes, if the sink needs to reserve() that much at once
+    cSmileFileWriter * createFileWriter(long minBufsize=0) {
+      return new cSmileFileWriter((size_t)(writeBufferSize > minBufsize ? writeBufferSize : minBufsize), writeThread);
+    }
+
+    // sharded processing (SMILExtract -shards): output range and index offset of this shard
+    int shardIndex;
+    double shardStart, shardEnd, shardOffset;
+    long shardFrameStart, shardFrameEnd, shardFrameOffset;
+
+    /* map the frame index and time of vec to the full (unsharded) input,
+       returns 0 if the frame lies outside the output range of this shard and must not be written */
+    int shardMapFrame(const cVector *vec, long *vIdx, double *time);
+    /* returns 1 if the file header is to be written (always, unless this is a shard > 0) */
+    int shardWriteHeader() { return (shardIndex <= 0); }
+
     cDataReader *reader;
     virtual void fetchConfig();
     virtual void mySetEnvironment();
@@ -74,6 +95,11 @@ class cDataSink : public cSmileComponent {
     SMILECOMPONENT_STATIC_DECL
 
     cDataSink(const char *_name);
+
+    virtual cDataReader * getInputReader() { return reader; }
+    // a sink needs the elements of its reader's projection (see cDataReader::setProjection), or all
+    virtual void markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn);
+
     virtual ~cDataSink();
 };
 
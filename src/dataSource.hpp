@@ -83,6 +83,9 @@ class cDataSource : public cSmileComponent {
     SMILECOMPONENT_STATIC_DECL
     
     cDataSource(const char *_name);
+
+    virtual cDataWriter * getOutputWriter() { return writer; }
+
     virtual ~cDataSource();
 };
 
@@ -125,9 +125,18 @@ class cDataWriter : public cSmileComponent {
       { return dm->getElementName(level,n); }
 
     const char * getLevelName() { return dmLevel; }
+    // data memory index of our level
+    int getLevelIdx() { return level; }
     
     cDataMemory * getDmObj() const { return dm; }
 
+    /* make our level a virtual framed level over level srcLevel of data memory srcDm (must be ours), srcRdId is
+       a reader id held in srcLevel. frame n of our level is frames n*step+pre .. n*step+pre+size-1 of srcLevel
+       (see cDataMemoryLevel::setVirtualSource), frames are then published via syncVirtual() instead of being written */
+    int setVirtualSource(const cDataMemory *srcDm, int srcLevel, int srcRdId, long step, long size, long pre)
+      { if (srcDm != dm) return 0; return dm->setVirtualSource(level, srcLevel, srcRdId, step, size, pre); }
+    int syncVirtual() { return dm->syncVirtual(level); }
+
     virtual ~cDataWriter() {}
 };
 
@@ -70,6 +70,9 @@ SMILECOMPONENT_REGCOMP(cDatadumpSink)
     ct->setField("filename","binary file to write to","datadump.dat");
     ct->setField("lag","output data <lag> frames behind",0);
     ct->setField("append","append to existing file (1/0 = yes/no)",0);
+    ct->setField("compress","1 = write a compressed feature file (see smileFeatureCodec.h, read it with cCompressedFeatureSource or convert it back to a datadump file with smileFc_decompressFile), 0 = write a plain datadump file",0);
+    ct->setField("compressFrameSize","number of vectors coded in one independently decodable frame of a compressed file",1024);
+    ct->setField("compressPredictor","lossless predictor applied before coding the values of a compressed file: 0 = none, 1 = XOR with the previous vector, 2 = difference to the previous vector (best for smooth contours)",2);
   )
 
   SMILECOMPONENT_MAKEINFO(cDatadumpSink);
@@ -81,10 +84,13 @@ SMILECOMPONENT_CREATE(cDatadumpSink)
 
 cDatadumpSink::cDatadumpSink(const char *_name) :
   cDataSink(_name),
-  filehandle(NULL),
+  writer(NULL),
   filename(NULL),
+  frameBuf(NULL),
   nVec(0),
-  vecSize(0)
+  vecSize(0),
+  compress(0),
+  encoder(NULL)
 {
 }
 
@@ -100,6 +106,14 @@ void cDatadumpSink::fetchConfig()
 
   append = getInt("append");
   if (append) SMILE_DBG(3,"append to file is enabled");
+  compress = getInt("compress");
+  compressFrameSize = getInt("compressFrameSize");
+  if (compressFrameSize < 1) compressFrameSize = 1;
+  compressPredictor = getInt("compressPredictor");
+  if ((compress)&&(append)) {
+    SMILE_IWRN(2,"appending to a compressed file is not supported, overwriting '%s'",filename);
+    append = 0;
+  }
 }
 
 /*
@@ -121,30 +135,38 @@ int cDatadumpSink::myFinaliseInstance()
   int ret = cDataSink::myFinaliseInstance();
   if (ret==0) return 0;
   
+  writer = createFileWriter();
+  frameBuf = (float *)malloc(sizeof(float)*reader->getLevelN());
+  if (frameBuf==NULL) OUT_OF_MEMORY;
+
   if (append) {
     // check if file exists:
-    filehandle = fopen(filename, "rb");
-    if (filehandle != NULL) {
+    FILE *f = fopen(filename, "rb");
+    if (f != NULL) {
       // load vecsize, to see if it matches!
-      if (fread(&tmp,sizeof(float),1,filehandle)) vecSize=(long)tmp;
+      if (fread(&tmp,sizeof(float),1,f)) vecSize=(long)tmp;
       else vecSize = 0;
       // load initial nVec
-      if (fread(&tmp,sizeof(float),1,filehandle)) nVec=(long)tmp;
+      if (fread(&tmp,sizeof(float),1,f)) nVec=(long)tmp;
       else nVec = 0;
-      fclose(filehandle);
-      filehandle = fopen(filename, "ab");
+      fclose(f);
+      writer->open(filename, "ab");
       ap=1;
     } else {
-      filehandle = fopen(filename, "wb");
+      writer->open(filename, "wb");
     }
   } else {
-    filehandle = fopen(filename, "wb");
+    writer->open(filename, "wb");
   }
-  if (filehandle == NULL) {
+  if (!writer->isOpen()) {
     COMP_ERR("Error opening binary file '%s' for writing (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
   }
   
   if (vecSize == 0) vecSize = reader->getLevelN();
+  if (compress) {
+    encoder = smileFc_encoderCreate(SMILEFC_FORMAT_DATADUMP, 0, vecSize, compressFrameSize, compressPredictor, reader->getLevelT());
+    if (encoder == NULL) OUT_OF_MEMORY;
+  }
 
   if (!ap) {
     // write mini dummy header ....
@@ -157,15 +179,18 @@ int cDatadumpSink::myFinaliseInstance()
 
 int cDatadumpSink::myTick(long long t)
 {
-  if (filehandle == NULL) return 0;
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
   
   SMILE_DBG(4,"tick # %i, writing value vector (lag=%i):",t,lag);
   cVector *vec= reader->getFrameRel(lag);  //new cVector(nValues+1);
   if (vec == NULL) return 0;
 
   // now print the vector:
-  int i; float *tmp = (float*)malloc(sizeof(float)*vec->N);
-  if (tmp==NULL) OUT_OF_MEMORY;
+  int i; float *tmp = frameBuf;
+  if (vec->N > reader->getLevelN()) {
+    SMILE_IERR(1,"frame size %i exceeds the level size %i",vec->N,reader->getLevelN());
+    return 0;
+  }
   
   if (vec->type == DMEM_FLOAT) {
     for (i=0; i<vec->N; i++) {
@@ -181,7 +206,17 @@ int cDatadumpSink::myTick(long long t)
   }
 
   int ret=1;
-  if (!fwrite(tmp,sizeof(float),vec->N,filehandle)) {
+  if (encoder != NULL) {
+    for (i=vec->N; i<vecSize; i++) tmp[i] = 0.0;
+    const unsigned char *frame;
+    long len = smileFc_encoderAdd(encoder, tmp, &frame);
+    if ((len > 0)&&(!writer->write(frame,len))) {
+      SMILE_ERR(1,"Error writing to compressed feature file '%s'!",filename);
+      ret = 0;
+    } else {
+      nVec++;
+    }
+  } else if (!writer->write(tmp,sizeof(float)*vec->N)) {
     SMILE_ERR(1,"Error writing to raw feature file '%s'!",filename);
     ret = 0;
   } else {
@@ -189,30 +224,40 @@ int cDatadumpSink::myTick(long long t)
     nVec++;
   }
 
-  free(tmp);
-
   // tick success
   return ret;
 }
 
-// WARNING: write header changes file write pointer to beginning of file (after header)
 void cDatadumpSink::writeHeader()
 {
-  // seek to beginning of file:
-  fseek( filehandle, 0, SEEK_SET );
-  // write header:
-  float tmp;
-  tmp = (float)vecSize;
-  fwrite(&tmp, sizeof(float), 1, filehandle);
-  tmp = (float)nVec;
-  fwrite(&tmp, sizeof(float), 1, filehandle);
+  if ((writer == NULL)||(!writer->isOpen())) return;
+  // write header at the beginning of the file:
+  float tmp[2];
+  tmp[0] = (float)vecSize;
+  tmp[1] = (float)nVec;
+  if (encoder != NULL) {
+    // compressed file header incl. the datadump header
+    const unsigned char *h;
+    long len = smileFc_encoderHeader(encoder, tmp, sizeof(float)*2, &h);
+    writer->writeAt(0, h, len);
+  } else {
+    writer->writeAt(0, tmp, sizeof(float)*2);
+  }
 }
 
 cDatadumpSink::~cDatadumpSink()
 {
+  if ((encoder != NULL)&&(writer != NULL)) {
+    // code the last (incomplete) frame
+    const unsigned char *frame;
+    long len = smileFc_encoderFlush(encoder, &frame);
+    if ((len > 0)&&(!writer->write(frame,len))) SMILE_ERR(1,"Error writing to compressed feature file '%s'!",filename);
+  }
   // write final header 
   writeHeader();
   // close output file
-  fclose(filehandle);
+  if (writer != NULL) delete writer;
+  if (encoder != NULL) smileFc_encoderFree(encoder);
+  if (frameBuf != NULL) free(frameBuf);
 }
 
@@ -43,17 +43,21 @@ ARFF file output (for WEKA)
 
 #include <smileCommon.hpp>
 #include <dataSink.hpp>
+#include <smileFeatureCodec.h>
 
 #define COMPONENT_DESCRIPTION_CDATADUMPSINK "write dataMemory data to a raw binary file (e.g. for matlab import)"
 #define COMPONENT_NAME_CDATADUMPSINK "cDatadumpSink"
 
 class cDatadumpSink : public cDataSink {
   private:
-    FILE * filehandle;
+    cSmileFileWriter * writer;
     const char *filename;
+    float *frameBuf;
     int lag;
     int append;
     long nVec,vecSize;
+    int compress, compressFrameSize, compressPredictor;
+    sSmileFcEncoder *encoder;
     
     void writeHeader();
     
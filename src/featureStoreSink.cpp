@@ -0,0 +1,248 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component: featureStoreSink
+
+binary columnar feature file output ("feature store"), see featureStoreSink.hpp for the file layout
+
+*/
+
+
+#include <featureStoreSink.hpp>
+
+#define MODULE "cFeatureStoreSink"
+
+
+SMILECOMPONENT_STATICS(cFeatureStoreSink)
+
+SMILECOMPONENT_REGCOMP(cFeatureStoreSink)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CFEATURESTORESINK;
+  sdescription = COMPONENT_DESCRIPTION_CFEATURESTORESINK;
+
+  // we inherit cDataSink configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cDataSink")
+  
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->setField("filename","feature store file to write to","smileoutput.sfs");
+    ct->setField("lag","output data <lag> frames behind",0);
+    ct->setField("chunkSize","number of rows (frames) per chunk, min/max statistics are stored for each chunk",1024);
+  )
+
+  SMILECOMPONENT_MAKEINFO(cFeatureStoreSink);
+}
+
+SMILECOMPONENT_CREATE(cFeatureStoreSink)
+
+//-----
+
+cFeatureStoreSink::cFeatureStoreSink(const char *_name) :
+  cDataSink(_name),
+  writer(NULL),
+  filename(NULL),
+  lag(0),
+  chunkSize(1024),
+  nCols(0),
+  colBuf(NULL), timeBuf(NULL), lengthBuf(NULL),
+  minBuf(NULL), maxBuf(NULL),
+  nBuf(0),
+  nRows(0),
+  chunkOffset(NULL),
+  nChunks(0), nChunksAlloc(0)
+{
+}
+
+void cFeatureStoreSink::fetchConfig()
+{
+  cDataSink::fetchConfig();
+  
+  filename = getStr("filename");
+  SMILE_DBG(2,"filename = '%s'",filename);
+
+  lag = getInt("lag");
+  SMILE_DBG(2,"lag = %i",lag);
+
+  chunkSize = getInt("chunkSize");
+  if (chunkSize < 1) chunkSize = 1;
+  SMILE_DBG(2,"chunkSize = %i",chunkSize);
+}
+
+int cFeatureStoreSink::writeHeader(int64_t indexOffset)
+{
+  sFeatureStoreHeader head;
+  memset(&head, 0, sizeof(head));
+  strncpy(head.magic, SMILE_FEATURESTORE_MAGIC, 8);
+  head.version = SMILE_FEATURESTORE_VERSION;
+  head.nCols = (int32_t)nCols;
+  head.nFields = (int32_t)(reader->getFrameMetaInfo()->N);
+  head.chunkSize = (int32_t)chunkSize;
+  head.nRows = nRows;
+  head.nChunks = nChunks;
+  head.indexOffset = indexOffset;
+  head.period = reader->getLevelT();
+  return writer->writeAt(0, &head, sizeof(head));
+}
+
+int cFeatureStoreSink::writeFieldTable()
+{
+  const FrameMetaInfo *fmeta = reader->getFrameMetaInfo();
+  int i;
+  for (i=0; i<fmeta->N; i++) {
+    int32_t f[3];
+    const char *name = fmeta->field[i].name;
+    f[0] = fmeta->field[i].N;
+    f[1] = fmeta->field[i].arrNameOffset;
+    f[2] = (name != NULL) ? (int32_t)strlen(name) : 0;
+    if (!writer->write(f, sizeof(f))) return 0;
+    if ((f[2] > 0)&&(!writer->write(name, f[2]))) return 0;
+  }
+  return 1;
+}
+
+// write the rows collected in the current chunk buffer to the file
+int cFeatureStoreSink::writeChunk()
+{
+  if (nBuf <= 0) return 1;
+
+  // align the chunk start
+  static const char pad[SMILE_FEATURESTORE_ALIGN] = {0};
+  long rem = (long)(writer->tell() % SMILE_FEATURESTORE_ALIGN);
+  if (rem > 0) writer->write(pad, SMILE_FEATURESTORE_ALIGN - rem);
+
+  if (nChunks >= nChunksAlloc) {
+    chunkOffset = (int64_t *)crealloc(chunkOffset, sizeof(int64_t)*(nChunksAlloc+64), sizeof(int64_t)*nChunksAlloc);
+    nChunksAlloc += 64;
+  }
+  chunkOffset[nChunks++] = writer->tell();
+
+  long i,c;
+  for (c=0; c<nCols; c++) {
+    float *col = colBuf + c*chunkSize;
+    float mi = col[0], ma = col[0];
+    for (i=1; i<nBuf; i++) {
+      if (col[i] < mi) mi = col[i];
+      if (col[i] > ma) ma = col[i];
+    }
+    minBuf[c] = mi; maxBuf[c] = ma;
+  }
+
+  sFeatureStoreChunk ch;
+  ch.nRows = (int32_t)nBuf;
+  ch.reserved = 0;
+  ch.firstRow = nRows - nBuf;
+  int ret = writer->write(&ch, sizeof(ch));
+  ret = ret && writer->write(timeBuf, sizeof(double)*nBuf);
+  ret = ret && writer->write(lengthBuf, sizeof(double)*nBuf);
+  ret = ret && writer->write(minBuf, sizeof(float)*nCols);
+  ret = ret && writer->write(maxBuf, sizeof(float)*nCols);
+  for (c=0; (c<nCols)&&(ret); c++) {
+    ret = writer->write(colBuf + c*chunkSize, sizeof(float)*nBuf);
+  }
+  nBuf = 0;
+  if (!ret) SMILE_IERR(1,"failed writing chunk #%i to feature store file '%s'! Disk full or read-only filesystem?",nChunks-1,filename);
+  return ret;
+}
+
+int cFeatureStoreSink::myFinaliseInstance()
+{
+  int ret = cDataSink::myFinaliseInstance();
+  if (ret==0) return 0;
+  
+  nCols = reader->getLevelN();
+  colBuf = (float *)malloc(sizeof(float)*nCols*chunkSize);
+  timeBuf = (double *)malloc(sizeof(double)*chunkSize);
+  lengthBuf = (double *)malloc(sizeof(double)*chunkSize);
+  minBuf = (float *)malloc(sizeof(float)*nCols);
+  maxBuf = (float *)malloc(sizeof(float)*nCols);
+  if ((colBuf==NULL)||(timeBuf==NULL)||(lengthBuf==NULL)||(minBuf==NULL)||(maxBuf==NULL)) OUT_OF_MEMORY;
+
+  writer = createFileWriter();
+  if (!writer->open(filename, "wb")) {
+    COMP_ERR("Error opening file '%s' for writing (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
+  }
+  // preliminary header, it is completed when the file is closed
+  if ((!writeHeader(0))||(!writeFieldTable())) {
+    COMP_ERR("failed writing header to feature store file '%s'! Disk full or read-only filesystem?",filename);
+  }
+  
+  return ret;
+}
+
+
+int cFeatureStoreSink::myTick(long long t)
+{
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
+
+  SMILE_DBG(4,"tick # %i, reading value vector (lag=%i):",t,lag);
+  cVector *vec= reader->getFrameRel(lag);
+  if (vec == NULL) return 0;
+
+  // add the frame as row to the current chunk
+  long c;
+  float *col = colBuf + nBuf;
+  for (c=0; c<nCols; c++) {
+    *col = (float)(vec->dataF[c]);
+    col += chunkSize;
+  }
+  timeBuf[nBuf] = vec->tmeta->time;
+  lengthBuf[nBuf] = vec->tmeta->lengthSec;
+  nBuf++; nRows++;
+
+  if (nBuf >= chunkSize) writeChunk();
+
+  // tick success
+  return 1;
+}
+
+
+cFeatureStoreSink::~cFeatureStoreSink()
+{
+  if (writer != NULL) {
+    if (writer->isOpen()) {
+      // write the last chunk, the chunk index, and the final header
+      writeChunk();
+      int64_t indexOffset = writer->tell();
+      if (nChunks > 0) writer->write(chunkOffset, sizeof(int64_t)*nChunks);
+      writeHeader(indexOffset);
+    }
+    delete writer;
+  }
+  if (colBuf != NULL) free(colBuf);
+  if (timeBuf != NULL) free(timeBuf);
+  if (lengthBuf != NULL) free(lengthBuf);
+  if (minBuf != NULL) free(minBuf);
+  if (maxBuf != NULL) free(maxBuf);
+  if (chunkOffset != NULL) free(chunkOffset);
+}
+
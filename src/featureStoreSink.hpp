@@ -0,0 +1,127 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component: featureStoreSink
+
+binary columnar feature file output ("feature store")
+
+*/
+
+
+#ifndef __CFEATURESTORESINK_HPP
+#define __CFEATURESTORESINK_HPP
+
+#include <smileCommon.hpp>
+#include <smileComponent.hpp>
+#include <dataSink.hpp>
+
+#define COMPONENT_DESCRIPTION_CFEATURESTORESINK "write dataMemory data to a binary columnar feature store file (float32 columns in chunks of rows, with per-chunk min/max statistics), which can be read by cFeatureStoreSource"
+#define COMPONENT_NAME_CFEATURESTORESINK "cFeatureStoreSink"
+
+/* feature store file layout (native byte order, i.e. little endian on x86):
+     sFeatureStoreHeader
+     field table: nFields x { int32 N, int32 arrNameOffset, int32 nameLen, char name[nameLen] } (names from FrameMetaInfo)
+     chunks, each starting at a multiple of SMILE_FEATURESTORE_ALIGN bytes:
+       sFeatureStoreChunk
+       double time[nRows], double lengthSec[nRows]    (time meta data of each row)
+       float min[nCols], float max[nCols]             (statistics of each column in this chunk)
+       float column[nCols][nRows]                     (one contiguous column after the other)
+     chunk index: nChunks x int64 file offset of each chunk
+   the header is written again when the file is closed, before indexOffset is set, the file is incomplete
+*/
+
+#define SMILE_FEATURESTORE_MAGIC    "SMILEFS"
+#define SMILE_FEATURESTORE_VERSION  1
+#define SMILE_FEATURESTORE_ALIGN    16
+
+typedef struct {
+  char magic[8];         // SMILE_FEATURESTORE_MAGIC, 0 terminated
+  int32_t version;
+  int32_t nCols;         // number of feature columns (elements of a frame)
+  int32_t nFields;       // number of entries in the field table
+  int32_t chunkSize;     // max. number of rows in one chunk
+  int64_t nRows;         // total number of rows
+  int64_t nChunks;       // number of chunks
+  int64_t indexOffset;   // file offset of the chunk index (0 = incomplete file)
+  double period;         // frame period of the data (0.0 = aperiodic)
+  int32_t reserved[2];
+} sFeatureStoreHeader;
+
+typedef struct {
+  int32_t nRows;         // number of rows in this chunk
+  int32_t reserved;
+  int64_t firstRow;      // index of the first row of this chunk
+} sFeatureStoreChunk;
+
+class cFeatureStoreSink : public cDataSink {
+  private:
+    cSmileFileWriter * writer;
+    const char *filename;
+    int lag;
+    long chunkSize;
+    long nCols;
+
+    // current chunk, column major (colBuf[col*chunkSize + row])
+    float *colBuf;
+    double *timeBuf, *lengthBuf;
+    float *minBuf, *maxBuf;
+    long nBuf;
+
+    int64_t nRows;
+    int64_t *chunkOffset;
+    long nChunks, nChunksAlloc;
+
+    int writeHeader(int64_t indexOffset);
+    int writeFieldTable();
+    int writeChunk();
+    
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+    
+    virtual void fetchConfig();
+    //virtual int myConfigureInstance();
+    virtual int myFinaliseInstance();
+    virtual int myTick(long long t);
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+    
+    cFeatureStoreSink(const char *_name);
+
+    virtual ~cFeatureStoreSink();
+};
+
+
+
+
+#endif // __CFEATURESTORESINK_HPP
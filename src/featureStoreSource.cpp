@@ -0,0 +1,438 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component: featureStoreSource
+
+reads binary columnar feature store files written by cFeatureStoreSink,
+see featureStoreSink.hpp for the file layout
+
+*/
+
+
+#include <featureStoreSource.hpp>
+#define MODULE "cFeatureStoreSource"
+
+#define MAX_LINE_LENGTH 1024
+
+#ifndef __WINDOWS
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+SMILECOMPONENT_STATICS(cFeatureStoreSource)
+
+SMILECOMPONENT_REGCOMP(cFeatureStoreSource)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CFEATURESTORESOURCE;
+  sdescription = COMPONENT_DESCRIPTION_CFEATURESTORESOURCE;
+
+  // we inherit cDataSource configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cDataSource")
+  
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->setField("filename","feature store file to read","input.sfs");
+    ct->setField("fselection","feature selection file (same format as for cLibsvmLiveSink: 'str' followed by the number of features and one feature name per line, or 'idx' followed by one feature index per line), only the selected columns are read (leave empty to read all features)",(const char*)NULL);
+    ct->setField("mmap","1 = memory map the file (if supported by the OS), 0 = read the selected columns chunk by chunk",1);
+  )
+
+  SMILECOMPONENT_MAKEINFO(cFeatureStoreSource);
+}
+
+SMILECOMPONENT_CREATE(cFeatureStoreSource)
+
+//-----
+
+cFeatureStoreSource::cFeatureStoreSource(const char *_name) :
+  cDataSource(_name),
+  filehandle(NULL),
+  filename(NULL),
+  fselection(NULL),
+  useMmap(1),
+  eof(0),
+  chunkOffset(NULL),
+  fieldName(NULL), fieldN(NULL), fieldArrNameOffset(NULL),
+  nSel(0), selCol(NULL),
+  curChunk(-1), chunkRows(0), chunkPos(0), nRead(0),
+  chunkTime(NULL), chunkLength(NULL), colPtr(NULL),
+  readBuf(NULL), readBufSize(0),
+  mapData(NULL), mapSize(0)
+{
+  memset(&header, 0, sizeof(header));
+}
+
+void cFeatureStoreSource::fetchConfig()
+{
+  cDataSource::fetchConfig();
+  
+  filename = getStr("filename");
+  SMILE_DBG(2,"filename = '%s'",filename);
+  fselection = getStr("fselection");
+  if (fselection != NULL) SMILE_DBG(2,"fselection = '%s'",fselection);
+  useMmap = getInt("mmap");
+}
+
+// open the file, read and check the header and the field table and the chunk index
+int cFeatureStoreSource::readHeader()
+{
+  filehandle = fopen(filename, "rb");
+  if (filehandle == NULL) {
+    COMP_ERR("Error opening file '%s' for reading (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
+  }
+  if (fread(&header, sizeof(header), 1, filehandle) != 1) {
+    SMILE_IERR(1,"failed reading header of feature store file '%s'",filename);
+    return 0;
+  }
+  if (strncmp(header.magic, SMILE_FEATURESTORE_MAGIC, 8)) {
+    SMILE_IERR(1,"'%s' is not a feature store file (bad magic)",filename);
+    return 0;
+  }
+  if (header.version != SMILE_FEATURESTORE_VERSION) {
+    SMILE_IERR(1,"unsupported feature store file version %i in '%s' (expected %i)",header.version,filename,SMILE_FEATURESTORE_VERSION);
+    return 0;
+  }
+  if (header.indexOffset == 0) {
+    SMILE_IERR(1,"incomplete feature store file '%s' (the writer did not finish)",filename);
+    return 0;
+  }
+
+  // field table
+  int i, n = 0;
+  fieldName = (char **)calloc(1, sizeof(char*)*header.nFields);
+  fieldN = (int *)calloc(1, sizeof(int)*header.nFields);
+  fieldArrNameOffset = (int *)calloc(1, sizeof(int)*header.nFields);
+  if ((fieldName==NULL)||(fieldN==NULL)||(fieldArrNameOffset==NULL)) OUT_OF_MEMORY;
+  for (i=0; i<header.nFields; i++) {
+    int32_t f[3];
+    if (fread(f, sizeof(f), 1, filehandle) != 1) break;
+    fieldN[i] = f[0];
+    fieldArrNameOffset[i] = f[1];
+    fieldName[i] = (char *)calloc(1, f[2]+1);
+    if (fieldName[i] == NULL) OUT_OF_MEMORY;
+    if ((f[2] > 0)&&(fread(fieldName[i], f[2], 1, filehandle) != 1)) break;
+    n += f[0];
+  }
+  if ((i < header.nFields)||(n != header.nCols)) {
+    SMILE_IERR(1,"corrupt field table in feature store file '%s'",filename);
+    return 0;
+  }
+
+  // chunk index
+  if (header.nChunks > 0) {
+    chunkOffset = (int64_t *)malloc(sizeof(int64_t)*header.nChunks);
+    if (chunkOffset == NULL) OUT_OF_MEMORY;
+    fseek(filehandle, (long)header.indexOffset, SEEK_SET);
+    if (fread(chunkOffset, sizeof(int64_t), (size_t)header.nChunks, filehandle) != (size_t)header.nChunks) {
+      SMILE_IERR(1,"failed reading the chunk index of feature store file '%s'",filename);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// load a feature selection file, sets selCol and nSel (or nothing, if no selection is to be used)
+int cFeatureStoreSource::loadSelection(const char *selFile)
+{
+  if ((selFile == NULL)||(strlen(selFile)<1)) return 1;
+
+  FILE *f = fopen(selFile,"r");
+  if (f== NULL) {
+    SMILE_IERR(1,"error opening feature selection file '%s' for reading!",selFile);
+    return 0;
+  }
+  
+  selCol = (long *)calloc(1,sizeof(long)*header.nCols);
+  if (selCol == NULL) OUT_OF_MEMORY;
+  nSel = 0;
+
+  char line[MAX_LINE_LENGTH+1];
+  if (fgets(line, MAX_LINE_LENGTH, f) == NULL) line[0] = 0;
+  line[3] = 0;
+  if (!strcmp(line,"str")) { // string list: match the names against all element names
+    long nStr=0;
+    if (fscanf(f, "%ld\n", &nStr) != 1) nStr = 0;
+    char **elName = (char **)calloc(1,sizeof(char*)*header.nCols);
+    if (elName == NULL) OUT_OF_MEMORY;
+    long c=0; int i,j;
+    for (i=0; i<header.nFields; i++) {
+      for (j=0; j<fieldN[i]; j++) {
+        if (fieldN[i] > 1) elName[c++] = myvprint("%s[%i]",fieldName[i],j+fieldArrNameOffset[i]);
+        else elName[c++] = strdup(fieldName[i]);
+      }
+    }
+    while(fgets(line,MAX_LINE_LENGTH,f) != NULL) {
+      long len = (long)strlen(line);
+      while ((len>0)&&((line[len-1]=='\n')||(line[len-1]=='\r'))) line[--len] = 0;
+      if (len < 1) continue;
+      for (c=0; c<header.nCols; c++) {
+        if (!strcmp(elName[c],line)) break;
+      }
+      if (c < header.nCols) {
+        if (nSel < header.nCols) selCol[nSel++] = c;
+      } else {
+        SMILE_IWRN(2,"feature '%s' from selection file '%s' not found in '%s'",line,selFile,filename);
+      }
+    }
+    for (c=0; c<header.nCols; c++) free(elName[c]);
+    free(elName);
+    if ((nStr > 0)&&(nSel != nStr)) SMILE_IWRN(2,"selected %i of %i features listed in '%s'",nSel,nStr,selFile);
+  } else if (!strcmp(line,"idx")) { // index list
+    long idx;
+    while(fscanf(f,"%ld\n",&idx) == 1) {
+      if ((idx >= 0)&&(idx < header.nCols)) {
+        if (nSel < header.nCols) selCol[nSel++] = idx;
+      } else {
+        SMILE_IWRN(2,"feature index %i from selection file '%s' is out of range (0-%i)",idx,selFile,header.nCols-1);
+      }
+    }
+  } else { // bogus file...
+    fclose(f);
+    COMP_ERR("error parsing fselection file '%s'. bogus header! expected 'str' or 'idx' at beginning. found '%s'.",selFile,line);
+  }
+  fclose(f);
+
+  if (nSel < 1) {
+    SMILE_IERR(1,"no features selected by feature selection file '%s'",selFile);
+    return 0;
+  }
+  SMILE_IDBG(2,"selected %i of %i features",nSel,header.nCols);
+  return 1;
+}
+
+// map the whole file into memory, returns 0 if this is not possible (then fread is used)
+int cFeatureStoreSource::mapFile()
+{
+#ifndef __WINDOWS
+  struct stat st;
+  if (filehandle == NULL) return 0;
+  if (fstat(fileno(filehandle), &st) != 0) return 0;
+  void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(filehandle), 0);
+  if (p == MAP_FAILED) return 0;
+  mapData = (const unsigned char *)p;
+  mapSize = (long)st.st_size;
+  // the mapping stays valid after the file is closed
+  fclose(filehandle); filehandle = NULL;
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+void cFeatureStoreSource::closeFile()
+{
+  if (filehandle != NULL) { fclose(filehandle); filehandle = NULL; }
+#ifndef __WINDOWS
+  if (mapData != NULL) { munmap((void *)mapData, (size_t)mapSize); mapData = NULL; }
+#endif
+}
+
+// make chunk n the current chunk, i.e. set the time and column pointers
+int cFeatureStoreSource::loadChunk(long n)
+{
+  if ((n < 0)||(n >= header.nChunks)) return 0;
+  int64_t o = chunkOffset[n];
+  long nCols = header.nCols;
+  long i;
+  sFeatureStoreChunk ch;
+
+  if (mapData != NULL) {
+    if (o + (int64_t)sizeof(ch) > mapSize) return 0;
+    memcpy(&ch, mapData + o, sizeof(ch));
+    const unsigned char *d = mapData + o + sizeof(ch);
+    if (o + (int64_t)sizeof(ch) + (int64_t)ch.nRows*(16 + 4*nCols) + 8*nCols > mapSize) return 0;
+    chunkTime = (const double *)d;
+    chunkLength = chunkTime + ch.nRows;
+    const float *cols = (const float *)(d + 16*ch.nRows + 8*nCols);
+    for (i=0; i<nSel; i++) colPtr[i] = cols + selCol[i]*ch.nRows;
+  } else {
+    // read the time meta data and the selected columns of this chunk
+    fseek(filehandle, (long)o, SEEK_SET);
+    if (fread(&ch, sizeof(ch), 1, filehandle) != 1) return 0;
+    if ((ch.nRows < 0)||(ch.nRows > header.chunkSize)) return 0;
+    if (fread(readBuf, 16*ch.nRows, 1, filehandle) != 1) return 0;
+    chunkTime = (const double *)readBuf;
+    chunkLength = chunkTime + ch.nRows;
+    long colStart = (long)o + sizeof(ch) + 16*ch.nRows + 8*nCols;
+    float *cols = (float *)(readBuf + 16*header.chunkSize);
+    if (nSel == nCols) { // all columns in their original order: one read
+      fseek(filehandle, colStart, SEEK_SET);
+      if (fread(cols, sizeof(float)*ch.nRows, nCols, filehandle) != (size_t)nCols) return 0;
+      for (i=0; i<nSel; i++) colPtr[i] = cols + i*ch.nRows;
+    } else {
+      for (i=0; i<nSel; i++) {
+        fseek(filehandle, colStart + selCol[i]*(long)sizeof(float)*ch.nRows, SEEK_SET);
+        if (fread(cols + i*ch.nRows, sizeof(float), ch.nRows, filehandle) != (size_t)ch.nRows) return 0;
+        colPtr[i] = cols + i*ch.nRows;
+      }
+    }
+  }
+  curChunk = n;
+  chunkRows = ch.nRows;
+  chunkPos = 0;
+  return 1;
+}
+
+int cFeatureStoreSource::configureWriter(sDmLevelConfig &c)
+{
+  if (!readHeader()) return 0;
+  // the period from the config overrides the period stored in the file
+  if (period == 0.0) c.T = header.period;
+  return 1;
+}
+
+int cFeatureStoreSource::setupNewNames(long nEl)
+{
+  int i;
+  if (!loadSelection(fselection)) return 0;
+
+  if (selCol == NULL) {
+    // no selection: all columns, with the original field structure
+    nSel = header.nCols;
+    selCol = (long *)malloc(sizeof(long)*nSel);
+    if (selCol == NULL) OUT_OF_MEMORY;
+    for (i=0; i<nSel; i++) selCol[i] = i;
+    for (i=0; i<header.nFields; i++) {
+      writer->addField(fieldName[i], fieldN[i], fieldArrNameOffset[i]);
+    }
+  } else {
+    // selection: one field for each selected element, named by its full element name
+    for (i=0; i<nSel; i++) {
+      long c = 0; int f;
+      for (f=0; f<header.nFields; f++) {
+        if (selCol[i] < c + fieldN[f]) break;
+        c += fieldN[f];
+      }
+      if (fieldN[f] > 1) {
+        char *tmp = myvprint("%s[%i]",fieldName[f],(int)(selCol[i]-c)+fieldArrNameOffset[f]);
+        writer->addField(tmp, 1);
+        free(tmp);
+      } else {
+        writer->addField(fieldName[f], 1);
+      }
+    }
+  }
+
+  colPtr = (const float **)calloc(1, sizeof(float*)*nSel);
+  if (colPtr == NULL) OUT_OF_MEMORY;
+  allocMat(nSel, blocksizeW);
+
+  namesAreSet=1;
+  return 1;
+}
+
+int cFeatureStoreSource::myFinaliseInstance()
+{
+  int ret = cDataSource::myFinaliseInstance();
+  if (ret == 0) return 0;
+
+  if ((!useMmap)||(!mapFile())) {
+    readBufSize = 16*header.chunkSize + sizeof(float)*nSel*header.chunkSize;
+    readBuf = (char *)malloc(readBufSize);
+    if (readBuf == NULL) OUT_OF_MEMORY;
+  }
+  if (header.nChunks > 0) {
+    if (!loadChunk(0)) {
+      SMILE_IERR(1,"failed reading chunk 0 of feature store file '%s'",filename);
+      eof = 1;
+    }
+  } else eof = 1;
+  return ret;
+}
+
+
+int cFeatureStoreSource::myTick(long long t)
+{
+  if (isEOI()) return 0;
+  
+  SMILE_DBG(4,"tick # %i, reading value vector from feature store file",t);
+  if (eof) {
+    SMILE_DBG(4,"(inst '%s') EOF, no more data to read",getInstName());
+    return 0;
+  }
+
+  // number of frames to write in this tick
+  long n = (long)blocksizeW;
+  int64_t remain = header.nRows - nRead;
+  if ((int64_t)n > remain) n = (long)remain;
+  if (n <= 0) { eof = 1; return 0; }
+  if (!(writer->checkWrite(n))) return 0;
+  if (mat->nT != n) allocMat(nSel, n);
+
+  long r = 0, i, j;
+  while (r < n) {
+    if (chunkPos >= chunkRows) {
+      if (!loadChunk(curChunk+1)) {
+        SMILE_IERR(1,"failed reading chunk %i of feature store file '%s'",curChunk+1,filename);
+        eof = 1; break;
+      }
+    }
+    long m = chunkRows - chunkPos;
+    if (m > n - r) m = n - r;
+    // copy the selected columns, column by column (sequential reads from the store)
+    for (j=0; j<nSel; j++) {
+      const float *src = colPtr[j] + chunkPos;
+      FLOAT_DMEM *dst = mat->dataF + r*nSel + j;
+      for (i=0; i<m; i++) { *dst = (FLOAT_DMEM)src[i]; dst += nSel; }
+    }
+    for (i=0; i<m; i++) {
+      mat->tmeta[r+i].time = chunkTime[chunkPos+i];
+      mat->tmeta[r+i].lengthSec = chunkLength[chunkPos+i];
+    }
+    chunkPos += m; r += m;
+    nRead += m;
+  }
+  if (r <= 0) return 0;
+  if (r < n) mat->nT = r;
+
+  writer->setNextMatrix(mat);
+  return 1;
+}
+
+
+cFeatureStoreSource::~cFeatureStoreSource()
+{
+  closeFile();
+  int i;
+  if (fieldName != NULL) {
+    for (i=0; i<header.nFields; i++) if (fieldName[i] != NULL) free(fieldName[i]);
+    free(fieldName);
+  }
+  if (fieldN != NULL) free(fieldN);
+  if (fieldArrNameOffset != NULL) free(fieldArrNameOffset);
+  if (chunkOffset != NULL) free(chunkOffset);
+  if (selCol != NULL) free(selCol);
+  if (colPtr != NULL) free(colPtr);
+  if (readBuf != NULL) free(readBuf);
+}
+
@@ -0,0 +1,107 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component: featureStoreSource
+
+reads binary columnar feature store files written by cFeatureStoreSink
+
+*/
+
+
+#ifndef __CFEATURESTORESOURCE_HPP
+#define __CFEATURESTORESOURCE_HPP
+
+#include <smileCommon.hpp>
+#include <dataSource.hpp>
+#include <featureStoreSink.hpp>
+
+#define COMPONENT_DESCRIPTION_CFEATURESTORESOURCE "reads a binary columnar feature store file (written by cFeatureStoreSink), optionally only a selection of columns (features)"
+#define COMPONENT_NAME_CFEATURESTORESOURCE "cFeatureStoreSource"
+
+class cFeatureStoreSource : public cDataSource {
+  private:
+    FILE *filehandle;
+    const char *filename;
+    const char *fselection;
+    int useMmap;
+    int eof;
+
+    sFeatureStoreHeader header;
+    int64_t *chunkOffset;
+    // field table
+    char **fieldName;
+    int *fieldN, *fieldArrNameOffset;
+
+    // selected columns
+    long nSel;
+    long *selCol;
+
+    // current chunk
+    long curChunk, chunkRows, chunkPos;
+    int64_t nRead;          // number of rows read so far
+    const double *chunkTime, *chunkLength;
+    const float **colPtr;   // pointers to the selected columns of the current chunk
+    char *readBuf;          // chunk data, if the file is not memory mapped
+    long readBufSize;
+    const unsigned char *mapData;
+    long mapSize;
+
+    int readHeader();
+    int loadSelection(const char *selFile);
+    int mapFile();
+    int loadChunk(long n);
+    void closeFile();
+    
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+    
+    virtual void fetchConfig();
+    //virtual int myConfigureInstance();
+    virtual int myFinaliseInstance();
+    virtual int myTick(long long t);
+
+    virtual int configureWriter(sDmLevelConfig &c);
+    virtual int setupNewNames(long nEl=0);
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+    
+    cFeatureStoreSource(const char *_name);
+
+    virtual ~cFeatureStoreSource();
+};
+
+
+
+
+#endif // __CFEATURESTORESOURCE_HPP
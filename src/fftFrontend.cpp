@@ -0,0 +1,340 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component:
+
+fused spectral front-end:
+pre-emphasis, windowing, fft and magnitude/phase/power spectrum in a single pass per frame
+
+*/
+
+
+#include <fftFrontend.hpp>
+#include <math.h>
+
+#define MODULE "cFFTfrontend"
+
+
+SMILECOMPONENT_STATICS(cFFTfrontend)
+
+SMILECOMPONENT_REGCOMP(cFFTfrontend)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CFFTFRONTEND;
+  sdescription = COMPONENT_DESCRIPTION_CFFTFRONTEND;
+
+  // we inherit cVectorProcessor configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cVectorProcessor")
+
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->setField("k","pre-emphasis coefficient k (0 = no pre-emphasis)",0.97);
+    ct->setField("gain","gain by which the window function should be multiplied",1.0);
+    ct->setField("offset","offset to add to windowed samples",0.0);
+    ct->setField("winFunc","window function:\n   Hann [Han],\n   Hamming [Ham],\n   Rectangular [Rec],\n   Gauss [Gau],\n   Sine / Cosine [Sin],\n   Triangular [Tri],\n   Bartlett [Bar],\n   Bartlett-Hann [BaH],\n   Blackmann [Bla],\n   Blackmann-Harris [BlH],\n   Lanczos [Lac]","Han");
+    ct->setField("sigma","stddev for Gauss window",0.4);
+    ct->setField("alpha0","alpha0 for Blackmann(-Harris) / Bartlett-Hann windows (optional!)",0.0);
+    ct->setField("alpha1","alpha1 for Blackmann(-Harris) / Bartlett-Hann windows (optional!)",0.0);
+    ct->setField("alpha2","alpha2 for Blackmann(-Harris) / Bartlett-Hann windows (optional!)",0.0);
+    ct->setField("alpha3","alpha3 for Blackmann-Harris window (optional!)",0.0);
+    ct->setField("alpha","alpha for Blackmann windows",0.16);
+    ct->setField("fftSize","minimum fft size in samples (0 = frame size), frames are zero-padded to the next power of 2 >= max(fftSize, frame size)",0);
+    ct->setField("magnitude","1/0 = compute magnitude spectrum (field '<input name>_Mag') yes/no",1);
+    ct->setField("phase","1/0 = compute phase spectrum (field '<input name>_Phase') yes/no",0);
+    ct->setField("power","1/0 = compute power spectrum (squared magnitude, field '<input name>_Power') yes/no",0);
+  )
+
+  SMILECOMPONENT_MAKEINFO(cFFTfrontend);
+}
+
+SMILECOMPONENT_CREATE(cFFTfrontend)
+
+//-----
+
+cFFTfrontend::cFFTfrontend(const char *_name) :
+  cVectorProcessor(_name),
+  k(0.0), offset(0.0), gain(1.0),
+  sigma(0.4), alpha(0.16), alpha0(0.0), alpha1(0.0), alpha2(0.0), alpha3(0.0),
+  winFunc(WINF_HANNING), fftSize(0),
+  magnitude(1), phase(0), power(0),
+  newFsSet(0),
+  win(NULL), x(NULL), ip(NULL), w(NULL)
+{
+
+}
+
+void cFFTfrontend::fetchConfig()
+{
+  cVectorProcessor::fetchConfig();
+
+  k = (FLOAT_DMEM)getDouble("k");
+  SMILE_DBG(2,"k=%f",k);
+  offset = getDouble("offset");
+  gain = getDouble("gain");
+
+  const char *winF = getStr("winFunc");
+  if ((!strcmp(winF,"Han"))||(!strcmp(winF,"han"))||(!strcmp(winF,"Hanning"))||(!strcmp(winF,"hanning"))||(!strcmp(winF,"hann"))||(!strcmp(winF,"Hann")))
+    { winFunc = WINF_HANNING; }
+  else if ((!strcmp(winF,"Ham"))||(!strcmp(winF,"ham"))||(!strcmp(winF,"Hamming"))||(!strcmp(winF,"hamming")))
+    { winFunc = WINF_HAMMING; }
+  else if ((!strcmp(winF,"Rec"))||(!strcmp(winF,"rec"))||(!strcmp(winF,"Rectangular"))||(!strcmp(winF,"rectangular"))||(!strcmp(winF,"none"))||(!strcmp(winF,"None")))
+    { winFunc = WINF_RECTANGLE; }
+  else if ((!strcmp(winF,"Gau"))||(!strcmp(winF,"gau"))||(!strcmp(winF,"Gauss"))||(!strcmp(winF,"gauss"))||(!strcmp(winF,"Gaussian"))||(!strcmp(winF,"gaussian")))
+    { winFunc = WINF_GAUSS; }
+  else if ((!strcmp(winF,"Sin"))||(!strcmp(winF,"sin"))||(!strcmp(winF,"Sine"))||(!strcmp(winF,"sine"))||(!strcmp(winF,"cosine"))||(!strcmp(winF,"Cosine"))||(!strcmp(winF,"Cos"))||(!strcmp(winF,"cos")))
+    { winFunc = WINF_SINE; }
+  else if ((!strcmp(winF,"Tri"))||(!strcmp(winF,"tri"))||(!strcmp(winF,"Triangle"))||(!strcmp(winF,"triangle")))
+    { winFunc = WINF_TRIANGLE; }
+  else if ((!strcmp(winF,"Bla"))||(!strcmp(winF,"bla"))||(!strcmp(winF,"Blackman"))||(!strcmp(winF,"blackman")))
+    { winFunc = WINF_BLACKMAN; }
+  else if ((!strcmp(winF,"BlH"))||(!strcmp(winF,"blh"))||(!strcmp(winF,"Blackman-Harris"))||(!strcmp(winF,"blackman-harris")))
+    { winFunc = WINF_BLACKHARR; }
+  else if ((!strcmp(winF,"Bar"))||(!strcmp(winF,"bar"))||(!strcmp(winF,"Bartlett"))||(!strcmp(winF,"bartlett")))
+    { winFunc = WINF_BARTLETT; }
+  else if ((!strcmp(winF,"BaH"))||(!strcmp(winF,"bah"))||(!strcmp(winF,"Bartlett-Hann"))||(!strcmp(winF,"bartlett-hann"))||(!strcmp(winF,"Bartlett-Hanning"))||(!strcmp(winF,"bartlett-hanning")))
+    { winFunc = WINF_BARTHANN; }
+  else if ((!strcmp(winF,"Lac"))||(!strcmp(winF,"lac"))||(!strcmp(winF,"Lanczos"))||(!strcmp(winF,"lanczos")))
+    { winFunc = WINF_LANCZOS; }
+  else {
+    SMILE_ERR(1,"unkown window function '%s' specified in config file! setting window function to 'rectangular' (none)!",winF);
+    winFunc = WINF_RECTANGLE;
+  }
+
+  if (winFunc == WINF_GAUSS) sigma = getDouble("sigma");
+
+  if (winFunc == WINF_BLACKMAN) {
+    if (isSet("alpha0") && isSet("alpha1") && isSet("alpha2")) {
+      alpha0 = getDouble("alpha0");
+      alpha1 = getDouble("alpha1");
+      alpha2 = getDouble("alpha2");
+    } else {
+      alpha = getDouble("alpha");
+      alpha0 = (1.0-alpha)*0.5;
+      alpha1 = 0.5;
+      alpha2 = alpha*0.5;
+    }
+  }
+  if (winFunc == WINF_BLACKHARR) {
+    if (isSet("alpha0")) alpha0 = getDouble("alpha0");
+    else alpha0 = 0.35875;
+    if (isSet("alpha1")) alpha1 = getDouble("alpha1");
+    else alpha1 = 0.48829;
+    if (isSet("alpha2")) alpha2 = getDouble("alpha2");
+    else alpha2 = 0.14128;
+    if (isSet("alpha3")) alpha3 = getDouble("alpha3");
+    else alpha3 = 0.01168;
+  }
+  if (winFunc == WINF_BARTHANN) {
+    if (isSet("alpha0")) alpha0 = getDouble("alpha0");
+    else alpha0 = 0.62;
+    if (isSet("alpha1")) alpha1 = getDouble("alpha1");
+    else alpha1 = 0.48;
+    if (isSet("alpha2")) alpha2 = getDouble("alpha2");
+    else alpha2 = 0.38;
+  }
+
+  fftSize = getInt("fftSize");
+  if (fftSize < 0) fftSize = 0;
+
+  magnitude = getInt("magnitude");
+  phase = getInt("phase");
+  power = getInt("power");
+  if ((!magnitude)&&(!phase)&&(!power)) { magnitude = 1; }
+  if (magnitude) SMILE_DBG(2,"magnitude computation enabled");
+  if (phase) SMILE_DBG(2,"phase computation enabled");
+  if (power) SMILE_DBG(2,"power spectrum computation enabled");
+}
+
+// fft size for a field with nEl elements: next power of 2 >= max(nEl, fftSize), at least 4 (as in cTransformFFT)
+long cFFTfrontend::getNfft(long nEl)
+{
+  long n = nEl;
+  if (fftSize > n) n = fftSize;
+  if (!smileMath_isPowerOf2(n)) n = smileMath_ceilToNextPowOf2(n);
+  if (n < 4) n = 4;
+  return n;
+}
+
+int cFFTfrontend::configureWriter(sDmLevelConfig &c)
+{
+  // frameSizeSec of the output level grows by the zero-padding (see cTransformFFT::configureWriter)
+  int i;
+  for (i=0; i<c.Nf; i++) {
+    long nEl = c.fmeta->field[i].N;
+    long nFft = getNfft(nEl);
+    if ((nFft != nEl)&&(nEl > 0)&&(!newFsSet)) {
+      c.frameSizeSec *= (double)nFft / (double)nEl;
+      newFsSet=1;
+      break;
+    }
+  }
+  return 1;
+}
+
+int cFFTfrontend::setupNamesForField(int i, const char*name, long nEl)
+{
+  long nBins = getNfft(nEl)/2 + 1;
+  long newNEl = 0;
+  if (magnitude) {
+    addNameAppendFieldAuto(name, "Mag", nBins);
+    newNEl += nBins;
+  }
+  if (phase) {
+    addNameAppendFieldAuto(name, "Phase", nBins);
+    newNEl += nBins;
+  }
+  if (power) {
+    addNameAppendFieldAuto(name, "Power", nBins);
+    newNEl += nBins;
+  }
+  return newNEl;
+}
+
+int cFFTfrontend::myFinaliseInstance()
+{
+  int ret = cVectorProcessor::myFinaliseInstance();
+
+  if (ret) {
+    if (win!=NULL) { multiConfFree(win); win=NULL; }
+    if (x!=NULL) { multiConfFree(x); x=NULL; }
+    if (ip!=NULL) { multiConfFree(ip); ip=NULL; }
+    if (w!=NULL) { multiConfFree(w); w=NULL; }
+    win = (FLOAT_DMEM**)multiConfAlloc();
+    x = (FLOAT_TYPE_FFT**)multiConfAlloc();
+    ip = (int**)multiConfAlloc();
+    w = (FLOAT_TYPE_FFT**)multiConfAlloc();
+  }
+  return ret;
+}
+
+// window function of length N incl. gain, as computed by cWindower
+FLOAT_DMEM * cFFTfrontend::computeWinFunc(long N)
+{
+  double *dw;
+  switch(winFunc) {
+    case WINF_RECTANGLE: dw = smileDsp_winRec(N); break;
+    case WINF_HANNING:   dw = smileDsp_winHan(N); break;
+    case WINF_HAMMING:   dw = smileDsp_winHam(N); break;
+    case WINF_TRIANGLE:  dw = smileDsp_winTri(N); break;
+    case WINF_BARTLETT:  dw = smileDsp_winBar(N); break;
+    case WINF_SINE:      dw = smileDsp_winSin(N); break;
+    case WINF_GAUSS:     dw = smileDsp_winGau(N,sigma); break;
+    case WINF_BLACKMAN:  dw = smileDsp_winBla(N,alpha0,alpha1,alpha2); break;
+    case WINF_BLACKHARR: dw = smileDsp_winBlH(N,alpha0,alpha1,alpha2,alpha3); break;
+    case WINF_BARTHANN:  dw = smileDsp_winBaH(N,alpha0,alpha1,alpha2); break;
+    case WINF_LANCZOS:   dw = smileDsp_winLac(N); break;
+    default: SMILE_ERR(1,"unknown window function ID (%i) !",winFunc); dw=NULL;
+  }
+
+  FLOAT_DMEM *fw = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+  if (fw == NULL) OUT_OF_MEMORY;
+  long i;
+  for (i=0; i<N; i++) {
+    if (dw != NULL) {
+      if (gain != 1.0) dw[i] *= gain;
+      fw[i] = (FLOAT_DMEM)dw[i];
+    } else {
+      fw[i] = (FLOAT_DMEM)gain;
+    }
+  }
+  if (dw != NULL) free(dw);
+  return fw;
+}
+
+int cFFTfrontend::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
+{
+  long n;
+  if (Nsrc <= 0) return 0;
+
+  idxi = getFconf(idxi);
+  long nFft = getNfft(Nsrc);
+
+  // per field buffers are allocated on the first frame and then reused
+  if (win[idxi] == NULL) win[idxi] = computeWinFunc(Nsrc);
+  if (x[idxi] == NULL) {
+    x[idxi] = (FLOAT_TYPE_FFT*)malloc(sizeof(FLOAT_TYPE_FFT)*nFft);
+    if (x[idxi] == NULL) OUT_OF_MEMORY;
+  }
+  if (ip[idxi] == NULL) ip[idxi] = (int *)calloc(1,sizeof(int)*(nFft+2));
+  if (w[idxi] == NULL) w[idxi] = (FLOAT_TYPE_FFT *)calloc(1,sizeof(FLOAT_TYPE_FFT)*((nFft*5)/4+2));
+  const FLOAT_DMEM *_win = win[idxi];
+  FLOAT_TYPE_FFT *_x = x[idxi];
+  FLOAT_DMEM off = (FLOAT_DMEM)offset;
+
+  // pre-emphasis, window and offset in one pass (same arithmetic as cVectorPreemphasis and cWindower)
+  _x[0] = (FLOAT_TYPE_FFT)( ((1-k) * src[0]) * _win[0] + off );
+  for (n=1; n<Nsrc; n++) {
+    _x[n] = (FLOAT_TYPE_FFT)( (src[n] - k * src[n-1]) * _win[n] + off );
+  }
+  for (n=Nsrc; n<nFft; n++) {  // zeropadding
+    _x[n] = 0;
+  }
+
+  rdft(nFft, 1, _x, ip[idxi], w[idxi]);
+
+  // rdft output: x[0] = Re(0), x[1] = Re(nFft/2), x[2k],x[2k+1] = Re(k),Im(k)
+  long nBins = nFft/2 + 1;
+  if (magnitude) {
+    dst[0] = (FLOAT_DMEM)fabs(_x[0]);
+    for (n=2; n<nFft; n += 2) {
+      dst[n/2] = (FLOAT_DMEM)sqrt(_x[n]*_x[n] + _x[n+1]*_x[n+1]);
+    }
+    dst[nFft/2] = (FLOAT_DMEM)fabs(_x[1]);
+    dst += nBins;
+  }
+  if (phase) {
+    dst[0] = (FLOAT_DMEM)atan2((FLOAT_TYPE_FFT)0.0, _x[0]);
+    for (n=2; n<nFft; n += 2) {
+      dst[n/2] = (FLOAT_DMEM)atan2(_x[n+1], _x[n]);
+    }
+    dst[nFft/2] = (FLOAT_DMEM)atan2((FLOAT_TYPE_FFT)0.0, _x[1]);
+    dst += nBins;
+  }
+  if (power) {
+    dst[0] = (FLOAT_DMEM)(_x[0]*_x[0]);
+    for (n=2; n<nFft; n += 2) {
+      dst[n/2] = (FLOAT_DMEM)(_x[n]*_x[n] + _x[n+1]*_x[n+1]);
+    }
+    dst[nFft/2] = (FLOAT_DMEM)(_x[1]*_x[1]);
+  }
+
+  return 1;
+}
+
+cFFTfrontend::~cFFTfrontend()
+{
+  if (win!=NULL) multiConfFree(win);
+  if (x!=NULL) multiConfFree(x);
+  if (ip!=NULL) multiConfFree(ip);
+  if (w!=NULL) multiConfFree(w);
+}
+
@@ -0,0 +1,96 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component:
+
+fused spectral front-end:
+pre-emphasis (cVectorPreemphasis), windowing (cWindower), fft (cTransformFFT) and
+magnitude/phase (cFFTmagphase) computed in a single pass per frame,
+output field names are the same as those of the cFFTmagphase at the end of the chain
+
+*/
+
+
+#ifndef __FFT_FRONTEND_HPP
+#define __FFT_FRONTEND_HPP
+
+#include <smileCommon.hpp>
+#include <vectorProcessor.hpp>
+#include <fftXg.h>  // fft4g include
+
+#define COMPONENT_DESCRIPTION_CFFTFRONTEND "applies pre-emphasis and a window function to each frame, and computes magnitude, phase, and/or power spectrum of the frame's fft (replaces the chain cVectorPreemphasis -> cWindower -> cTransformFFT -> cFFTmagphase, output field names are compatible with cFFTmagphase)"
+#define COMPONENT_NAME_CFFTFRONTEND "cFFTfrontend"
+
+// WINF_XXXXXX constants are defined in smileUtil.hpp !
+
+class cFFTfrontend : public cVectorProcessor {
+  private:
+    FLOAT_DMEM k;
+    double offset, gain;
+    double sigma, alpha, alpha0, alpha1, alpha2, alpha3;
+    int   winFunc;    // winFunc as numeric constant
+    long  fftSize;
+    int   magnitude, phase, power;
+    int   newFsSet;
+
+    // per field config:
+    FLOAT_DMEM **win;      // window function incl. gain
+    FLOAT_TYPE_FFT **x;    // fft work buffer
+    int **ip;
+    FLOAT_TYPE_FFT **w;
+
+    long getNfft(long nEl);
+    FLOAT_DMEM * computeWinFunc(long N);
+
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+
+    virtual void fetchConfig();
+    virtual int myFinaliseInstance();
+
+    virtual int configureWriter(sDmLevelConfig &c);
+    virtual int setupNamesForField(int i, const char*name, long nEl);
+    virtual int processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi);
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+    
+    cFFTfrontend(const char *_name);
+
+    virtual ~cFFTfrontend();
+};
+
+
+
+
+#endif // __FFT_FRONTEND_HPP
@@ -144,12 +144,11 @@ int cFFTmagphase::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, lon
 //    dst += Nsrc/2;
   }
   if (phase) {
-    dst[0] = 0.0;
-    for(n=2; n<Nsrc-1; n++) {
-      dst[n/2] = atan(src[n+1]/src[n]);
+    dst[0] = atan2((FLOAT_DMEM)0.0, src[0]);
+    for(n=2; n<Nsrc; n += 2) {
+      dst[n/2] = atan2(src[n+1], src[n]);
     }
-//    dst[Nsrc/2] = 0.0;
-    //dst += Nsrc/2+1;
+    dst[Nsrc/2] = atan2((FLOAT_DMEM)0.0, src[1]);
   }
 
   return 1;
@@ -57,8 +57,8 @@ SMILECOMPONENT_REGCOMP(cFramer)
   // we inherit cWinToVecProcessor configType and extend it:
   SMILECOMPONENT_INHERIT_CONFIGTYPE("cWinToVecProcessor")
   
-  SMILECOMPONENT_IFNOTREGAGAIN( {} 
-
+  SMILECOMPONENT_IFNOTREGAGAIN( 
+    ct->setField("zeroCopy","1 = do not copy the input samples to the output level, the output level is a virtual view on the input level's buffer instead, from which the frames are read directly (only for fixed size frames from a float input level with noPostEOIprocessing=1, else the frames are copied)",0);
   )
   
   SMILECOMPONENT_MAKEINFO(cFramer);
@@ -75,6 +75,14 @@ cFramer::cFramer(const char *_name) :
 }
 
 
+void cFramer::fetchConfig()
+{
+  cWinToVecProcessor::fetchConfig();
+
+  zeroCopy = getInt("zeroCopy");
+  SMILE_IDBG(2,"zeroCopy = %i",zeroCopy);
+}
+
 // this must return the multiplier, i.e. the vector size returned for each input element (e.g. number of functionals, etc.)
 int cFramer::getMultiplier()
 {
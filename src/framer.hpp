@@ -53,7 +53,7 @@ class cFramer : public cWinToVecProcessor {
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
 
-    //virtual void fetchConfig();
+    virtual void fetchConfig();
     //virtual int myFinaliseInstance();
     //virtual int myTick(long long t);
 
@@ -95,6 +95,23 @@ const char* cFunctionalComponent::getValueName(long i)
   return NULL;
 }
 
+int cFunctionalComponent::disableValues(const char *keep)
+{
+  int j, n=0;
+  if (enab == NULL) return 0;
+  for (j=0; j<nTotal; j++) { if (enab[j]) n++; }
+  // functionals with multiple values per enab flag (e.g. percentile[]) cannot be pruned per value
+  if (n != getNoutputValues()) return 0;
+  n = 0;
+  for (j=0; j<nTotal; j++) {
+    if (enab[j]) {
+      if (!keep[n]) { enab[j] = 0; nEnab--; }
+      n++;
+    }
+  }
+  return 1;
+}
+
 long cFunctionalComponent::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_DMEM *out, long Nin, long Nout)
 {
   SMILE_ERR(1,"dataType FLOAT_DMEM not yet supported in component '%s' of type '%s'",getTypeName(), getInstName());
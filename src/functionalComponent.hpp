@@ -81,6 +81,9 @@ class cFunctionalComponent : public cSmileComponent {
 
     virtual long getNoutputValues() { return nEnab; }
     virtual const char* getValueName(long i);
+    // disable the output values i (0..getNoutputValues()-1) with keep[i]==0 (dead output elimination),
+    // returns 0 if the output values of this functional cannot be disabled individually
+    int disableValues(const char *keep);
     virtual int getRequireSorted() { return 0; }
 
     virtual ~cFunctionalComponent();
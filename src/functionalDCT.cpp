@@ -76,7 +76,7 @@ cFunctionalDCT::cFunctionalDCT(const char *_name) :
   firstCoeff(1),
   lastCoeff(6),
   nCo(0),
-  costable(NULL),
+  dct(NULL),
   tmpstr(NULL)
 {
 }
@@ -103,19 +103,15 @@ void cFunctionalDCT::fetchConfig()
   nEnab += lastCoeff - firstCoeff;
 }
 
-void cFunctionalDCT::initCostable(long Nin, long Nout)
+// (re-)create the dct plan, the contour length Nin may change from turn to turn
+void cFunctionalDCT::initDct(long Nin, long Nout)
 {
+  if (dct != NULL) { smileDsp_dctFree(dct); dct = NULL; }
   if ((Nin>0)&&(Nout>0)) {
-    costable = (FLOAT_DMEM * )malloc(sizeof(FLOAT_DMEM)*Nin*Nout);
-	if (costable==NULL) OUT_OF_MEMORY;
-    int i,m;
 	nCo = lastCoeff - firstCoeff + 1;
 	N=Nin;
-	for (i=firstCoeff; i<=lastCoeff; i++) {
-	  for (m=0; m<Nin; m++) {
-        costable[m + (i-firstCoeff)*Nin] = (FLOAT_DMEM)cos(M_PI*(double)i/(double)(N) * ((FLOAT_DMEM)(m) + 0.5) );
-	  }
-	}
+	dct = smileDsp_dctCreate(Nin, firstCoeff, nCo, DCT_AUTO);
+	if (dct==NULL) OUT_OF_MEMORY;
 	factor = (FLOAT_DMEM)sqrt((double)2.0/(double)(N));
   }
 }
@@ -131,18 +127,15 @@ const char* cFunctionalDCT::getValueName(long i)
 
 long cFunctionalDCT::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_DMEM *out, long Nin, long Nout)
 {
-  int i,m;
+  int i;
   if ((Nin>0)&&(out!=NULL)) {
-	if (costable == NULL) {
-      initCostable(Nin,Nout);
-	  if (costable == NULL) SMILE_IERR(1,"error initializing costable, probably Nin or Nout == 0 in cFunctionalDCT::process");
+	if ((dct == NULL)||(Nin != N)) {
+      initDct(Nin,Nout);
+	  if (dct == NULL) SMILE_IERR(1,"error initializing dct, probably Nin or Nout == 0 in cFunctionalDCT::process");
 	}
 	
+	smileDsp_dct(dct, in, out);
 	for (i=0; i < nCo; i++) {
-	  out[i] = 0.0;
-      for (m=0; m<Nin; m++) {
-        out[i] +=  in[m] * costable[m+i*N];
-      }
       out[i] *= factor; 
     }
 
@@ -162,5 +155,6 @@ long cFunctionalDCT::process(INT_DMEM *in, INT_DMEM *inSorted, INT_DMEM *out, lo
 cFunctionalDCT::~cFunctionalDCT()
 {
   if (tmpstr != NULL) free(tmpstr);
+  if (dct != NULL) smileDsp_dctFree(dct);
 }
 
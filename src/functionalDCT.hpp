@@ -52,14 +52,14 @@ class cFunctionalDCT : public cFunctionalComponent {
   private:
     int firstCoeff, lastCoeff;
 	int nCo,N;
-	FLOAT_DMEM * costable;
+	sSmileDspDct * dct;
 	FLOAT_DMEM factor;
 	char *tmpstr;
 
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
     virtual void fetchConfig();
-	virtual void initCostable(long Nin, long Nout);
+	virtual void initDct(long Nin, long Nout);
 
   public:
     SMILECOMPONENT_STATIC_DECL
@@ -208,6 +208,53 @@ int cFunctionals::myConfigureInstance()
   return cWinToVecProcessor::myConfigureInstance();
 }
 
+// dead output elimination: do not compute the functionals whose outputs are not consumed by any input element
+int cFunctionals::dataProcessorCustomFinalise()
+{
+  const sDeadOutputInfo *pr = getCompMan()->getPrunedLevel(writer->getLevelName());
+  if (pr != NULL) {
+    long Nin = reader->getLevelN();
+    long e;
+    int i,j;
+    char **inNames = (char **)calloc(1,sizeof(char *)*Nin);
+    if (inNames == NULL) OUT_OF_MEMORY;
+    for (e=0; e<Nin; e++) inNames[e] = reader->getElementName(e);
+    int nOld = nFunctValues;
+    nFunctValues = 0;
+    requireSorted = 0;
+    for (i=0; i<nFunctionalsEnabled; i++) {
+      if ((functObj[i] == NULL)||(functN[i] <= 0)) continue;
+      char *keep = (char *)calloc(1,sizeof(char)*functN[i]);
+      if (keep == NULL) OUT_OF_MEMORY;
+      int nKeep = 0;
+      for (j=0; j<functN[i]; j++) {
+        const char *vn = functObj[i]->getValueName(j);
+        if (vn == NULL) { keep[j] = 1; nKeep++; continue; }
+        for (e=0; e<Nin; e++) {
+          char *name = myvprint("%s_%s",inNames[e],vn);
+          int need = pr->isNeeded(name);
+          free(name);
+          if (need) { keep[j] = 1; nKeep++; break; }
+        }
+      }
+      if (nKeep == 0) {
+        functN[i] = 0;
+      } else if ((nKeep < functN[i])&&(functObj[i]->disableValues(keep))) {
+        functN[i] = functObj[i]->getNoutputValues();
+      }
+      free(keep);
+      if (functN[i] > 0) {
+        nFunctValues += functN[i];
+        requireSorted += functObj[i]->getRequireSorted();
+      }
+    }
+    for (e=0; e<Nin; e++) { if (inNames[e] != NULL) free(inNames[e]); }
+    free(inNames);
+    SMILE_IMSG(3,"dead output elimination: computing %i of %i functional values",nFunctValues,nOld);
+  }
+  return cWinToVecProcessor::dataProcessorCustomFinalise();
+}
+
 int cFunctionals::setupNamesForElement(int idxi, const char*name, long nEl)
 {
   // in a winToVecProcessor , nEl should always be 1!
@@ -277,7 +324,7 @@ int cFunctionals::doProcess(int idxi, cMatrix *row, FLOAT_DMEM*y)
   
   FLOAT_DMEM *curY = y;
   for (i=0; i<nFunctionalsEnabled; i++) {
-    if (functObj[i] != NULL) {
+    if ((functObj[i] != NULL)&&(functN[i] > 0)) {
       functObj[i]->setInputPeriod(getInputPeriod());
       int ret;
       ret = functObj[i]->process( unsorted, sorted, min, max, (FLOAT_DMEM)mean, curY, row->nT, functN[i] );
@@ -73,6 +73,7 @@ class cFunctionals : public cWinToVecProcessor {
     //virtual int myFinaliseInstance();
     //virtual int myTick(long long t);
 
+    virtual int dataProcessorCustomFinalise();
     virtual int getMultiplier();
     //virtual int configureWriter(const sDmLevelConfig *c);
     virtual int setupNamesForElement(int idxi, const char*name, long nEl);
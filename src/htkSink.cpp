@@ -59,6 +59,9 @@ SMILECOMPONENT_REGCOMP(cHtkSink)
     ct->setField("lag","output data <lag> frames behind",0);
     ct->setField("append","append to existing file (1/0 = yes/no)",0);
     ct->setField("parmKind","HTK parmKind (9=USER)",9);
+    ct->setField("compress","1 = write a compressed feature file (see smileFeatureCodec.h, read it with cCompressedFeatureSource or convert it back to an HTK file with smileFc_decompressFile), 0 = write a plain HTK file",0);
+    ct->setField("compressFrameSize","number of vectors coded in one independently decodable frame of a compressed file",1024);
+    ct->setField("compressPredictor","lossless predictor applied before coding the values of a compressed file: 0 = none, 1 = XOR with the previous vector, 2 = difference to the previous vector (best for smooth contours)",2);
   )
 
   SMILECOMPONENT_MAKEINFO(cHtkSink);
@@ -70,8 +73,11 @@ SMILECOMPONENT_CREATE(cHtkSink)
 
 cHtkSink::cHtkSink(const char *_name) :
   cDataSink(_name),
-  filehandle(NULL),
+  writer(NULL),
   filename(NULL),
+  frameBuf(NULL),
+  compress(0),
+  encoder(NULL),
   nVec(0),
   vecSize(0),
   period(0.0)
@@ -96,6 +102,14 @@ void cHtkSink::fetchConfig()
 
   parmKind = (uint16_t)getInt("parmKind");
   SMILE_DBG(3,"parmKind = %i",parmKind);
+  compress = getInt("compress");
+  compressFrameSize = getInt("compressFrameSize");
+  if (compressFrameSize < 1) compressFrameSize = 1;
+  compressPredictor = getInt("compressPredictor");
+  if ((compress)&&(append)) {
+    SMILE_IWRN(2,"appending to a compressed file is not supported, overwriting '%s'",filename);
+    append = 0;
+  }
 }
 
 /*
@@ -110,7 +124,7 @@ int cHtkSink::myConfigureInstance()
 
 int cHtkSink::writeHeader()
 {
-  if (filehandle==NULL) return 0;
+  if ((writer==NULL)||(!writer->isOpen())) return 0;
 
   header.nSamples = nVec;
   header.samplePeriod = (uint32_t)round(period*10000000.0);
@@ -125,12 +139,17 @@ int cHtkSink::writeHeader()
   sHTKheader head;  // local copy, due to prepareHeader! we don't want to change 'header' variable!
   memcpy(&head, &header, sizeof(sHTKheader));
   prepareHeader(&head);
+  const void *data = &head;
+  long len = sizeof(sHTKheader);
+  if (encoder != NULL) {
+    // compressed file header incl. the htk header
+    const unsigned char *h;
+    len = smileFc_encoderHeader(encoder, &head, sizeof(sHTKheader), &h);
+    data = h;
+  }
 
-  // seek to beginning of file:
-  fseek(filehandle, 0 , SEEK_SET);
-  
-  // write header:
-  if (!fwrite(&head, sizeof(sHTKheader), 1, filehandle)) {
+  // write header at the beginning of the file:
+  if (!writer->writeAt(0, data, len)) {
     SMILE_ERR(1,"Error writing to htk feature file '%s'!",filename);
     return 0;
   }
@@ -138,10 +157,10 @@ int cHtkSink::writeHeader()
   return 1;
 }
 
-int cHtkSink::readHeader()
+int cHtkSink::readHeader(FILE *f)
 {
-  if (filehandle==NULL) return 0;
-  if (!fread(&header, sizeof(sHTKheader), 1, filehandle)) {
+  if (f==NULL) return 0;
+  if (!fread(&header, sizeof(sHTKheader), 1, f)) {
     SMILE_ERR(1,"error reading header from file '%s'",filename);
     return 0;
   }
@@ -159,11 +178,15 @@ int cHtkSink::myFinaliseInstance()
   period = reader->getLevelT();
   vecSize = reader->getLevelN();
   
+  writer = createFileWriter();
+  frameBuf = (float *)malloc(sizeof(float)*reader->getLevelN());
+  if (frameBuf==NULL) OUT_OF_MEMORY;
+
   if (append) {
     // check if file exists:
-    filehandle = fopen(filename, "rb");
-    if (filehandle != NULL) {
-      if (!readHeader()) {
+    FILE *f = fopen(filename, "rb");
+    if (f != NULL) {
+      if (!readHeader(f)) {
         SMILE_ERR(1,"error reading header from file '%s' (which seems to exist)! we cannot append to that file!");
         // TODO: force overwrite via config file option in this case...
         ret = 0;
@@ -179,21 +202,25 @@ int cHtkSink::myFinaliseInstance()
         }
       }
       nVec = header.nSamples;
-      fclose(filehandle); filehandle = NULL;
+      fclose(f);
       if (ret==0) return 0;
-      filehandle = fopen(filename, "ab");
+      writer->open(filename, "ab");
       ap=1;
     } else {
-      filehandle = fopen(filename, "wb");
+      writer->open(filename, "wb");
     }
   } else {
-    filehandle = fopen(filename, "wb");
+    writer->open(filename, "wb");
   }
-  if (filehandle == NULL) {
+  if (!writer->isOpen()) {
     COMP_ERR("Error opening binary file '%s' for writing (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
   }
+  if (compress) {
+    encoder = smileFc_encoderCreate(SMILEFC_FORMAT_HTK, vax ? SMILEFC_FLAG_BIGENDIAN : 0, vecSize, compressFrameSize, compressPredictor, period);
+    if (encoder == NULL) OUT_OF_MEMORY;
+  }
   
-  if (!ap) {
+  if ((!ap)&&(shardWriteHeader())) {
     // write dummy htk header ....
     writeHeader();
   }
@@ -204,25 +231,31 @@ int cHtkSink::myFinaliseInstance()
 
 int cHtkSink::myTick(long long t)
 {
-  if (filehandle == NULL) return 0;
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
 
   SMILE_DBG(4,"tick # %i, reading value vector (lag=%i):",t,lag);
   cVector *vec= reader->getFrameRel(lag);  //new cVector(nValues+1);
   if (vec == NULL) return 0;
+  if (!shardMapFrame(vec, NULL, NULL)) return 1; // frame belongs to another shard
 
   // now print the vector:
-  int i; float *tmp = (float *)malloc(sizeof(float)*vec->N);
-  if (tmp==NULL) OUT_OF_MEMORY;
+  int i; float *tmp = frameBuf;
+  if (vec->N > reader->getLevelN()) {
+    SMILE_IERR(1,"frame size %i exceeds the level size %i",vec->N,reader->getLevelN());
+    return 0;
+  }
 
+  // the compressed file stores the values in host byte order
+  int swap = vax && (encoder == NULL);
   if (vec->type == DMEM_FLOAT) {
     for (i=0; i<vec->N; i++) {
       tmp[i] = (float)(vec->dataF[i]);
-      if (vax) SwapFloat(tmp+i);
+      if (swap) SwapFloat(tmp+i);
     }
   } else if (vec->type == DMEM_INT) {
     for (i=0; i<vec->N; i++) {
       tmp[i] = (float)(vec->dataI[i]);
-      if (vax) SwapFloat(tmp+i);
+      if (swap) SwapFloat(tmp+i);
     }
   } else {
     SMILE_ERR(1,"unknown data type %i",vec->type);
@@ -231,7 +264,17 @@ int cHtkSink::myTick(long long t)
 
   int ret = 1;
   
-  if (!fwrite(tmp,sizeof(float),vec->N,filehandle)) {
+  if (encoder != NULL) {
+    for (i=vec->N; i<(int)vecSize; i++) tmp[i] = 0.0;
+    const unsigned char *frame;
+    long len = smileFc_encoderAdd(encoder, tmp, &frame);
+    if ((len > 0)&&(!writer->write(frame,len))) {
+      SMILE_ERR(1,"Error writing to compressed feature file '%s'!",filename);
+      ret = 0;
+    } else {
+      nVec++;
+    }
+  } else if (!writer->write(tmp,sizeof(float)*vec->N)) {
     SMILE_ERR(1,"Error writing to raw feature file '%s'!",filename);
     ret = 0;
   } else {
@@ -239,8 +282,6 @@ int cHtkSink::myTick(long long t)
     nVec++;
   }
 
-  free(tmp);
-
   // tick success
   return ret;
 }
@@ -248,7 +289,16 @@ int cHtkSink::myTick(long long t)
 
 cHtkSink::~cHtkSink()
 {
-  writeHeader();
-  fclose(filehandle);
+  if ((encoder != NULL)&&(writer != NULL)) {
+    // code the last (incomplete) frame
+    const unsigned char *frame;
+    long len = smileFc_encoderFlush(encoder, &frame);
+    if ((len > 0)&&(!writer->write(frame,len))) SMILE_ERR(1,"Error writing to compressed feature file '%s'!",filename);
+  }
+  // shards > 0 write the data only, the header of the first shard is updated when the shards are joined
+  if (shardWriteHeader()) writeHeader();
+  if (writer != NULL) delete writer;
+  if (encoder != NULL) smileFc_encoderFree(encoder);
+  if (frameBuf != NULL) free(frameBuf);
 }
 
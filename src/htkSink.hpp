@@ -44,6 +44,7 @@ ARFF file output (for WEKA)
 #include <smileCommon.hpp>
 #include <smileComponent.hpp>
 #include <dataSink.hpp>
+#include <smileFeatureCodec.h>
 
 #define COMPONENT_DESCRIPTION_CHTKSINK "write dataMemory data to an HTK feature file"
 #define COMPONENT_NAME_CHTKSINK "cHtkSink"
@@ -57,12 +58,15 @@ typedef struct {
 
 class cHtkSink : public cDataSink {
   private:
-    FILE * filehandle;
+    cSmileFileWriter * writer;
     const char *filename;
+    float *frameBuf;
     int lag;
     int append;
     int vax;
     uint16_t parmKind;
+    int compress, compressFrameSize, compressPredictor;
+    sSmileFcEncoder *encoder;
     uint32_t vecSize;
     uint32_t nVec;
     double period;
@@ -112,7 +116,7 @@ class cHtkSink : public cDataSink {
     }
 
     int writeHeader();
-    int readHeader();
+    int readHeader(FILE *f);
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
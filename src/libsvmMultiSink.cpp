@@ -0,0 +1,540 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+
+/*  openSMILE component:
+
+LibSVM multi-head classifier: several LibSVM models on one feature vector.
+Heads with the same feature selection and scaling share one input vector and one dense SV matrix
+(svm_dense_pool), in which SVs used by several models are stored only once, the dot products of the
+input with the SVs are thus computed once per unique SV. The dot products and the heads are evaluated
+by several threads, if there are enough heads.
+
+*/
+
+
+
+#include <libsvmMultiSink.hpp>
+
+#define MODULE "cLibsvmMultiSink"
+
+
+SMILECOMPONENT_STATICS(cLibsvmMultiSink)
+
+SMILECOMPONENT_REGCOMP(cLibsvmMultiSink)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CLIBSVMMULTISINK;
+  sdescription = COMPONENT_DESCRIPTION_CLIBSVMMULTISINK;
+
+  // we inherit cDataSink configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cDataSink")
+
+  SMILECOMPONENT_IFNOTREGAGAIN_BEGIN
+    ConfigType * headType = new ConfigType("libsvmHead");
+    headType->setField("name","name of this head (printed and sent with the results), default: model file name",(const char*)NULL);
+    headType->setField("model","LibSVM model file to load (text model, or binary model created with svm-compile)","svm.model");
+    headType->setField("scale","LibSVM scale file to load (text models only)",(const char*)NULL);
+    headType->setField("fselection","feature selection file to apply (text models only, leave empty to use all features)",(const char*)NULL);
+    headType->setField("classes","class name lookup file (text models only, leave empty to display libsvm class numbers/indicies)",(const char*)NULL);
+    headType->setField("predictProbability","predict class probabilities (1/0=yes/no)",0);
+    ct->setField("head","array of classifier heads (models) to apply to the input",headType,ARRAY_TYPE);
+    ct->setField("printResult","print classification/regression results to console (1/0=yes/no)",0);
+    ct->setField("resultRecp","component(s) to send the 'classificationResults' message to (use , to separate multiple recepients), leave blank (NULL) to not send any messages",(const char *) NULL);
+    ct->setField("resultMessageName","custom name that is sent with the 'classificationResults' message","svm_results");
+    ct->setField("threads","number of threads (including the tick thread) for evaluating the heads, 0 = automatic (one thread per 'headsPerThread' heads, at most 4), 1 = no threads",0);
+    ct->setField("headsPerThread","(threads=0 only) minimum number of heads per thread",2);
+  SMILECOMPONENT_IFNOTREGAGAIN_END
+
+  SMILECOMPONENT_MAKEINFO(cLibsvmMultiSink);
+}
+
+SMILECOMPONENT_CREATE(cLibsvmMultiSink)
+
+//-----
+
+cLibsvmMultiSink::cLibsvmMultiSink(const char *_name) :
+  cDataSink(_name),
+  printResult(0), sendResult(0),
+  resultRecp(NULL), resultMessageName(NULL),
+  nHeads(0), heads(NULL),
+  nGroups(0), groups(NULL), results(NULL),
+  nThreads(0), headsPerThread(2), workers(NULL),
+  nWorkersRunning(0), workerStop(0), workerPhase(0), nWorkersDone(0), workerIdx(0),
+  workerGen(0)
+{
+}
+
+void cLibsvmMultiSink::fetchConfig()
+{
+  cDataSink::fetchConfig();
+  
+  printResult = getInt("printResult");
+  SMILE_IDBG(2,"printResult = %i",printResult);
+
+  resultRecp = getStr("resultRecp");
+  SMILE_IDBG(2,"resultRecp = '%s'",resultRecp);
+  if (resultRecp != NULL) sendResult = 1;
+
+  resultMessageName = getStr("resultMessageName");
+  SMILE_IDBG(2,"resultMessageName = '%s'",resultMessageName);
+
+  nThreads = getInt("threads");
+  if (nThreads < 0) nThreads = 0;
+#ifndef HAVE_PTHREAD
+#ifndef __WINDOWS
+  nThreads = 1;
+#endif
+#endif
+  SMILE_IDBG(2,"threads = %i",nThreads);
+  headsPerThread = getInt("headsPerThread");
+  if (headsPerThread < 1) headsPerThread = 1;
+
+  int i;
+  nHeads = getArraySize("head");
+  if (nHeads < 1) {
+    COMP_ERR("no classifier heads defined (head[] array)!");
+  }
+  heads = (sLibsvmHead *)calloc(1,sizeof(sLibsvmHead)*nHeads);
+  for (i=0; i<nHeads; i++) {
+    sLibsvmHead *h = heads+i;
+    h->modelfile = getStr_f(myvprint("head[%i].model",i));
+    h->name = getStr_f(myvprint("head[%i].name",i));
+    if (h->name == NULL) h->name = h->modelfile;
+    h->scalefile = getStr_f(myvprint("head[%i].scale",i));
+    h->fselection = getStr_f(myvprint("head[%i].fselection",i));
+    h->classes = getStr_f(myvprint("head[%i].classes",i));
+    h->predictProbability = getInt_f(myvprint("head[%i].predictProbability",i));
+    SMILE_IDBG(2,"head %i: name = '%s', model = '%s'",i,h->name,h->modelfile);
+  }
+}
+
+// load model, scale, class map, and feature selection of one head
+int cLibsvmMultiSink::loadHead(sLibsvmHead *h)
+{
+  if (svm_is_bundle(h->modelfile)) {
+    if (!svm_load_bundle(h->modelfile, &(h->bundle))) {
+      COMP_ERR("can't load binary libSVM model file '%s'",h->modelfile);
+    }
+    h->model = h->bundle.model;
+    h->scale = h->bundle.scale;
+    h->nCls = h->bundle.nCls;
+    h->classNames = h->bundle.classNames;
+    h->fselType = h->bundle.fselType;
+    h->selStr = h->bundle.selStr;
+    h->selIdx = h->bundle.selIdx;
+  } else {
+    if ((h->model = svm_load_model(h->modelfile)) == NULL) {
+      COMP_ERR("can't open libSVM model file '%s'",h->modelfile);
+    }
+    if ((h->scale = svm_load_scale(h->scalefile)) == NULL) {
+      COMP_ERR("can't open libSVM scale file '%s' (head '%s')",h->scalefile,h->name);
+    }
+    h->fselType = svm_load_selection(h->fselection, &(h->selStr), &(h->selIdx));
+    if (h->fselType < 0) {
+      COMP_ERR("error parsing fselection file '%s' (head '%s')!",h->fselection,h->name);
+    }
+  }
+
+  h->nClasses = svm_get_nr_class(h->model);
+  h->svmType = svm_get_svm_type(h->model);
+  if ((h->svmType==NU_SVR) || (h->svmType==EPSILON_SVR)) {
+    h->nClasses = 0;
+    h->predictProbability = 0;
+  } else {
+    h->labels = (int *) malloc(h->nClasses*sizeof(int));
+    svm_get_labels(h->model,h->labels);
+    if ((h->classes != NULL)&&(h->classNames == NULL)) {
+      h->nCls = svm_load_classes(h->classes, &(h->classNames));
+    }
+  }
+  if ((h->predictProbability)&&(!svm_check_probability_model(h->model))) {
+    SMILE_IWRN(2,"model '%s' of head '%s' has no probability information, not predicting probabilities",h->modelfile,h->name);
+    h->predictProbability = 0;
+  }
+  return 1;
+}
+
+int cLibsvmMultiSink::myFinaliseInstance()
+{
+  int ret = cDataSink::myFinaliseInstance();
+  if (ret==0) return 0;
+  
+  int i;
+  SMILE_MSG(2,"loading %i LibSVM models for instance '%s' ...",nHeads,getInstName()); 
+  results = (sClassifierResult *)calloc(1,sizeof(sClassifierResult)*nHeads);
+  for (i=0; i<nHeads; i++) {
+    loadHead(heads+i);
+    results[i].name = heads[i].name;
+    if (heads[i].predictProbability) {
+      results[i].nClasses = heads[i].nClasses;
+      results[i].probEstimates = (double *)calloc(1,sizeof(double)*heads[i].nClasses);
+    }
+  }
+  setupGroups();
+
+  if (nThreads == 0) {
+    nThreads = nHeads / headsPerThread;
+    if (nThreads > 4) nThreads = 4;
+  }
+  if (nThreads > nHeads) nThreads = nHeads;
+  if (nThreads < 1) nThreads = 1;
+
+  if ((nThreads > 1)&&(workers == NULL)) {
+    smileMutexCreate(workerMtx);
+    smileCondCreate(workerCondStart);
+    smileCondCreate(workerCondDone);
+    workers = (smileThread *)calloc(1,sizeof(smileThread)*(nThreads-1));
+    for (nWorkersRunning=0; nWorkersRunning<nThreads-1; nWorkersRunning++) {
+      if (!smileThreadCreate(workers[nWorkersRunning], workerThreadMain, this)) {
+        SMILE_IERR(1,"error creating worker thread #%i",nWorkersRunning);
+        break;
+      }
+    }
+    SMILE_IDBG(2,"evaluating %i heads in %i threads",nHeads,nWorkersRunning+1);
+  }
+
+  return ret;
+}
+
+// assign the heads to input groups, the feature selections are resolved to element index lists,
+// the reader then reads only the union of all selections (projection)
+void cLibsvmMultiSink::setupGroups()
+{
+  int i, g;
+  long n, N = reader->getLevelN();
+  const FrameMetaInfo *fmeta = reader->getFrameMetaInfo();
+  groups = (sLibsvmInputGroup *)calloc(1,sizeof(sLibsvmInputGroup)*nHeads);
+  for (i=0; i<nHeads; i++) {
+    sLibsvmHead *h = heads+i;
+    long *idx = NULL;
+    int dim = (int)N;
+    if (h->fselType != 0) {
+      idx = (long *)malloc(sizeof(long)*(N+1));
+      dim = 0;
+      if (h->fselType == 1) {
+        // the indices refer to the input before dead output elimination
+        for (n=0; n<h->selIdx.nFull; n++) {
+          if (!h->selIdx.enabled[n]) continue;
+          long m = reader->mapUnprunedIndex(n);
+          if ((m >= 0)&&(m < N)) idx[dim++] = m;
+        }
+      } else if (fmeta != NULL) {
+        for (n=0; n<N; n++) {
+          const char *fn = fmeta->getName(n,NULL);
+          for (long j=0; j<h->selStr.n; j++) {
+            if (!strcmp(fn,h->selStr.names[j])) { idx[dim++] = n; break; }
+          }
+        }
+      }
+      if (dim == 0) {
+        SMILE_IWRN(2,"no features enabled by the feature selection of head '%s', using all features",h->name);
+        free(idx); idx = NULL;
+        dim = (int)N;
+      }
+    }
+    double *sa = NULL, *sb = NULL;
+    if (h->scale != NULL) {
+      sa = (double *)malloc(sizeof(double)*dim);
+      sb = (double *)malloc(sizeof(double)*dim);
+      svm_scale_affine(h->scale, dim, sa, sb);
+    }
+
+    // find a group with the same selection and scaling
+    for (g=0; g<nGroups; g++) {
+      sLibsvmInputGroup *gr = groups+g;
+      if (gr->dim != dim) continue;
+      if ((gr->idx == NULL) != (idx == NULL)) continue;
+      if ((idx != NULL)&&(memcmp(gr->idx, idx, sizeof(long)*dim) != 0)) continue;
+      if ((gr->scale_a == NULL) != (sa == NULL)) continue;
+      if ((sa != NULL)&&((memcmp(gr->scale_a, sa, sizeof(double)*dim) != 0)||(memcmp(gr->scale_b, sb, sizeof(double)*dim) != 0))) continue;
+      break;
+    }
+    if (g < nGroups) {
+      if (idx != NULL) free(idx);
+      if (sa != NULL) free(sa);
+      if (sb != NULL) free(sb);
+    } else {
+      sLibsvmInputGroup *gr = groups+nGroups++;
+      gr->N = N;
+      gr->idx = idx;
+      gr->dim = dim;
+      gr->scale_a = sa;
+      gr->scale_b = sb;
+      gr->x = (float *)calloc(1,sizeof(float)*dim);
+      gr->pool = svm_dense_pool_create(dim, sa, sb);
+    }
+    h->group = g;
+    h->dm = svm_dense_pool_add(groups[g].pool, h->model);
+    if (h->dm == NULL) {
+      COMP_ERR("the model of head '%s' can not be evaluated (precomputed kernels are not supported)",h->name);
+    }
+  }
+
+  // if all groups use a selection, read only the union of the selected elements,
+  // and map the group indices to positions in the projected frame
+  for (g=0; g<nGroups; g++) if (groups[g].idx == NULL) break;
+  if ((g == nGroups)&&(nGroups > 0)) {
+    long *pos = (long *)malloc(sizeof(long)*(N+1));
+    long *sel = (long *)malloc(sizeof(long)*(N+1));
+    long nSel = 0;
+    for (n=0; n<N; n++) pos[n] = -1;
+    for (g=0; g<nGroups; g++) {
+      for (i=0; i<groups[g].dim; i++) pos[groups[g].idx[i]] = 0;
+    }
+    for (n=0; n<N; n++) {
+      if (pos[n] >= 0) { pos[n] = nSel; sel[nSel++] = n; }
+    }
+    if (nSel < N) {
+      if (!reader->setProjection(sel, nSel)) {
+        COMP_ERR("error setting up the feature selection");
+      }
+      for (g=0; g<nGroups; g++) {
+        for (i=0; i<groups[g].dim; i++) groups[g].idx[i] = pos[groups[g].idx[i]];
+        groups[g].N = nSel;
+      }
+      SMILE_IDBG(3,"feature selections: reading %li of %li input elements",nSel,N);
+    }
+    free(pos);
+    free(sel);
+  }
+
+  long nRows = 0;
+  for (g=0; g<nGroups; g++) nRows += svm_dense_pool_get_nr_rows(groups[g].pool);
+  SMILE_IMSG(3,"%i heads in %i input groups, %li unique SVs / weight vectors",nHeads,nGroups,nRows);
+}
+
+// phase 0: dot products of the inputs with the SVs (each worker a range of rows), phase 1: kernels and decisions of the heads
+void cLibsvmMultiSink::runPhase(int phase, int w)
+{
+  int i, g;
+  int nT = nWorkersRunning + 1;
+  if (phase == 0) {
+    for (g=0; g<nGroups; g++) {
+      int n = svm_dense_pool_get_nr_rows(groups[g].pool);
+      int chunk = ((n + nT-1) / nT + 3) / 4 * 4;
+      int r0 = w * chunk;
+      if (r0 < n) svm_dense_pool_dot(groups[g].pool, r0, r0 + chunk);
+    }
+  } else {
+    for (i=w; i<nHeads; i+=nT) {
+      sLibsvmHead *h = heads+i;
+      sClassifierResult *r = results+i;
+      if (h->predictProbability) {
+        r->result = svm_dense_predict_probability(h->dm, NULL, r->probEstimates);
+      } else {
+        r->result = svm_dense_predict(h->dm, NULL);
+      }
+      r->className = NULL;
+      if ((h->nClasses > 0)&&(h->nCls > 0)&&(h->classNames != NULL)) {
+        long c = (long)r->result;
+        if (c >= h->nCls) c = h->nCls-1;
+        if (c < 0) c = 0;
+        r->className = h->classNames[c];
+      }
+    }
+  }
+}
+
+void cLibsvmMultiSink::runParallel(int phase)
+{
+  if (nWorkersRunning == 0) {
+    runPhase(phase, 0);
+    return;
+  }
+  smileMutexLock(workerMtx);
+  workerPhase = phase;
+  nWorkersDone = 0;
+  workerGen++;
+  smileCondBroadcastRaw(workerCondStart);
+  smileMutexUnlock(workerMtx);
+
+  runPhase(phase, 0);
+
+  smileMutexLock(workerMtx);
+  while (nWorkersDone < nWorkersRunning) smileCondWaitWMtx(workerCondDone, workerMtx);
+  smileMutexUnlock(workerMtx);
+}
+
+SMILE_THREAD_RETVAL cLibsvmMultiSink::workerThreadMain(void *_obj)
+{
+  cLibsvmMultiSink *obj = (cLibsvmMultiSink *)_obj;
+  smileMutexLock(obj->workerMtx);
+  int w = ++obj->workerIdx;
+  long gen = 0;  // all workers are created before the first phase is started
+  smileMutexUnlock(obj->workerMtx);
+  while (1) {
+    smileMutexLock(obj->workerMtx);
+    while ((obj->workerGen == gen)&&(!obj->workerStop)) smileCondWaitWMtx(obj->workerCondStart, obj->workerMtx);
+    if (obj->workerStop) {
+      smileMutexUnlock(obj->workerMtx);
+      break;
+    }
+    gen = obj->workerGen;
+    int phase = obj->workerPhase;
+    smileMutexUnlock(obj->workerMtx);
+
+    obj->runPhase(phase, w);
+
+    smileMutexLock(obj->workerMtx);
+    obj->nWorkersDone++;
+    smileCondSignalRaw(obj->workerCondDone);
+    smileMutexUnlock(obj->workerMtx);
+  }
+  SMILE_THREAD_RET;
+}
+
+void cLibsvmMultiSink::processResults(long long tick, long frameIdx, double time, double dur)
+{
+  int i, j;
+  if (printResult) {
+    for (i=0; i<nHeads; i++) {
+      sClassifierResult *r = results+i;
+      if (r->className != NULL) {
+        SMILE_PRINT("\n LibSVM  '%s' result (@ time: %f) :  ~~> %s <~~",r->name,time,r->className);
+      } else {
+        SMILE_PRINT("\n LibSVM  '%s' result (@ time: %f) :  ~~> %.2f <~~",r->name,time,r->result);
+      }
+      if (r->probEstimates != NULL) {
+        sLibsvmHead *h = heads+i;
+        for (j=0; j<r->nClasses; j++) {
+          int idx = h->labels[j];
+          if ((h->nCls>0)&&(h->classNames != NULL)) {
+            if (idx >= h->nCls) idx = h->nCls-1;
+            if (idx < 0) idx = 0;
+            SMILE_PRINT("     prob. class '%s': \t %f",h->classNames[idx],r->probEstimates[j]);
+          } else {
+            SMILE_PRINT("     prob. class %i : \t %f",idx,r->probEstimates[j]);
+          }
+        }
+      }
+    }
+  }
+
+  // send all results in one componentMessage
+  if (sendResult) {
+    cComponentMessage msg("classificationResults", resultMessageName);
+    for (i=0; (i<nHeads)&&(i<CMSG_nUserData); i++) msg.floatData[i] = results[i].result;
+    msg.intData[0]   = nHeads;
+    msg.custData     = results;
+    msg.userTime1    = time;
+    msg.userTime2    = time+dur;
+    sendComponentMessage( resultRecp, &msg );
+    SMILE_IDBG(3,"sending 'classificationResults' message to '%s'",resultRecp);
+  }
+}
+
+int cLibsvmMultiSink::myTick(long long t)
+{
+  if (heads == NULL) return 0;
+
+  SMILE_DBG(4,"tick # %i, classifiy value vector using %i LibSVM models",t,nHeads);
+  cVector *vec= reader->getFrameRel(0);
+  if (vec == NULL) return 0;
+
+  int g;
+  long i;
+  for (g=0; g<nGroups; g++) {
+    sLibsvmInputGroup *gr = groups+g;
+    const FLOAT_DMEM *x = vec->dataF;
+    if (gr->idx != NULL) {
+      for (i=0; i<gr->dim; i++) {
+        gr->x[i] = (gr->idx[i] < vec->N) ? (float)x[gr->idx[i]] : 0.0f;
+      }
+    } else {
+      for (i=0; (i<vec->N)&&(i<gr->dim); i++) gr->x[i] = (float)x[i];
+    }
+    svm_dense_pool_set_input(gr->pool, gr->x);
+  }
+
+  runParallel(0);
+  runParallel(1);
+
+  processResults(t, vec->tmeta->vIdx, vec->tmeta->smileTime, vec->tmeta->lengthSec);
+
+  // tick success
+  return 1;
+}
+
+
+cLibsvmMultiSink::~cLibsvmMultiSink()
+{
+  int i;
+  long n;
+  if (workers != NULL) {
+    smileMutexLock(workerMtx);
+    workerStop = 1;
+    smileCondBroadcastRaw(workerCondStart);
+    smileMutexUnlock(workerMtx);
+    for (i=0; i<nWorkersRunning; i++) smileThreadJoin(workers[i]);
+    free(workers);
+    smileCondDestroy(workerCondStart);
+    smileCondDestroy(workerCondDone);
+    smileMutexDestroy(workerMtx);
+  }
+  if (heads != NULL) {
+    for (i=0; i<nHeads; i++) {
+      sLibsvmHead *h = heads+i;
+      if (h->dm != NULL) svm_dense_destroy(h->dm);
+      if (h->model != NULL) svm_destroy_model(h->model);
+      svm_destroy_scale(h->scale);
+      svm_unmap_bundle(&(h->bundle));
+      if (h->labels != NULL) free(h->labels);
+      if (h->selIdx.enabled != NULL) free(h->selIdx.enabled);
+      if (h->selStr.names != NULL) {
+        for (n=0; n<h->selStr.n; n++) if (h->selStr.names[n] != NULL) free(h->selStr.names[n]);
+        free(h->selStr.names);
+      }
+      if (h->classNames != NULL) {
+        for (n=0; n<h->nCls; n++) if (h->classNames[n] != NULL) free(h->classNames[n]);
+        free(h->classNames);
+      }
+    }
+    free(heads);
+  }
+  if (groups != NULL) {
+    for (i=0; i<nGroups; i++) {
+      svm_dense_pool_destroy(groups[i].pool);
+      if (groups[i].idx != NULL) free(groups[i].idx);
+      if (groups[i].scale_a != NULL) free(groups[i].scale_a);
+      if (groups[i].scale_b != NULL) free(groups[i].scale_b);
+      if (groups[i].x != NULL) free(groups[i].x);
+    }
+    free(groups);
+  }
+  if (results != NULL) {
+    for (i=0; i<nHeads; i++) if (results[i].probEstimates != NULL) free(results[i].probEstimates);
+    free(results);
+  }
+}
+
@@ -0,0 +1,137 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+
+/*  openSMILE component:
+
+LibSVM multi-head classifier: several LibSVM models on one feature vector
+
+*/
+
+
+#ifndef __CLIBSVMMULTISINK_HPP
+#define __CLIBSVMMULTISINK_HPP
+
+#include <smileCommon.hpp>
+#include <smileComponent.hpp>
+#include <dataSink.hpp>
+#include <libsvmliveSink.hpp>
+
+#define COMPONENT_DESCRIPTION_CLIBSVMMULTISINK "classifies data from dataMemory with several LibSVM models (heads) at once, support vectors shared by the models are evaluated only once, the results are sent in one 'classificationResults' message"
+#define COMPONENT_NAME_CLIBSVMMULTISINK "cLibsvmMultiSink"
+
+/* result of one head, an array of these (one per head) is sent as custData of the 'classificationResults' message */
+typedef struct {
+  const char *name;        // name of the head
+  double result;           // class label, or regression value
+  const char *className;   // class name from the class map, NULL if there is none
+  int nClasses;            // number of probEstimates (0 = none)
+  double *probEstimates;   // class probabilities (in the order of the model labels), or NULL
+} sClassifierResult;
+
+/* one model */
+typedef struct {
+  const char *name;
+  const char *modelfile, *scalefile, *fselection, *classes;
+  int predictProbability;
+  struct svm_model *model;
+  struct svm_scale *scale;
+  sSvmBundle bundle;
+  int nClasses, svmType;
+  int *labels;
+  long nCls;
+  char **classNames;
+  int fselType;
+  sOutputSelectionStr selStr;
+  sOutputSelectionIdx selIdx;
+  int group;               // input group of this head
+  struct svm_dense_model *dm;
+} sLibsvmHead;
+
+/* heads with the same feature selection and scaling share one input vector and one SV matrix */
+typedef struct {
+  long N;                  // length of the input frame (after the projection of the reader)
+  long *idx;               // selected features (dim indices into the input frame), NULL = all
+  int dim;
+  double *scale_a, *scale_b;
+  float *x;
+  struct svm_dense_pool *pool;
+} sLibsvmInputGroup;
+
+class cLibsvmMultiSink : public cDataSink {
+  private:
+    int printResult, sendResult;
+    const char * resultRecp;
+    const char * resultMessageName;
+
+    int nHeads;
+    sLibsvmHead *heads;
+    int nGroups;
+    sLibsvmInputGroup *groups;
+    sClassifierResult *results;
+
+    // worker threads, the tick thread is worker 0
+    int nThreads, headsPerThread;
+    smileThread *workers;
+    int nWorkersRunning, workerStop, workerPhase, nWorkersDone, workerIdx;
+    long workerGen;
+    smileMutex workerMtx;
+    smileCond workerCondStart, workerCondDone;
+
+    int loadHead(sLibsvmHead *h);
+    void setupGroups();
+    void runPhase(int phase, int w);
+    void runParallel(int phase);
+    static SMILE_THREAD_RETVAL workerThreadMain(void *_obj);
+
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+
+    virtual void fetchConfig();
+    virtual int myFinaliseInstance();
+    virtual int myTick(long long t);
+
+    virtual void processResults(long long tick, long frameIdx, double time, double dur);
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+    
+    cLibsvmMultiSink(const char *_name);
+
+    virtual ~cLibsvmMultiSink();
+};
+
+
+
+
+#endif // __CLIBSVMMULTISINK_HPP
@@ -61,6 +61,7 @@ SMILECOMPONENT_REGCOMP(cLibsvmSink)
     ct->setField("timestamp","print timestamp attribute (1/0 = yes/no)",1);
     ct->setField("instanceBase","if not empty, print instance name attribute <instanceBase_Nr>","");
     ct->setField("instanceName","if not empty, print instance name attribute <instanceName>","");
+    ct->setField("precision","number of significant digits to print for each value (exponent notation, 7 = printf's %e), 0 = print the shortest text that reads back as the exact value",0);
 //    ct->setField("number","print instance number (= frameIndex) attribute (1/0 = yes/no)",1);
 
     ct->setField("class","optional definition of class-name strings (array for multiple classes)", "classX", ARRAY_TYPE);
@@ -80,8 +81,10 @@ SMILECOMPONENT_CREATE(cLibsvmSink)
 
 cLibsvmSink::cLibsvmSink(const char *_name) :
   cDataSink(_name),
-  filehandle(NULL),
+  writer(NULL),
   filename(NULL),
+  precision(0),
+  rowLen(0),
   nInst(0),
   nClasses(0),
   inr(0),
@@ -106,6 +109,9 @@ void cLibsvmSink::fetchConfig()
   timestamp = getInt("timestamp");
   if (append) SMILE_DBG(3,"printing timestamp attribute (index 1) enabled");
 
+  precision = getInt("precision");
+  SMILE_DBG(3,"precision = %i",precision);
+
   instanceBase = getStr("instanceBase");
   SMILE_DBG(3,"instanceBase = '%s'",instanceBase);
 
@@ -166,34 +172,37 @@ int cLibsvmSink::myFinaliseInstance()
   int ret = cDataSink::myFinaliseInstance();
   if (ret==0) return 0;
   
+  // each row is formatted directly into the output buffer, thus it must hold one complete row (index:value pairs)
+  rowLen = (reader->getLevelN()+2) * 2 * SMILEUTIL_NUMSTR_MAX + (long)strlen(NEWLINE);
+  writer = createFileWriter(rowLen);
   if (append) {
     // check if file exists:
-    filehandle = fopen(filename, "r");
-    if (filehandle != NULL) {
-      fclose(filehandle);
-      filehandle = fopen(filename, "a");
+    FILE *f = fopen(filename, "r");
+    if (f != NULL) {
+      fclose(f);
+      writer->open(filename, "a");
       ap=1;
     } else {
-      filehandle = fopen(filename, "w");
+      writer->open(filename, "w");
     }
   } else {
-    filehandle = fopen(filename, "w");
+    writer->open(filename, "w");
   }
-  if (filehandle == NULL) {
+  if (!writer->isOpen()) {
     COMP_ERR("Error opening file '%s' for writing (component instance '%s', type '%s')",filename, getInstName(), getTypeName());
   }
   
 //  if (!ap) {
   // write header ....
 //  if (timestamp) {
-//    fprintf(filehandle, "@attribute frameTime numeric%s",NEWLINE);
+//    writer->printf("@attribute frameTime numeric%s",NEWLINE);
 //  }
 /*
   long _N = reader->getLevelN();
   long i;
   for(i=0; i<_N; i++) {
     char *tmp = reader->getElementName(i);
-    fprintf(filehandle, "@attribute %s numeric%s",tmp,NEWLINE);
+    writer->printf("@attribute %s numeric%s",tmp,NEWLINE);
     free(tmp);
   }
 */
@@ -205,7 +214,7 @@ int cLibsvmSink::myFinaliseInstance()
 
 int cLibsvmSink::myTick(long long t)
 {
-  if (filehandle == NULL) return 0;
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
 
   SMILE_DBG(4,"tick # %i, writing to lsvm file (lag=%i):",t,lag);
   cVector *vec= reader->getFrameRel(lag);  //new cVector(nValues+1);
@@ -218,35 +227,44 @@ int cLibsvmSink::myTick(long long t)
   
 /*
   if (prname==1) {
-    fprintf(filehandle,"'%s',",instanceName);
+    writer->printf("'%s',",instanceName);
   } else if (prname==2) {
-    fprintf(filehandle,"'%s_%i',",instanceBase,vi);
+    writer->printf("'%s_%i',",instanceBase,vi);
   }
   */
+  // the row is formatted directly into the output buffer:
+  char *b = writer->reserve(rowLen);
+  if (b == NULL) return 0;
+  char *c = b;
+
   // classes: TODO:::
   if ((nClasses > 0)&&(nInst>0)) {  // per instance classes
     if (inr >= nInst) {
       SMILE_WRN(3,"more instances written to LibSVM file (%i), then there are targets available for (%i)!",inr,nInst);
-      fprintf(filehandle,"%i ",targetNumAll);
+      c += smileUtil_formatLong(c,targetNumAll);
     } else {
-      fprintf(filehandle,"%i ",target[inr++]);
+      c += smileUtil_formatLong(c,target[inr++]);
     }
   } else {
-    fprintf(filehandle,"%i ",targetNumAll);
+    c += smileUtil_formatLong(c,targetNumAll);
   }
+  *(c++) = ' ';
 
-//  if (number) fprintf(filehandle,"%i:%i ",idx++,vi);
-  if (timestamp) fprintf(filehandle,"%i:%f ",idx++,tm);
+//  if (number) writer->printf("%i:%i ",idx++,vi);
+  if (timestamp) c += sprintf(c,"%i:%f ",idx++,tm);
 
   
   // now print the vector:
   int i;
-  fprintf(filehandle,"%i:%e ",idx++,vec->dataF[0]);
-  for (i=1; i<vec->N; i++) {
-    fprintf(filehandle,"%i:%e ",idx++,vec->dataF[i]);
+  for (i=0; i<vec->N; i++) {
+    c += smileUtil_formatLong(c,idx++);
+    *(c++) = ':';
+    c += smileUtil_formatFloat(c,vec->dataF[i],precision);
+    *(c++) = ' ';
   }
 
-  fprintf(filehandle,"%s",NEWLINE);
+  memcpy(c,NEWLINE,strlen(NEWLINE));
+  writer->commit(c - b + strlen(NEWLINE));
 
   // tick success
   return 1;
@@ -255,7 +273,7 @@ int cLibsvmSink::myTick(long long t)
 
 cLibsvmSink::~cLibsvmSink()
 {
-  fclose(filehandle);
+  if (writer != NULL) delete writer;
   int i;
   if (classname!=NULL) {
     for (i=0; i<nClasses; i++) if (classname[i] != NULL) free(classname[i]);
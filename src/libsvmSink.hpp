@@ -50,10 +50,12 @@ LibSVM file output
 
 class cLibsvmSink : public cDataSink {
   private:
-    FILE * filehandle;
+    cSmileFileWriter * writer;
     const char *filename;
     int lag;
     int append, timestamp;
+    int precision;
+    long rowLen;  // max. length of the text of the attributes of one instance
     const char *instanceBase, *instanceName;
     
     int targetNumAll;
@@ -57,8 +57,8 @@ SMILECOMPONENT_REGCOMP(cLibsvmLiveSink)
   SMILECOMPONENT_INHERIT_CONFIGTYPE("cDataSink")
 
   SMILECOMPONENT_IFNOTREGAGAIN_BEGIN
-    ct->makeMandatory(ct->setField("model","LibSVM model file to load","svm.model"));
-    ct->makeMandatory(ct->setField("scale","LibSVM scale file to load",(const char*)NULL));
+    ct->makeMandatory(ct->setField("model","LibSVM model file to load (text model, or binary model created with svm-compile, which includes scale, class map, and feature selection)","svm.model"));
+    ct->setField("scale","LibSVM scale file to load (mandatory for text models)",(const char*)NULL);
     ct->setField("fselection","feature selection file to apply (leave empty to use all features)",(const char*)NULL);
     ct->setField("classes","class name lookup file (leave empty to display libsvm class numbers/indicies)",(const char*)NULL);
     ct->setField("predictProbability","predict class probabilities (1/0=yes/no)",0);
@@ -66,6 +66,9 @@ SMILECOMPONENT_REGCOMP(cLibsvmLiveSink)
     ct->setField("resultRecp","component(s) to send 'classificationResult' messages to (use , to separate multiple recepients), leave blank (NULL) to not send any messages",(const char *) NULL);
     ct->setField("resultMessageName","custom name that is sent with 'classificationResult' message","svm_result");
     ct->setField("lag","output data <lag> frames behind (obsolete for this component...?)",0);
+    ct->setField("dense","1 = classify with the dense inference engine (support vectors unpacked to a dense matrix at load time, scaling folded into the model), 0 = use the sparse LibSVM code",1);
+    ct->setField("batchSize","(dense=1 only) > 1 : batch mode for offline classification: wait for batchSize frames (per thread) and classify them at once (the SVs are multiplied with tiles of frames for better cache reuse), the results are processed in the order of the frames. 1 = classify each frame as soon as it arrives",1);
+    ct->setField("batchThreads","(batchSize > 1 only) number of threads (including the tick thread) which classify the frames of a batch",1);
     
   SMILECOMPONENT_IFNOTREGAGAIN_END
 
@@ -79,16 +82,22 @@ SMILECOMPONENT_CREATE(cLibsvmLiveSink)
 cLibsvmLiveSink::cLibsvmLiveSink(const char *_name) :
   cDataSink(_name),
   modelfile(NULL), scalefile(NULL), predictProbability(0),
+  model(NULL), scale(NULL),
   labels(NULL), probEstimates(NULL),
   nClasses(0), printResult(1),
   fselType(0), Nsel(-1),
   classNames(0), nCls(0),
   sendResult(0),
-  resultMessageName(NULL), resultRecp(NULL)
+  resultMessageName(NULL), resultRecp(NULL),
+  useDense(1), denseModel(NULL), denseX(NULL),
+  batchSize(1), nBatchThreads(1), batchMax(0), batchN(0), batchNft(0),
+  batchX(NULL), batchRes(NULL), batchProb(NULL), batchVi(NULL), batchTm(NULL), batchDur(NULL),
+  workers(NULL), nWorkersRunning(0), workerStop(0), nWorkersDone(0), workerIdx(0), workerGen(0)
 {
   outputSelIdx.enabled = NULL;
   outputSelStr.n = 0;
   outputSelStr.names = NULL;
+  memset(&bundle, 0, sizeof(bundle));
 }
 
 void cLibsvmLiveSink::fetchConfig()
@@ -122,6 +131,23 @@ void cLibsvmLiveSink::fetchConfig()
 
   resultMessageName = getStr("resultMessageName");
   SMILE_IDBG(2,"resultMessageName = '%s'",resultMessageName);
+
+  useDense = getInt("dense");
+  SMILE_IDBG(2,"dense = %i",useDense);
+
+  batchSize = getInt("batchSize");
+  if (batchSize < 1) batchSize = 1;
+  if (!useDense) batchSize = 1;
+  SMILE_IDBG(2,"batchSize = %i",batchSize);
+  nBatchThreads = getInt("batchThreads");
+  if (nBatchThreads < 1) nBatchThreads = 1;
+#ifndef HAVE_PTHREAD
+#ifndef __WINDOWS
+  nBatchThreads = 1;
+#endif
+#endif
+  if (batchSize == 1) nBatchThreads = 1;
+  SMILE_IDBG(2,"batchThreads = %i",nBatchThreads);
 }
 
 /*
@@ -134,122 +160,29 @@ int cLibsvmLiveSink::myConfigureInstance()
 }
 */
 
-#define MAX_LINE_LENGTH 1024
-
 int cLibsvmLiveSink::loadClasses( const char *file )
 {
   if (file != NULL) {
     if (strlen(file)<1) return 0;
-
-    FILE *f = fopen(file,"r");
-    if (f== NULL) {
-      SMILE_IERR(2,"error opening class map file '%s' for reading! NOT using a class map!",file);
-      return 0;
-    }
-
-    char line[MAX_LINE_LENGTH+1];
-    nCls=0;
-    
-    while(fgets(line,MAX_LINE_LENGTH,f) != NULL) {
-        if (strlen( line ) > 1) { 
-          line[strlen( line ) - 1] = 0;
-          const char *cn = strchr(line,':');
-          if (cn!=NULL) {
-            nCls++;
-            // TODO: use class number instead of cont. index
-          }
-        }
-    }
-    fclose(f);
-
-    f = fopen(file,"r");
-    if (f== NULL) {
-      SMILE_IERR(2,"error opening class map file '%s' for reading (2nd pass)! NOT using a class map!",file);
-      return 0;
-    }
-
-    int i=0;
-    classNames=(char**)calloc(1,sizeof(char*)*nCls);
-    while(fgets(line,MAX_LINE_LENGTH,f) != NULL) {
-        if (strlen( line ) > 1) { 
-          line[strlen( line ) - 1] = 0;
-          const char *cn = strchr(line,':');
-          if (cn!=NULL) {
-            classNames[i++] = strdup(cn+1);
-            // TODO: use class number instead of cont. index
-          }
-        }
-    }
-    fclose(f);
-
-    return 1;
+    nCls = svm_load_classes(file, &classNames);
+    if (nCls > 0) return 1;
+    SMILE_IERR(2,"NOT using a class map (class map file '%s')!",file);
   }
   return 0;
 }
 
 int cLibsvmLiveSink::loadSelection( const char *selFile )
 {
-  if (selFile != NULL) {
-    if (strlen(selFile)<1) return 0;
-
-    FILE *f = fopen(selFile,"r");
-    if (f== NULL) {
-      SMILE_IERR(2,"error opening feature selection file '%s' for reading! NOT using a feature selection!",selFile);
-      return 0;
-    }
-    
-    // read first line to determine filetype:
-    char line[MAX_LINE_LENGTH+1];
-    long nStr=0;
-    fgets( line, 5, f);
-    line[3] = 0;
-    if (!strcmp(line,"str")) { // string list
-      fselType = 2;
-      SMILE_IDBG(5,"reading string list of features");
-      fscanf( f, "%u\n", &nStr);
-      if (nStr < 1) { COMP_ERR("Error reading feature selection file, nFeatures < 1!"); }
-      outputSelStr.n = nStr;
-      Nsel=nStr;
-      outputSelStr.names = (char **)calloc(1,sizeof(char *)*nStr);
-      int i=0; line[0] = 0;
-      while(fgets(line,MAX_LINE_LENGTH,f) != NULL) {
-        if (strlen( line ) > 1) { 
-          line[strlen( line ) - 1] = 0;
-          outputSelStr.names[i++] = strdup(line);
-        }
-      }
-      SMILE_IDBG(5,"enabled %i features",i);
-      fclose(f);
-      return 1;
-    } else if (!strcmp(line,"idx")) { // index list
-      fselType = 1;
-      SMILE_IDBG(5,"reading index list of features");
-      long idx=0; int i;
-      // pass1: parse for max index
-      while(fscanf(f,"%u\n",&idx) == 1)
-        outputSelIdx.nFull = MAX(outputSelIdx.nFull, idx);
-      SMILE_IDBG(5,"max index in selection file was found to be %i",outputSelIdx.nFull);
-      outputSelIdx.nFull++;
-      outputSelIdx.enabled = (long *)calloc(1,sizeof(long)*outputSelIdx.nFull);
-      rewind( f );
-      fgets(line, 5, f); // skip header line;
-      // pass2: parse for max index
-      i=0;
-      while(fscanf(f,"%u\n",&idx) == 1) {
-        outputSelIdx.enabled[idx] = 1; // enable feature "idx"
-        i++;
-      }
-      outputSelIdx.nSel = i;
-      Nsel = i;
-      SMILE_IDBG(5,"enabled %i features",i);
-      fclose(f);
-      return 1;
-    } else { // bogus file...
-      COMP_ERR("error parsing fselection file '%s'. bogus header! expected 'str' or 'idx' at beginning. found '%s'.",selFile,line);
-      fclose( f );
-    }
+  int t = svm_load_selection(selFile, &outputSelStr, &outputSelIdx);
+  if (t == -1) {
+    COMP_ERR("error parsing fselection file '%s'!",selFile);
   }
-  return 0;
+  if (t <= 0) return 0;
+  fselType = t;
+  if (fselType == 1) Nsel = outputSelIdx.nSel;
+  else Nsel = outputSelStr.n;
+  SMILE_IDBG(5,"enabled %i features",Nsel);
+  return 1;
 }
 
 int cLibsvmLiveSink::myFinaliseInstance()
@@ -259,11 +192,34 @@ int cLibsvmLiveSink::myFinaliseInstance()
   int ret = cDataSink::myFinaliseInstance();
   if (ret==0) return 0;
   
-  // TODO: binary model files...
-  // load model
-  SMILE_MSG(2,"loading LibSVM model for instance '%s' ...",getInstName()); 
-  if((model=svm_load_model(modelfile))==0) {
-    COMP_ERR("can't open libSVM model file '%s'",modelfile);
+  int isBundle = svm_is_bundle(modelfile);
+  if (isBundle) {
+    // binary model: model, scale, class names and feature selection from one (memory mapped) file
+    SMILE_MSG(2,"loading binary LibSVM model for instance '%s' ...",getInstName()); 
+    if (!svm_load_bundle(modelfile, &bundle)) {
+      COMP_ERR("can't load binary libSVM model file '%s'",modelfile);
+    }
+    model = bundle.model;
+    scale = bundle.scale;
+    nCls = bundle.nCls;
+    classNames = bundle.classNames;
+    fselType = bundle.fselType;
+    outputSelStr = bundle.selStr;
+    outputSelIdx = bundle.selIdx;
+    if (fselType == 1) Nsel = outputSelIdx.nSel;
+    else if (fselType == 2) Nsel = outputSelStr.n;
+    if ((scalefile != NULL)||(fselection != NULL)||(classes != NULL))
+      SMILE_IWRN(2,"the binary model '%s' contains the scale, class map, and feature selection, ignoring the 'scale', 'classes', and 'fselection' options",modelfile);
+    if (!useDense) {
+      SMILE_IWRN(2,"binary models can only be used with the dense inference engine, enabling 'dense'");
+      useDense = 1;
+    }
+  } else {
+    // load model
+    SMILE_MSG(2,"loading LibSVM model for instance '%s' ...",getInstName()); 
+    if((model=svm_load_model(modelfile))==0) {
+      COMP_ERR("can't open libSVM model file '%s'",modelfile);
+    }
   }
 
   nClasses = svm_get_nr_class(model);
@@ -288,23 +244,27 @@ int cLibsvmLiveSink::myFinaliseInstance()
   if ((predictProbability)&&(nClasses>0))
     probEstimates = (double *) malloc(nClasses*sizeof(double));
 
-  // load scale
-  if((scale=svm_load_scale(scalefile))==0) {
-	COMP_ERR("can't open libSVM scale file '%s'",scalefile);
-  }
+  if (!isBundle) {
+    // load scale
+    if((scale=svm_load_scale(scalefile))==0) {
+      COMP_ERR("can't open libSVM scale file '%s'",scalefile);
+    }
 
-  // load selection
-  loadSelection(fselection);
+    // load selection
+    loadSelection(fselection);
 
-  //TODO: check compatibility of getLevelN() (possibly after selection), number of features in model, and scale
+    //TODO: check compatibility of getLevelN() (possibly after selection), number of features in model, and scale
   
-  if (nClasses>0) {
-    // load class mapping
-    loadClasses(classes);
-  } else {
-    if (classes != NULL) SMILE_IWRN(2,"not loading given class mapping file for regression SVR model (there are no classes...)!");
+    if (nClasses>0) {
+      // load class mapping
+      loadClasses(classes);
+    } else {
+      if (classes != NULL) SMILE_IWRN(2,"not loading given class mapping file for regression SVR model (there are no classes...)!");
+    }
   }
 
+  resolveSelection();
+
   return ret;
 }
 
@@ -364,98 +324,90 @@ void cLibsvmLiveSink::processResult(long long tick, long frameIdx, double time,
   }
 }
 
-/*
-   // genOutput_applySelection(obj);
-int genOutput_applySelection( pGenOutput obj )
-#define FUNCTION "genOutput_applySelection"
-{_FUNCTION_ENTER_
-  int i,j,N=0;
-  
-  if (obj != NULL) {
-    if (obj->outputSelType == 1) {  // index list
-      if (obj->outputDef.namesFull != NULL) {
-         FEATUM_DEBUG(6,"applying index list feature selection...");
-         obj->outputDef.names = (char **)calloc(1,sizeof(char *)*obj->outputSelIdx.nSel);
-         for (i=0; i<obj->outputDef.nFull; i++) {
-           if ((i<obj->outputSelIdx.nFull)&&(obj->outputSelIdx.enabled[i])) { 
-             obj->outputDef.names[N++] = strdup(obj->outputDef.namesFull[i]);
-           }
-         }
-         if (N==0) {
-           FEATUM_ERROR(1,"No features enabled! Ignoring feature selection");
-           obj->outputDef.n = obj->outputDef.nFull;        
-           free(obj->outputDef.names);  
-           obj->outputDef.names = obj->outputDef.namesFull;
-           obj->outputSelIdx.nFull = 0;           
-         } else {
-           obj->outputDef.n = N;
-           obj->outputVec.n = N;
-         }
-         FEATUM_DEBUG(7,"DONE : applying index list feature selection.");
-      }     
-      
-      _FUNCTION_RETURN_(1);
-    } else
-    if (obj->outputSelType == 2) {  // string list
-      if (obj->outputDef.namesFull != NULL) {
-         FEATUM_DEBUG(6,"applying string list feature selection...");
-         obj->outputDef.names = (char **)calloc(1,sizeof(char *)*obj->outputSelStr.n);
-         if (obj->outputSelIdx.enabled) free(obj->outputSelIdx.enabled);
-         obj->outputSelIdx.enabled = (int *)calloc(1,sizeof(int)*obj->outputDef.nFull);
-         for (i=0; i<  obj->outputDef.nFull; i++) {
-             for (j=0; j<obj->outputSelStr.n; j++) {
-               if (!strcmp(obj->outputDef.namesFull[i], obj->outputSelStr.names[j])) {
-                 obj->outputDef.names[N++] = strdup(obj->outputDef.namesFull[i]);
-                 obj->outputSelIdx.enabled[i] = 1;
-                 break;                                     
-               }
-             }             
-         }
-         if (N==0) {
-           FEATUM_ERROR(1,"No matching features! Ignoring feature selection");
-           obj->outputDef.n = obj->outputDef.nFull;        
-           free(obj->outputDef.names);  
-           obj->outputDef.names = obj->outputDef.namesFull;
-           obj->outputSelIdx.nFull = 0;
-         } else {
-           obj->outputDef.n = N;
-           obj->outputVec.n = N;
-           // we must now build the index mapping:
-           obj->outputSelIdx.nFull = obj->outputDef.nFull;
-           obj->outputSelIdx.nSel = N;
-           
-         }
-         FEATUM_DEBUG(7,"DONE : applying string list feature selection.");
-      }     
-      _FUNCTION_RETURN_(1);
+// resolve the feature selection (indices or names) to the list of selected elements of the input frame,
+// the reader then reads only these elements from the data memory (projection)
+int cLibsvmLiveSink::resolveSelection()
+{
+  if (fselType <= 0) return 1;
+  long N = reader->getLevelN();
+  long n, nIdx = 0;
+  long *idx = (long *)malloc(sizeof(long)*(N+1));
+  if (idx == NULL) OUT_OF_MEMORY;
+  if (fselType == 1) {
+    // the indices refer to the input before dead output elimination
+    for (n=0; n<outputSelIdx.nFull; n++) {
+      if (!outputSelIdx.enabled[n]) continue;
+      long m = reader->mapUnprunedIndex(n);
+      if ((m >= 0)&&(m < N)) idx[nIdx++] = m;
     }
+  } else if (fselType == 2) {
+    const FrameMetaInfo *fmeta = reader->getFrameMetaInfo();
+    for (n=0; (n<N)&&(fmeta != NULL); n++) {
+      const char *name = fmeta->getName(n,NULL);
+      long i;
+      for (i=0; i<outputSelStr.n; i++) {
+        if (!strcmp(name,outputSelStr.names[i])) { idx[nIdx++] = n; break; }
+      }
+    }
+  }
+  if (nIdx == 0) {
+    SMILE_IWRN(2,"no features of the input are enabled by the feature selection, ignoring the feature selection");
+    Nsel = -1;
+  } else {
+    if (nIdx < Nsel) SMILE_IWRN(2,"only %li of the %li selected features were found in the input (the missing features are set to 0)",nIdx,Nsel);
+    if (!reader->setProjection(idx, nIdx)) {
+      COMP_ERR("error setting up the feature selection");
+    }
+    SMILE_IDBG(3,"feature selection: reading %li of %li input elements",nIdx,N);
   }
-  _FUNCTION_RETURN_(0);
+  free(idx);
+  return 1;
 }
-#undef FUNCTION
 
-*/
-
-int cLibsvmLiveSink::buildEnabledSelFromNames(long N, const FrameMetaInfo *fmeta)
+// number of features after the selection, builds the dense model at the first frame
+long cLibsvmLiveSink::prepareInput(cVector *vec)
 {
-  int n,i;
-  SMILE_IDBG(3,"computing mapping from feature names to feature indicies");
-  outputSelIdx.nFull = N;
-  outputSelIdx.nSel = outputSelStr.n;
-  outputSelIdx.enabled = (long *)calloc(1,sizeof(long)*outputSelIdx.nFull);
-  for (n=0; n<N; n++) {
-    for (i=0; i<outputSelStr.n; i++) {
-      if (!strcmp(fmeta->getName(n,NULL),outputSelStr.names[i]))
-        outputSelIdx.enabled[n] = 1;
+  long Nft = Nsel;
+  if (Nft <= 0) Nft = vec->N;
+
+  if ((useDense)&&(denseModel == NULL)) {
+    // unpack the model to the dense representation, with the scaling folded in
+    double *sa = NULL, *sb = NULL;
+    if (scale != NULL) {
+      sa = (double *)malloc(sizeof(double)*Nft);
+      sb = (double *)malloc(sizeof(double)*Nft);
+      svm_scale_affine(scale, Nft, sa, sb);
+    }
+    denseModel = svm_dense_create(model, Nft, sa, sb);
+    if (sa != NULL) free(sa);
+    if (sb != NULL) free(sb);
+    if (denseModel == NULL) {
+      SMILE_IWRN(2,"dense inference is not supported for this model (precomputed kernel?), using the sparse LibSVM code");
+      useDense = 0;
+    } else {
+      denseX = (float *)calloc(1,sizeof(float)*Nft);
     }
   }
-  SMILE_IDBG(3,"mapping computed successfully");
-  return 1;
+  return Nft;
+}
+
+// input vector of the dense model, copied to dst if the frame can not be used directly (or if copy=1)
+// (the frame holds the selected features only, see resolveSelection)
+const float * cLibsvmLiveSink::gatherDense(cVector *vec, long Nft, float *dst, int copy)
+{
+  long i;
+  if ((vec->N < Nft)||(copy)) {
+    for (i=0; (i<vec->N)&&(i<Nft); i++) dst[i] = (float)vec->dataF[i];
+    for (; i<Nft; i++) dst[i] = 0.0;
+    return dst;
+  }
+  return vec->dataF;
 }
 
 int cLibsvmLiveSink::myTick(long long t)
 {
   if (model == NULL) return 0;
+  if (batchSize > 1) return batchTick(t);
 
   SMILE_DBG(4,"tick # %i, classifiy value vector using LibSVM (lag=%i):",t,lag);
   cVector *vec= reader->getFrameRel(lag);  //new cVector(nValues+1);
@@ -466,39 +418,33 @@ int cLibsvmLiveSink::myTick(long long t)
   int i = 0;
   double v;
                                           // need one more for index = -1
-  long Nft = Nsel;
-  if (Nft <= 0) Nft = vec->N;
+  long Nft = prepareInput(vec);
 
-  if (fselType) {
-    if ((outputSelIdx.enabled == NULL)&&(outputSelStr.names != NULL)) {
-      buildEnabledSelFromNames(vec->N, vec->fmeta);
-    } else if (outputSelIdx.enabled == NULL) Nft = vec->N;
-  }
-    
-  // TODO: fselection by names... 
-  // TODO: compute Nsel in loadSelection
-
-  x = (struct svm_node *) malloc( (Nft + 1) * sizeof(struct svm_node));
-  int j = 0;
-  for (i=0; i<vec->N; i++) {
-    if ((outputSelIdx.enabled == NULL)||(Nsel<=0)) {
-      x[i].index = i+1; // FIXME!!! +1 is ok??? (no!?)
-      x[i].value = vec->dataF[i];
+  long vi = vec->tmeta->vIdx;
+  double tm = vec->tmeta->smileTime;
+  double dur = vec->tmeta->lengthSec;
+
+  if (useDense) {
+    const float *xd = gatherDense(vec, Nft, denseX, 0);
+    if ( (predictProbability) && (svmType==C_SVC || svmType==NU_SVC) ) {
+      v = svm_dense_predict_probability(denseModel,xd,probEstimates);
+      processResult(t, vi, tm, v, probEstimates, nClasses, dur);
     } else {
-      if (outputSelIdx.enabled[i]) {
-        x[j].index = j+1; // FIXME!!! +1 is ok??? (no!?)
-        x[j].value = vec->dataF[i];
-        j++;
-      }
+      v = svm_dense_predict(denseModel,xd);
+      processResult(t, vi, tm, v, NULL, nClasses, dur);
     }
+    return 1;
   }
-  if ((outputSelIdx.enabled == NULL)||(Nsel<=0)) {
-    x[i].index = -1;
-    x[i].value = 0.0;
-  } else {
-    x[j].index = -1;
-    x[j].value = 0.0;
+
+  // the frame holds the selected features only (see resolveSelection)
+  long nx = MIN(vec->N, Nft);
+  x = (struct svm_node *) malloc( (nx + 1) * sizeof(struct svm_node));
+  for (i=0; i<nx; i++) {
+    x[i].index = i+1; // FIXME!!! +1 is ok??? (no!?)
+    x[i].value = vec->dataF[i];
   }
+  x[i].index = -1;
+  x[i].value = 0.0;
 
   svm_apply_scale(scale,x);
 
@@ -508,9 +454,6 @@ int cLibsvmLiveSink::myTick(long long t)
         }
         printf("\n");
      */
-  long vi = vec->tmeta->vIdx;
-  double tm = vec->tmeta->smileTime;
-  double dur = vec->tmeta->lengthSec;
 
   if ( (predictProbability) && (svmType==C_SVC || svmType==NU_SVC) ) {
     v = svm_predict_probability(model,x,probEstimates);
@@ -548,11 +491,149 @@ int cLibsvmLiveSink::myTick(long long t)
   return 1;
 }
 
+// batch mode: classify batchSize frames (per thread) at once, the results are processed in the order of the frames
+int cLibsvmLiveSink::batchTick(long long t)
+{
+  long j;
+  if (batchX == NULL) {
+    // first batch: set up the input (and the dense model) from the first frame
+    cVector *vec = reader->getFrameRel(lag, 0, 1);
+    if (vec == NULL) return 0;
+    batchNft = prepareInput(vec);
+    if (!useDense) {
+      SMILE_IWRN(2,"batch classification needs the dense inference engine, classifying frame by frame");
+      batchSize = 1;
+      return myTick(t);
+    }
+    batchMax = (long)batchSize * nBatchThreads;
+    const sDmLevelConfig *c = reader->getLevelConfig();
+    if ((c != NULL)&&(c->isRb)&&(!c->growDyn)&&(batchMax > c->nT/2)) {
+      batchMax = MAX(1, c->nT/2);
+      SMILE_IWRN(2,"batch size (%i x %i threads) is too large for the input level buffer (%i frames), using batches of %i frames",batchSize,nBatchThreads,c->nT,batchMax);
+    }
+    batchX = (float *)calloc(1,sizeof(float)*batchMax*batchNft);
+    batchRes = (double *)calloc(1,sizeof(double)*batchMax);
+    if ((predictProbability)&&(nClasses>0)&&(svmType==C_SVC || svmType==NU_SVC))
+      batchProb = (double *)calloc(1,sizeof(double)*batchMax*nClasses);
+    batchVi = (long *)calloc(1,sizeof(long)*batchMax);
+    batchTm = (double *)calloc(1,sizeof(double)*batchMax*2);
+    batchDur = batchTm + batchMax;
+    if ((nBatchThreads > 1)&&(workers == NULL)) {
+      smileMutexCreate(workerMtx);
+      smileCondCreate(workerCondStart);
+      smileCondCreate(workerCondDone);
+      workers = (smileThread *)calloc(1,sizeof(smileThread)*(nBatchThreads-1));
+      for (nWorkersRunning=0; nWorkersRunning<nBatchThreads-1; nWorkersRunning++) {
+        if (!smileThreadCreate(workers[nWorkersRunning], workerThreadMain, this)) {
+          SMILE_IERR(1,"error creating batch thread #%i",nWorkersRunning);
+          break;
+        }
+      }
+    }
+  }
+
+  // wait for a full batch, except at the end of the input
+  long nAvail = reader->getNAvail();
+  if (nAvail <= 0) return 0;
+  if ((nAvail < batchMax)&&(!isEOI())) return 0;
+  long n = MIN(nAvail, batchMax);
+
+  for (j=0; j<n; j++) {
+    cVector *vec = reader->getFrameRel(lag);
+    if (vec == NULL) break;
+    gatherDense(vec, batchNft, batchX + j*batchNft, 1);
+    batchVi[j] = vec->tmeta->vIdx;
+    batchTm[j] = vec->tmeta->smileTime;
+    batchDur[j] = vec->tmeta->lengthSec;
+  }
+  batchN = j;
+  if (batchN == 0) return 0;
+
+  SMILE_DBG(4,"tick # %i, classifiy a batch of %i frames using LibSVM",t,batchN);
+  if (nWorkersRunning > 0) {
+    smileMutexLock(workerMtx);
+    nWorkersDone = 0;
+    workerGen++;
+    smileCondBroadcastRaw(workerCondStart);
+    smileMutexUnlock(workerMtx);
+    classifyBatchSlice(0);
+    smileMutexLock(workerMtx);
+    while (nWorkersDone < nWorkersRunning) smileCondWaitWMtx(workerCondDone, workerMtx);
+    smileMutexUnlock(workerMtx);
+  } else {
+    classifyBatchSlice(0);
+  }
+
+  for (j=0; j<batchN; j++) {
+    processResult(t, batchVi[j], batchTm[j], (float)batchRes[j], (batchProb != NULL) ? batchProb + j*nClasses : NULL, nClasses, batchDur[j]);
+  }
+  return 1;
+}
+
+// classify slice w of the current batch (one slice per thread)
+void cLibsvmLiveSink::classifyBatchSlice(int w)
+{
+  long nT = nWorkersRunning + 1;
+  long per = (batchN + nT - 1) / nT;
+  long j0 = w * per;
+  long n = MIN(per, batchN - j0);
+  if (n <= 0) return;
+  svm_dense_predict_batch(denseModel, batchX + j0*batchNft, (int)n, (int)batchNft, batchRes + j0,
+    (batchProb != NULL) ? batchProb + j0*nClasses : NULL);
+}
+
+SMILE_THREAD_RETVAL cLibsvmLiveSink::workerThreadMain(void *_obj)
+{
+  cLibsvmLiveSink *obj = (cLibsvmLiveSink *)_obj;
+  smileMutexLock(obj->workerMtx);
+  int w = ++obj->workerIdx;
+  long gen = 0;  // all workers are created before the first batch is started
+  smileMutexUnlock(obj->workerMtx);
+  while (1) {
+    smileMutexLock(obj->workerMtx);
+    while ((obj->workerGen == gen)&&(!obj->workerStop)) smileCondWaitWMtx(obj->workerCondStart, obj->workerMtx);
+    if (obj->workerStop) {
+      smileMutexUnlock(obj->workerMtx);
+      break;
+    }
+    gen = obj->workerGen;
+    smileMutexUnlock(obj->workerMtx);
+
+    obj->classifyBatchSlice(w);
+
+    smileMutexLock(obj->workerMtx);
+    obj->nWorkersDone++;
+    smileCondSignalRaw(obj->workerCondDone);
+    smileMutexUnlock(obj->workerMtx);
+  }
+  SMILE_THREAD_RET;
+}
+
 
 cLibsvmLiveSink::~cLibsvmLiveSink()
 {
-  svm_destroy_model(model);
+  if (workers != NULL) {
+    int i;
+    smileMutexLock(workerMtx);
+    workerStop = 1;
+    smileCondBroadcastRaw(workerCondStart);
+    smileMutexUnlock(workerMtx);
+    for (i=0; i<nWorkersRunning; i++) smileThreadJoin(workers[i]);
+    free(workers);
+    smileCondDestroy(workerCondStart);
+    smileCondDestroy(workerCondDone);
+    smileMutexDestroy(workerMtx);
+  }
+  if (batchX != NULL) free(batchX);
+  if (batchRes != NULL) free(batchRes);
+  if (batchProb != NULL) free(batchProb);
+  if (batchVi != NULL) free(batchVi);
+  if (batchTm != NULL) free(batchTm);
+  if (denseModel != NULL) svm_dense_destroy(denseModel);
+  if (denseX != NULL) free(denseX);
+  if (model != NULL) svm_destroy_model(model);
   svm_destroy_scale(scale);
+  svm_unmap_bundle(&bundle);
   if ((predictProbability)&&(probEstimates!=NULL)) free(probEstimates);
   if (labels != NULL) free(labels);
 
@@ -583,6 +664,10 @@ cLibsvmLiveSink::~cLibsvmLiveSink()
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#ifndef __WINDOWS
+#include <sys/types.h>
+#include <sys/mman.h>
+#endif
 
 #ifndef __WINDOWS
 #define max(x,y) (((x)>(y))?(x):(y))
@@ -708,6 +793,20 @@ void svm_destroy_scale(struct svm_scale *scale)
   }
 }
 
+void svm_scale_affine(struct svm_scale *scale, int dim, double *a, double *b)
+{
+  int i;
+  for (i=0; i<dim; i++) { a[i] = 1.0; b[i] = 0.0; }
+  if (scale == NULL) return;
+  for (i=0; (i<dim)&&(i+1<=scale->max_index); i++) {
+    int index = i+1;
+    /* skip single-valued attribute */
+    if (scale->feature_max[index] == scale->feature_min[index]) continue;
+    a[i] = (scale->upper - scale->lower) / (scale->feature_max[index] - scale->feature_min[index]);
+    b[i] = scale->lower - a[i] * scale->feature_min[index];
+  }
+}
+
 void svm_apply_scale(struct svm_scale *scale, struct svm_node * x)
 {
   int i=0;
@@ -747,3 +846,358 @@ void svm_apply_scale(struct svm_scale *scale, struct svm_node * x)
 
 /**************************************************************************/
 
+
+/**************************************************************************/
+/*********        LibSVM   addon:   class maps, feature selections,   ****/
+/*********                          and binary model bundles           ****/
+/**************************************************************************/
+
+#define MAX_LINE_LENGTH 1024
+
+long svm_load_classes(const char *file, char ***classNames)
+{
+  if ((file == NULL)||(classNames == NULL)) return 0;
+
+  FILE *f = fopen(file,"r");
+  if (f== NULL) {
+    SMILE_ERR(2,"error opening class map file '%s' for reading!",file);
+    return 0;
+  }
+
+  char line[MAX_LINE_LENGTH+1];
+  long nCls=0;
+  while(fgets(line,MAX_LINE_LENGTH,f) != NULL) {
+    if (strlen( line ) > 1) { 
+      line[strlen( line ) - 1] = 0;
+      if (strchr(line,':') != NULL) nCls++;
+    }
+  }
+  if (nCls == 0) { fclose(f); return 0; }
+
+  rewind(f);
+  long i=0;
+  char **names = (char**)calloc(1,sizeof(char*)*nCls);
+  while((i<nCls)&&(fgets(line,MAX_LINE_LENGTH,f) != NULL)) {
+    if (strlen( line ) > 1) { 
+      line[strlen( line ) - 1] = 0;
+      const char *cn = strchr(line,':');
+      if (cn!=NULL) {
+        names[i++] = strdup(cn+1);
+        // TODO: use class number instead of cont. index
+      }
+    }
+  }
+  fclose(f);
+  *classNames = names;
+  return nCls;
+}
+
+int svm_load_selection(const char *file, sOutputSelectionStr *selStr, sOutputSelectionIdx *selIdx)
+{
+  if (file == NULL) return 0;
+  if (strlen(file)<1) return 0;
+
+  FILE *f = fopen(file,"r");
+  if (f== NULL) {
+    SMILE_ERR(2,"error opening feature selection file '%s' for reading! NOT using a feature selection!",file);
+    return 0;
+  }
+    
+  // read first line to determine filetype:
+  char line[MAX_LINE_LENGTH+1];
+  fgets( line, 5, f);
+  line[3] = 0;
+  if (!strcmp(line,"str")) { // string list
+    long nStr=0;
+    SMILE_DBG(5,"reading string list of features");
+    if ((fscanf( f, "%ld\n", &nStr) != 1)||(nStr < 1)) {
+      SMILE_ERR(1,"error reading feature selection file '%s', nFeatures < 1!",file);
+      fclose(f);
+      return -1;
+    }
+    selStr->n = nStr;
+    selStr->names = (char **)calloc(1,sizeof(char *)*nStr);
+    long i=0; line[0] = 0;
+    while((i<nStr)&&(fgets(line,MAX_LINE_LENGTH,f) != NULL)) {
+      if (strlen( line ) > 1) { 
+        line[strlen( line ) - 1] = 0;
+        selStr->names[i++] = strdup(line);
+      }
+    }
+    fclose(f);
+    return 2;
+  } else if (!strcmp(line,"idx")) { // index list
+    long idx=0, i=0;
+    SMILE_DBG(5,"reading index list of features");
+    // pass1: parse for max index
+    selIdx->nFull = 0;
+    while(fscanf(f,"%ld\n",&idx) == 1)
+      selIdx->nFull = MAX(selIdx->nFull, idx);
+    selIdx->nFull++;
+    selIdx->enabled = (long *)calloc(1,sizeof(long)*selIdx->nFull);
+    rewind( f );
+    fgets(line, 5, f); // skip header line;
+    // pass2: enable the features
+    while(fscanf(f,"%ld\n",&idx) == 1) {
+      if (idx >= 0) { selIdx->enabled[idx] = 1; i++; }
+    }
+    selIdx->nSel = i;
+    fclose(f);
+    return 1;
+  }
+  SMILE_ERR(1,"bogus header in feature selection file '%s'! expected 'str' or 'idx' at beginning, found '%s'.",file,line);
+  fclose( f );
+  return -1;
+}
+
+// bundle file: header, LibSVM binary model, scale, feature index list, strings (class names, feature names)
+#define SVM_BUNDLE_MAGIC "SMILSVM"
+#define SVM_BUNDLE_VERSION 1
+#define SVM_BUNDLE_SCALE 1
+#define SVM_BUNDLE_YSCALING 2
+
+typedef struct {
+  char magic[8];
+  int version;
+  int flags;
+  int nCls;
+  int fselType;
+  int nSel;        // number of entries in the feature index list or the feature name list
+  int nFull;       // length of the unselected feature vector (index list)
+  int scaleMaxIndex;
+  int strBytes;    // size of the string table
+} sSvmBundleHeader;
+
+// writes len bytes of data and pads to a multiple of 8 bytes (keeps all arrays in the file aligned)
+static int svm_bundle_write(FILE *fp, const void *data, size_t len)
+{
+  static const char zero[8] = {0,0,0,0,0,0,0,0};
+  if ((len > 0)&&(fwrite(data, 1, len, fp) != len)) return 0;
+  size_t pad = (8 - len % 8) % 8;
+  if ((pad > 0)&&(fwrite(zero, 1, pad, fp) != pad)) return 0;
+  return 1;
+}
+
+static const char * svm_bundle_take(const sSvmBundle *b, long *pos, size_t n)
+{
+  size_t padded = (n + 7) / 8 * 8;
+  if ((size_t)(b->mapSize - *pos) < padded) return NULL;
+  const char *p = b->map + *pos;
+  *pos += (long)padded;
+  return p;
+}
+
+int svm_is_bundle(const char *file)
+{
+  char magic[8];
+  if (file == NULL) return 0;
+  FILE *f = fopen(file,"rb");
+  if (f == NULL) return 0;
+  int ret = ((fread(magic, 1, 8, f) == 8) && (memcmp(magic, SVM_BUNDLE_MAGIC, 8) == 0));
+  fclose(f);
+  return ret;
+}
+
+int svm_save_bundle(const char *file, const struct svm_model *model, const struct svm_scale *scale, long nCls, char **classNames, int fselType, const sOutputSelectionStr *selStr, const sOutputSelectionIdx *selIdx)
+{
+  long i;
+  sSvmBundleHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, SVM_BUNDLE_MAGIC, 8);
+  h.version = SVM_BUNDLE_VERSION;
+  if (scale != NULL) {
+    h.flags |= SVM_BUNDLE_SCALE;
+    if (scale->y_scaling) h.flags |= SVM_BUNDLE_YSCALING;
+    h.scaleMaxIndex = scale->max_index;
+  }
+  if (classNames != NULL) h.nCls = (int)nCls;
+  h.fselType = fselType;
+  if ((fselType == 1)&&(selIdx != NULL)&&(selIdx->enabled != NULL)) {
+    h.nFull = (int)selIdx->nFull;
+    for (i=0; i<selIdx->nFull; i++) if (selIdx->enabled[i]) h.nSel++;
+  } else if ((fselType == 2)&&(selStr != NULL)) {
+    h.nSel = (int)selStr->n;
+  } else {
+    h.fselType = 0;
+  }
+  for (i=0; i<h.nCls; i++) h.strBytes += (int)strlen(classNames[i]) + 1;
+  if (h.fselType == 2) {
+    for (i=0; i<h.nSel; i++) h.strBytes += (int)strlen(selStr->names[i]) + 1;
+  }
+
+  FILE *f = fopen(file,"wb");
+  if (f == NULL) {
+    SMILE_ERR(1,"can't open binary model file '%s' for writing",file);
+    return 0;
+  }
+  int ok = svm_bundle_write(f, &h, sizeof(h));
+  if (ok && (svm_save_model_binary(f, model) != 0)) {
+    SMILE_ERR(1,"can't write the LibSVM model to '%s' (precomputed kernels are not supported)",file);
+    ok = 0;
+  }
+  if (ok && (scale != NULL)) {
+    double r[6] = { scale->lower, scale->upper, scale->y_lower, scale->y_upper, scale->y_min, scale->y_max };
+    ok = svm_bundle_write(f, r, sizeof(r));
+    ok = ok && svm_bundle_write(f, scale->feature_min, sizeof(double)*(scale->max_index+1));
+    ok = ok && svm_bundle_write(f, scale->feature_max, sizeof(double)*(scale->max_index+1));
+  }
+  if (ok && (h.fselType == 1)) {
+    int *idx = (int *)calloc(1, sizeof(int)*(h.nSel+1));
+    int n = 0;
+    for (i=0; i<selIdx->nFull; i++) if (selIdx->enabled[i]) idx[n++] = (int)i;
+    ok = svm_bundle_write(f, idx, sizeof(int)*h.nSel);
+    free(idx);
+  }
+  if (ok && (h.strBytes > 0)) {
+    char *str = (char *)malloc(h.strBytes);
+    char *p = str;
+    for (i=0; i<h.nCls; i++) { strcpy(p, classNames[i]); p += strlen(p)+1; }
+    if (h.fselType == 2) {
+      for (i=0; i<h.nSel; i++) { strcpy(p, selStr->names[i]); p += strlen(p)+1; }
+    }
+    ok = svm_bundle_write(f, str, h.strBytes);
+    free(str);
+  }
+  if (fclose(f) != 0) ok = 0;
+  if (!ok) SMILE_ERR(1,"error writing binary model file '%s'",file);
+  return ok;
+}
+
+// map the bundle file into memory (or read it, if memory mapping is not supported)
+static int svm_map_bundle(const char *file, sSvmBundle *b)
+{
+  FILE *f = fopen(file,"rb");
+  if (f == NULL) return 0;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  rewind(f);
+  if (size <= (long)sizeof(sSvmBundleHeader)) { fclose(f); return 0; }
+#ifndef __WINDOWS
+  void *p = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+  if (p != MAP_FAILED) {
+    b->map = (char *)p;
+    b->mapSize = size;
+    b->mapped = 1;
+    fclose(f);
+    return 1;
+  }
+#endif
+  b->map = (char *)malloc(size);
+  if ((b->map == NULL)||(fread(b->map, 1, size, f) != (size_t)size)) {
+    if (b->map != NULL) { free(b->map); b->map = NULL; }
+    fclose(f);
+    return 0;
+  }
+  b->mapSize = size;
+  b->mapped = 0;
+  fclose(f);
+  return 1;
+}
+
+void svm_unmap_bundle(sSvmBundle *b)
+{
+  if ((b == NULL)||(b->map == NULL)) return;
+#ifndef __WINDOWS
+  if (b->mapped) munmap(b->map, (size_t)b->mapSize);
+  else
+#endif
+  free(b->map);
+  b->map = NULL;
+  b->mapSize = 0;
+}
+
+int svm_load_bundle(const char *file, sSvmBundle *b)
+{
+  long i;
+  memset(b, 0, sizeof(sSvmBundle));
+  if (!svm_map_bundle(file, b)) {
+    SMILE_ERR(1,"can't read binary model file '%s'",file);
+    return 0;
+  }
+
+  long pos = 0;
+  const sSvmBundleHeader *h = (const sSvmBundleHeader *)svm_bundle_take(b, &pos, sizeof(sSvmBundleHeader));
+  if ((h == NULL)||(memcmp(h->magic, SVM_BUNDLE_MAGIC, 8) != 0)||(h->version != SVM_BUNDLE_VERSION)) {
+    SMILE_ERR(1,"'%s' is not a binary model file of version %i (or it was written on a machine with a different byte order)",file,SVM_BUNDLE_VERSION);
+    svm_unmap_bundle(b);
+    return 0;
+  }
+
+  long used = 0;
+  b->model = svm_load_model_binary(b->map + pos, b->mapSize - pos, &used);
+  pos += used;
+  int ok = (b->model != NULL);
+
+  if (ok && (h->flags & SVM_BUNDLE_SCALE)) {
+    const double *r = (const double *)svm_bundle_take(b, &pos, sizeof(double)*6);
+    const double *fmin = (const double *)svm_bundle_take(b, &pos, sizeof(double)*(h->scaleMaxIndex+1));
+    const double *fmax = (const double *)svm_bundle_take(b, &pos, sizeof(double)*(h->scaleMaxIndex+1));
+    if ((r == NULL)||(fmin == NULL)||(fmax == NULL)||(h->scaleMaxIndex < 0)) {
+      ok = 0;
+    } else {
+      struct svm_scale *s = (struct svm_scale *) calloc(1, sizeof(struct svm_scale));
+      s->max_index = h->scaleMaxIndex;
+      s->y_scaling = ((h->flags & SVM_BUNDLE_YSCALING) != 0);
+      s->lower = r[0]; s->upper = r[1];
+      s->y_lower = r[2]; s->y_upper = r[3];
+      s->y_min = r[4]; s->y_max = r[5];
+      s->feature_min = (double *)malloc(sizeof(double)*(s->max_index+1));
+      s->feature_max = (double *)malloc(sizeof(double)*(s->max_index+1));
+      memcpy(s->feature_min, fmin, sizeof(double)*(s->max_index+1));
+      memcpy(s->feature_max, fmax, sizeof(double)*(s->max_index+1));
+      b->scale = s;
+    }
+  }
+
+  if (ok && (h->fselType == 1)) {
+    const int *idx = (const int *)svm_bundle_take(b, &pos, sizeof(int)*h->nSel);
+    if ((idx == NULL)||(h->nFull < 1)) {
+      ok = 0;
+    } else {
+      b->selIdx.nFull = h->nFull;
+      b->selIdx.nSel = h->nSel;
+      b->selIdx.enabled = (long *)calloc(1,sizeof(long)*h->nFull);
+      for (i=0; i<h->nSel; i++) {
+        if ((idx[i] >= 0)&&(idx[i] < h->nFull)) b->selIdx.enabled[idx[i]] = 1;
+      }
+      b->fselType = 1;
+    }
+  }
+
+  if (ok && (h->strBytes > 0)) {
+    const char *str = svm_bundle_take(b, &pos, h->strBytes);
+    if ((str == NULL)||(str[h->strBytes-1] != 0)) {
+      ok = 0;
+    } else {
+      const char *p = str, *end = str + h->strBytes;
+      if (h->nCls > 0) {
+        b->classNames = (char **)calloc(1,sizeof(char *)*h->nCls);
+        for (i=0; (i<h->nCls)&&(p<end); i++) { b->classNames[i] = strdup(p); p += strlen(p)+1; }
+        b->nCls = i;
+      }
+      if (h->fselType == 2) {
+        b->selStr.names = (char **)calloc(1,sizeof(char *)*h->nSel);
+        for (i=0; (i<h->nSel)&&(p<end); i++) { b->selStr.names[i] = strdup(p); p += strlen(p)+1; }
+        b->selStr.n = i;
+        b->fselType = 2;
+      }
+    }
+  }
+
+  if (!ok) {
+    SMILE_ERR(1,"binary model file '%s' is corrupt or truncated",file);
+    if (b->model != NULL) svm_destroy_model(b->model);
+    svm_destroy_scale(b->scale);
+    if (b->selIdx.enabled != NULL) free(b->selIdx.enabled);
+    for (i=0; i<b->nCls; i++) free(b->classNames[i]);
+    if (b->classNames != NULL) free(b->classNames);
+    for (i=0; i<b->selStr.n; i++) free(b->selStr.names[i]);
+    if (b->selStr.names != NULL) free(b->selStr.names);
+    svm_unmap_bundle(b);
+    memset(b, 0, sizeof(sSvmBundle));
+    return 0;
+  }
+  return 1;
+}
+
+/**************************************************************************/
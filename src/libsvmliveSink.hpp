@@ -67,6 +67,8 @@ struct svm_scale {
 struct svm_scale * svm_load_scale(const char* restore_filename);
 void svm_destroy_scale(struct svm_scale *scale);
 void svm_apply_scale(struct svm_scale *scale, struct svm_node * x);
+// get the scaling of features 1..dim as x' = a[i]*x + b[i] (for svm_dense_create)
+void svm_scale_affine(struct svm_scale *scale, int dim, double *a, double *b);
 
 /**************************************************************************/
 
@@ -83,6 +85,37 @@ typedef struct{
 } sOutputSelectionIdx;  
 typedef sOutputSelectionIdx *pOutputSelectionIdx;
 
+/**************************************************************************/
+/*********        LibSVM   addon:   class maps, feature selections,   ****/
+/*********                          and binary model bundles           ****/
+/**************************************************************************/
+
+// load a class name lookup file ('number:name' per line), returns the number of class names (0 on error)
+long svm_load_classes(const char *file, char ***classNames);
+// load a feature selection file ('str' or 'idx' list), returns the selection type (1=idx, 2=str, 0=no selection, -1=bogus file)
+int svm_load_selection(const char *file, sOutputSelectionStr *selStr, sOutputSelectionIdx *selIdx);
+
+/* A binary model bundle holds a LibSVM model (SVs as dense float rows), the scale ranges, the class names, and
+   the feature selection in one file. It is memory mapped for loading, the SVs are used directly from the mapping. */
+typedef struct {
+  char *map;       // file data (mapped or read)
+  long mapSize;
+  int mapped;      // 1: map is a memory mapping, 0: map was allocated
+  struct svm_model *model;
+  struct svm_scale *scale;
+  long nCls;
+  char **classNames;
+  int fselType;
+  sOutputSelectionStr selStr;
+  sOutputSelectionIdx selIdx;
+} sSvmBundle;
+
+int svm_is_bundle(const char *file);
+int svm_save_bundle(const char *file, const struct svm_model *model, const struct svm_scale *scale, long nCls, char **classNames, int fselType, const sOutputSelectionStr *selStr, const sOutputSelectionIdx *selIdx);
+// load a bundle into b, model, scale, class names and selection are then owned by the caller, the file data must be freed with svm_unmap_bundle after the model has been destroyed
+int svm_load_bundle(const char *file, sSvmBundle *b);
+void svm_unmap_bundle(sSvmBundle *b);
+
 class cLibsvmLiveSink : public cDataSink {
   private:
     int sendResult;
@@ -93,6 +126,24 @@ class cLibsvmLiveSink : public cDataSink {
     const char *modelfile, *scalefile;
     struct svm_model* model;
     struct svm_scale* scale;
+    int useDense;
+    struct svm_dense_model* denseModel;
+    float *denseX;  // input vector for the dense model (after feature selection)
+    sSvmBundle bundle;  // file data of a binary model
+
+    // batch mode
+    int batchSize, nBatchThreads;
+    long batchMax, batchN, batchNft;
+    float *batchX;      // batchMax x batchNft inputs
+    double *batchRes, *batchProb;
+    long *batchVi;
+    double *batchTm, *batchDur;
+    // batch worker threads, the tick thread is worker 0
+    smileThread *workers;
+    int nWorkersRunning, workerStop, nWorkersDone, workerIdx;
+    long workerGen;
+    smileMutex workerMtx;
+    smileCond workerCondStart, workerCondDone;
     int nClasses, svmType;
     double *probEstimates;
 //    char *labels;
@@ -106,8 +157,13 @@ class cLibsvmLiveSink : public cDataSink {
     sOutputSelectionIdx outputSelIdx;
 
     int loadSelection( const char *selFile );
-    int buildEnabledSelFromNames(long N, const FrameMetaInfo *fmeta);
+    int resolveSelection();
     int loadClasses( const char *file );
+    long prepareInput(cVector *vec);
+    const float * gatherDense(cVector *vec, long Nft, float *dst, int copy);
+    int batchTick(long long t);
+    void classifyBatchSlice(int w);
+    static SMILE_THREAD_RETVAL workerThreadMain(void *_obj);
 
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
@@ -74,8 +74,9 @@ SMILECOMPONENT_CREATE(cMfcc)
 
 cMfcc::cMfcc(const char *_name) :
   cVectorProcessor(_name),
-  costable(NULL),
+  dctPlan(NULL),
   sintable(NULL),
+  logmel(NULL), cep(NULL), logmelN(0),
   firstMfcc(1),
   lastMfcc(12),
   htkcompatible(0)
@@ -133,7 +134,7 @@ int cMfcc::dataProcessorCustomFinalise()
 
   // allocate for multiple configurations..
   if (sintable == NULL) sintable = (FLOAT_DMEM**)multiConfAlloc();
-  if (costable == NULL) costable = (FLOAT_DMEM**)multiConfAlloc();
+  if (dctPlan == NULL) dctPlan = (sSmileDspDct**)multiConfAlloc();
 
   return cVectorProcessor::dataProcessorCustomFinalise();
 }
@@ -167,20 +168,15 @@ int cMfcc::setupNamesForField(int i, const char*name, long nEl)
 // blocksize is size of mspec block (=nBands)
 int cMfcc::initTables( long blocksize, int idxc )
 {
-  int i,m;
-  FLOAT_DMEM *_costable = costable[idxc];
+  int i;
   FLOAT_DMEM *_sintable = sintable[idxc];
-  
-  if (_costable != NULL) free(_costable);
-  _costable = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*blocksize*nMfcc);
-  if (_costable == NULL) OUT_OF_MEMORY;
 
-  double fnM = (double)(blocksize);
-  for (i=firstMfcc; i <= lastMfcc; i++) {
-    double fi = (double)i;
-    for (m=0; m<blocksize; m++) {
-      _costable[m+(i-firstMfcc)*blocksize] = (FLOAT_DMEM)cos((double)M_PI*(fi/fnM) * ( (double)(m) + (double)0.5) );
-    }
+  // DCT-II of the log mel spectrum, coefficients firstMfcc..lastMfcc
+  if (dctPlan[idxc] != NULL) smileDsp_dctFree(dctPlan[idxc]);
+  dctPlan[idxc] = smileDsp_dctCreate(blocksize, firstMfcc, nMfcc, DCT_AUTO);
+  if (dctPlan[idxc] == NULL) {
+    SMILE_IERR(1,"failed to create DCT for %i mel bands (firstMfcc=%i, lastMfcc=%i)",blocksize,firstMfcc,lastMfcc);
+    return 0;
   }
 
   if (_sintable != NULL) free(_sintable);
@@ -196,8 +192,7 @@ int cMfcc::initTables( long blocksize, int idxc )
       _sintable[i-firstMfcc] = 1.0;
     }
   }
-  
-  costable[idxc] = _costable;
+
   sintable[idxc] = _sintable;
   
   return 1;
@@ -227,22 +222,32 @@ int cMfcc::processVectorInt(const INT_DMEM *src, INT_DMEM *dst, long Nsrc, long
 // a derived class should override this method, in order to implement the actual processing
 int cMfcc::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
 {
-  int i,m;
+  int i;
   idxi = getFconf(idxi);
-  FLOAT_DMEM *_costable = costable[idxi];
+  sSmileDspDct *_dct = dctPlan[idxi];
   FLOAT_DMEM *_sintable = sintable[idxi];
+  if (_dct == NULL) return 0;
 
-  FLOAT_DMEM *_src;
-  _src = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*Nsrc);
-  if (_src==NULL) OUT_OF_MEMORY;
+  // work buffers are kept across frames
+  if (Nsrc > logmelN) {
+    logmel = (FLOAT_DMEM*)realloc(logmel, sizeof(FLOAT_DMEM)*Nsrc);
+    if (logmel==NULL) OUT_OF_MEMORY;
+    logmelN = Nsrc;
+  }
+  if (cep == NULL) {
+    cep = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*nMfcc);
+    if (cep==NULL) OUT_OF_MEMORY;
+  }
   
   // compute log mel spectrum
+  FLOAT_DMEM logfloor = (FLOAT_DMEM)log(melfloor);
   for (i=0; i<Nsrc; i++) {
-    if (src[i] < melfloor) _src[i] = log(melfloor);
-    else _src[i] = (FLOAT_DMEM)log(src[i]);
+    if (src[i] < melfloor) logmel[i] = logfloor;
+    else logmel[i] = (FLOAT_DMEM)log(src[i]);
   }
 
   // compute dct of mel data & do cepstral liftering:
+  smileDsp_dct(_dct, logmel, cep);
   FLOAT_DMEM factor = (FLOAT_DMEM)sqrt((double)2.0/(double)(Nsrc));
   for (i=firstMfcc; i <= lastMfcc; i++) {
     int i0 = i-firstMfcc;
@@ -251,23 +256,23 @@ int cMfcc::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
       if (i==lastMfcc) { i0 = 0; }
       else { i0 += 1; }
     }
-    *outc = 0.0;
-    for (m=0; m<Nsrc; m++) {
-      *outc += _src[m] * _costable[m + i0*Nsrc];
-    }
-    //*outc *= factor;   // use this line, if you want unliftered mfcc
+    //*outc = cep[i0] * factor;   // use this line, if you want unliftered mfcc
     // do cepstral liftering:
-    *outc *= _sintable[i0] * factor;
+    *outc = cep[i0] * _sintable[i0] * factor;
   }
 
-  free(_src);
-  
   return 1;
 }
 
 cMfcc::~cMfcc()
 {
-  multiConfFree(costable);
+  int i;
+  if (dctPlan != NULL) {
+    for (i=0; i<getNf(); i++) smileDsp_dctFree(dctPlan[i]);
+    free(dctPlan);
+  }
   multiConfFree(sintable);
+  if (logmel != NULL) free(logmel);
+  if (cep != NULL) free(cep);
 }
 
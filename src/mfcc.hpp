@@ -51,8 +51,10 @@ computes MFCC from Mel-spectrum (see cMelspec)
 class cMfcc : public cVectorProcessor {
   private:
     int nBands, htkcompatible, usePower;
-    FLOAT_DMEM **costable;
+    sSmileDspDct **dctPlan;
     FLOAT_DMEM **sintable;
+    FLOAT_DMEM *logmel, *cep;
+    long logmelN;
     int firstMfcc, lastMfcc, nMfcc;
     FLOAT_DMEM melfloor;
     FLOAT_DMEM cepLifter;
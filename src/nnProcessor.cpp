@@ -0,0 +1,138 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component:
+
+neural network (MLP / LSTM) processor: runs a network (smileNn) on every input frame
+and writes the network outputs (e.g. class posteriors) to the output level
+
+*/
+
+
+#include <nnProcessor.hpp>
+
+#define MODULE "cNnProcessor"
+
+SMILECOMPONENT_STATICS(cNnProcessor)
+
+SMILECOMPONENT_REGCOMP(cNnProcessor)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  
+  scname = COMPONENT_NAME_CNNPROCESSOR;
+  sdescription = COMPONENT_DESCRIPTION_CNNPROCESSOR;
+
+  // we inherit cVectorProcessor configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cVectorProcessor")
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->makeMandatory(ct->setField("net","network file to load (smileNn binary format, or text format, see smileNn.h)","nn.net"));
+    ct->setField("int8","1 = quantise the weights to int8 after loading (one scale per matrix row; 4x less memory for the weights, slightly less accurate)",0);
+    ct->setField("outputName","name of the output array field","nnOut");
+    ct->setField("processArrayFields",NULL,0);
+  )
+  SMILECOMPONENT_MAKEINFO(cNnProcessor);
+}
+
+SMILECOMPONENT_CREATE(cNnProcessor)
+
+//-----
+
+cNnProcessor::cNnProcessor(const char *_name) :
+  cVectorProcessor(_name),
+  netfile(NULL), outputName(NULL), int8(0),
+  net(NULL)
+{
+
+}
+
+void cNnProcessor::fetchConfig()
+{
+  cVectorProcessor::fetchConfig();
+  
+  netfile = getStr("net");
+  SMILE_IDBG(2,"net = '%s'",netfile);
+  int8 = getInt("int8");
+  SMILE_IDBG(2,"int8 = %i",int8);
+  outputName = getStr("outputName");
+  SMILE_IDBG(2,"outputName = '%s'",outputName);
+}
+
+int cNnProcessor::myConfigureInstance()
+{
+  // the network must be loaded before the output names are set up
+  if (net == NULL) {
+    char err[256];
+    net = smileNn_load(netfile, err, sizeof(err));
+    if (net == NULL) {
+      COMP_ERR("can't load network file '%s': %s",netfile,err);
+    }
+    if (int8) smileNn_quantise(net);
+    SMILE_IMSG(3,"loaded network '%s': %i layers, %i inputs, %i outputs, %i int8 matrices",netfile,net->nLayers,net->inputDim,net->outputDim,net->quantised);
+  }
+  return cVectorProcessor::myConfigureInstance();
+}
+
+int cNnProcessor::setupNewNames(long nEl)
+{
+  if (nEl != net->inputDim) {
+    COMP_ERR("the input level has %i elements, the network '%s' expects %i inputs",nEl,netfile,net->inputDim);
+  }
+  if ((nameAppend != NULL)&&(strlen(nameAppend)>0)) {
+    addNameAppendField(outputName,nameAppend,net->outputDim);
+  } else {
+    writer->addField(outputName,net->outputDim);
+  }
+  namesAreSet = 1;
+  return net->outputDim;
+}
+
+int cNnProcessor::processVectorInt(const INT_DMEM *src, INT_DMEM *dst, long Nsrc, long Ndst, int idxi)
+{
+  // not implemented
+  return 0;
+}
+
+int cNnProcessor::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi)
+{
+  const float *y = smileNn_forward(net, src);
+  long i;
+  for (i=0; i<Ndst; i++) dst[i] = (FLOAT_DMEM)y[i];
+  return 1;
+}
+
+cNnProcessor::~cNnProcessor()
+{
+  smileNn_free(net);
+}
+
@@ -0,0 +1,202 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component:
+
+neural network (MLP / LSTM) classifier sink: runs a network (smileNn) on every input frame,
+prints the winning class and/or sends it in a 'classificationResult' message
+
+*/
+
+
+#include <nnSink.hpp>
+#include <libsvmliveSink.hpp>  // svm_load_classes
+
+#define MODULE "cNnSink"
+
+
+SMILECOMPONENT_STATICS(cNnSink)
+
+SMILECOMPONENT_REGCOMP(cNnSink)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CNNSINK;
+  sdescription = COMPONENT_DESCRIPTION_CNNSINK;
+
+  // we inherit cDataSink configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cDataSink")
+
+  SMILECOMPONENT_IFNOTREGAGAIN_BEGIN
+    ct->makeMandatory(ct->setField("net","network file to load (smileNn binary format, or text format, see smileNn.h)","nn.net"));
+    ct->setField("int8","1 = quantise the weights to int8 after loading (one scale per matrix row; 4x less memory for the weights, slightly less accurate)",0);
+    ct->setField("classes","class name lookup file ('index:name' per line, the index of the network output), leave empty to display the output indicies",(const char*)NULL);
+    ct->setField("printResult","print the classification result to console (0 = no, 1 = winning class, 2 = winning class and all network outputs)",0);
+    ct->setField("resultRecp","component(s) to send 'classificationResult' messages to (use , to separate multiple recepients), leave blank (NULL) to not send any messages",(const char *) NULL);
+    ct->setField("resultMessageName","custom name that is sent with 'classificationResult' message","nn_result");
+    ct->setField("lag","classify the frame <lag> frames behind the current frame",0);
+  SMILECOMPONENT_IFNOTREGAGAIN_END
+
+  SMILECOMPONENT_MAKEINFO(cNnSink);
+}
+
+SMILECOMPONENT_CREATE(cNnSink)
+
+//-----
+
+cNnSink::cNnSink(const char *_name) :
+  cDataSink(_name),
+  netfile(NULL), classes(NULL), resultRecp(NULL), resultMessageName(NULL),
+  int8(0), lag(0), printResult(0),
+  net(NULL), outputs(NULL),
+  nCls(0), classNames(NULL)
+{
+}
+
+void cNnSink::fetchConfig()
+{
+  cDataSink::fetchConfig();
+  
+  netfile = getStr("net");
+  SMILE_IDBG(2,"net = '%s'",netfile);
+  int8 = getInt("int8");
+  SMILE_IDBG(2,"int8 = %i",int8);
+  classes = getStr("classes");
+  if (classes != NULL) SMILE_IDBG(2,"filename of class mapping to load = '%s'",classes);
+  printResult = getInt("printResult");
+  SMILE_IDBG(2,"printResult = %i",printResult);
+  resultRecp = getStr("resultRecp");
+  SMILE_IDBG(2,"resultRecp = '%s'",resultRecp);
+  resultMessageName = getStr("resultMessageName");
+  SMILE_IDBG(2,"resultMessageName = '%s'",resultMessageName);
+  lag = getInt("lag");
+  if (lag != 0) SMILE_IDBG(2,"lag = %i frames",lag);
+}
+
+int cNnSink::myFinaliseInstance()
+{
+  int ret = cDataSink::myFinaliseInstance();
+  if (ret==0) return 0;
+
+  char err[256];
+  SMILE_MSG(2,"loading network for instance '%s' ...",getInstName()); 
+  net = smileNn_load(netfile, err, sizeof(err));
+  if (net == NULL) {
+    COMP_ERR("can't load network file '%s': %s",netfile,err);
+  }
+  if (int8) smileNn_quantise(net);
+  SMILE_IMSG(3,"loaded network '%s': %i layers, %i inputs, %i outputs, %i int8 matrices",netfile,net->nLayers,net->inputDim,net->outputDim,net->quantised);
+  if (reader->getLevelN() != net->inputDim) {
+    COMP_ERR("the input level has %i elements, the network '%s' expects %i inputs",reader->getLevelN(),netfile,net->inputDim);
+  }
+  outputs = (double *)calloc(1,sizeof(double)*net->outputDim);
+
+  if ((classes != NULL)&&(strlen(classes)>0)) {
+    nCls = svm_load_classes(classes, &classNames);
+    if (nCls <= 0) SMILE_IERR(2,"NOT using a class map (class map file '%s')!",classes);
+  }
+  return ret;
+}
+
+void cNnSink::processResult(double time, double dur, int winner, const double *out, int nOut)
+{
+  const char *name = NULL;
+  if ((nOut > 1)&&(winner < nCls)) name = classNames[winner];
+
+  if (printResult) {
+    if (nOut == 1) {
+      SMILE_PRINT("\n NN  '%s' result (@ time: %f) :  ~~> %.4f <~~",getInstName(),time,out[0]);
+    } else if (name != NULL) {
+      SMILE_PRINT("\n NN  '%s' result (@ time: %f) :  ~~> %s <~~",getInstName(),time,name);
+    } else {
+      SMILE_PRINT("\n NN  '%s' result (@ time: %f) :  ~~> %i <~~",getInstName(),time,winner);
+    }
+    if ((printResult > 1)&&(nOut > 1)) {
+      int i;
+      for (i=0; i<nOut; i++) {
+        if (i < nCls) SMILE_PRINT("     output '%s': \t %f",classNames[i],out[i]);
+        else SMILE_PRINT("     output %i : \t %f",i,out[i]);
+      }
+    }
+  }
+
+  // send result as componentMessage 
+  if (resultRecp != NULL) {
+    cComponentMessage msg("classificationResult", resultMessageName);
+    if (name != NULL) {
+      strncpy(msg.msgtext, name, CMSG_textLen-1);
+      msg.msgtext[CMSG_textLen-1] = 0;
+    }
+    msg.floatData[0] = (nOut == 1) ? out[0] : (double)winner;
+    msg.intData[0]   = nOut;
+    msg.custData     = (void *)out;
+    msg.userTime1    = time;
+    msg.userTime2    = time+dur;
+    sendComponentMessage( resultRecp, &msg );
+    SMILE_IDBG(3,"sending 'classificationResult' message to '%s'",resultRecp);
+  }
+}
+
+int cNnSink::myTick(long long t)
+{
+  if (net == NULL) return 0;
+
+  SMILE_DBG(4,"tick # %i, classifiy value vector using the network (lag=%i):",t,lag);
+  cVector *vec= reader->getFrameRel(lag);
+  if (vec == NULL) return 0;
+
+  const float *y = smileNn_forward(net, vec->dataF);
+  int i, winner = 0;
+  for (i=0; i<net->outputDim; i++) {
+    outputs[i] = y[i];
+    if (y[i] > y[winner]) winner = i;
+  }
+  processResult(vec->tmeta->smileTime, vec->tmeta->lengthSec, winner, outputs, net->outputDim);
+
+  // tick success
+  return 1;
+}
+
+cNnSink::~cNnSink()
+{
+  smileNn_free(net);
+  if (outputs != NULL) free(outputs);
+  if (classNames != NULL) {
+    int n;
+    for (n=0; n<nCls; n++) {
+      if (classNames[n] != NULL) free(classNames[n]);
+    }
+    free(classNames);
+  }
+}
+
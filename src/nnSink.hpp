@@ -0,0 +1,89 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ ******************************************************************************E*/
+
+
+/*  openSMILE component:
+
+neural network (MLP / LSTM) classifier sink: runs a network (smileNn) on every input frame,
+prints the winning class and/or sends it in a 'classificationResult' message
+
+*/
+
+
+#ifndef __CNNSINK_HPP
+#define __CNNSINK_HPP
+
+#include <smileCommon.hpp>
+#include <smileComponent.hpp>
+#include <dataSink.hpp>
+#include <smileNn.h>
+
+#define COMPONENT_DESCRIPTION_CNNSINK "classifies the frames from dataMemory with a feed-forward or LSTM neural network (smileNn binary or text format), the winning output (or the value of a single output) is printed and/or sent as 'classificationResult' message"
+#define COMPONENT_NAME_CNNSINK "cNnSink"
+
+class cNnSink : public cDataSink {
+  private:
+    const char *netfile;
+    const char *classes;
+    const char *resultRecp;
+    const char *resultMessageName;
+    int int8;
+    int lag;
+    int printResult;
+    sSmileNn *net;
+    double *outputs;    // network outputs of the current frame (custData of the result message)
+    long nCls;
+    char **classNames;
+
+    void processResult(double time, double dur, int winner, const double *out, int nOut);
+
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+
+    virtual void fetchConfig();
+    //virtual int myConfigureInstance();
+    virtual int myFinaliseInstance();
+    virtual int myTick(long long t);
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+
+    cNnSink(const char *_name);
+
+    virtual ~cNnSink();
+};
+
+
+
+
+#endif // __CNNSINK_HPP
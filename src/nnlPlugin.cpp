@@ -78,6 +78,7 @@ nnlPlugin::nnlPlugin(const char *_name) :
 {
 	means = NULL;
 	stddevs = NULL;
+	standardizedInputs = NULL;
 }
 
 void nnlPlugin::fetchConfig()
@@ -114,7 +115,7 @@ int nnlPlugin::myFinaliseInstance()
 
   if (ret) {
     controller = new NetController();
-    char* ddFile = new char[sizeof(dataDimensionsFile)];
+    char* ddFile = new char[strlen(dataDimensionsFile)+1];
     strcpy(ddFile,dataDimensionsFile);
     ((NetController*)controller)->init(netconfigFile,ddFile);
   }
@@ -131,12 +132,13 @@ int nnlPlugin::myTick(long long t){
 	  return 0;
 	//else reader->nextFrame();
 
-	float* standardizedInputs = new float[vec->N];
+	const float* inputs = vec->dataF;
 
 	std::string standardizeFileName(standardizeFile);
 	if (!standardizeFileName.empty()){
 		if (means==NULL){
 			initStandardizationValues(vec->N);
+			standardizedInputs = new float[vec->N];
 		}
 
 		//the input dimensions are not known at the time of the plugin initialization
@@ -144,11 +146,10 @@ int nnlPlugin::myTick(long long t){
 		for (int i=0; i<vec->N; i++){
 			standardizedInputs[i] = (vec->dataF[i] - means[i])/stddevs[i];
 		}
-	}else{
-		standardizedInputs = vec->dataF;
+		inputs = standardizedInputs;
 	}
 
-	string result = ((NetController*)controller)->recognize(standardizedInputs);
+	string result = ((NetController*)controller)->recognize((float*)inputs);
 	if (!result.empty()){
 		cout << result << " ";
         cout.flush();
@@ -172,6 +173,9 @@ void nnlPlugin::initStandardizationValues(long dim)
 }
 
 nnlPlugin::~nnlPlugin(){
+	if (standardizedInputs != NULL) delete[] standardizedInputs;
+	if (means != NULL) delete[] means;
+	if (stddevs != NULL) delete[] stddevs;
 }
 
 #endif //HAVE_RTNNLLIB
@@ -69,6 +69,7 @@ class nnlPlugin : public cDataSink {
 
 	double* means;
 	double* stddevs;
+	float* standardizedInputs;
 
 	void initStandardizationValues(long dim);
 
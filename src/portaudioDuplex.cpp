@@ -315,55 +315,14 @@ cPortaudioDuplex::~cPortaudioDuplex()
 // channels = number of output channels (can be 1 or 2)
 int matrixToPcmDataFloat_d(void *outputBuffer, long __N, cMatrix *_mat, int channels, int mixdown=0) 
 {
-  int i,c,n;
-
-  float *out = (float*)outputBuffer;
-
-  for (i=0; i<MIN(_mat->nT,__N); i++) {
-    if (mixdown) {
-      out[i*channels] = 0.0;
-      for (c=0; c<channels; c++) {
-        for (n=0; n<_mat->N; n++) 
-          out[i*channels+c] += (float)(_mat->dataF)[i*(_mat->N)+n];
-      }
-    } else {
-      int minc = channels;
-      if (_mat->N < minc) minc = _mat->N;
-      for (c=0; c<channels; c++) {
-        out[i*channels+c] = (float)(_mat->dataF)[i*(_mat->N)+c];
-      }
-    }
-  }
+  smilePcm_remapChannels(_mat->dataF, _mat->N, (float*)outputBuffer, channels, MIN(_mat->nT,__N), mixdown);
   return 1;
 }
 
 // channels = number of output channels (can be 1 or 2)
 int pcmDataFloatToMatrix_d(const void *inputBuffer, long __N, cMatrix *_mat, int channels, int mixdown=0) 
 {
-  int i,c,n;
-
-  const float *in = (const float*)inputBuffer;
-  FLOAT_DMEM *out = _mat->dataF;
-
-  for (i=0; i<MIN(_mat->nT,__N); i++) {
-    if (mixdown) {
-      out[i*_mat->N] = (FLOAT_DMEM)0.0;
-      for (c=0; c<channels; c++) {
-        for (n=0; n<_mat->N; n++) 
-          out[i*_mat->N+n] += (FLOAT_DMEM)(in[i*channels+c]);
-      }
-    } else {
-      int minc = channels;
-      if (_mat->N < minc) minc = _mat->N;
-      for (c=0; c<channels; c++) {
-        if (c>minc) {
-          out[i*_mat->N+c] = (FLOAT_DMEM)(0.0);
-        } else {
-          out[i*_mat->N+c] = (float)(in[i*channels+c]);
-        }
-      }
-    }
-  }
+  smilePcm_remapChannels((const float*)inputBuffer, channels, _mat->dataF, _mat->N, MIN(_mat->nT,__N), mixdown);
   return 1;
 }
 
@@ -274,25 +274,7 @@ cPortaudioSink::~cPortaudioSink()
 // channels = number of output channels (can be 1 or 2)
 int matrixToPcmDataFloat(void *outputBuffer, long __N, cMatrix *_mat, int channels, int mixdown=0) 
 {
-  int i,c,n;
-
-  float *out = (float*)outputBuffer;
-  
-  for (i=0; i<MIN(_mat->nT,__N); i++) {
-	if (mixdown) {
-      out[i*channels] = 0.0;
-      for (c=0; c<channels; c++) {
-	    for (n=0; n<_mat->N; n++) 
-          out[i*channels+c] += (float)(_mat->dataF)[i*(_mat->N)+n];
-      }
-	} else {
-	  int minc = channels;
-	  if (_mat->N < minc) minc = _mat->N;
-      for (c=0; c<channels; c++) {
-        out[i*channels+c] = (float)(_mat->dataF)[i*(_mat->N)+c];
-	  }
-	}
-  }
+  smilePcm_remapChannels(_mat->dataF, _mat->N, (float*)outputBuffer, channels, MIN(_mat->nT,__N), mixdown);
   return 1;
 }
 
@@ -0,0 +1,406 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  cShardRunner
+
+sharded processing of one long input, see shardRunner.hpp
+
+*/
+
+
+#include <shardRunner.hpp>
+#include <dataMemory.hpp>
+#include <waveSource.hpp>
+
+#ifndef __WINDOWS
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#define MODULE "cShardRunner"
+
+// component types with whole-input or unbounded internal state, frames near a shard boundary would differ from a serial run
+static const char *shardUnsafeTypes[] = {
+  "cFullinputMean", "cVecGlMean", "cVectorMVStd", "cTurnDetector", "cTonefilt",
+  "cEchoCanceller", "cEchoAttenuator", "cSpeexPreprocess", "cSpeexResample",
+  "cVolanalyse", "cFingerprint", NULL
+};
+
+static long gcd(long a, long b)
+{
+  while (b != 0) { long t = a%b; a = b; b = t; }
+  return a;
+}
+
+
+cShardRunner::cShardRunner(cConfigManager *_confman, cComponentManager *_cman, int _nShards) :
+  confman(_confman), cman(_cman), nShards(_nShards),
+  waveInst(NULL), waveName(NULL),
+  nSinks(0), sinkInst(NULL), sinkFile(NULL), sinkType(NULL)
+{
+}
+
+int cShardRunner::checkGraph()
+{
+  int N=0, i, j;
+  char *tmp = myvprint("%s.instance",CM_CONF_INST);
+  char **insts = confman->getArrayKeys(tmp,&N);
+  if (tmp!=NULL) free(tmp);
+  if ((insts==NULL)||(N<=0)) return 0;
+
+  sinkInst = (const char **)calloc(1,sizeof(const char*)*N);
+  sinkFile = (char **)calloc(1,sizeof(char*)*N);
+  sinkType = (int *)calloc(1,sizeof(int)*N);
+
+  for (i=0; i<N; i++) {
+    const char *k = insts[i];
+    if (k==NULL) continue;
+    const char *tp = confman->getStr_f(myvprint("%s.instance[%s].type",CM_CONF_INST,k));
+    const char *ci = confman->getStr_f(myvprint("%s.instance[%s].configInstance",CM_CONF_INST,k));
+    if (tp == NULL) return 0;
+    if (ci == NULL) ci = k;
+
+    for (j=0; shardUnsafeTypes[j]!=NULL; j++) {
+      if (!strcmp(tp,shardUnsafeTypes[j])) {
+        SMILE_MSG(2,"component '%s' (%s) processes the full input or has unbounded state, cannot split the input into shards",k,tp);
+        return 0;
+      }
+    }
+
+    if (!strcmp(tp,"cWaveSource")) {
+      if (waveInst != NULL) {
+        SMILE_MSG(2,"more than one cWaveSource in the configuration, cannot split the input into shards");
+        return 0;
+      }
+      waveInst = ci; waveName = k;
+    } else if ((!strcmp(tp,"cCsvSink"))||(!strcmp(tp,"cArffSink"))||(!strcmp(tp,"cHtkSink"))) {
+      ConfigInstance *inst = confman->getInstance(ci);
+      if ((inst == NULL)||(inst->getStr("filename") == NULL)) return 0;
+      if ((!strcmp(tp,"cHtkSink"))&&(inst->getInt("compress"))) {
+        SMILE_MSG(2,"compressed output of component '%s' (%s) cannot be joined from shards",k,tp);
+        return 0;
+      }
+      sinkInst[nSinks] = ci;
+      sinkFile[nSinks] = strdup(inst->getStr("filename"));
+      if (!strcmp(tp,"cCsvSink")) sinkType[nSinks] = SHARD_SINK_CSV;
+      else if (!strcmp(tp,"cArffSink")) sinkType[nSinks] = SHARD_SINK_ARFF;
+      else sinkType[nSinks] = SHARD_SINK_HTK;
+      nSinks++;
+    } else if ((strstr(tp,"Source")!=NULL)||(strstr(tp,"Sink")!=NULL)||(strstr(tp,"Duplex")!=NULL)||(strstr(tp,"Sender")!=NULL)) {
+      SMILE_MSG(2,"component '%s' (%s) does not support sharded processing (only cWaveSource input and cCsvSink, cArffSink, cHtkSink output)",k,tp);
+      return 0;
+    }
+  }
+
+  if (waveInst == NULL) {
+    SMILE_MSG(2,"no cWaveSource in the configuration, cannot split the input into shards");
+    return 0;
+  }
+  for (i=0; i<nSinks; i++) {
+    for (j=0; j<i; j++) {
+      if (!strcmp(sinkFile[i],sinkFile[j])) {
+        SMILE_MSG(2,"sinks '%s' and '%s' write to the same file, cannot split the input into shards",sinkInst[j],sinkInst[i]);
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+char * cShardRunner::shardFilename(int sink, int k)
+{
+  return myvprint("%s.shard%i",sinkFile[sink],k);
+}
+
+void cShardRunner::setSinks(int k, int probeOnly)
+{
+  int i;
+  for (i=0; i<nSinks; i++) {
+    ConfigInstance *inst = confman->getInstance(sinkInst[i]);
+    if (probeOnly) {
+      inst->setStr("filename","/dev/null");
+      inst->setInt("append",0);
+    } else if (k > 0) {
+      // shards > 0 write the data only to a temporary file, which is appended to the output of shard 0
+      char *f = shardFilename(i,k);
+      inst->setStr("filename",f);
+      inst->setInt("append",0);
+      free(f);
+    }
+  }
+}
+
+#ifndef __WINDOWS
+
+// configure the full graph (without processing) in a child process and analyse the data memory levels
+int cShardRunner::probe(sShardProbe *p)
+{
+  int fd[2];
+  memset(p, 0, sizeof(sShardProbe));
+  if (pipe(fd) != 0) return 0;
+
+  fflush(NULL);
+  pid_t pid = fork();
+  if (pid < 0) { close(fd[0]); close(fd[1]); return 0; }
+
+  if (pid == 0) {
+    sShardProbe r;
+    memset(&r, 0, sizeof(sShardProbe));
+    close(fd[0]);
+    try {
+      setSinks(0,1);
+      cman->createInstances(0);
+      cWaveSource *ws = (cWaveSource *)cman->getComponentInstance(waveName);
+      if ((ws != NULL)&&(ws->getSampleRate() > 0)) {
+        double rate = (double)ws->getSampleRate();
+        r.sampleRate = ws->getSampleRate();
+        r.startSamples = ws->getStartSamples();
+        r.endSamples = ws->getEndSamples();
+        r.period = 1;
+        r.ok = 1;
+        int i, l;
+        for (i=0; (i<cman->getNComponentInstances())&&(r.ok); i++) {
+          const char *tp = cman->getComponentInstanceType(i);
+          if ((tp == NULL)||(strcmp(tp,"cDataMemory"))) continue;
+          cDataMemory *dm = (cDataMemory *)cman->getComponentInstance(i);
+          for (l=0; l<dm->getNLevels(); l++) {
+            const sDmLevelConfig *c = dm->getLevelConfig(l);
+            if (c == NULL) continue;
+            double n = c->T * rate;
+            long nL = (long)round(n);
+            if ((c->T <= 0.0)||(!c->isRb)||(c->growDyn)||(nL < 1)||(fabs(n-(double)nL) > 1e-6*n)) {
+              SMILE_MSG(2,"level '%s' has no constant frame period of a multiple of the input sample period or is not a ringbuffer, cannot split the input into shards",dm->getLevelName(l));
+              r.ok = 0; break;
+            }
+            r.period = r.period / gcd(r.period,nL) * nL;
+            r.context += c->blocksizeReader * nL + (long)ceil(c->frameSizeSec * rate);
+          }
+        }
+      }
+    } catch (cSMILException *) {
+      r.ok = 0;
+    }
+    if (write(fd[1], &r, sizeof(sShardProbe)) != sizeof(sShardProbe)) r.ok = 0;
+    close(fd[1]);
+    _exit(0);
+  }
+
+  close(fd[1]);
+  int ret = (read(fd[0], p, sizeof(sShardProbe)) == sizeof(sShardProbe));
+  close(fd[0]);
+  waitpid(pid, NULL, 0);
+  return (ret && p->ok);
+}
+
+// start the process for shard k: input range inStart..inEnd, output range outStart..outEnd (samples relative to p->startSamples)
+int cShardRunner::runShard(int k, long inStart, long inEnd, long outStart, long outEnd, const sShardProbe *p, long long maxtick)
+{
+  fflush(NULL);
+  pid_t pid = fork();
+  if (pid != 0) return (int)pid;
+
+  int ret = EXIT_SUCCESS;
+  try {
+    double rate = (double)p->sampleRate;
+    ConfigInstance *wi = confman->getInstance(waveInst);
+    wi->setInt("startSamples",(int)(p->startSamples + inStart));
+    wi->setInt("endSamples",(int)(p->startSamples + inEnd));
+    setSinks(k);
+    int i;
+    for (i=0; i<nSinks; i++) {
+      ConfigInstance *inst = confman->getInstance(sinkInst[i]);
+      inst->setInt("shardIndex",k);
+      inst->setDouble("shardStart",(double)outStart/rate);
+      inst->setDouble("shardEnd",(outEnd >= 0) ? (double)outEnd/rate : -1.0);
+      inst->setDouble("shardOffset",(double)inStart/rate);
+    }
+    SMILE_MSG(3,"shard %i: input samples %ld - %ld, output samples %ld - %ld",k,inStart,inEnd,outStart,outEnd);
+    cman->createInstances(0);
+    cman->runMultiThreaded(maxtick);
+    // close all output files
+    delete confman;
+    delete cman;
+  } catch (cSMILException *) {
+    ret = EXIT_ERROR;
+  }
+  fflush(NULL);
+  _exit(ret);
+  return 0;
+}
+
+#else
+
+int cShardRunner::probe(sShardProbe *p)
+{
+  SMILE_MSG(2,"sharded processing is not supported on this platform");
+  return 0;
+}
+
+int cShardRunner::runShard(int k, long inStart, long inEnd, long outStart, long outEnd, const sShardProbe *p, long long maxtick)
+{
+  return -1;
+}
+
+#endif // __WINDOWS
+
+// append the output of shards 1..n-1 to the output of shard 0
+int cShardRunner::joinShards(int n)
+{
+  int i, k;
+  int ret = 1;
+  char *buf = (char *)malloc(1<<16);
+  if (buf == NULL) OUT_OF_MEMORY;
+
+  for (i=0; i<nSinks; i++) {
+    FILE *out = fopen(sinkFile[i], (sinkType[i] == SHARD_SINK_HTK) ? "r+b" : "ab");
+    if (out == NULL) {
+      SMILE_ERR(1,"cannot open '%s' for appending the output of the shards",sinkFile[i]);
+      ret = 0; continue;
+    }
+    fseek(out, 0, SEEK_END);
+    long nBytes = 0;
+    for (k=1; k<n; k++) {
+      char *f = shardFilename(i,k);
+      FILE *in = fopen(f, "rb");
+      if (in == NULL) {
+        SMILE_ERR(1,"output of shard %i '%s' is missing",k,f);
+        ret = 0;
+      } else {
+        size_t r;
+        while ((r = fread(buf, 1, 1<<16, in)) > 0) {
+          if (fwrite(buf, 1, r, out) != r) { SMILE_ERR(1,"error writing to '%s'",sinkFile[i]); ret = 0; break; }
+          nBytes += (long)r;
+        }
+        fclose(in);
+      }
+      free(f);
+    }
+    if (sinkType[i] == SHARD_SINK_HTK) {
+      // update the number of samples in the (big endian) htk header written by shard 0
+      unsigned char h[12];
+      fseek(out, 0, SEEK_SET);
+      if (fread(h, 1, 12, out) == 12) {
+        uint32_t nSamples = ((uint32_t)h[0]<<24) | ((uint32_t)h[1]<<16) | ((uint32_t)h[2]<<8) | (uint32_t)h[3];
+        uint32_t sampleSize = ((uint32_t)h[8]<<8) | (uint32_t)h[9];
+        if (sampleSize > 0) nSamples += (uint32_t)(nBytes / sampleSize);
+        h[0] = (unsigned char)(nSamples>>24); h[1] = (unsigned char)(nSamples>>16);
+        h[2] = (unsigned char)(nSamples>>8);  h[3] = (unsigned char)nSamples;
+        fseek(out, 0, SEEK_SET);
+        if (fwrite(h, 1, 4, out) != 4) ret = 0;
+      } else {
+        SMILE_ERR(1,"cannot read htk header of '%s'",sinkFile[i]);
+        ret = 0;
+      }
+    }
+    fclose(out);
+  }
+  free(buf);
+  return ret;
+}
+
+void cShardRunner::removeShards(int n)
+{
+  int i, k;
+  for (i=0; i<nSinks; i++) {
+    for (k=1; k<n; k++) {
+      char *f = shardFilename(i,k);
+      remove(f);
+      free(f);
+    }
+  }
+}
+
+int cShardRunner::run(long long maxtick)
+{
+  if (nShards < 2) return -1;
+  if (!checkGraph()) return -1;
+
+  sShardProbe p;
+  if (!probe(&p)) {
+    SMILE_MSG(2,"the input cannot be split into shards, processing serially");
+    return -1;
+  }
+
+  long L = p.endSamples - p.startSamples;
+  long P = p.period;
+  long M = ((p.context + P - 1) / P) * P;  // margin, aligned to the period of all levels
+  long minLen = (M > P) ? M : P;
+  int n = nShards;
+  if (L / n < minLen) n = (int)(L / minLen);
+  if (n < 2) {
+    SMILE_MSG(2,"input is too short to be split into shards (margin %ld samples), processing serially",M);
+    return -1;
+  }
+  SMILE_MSG(2,"processing %ld samples in %i shards (margin %ld samples, alignment %ld samples)",L,n,M,P);
+
+  int k;
+  int *pids = (int *)calloc(1,sizeof(int)*n);
+  int ret = 1;
+  for (k=0; k<n; k++) {
+    long outStart = (k==0) ? 0 : (long)(((long long)L*k/n) / P) * P;
+    long outEnd = (k==n-1) ? L : (long)(((long long)L*(k+1)/n) / P) * P;
+    long inStart = (k==0) ? 0 : outStart - M;
+    long inEnd = (k==n-1) ? L : outEnd + M;
+    if (inEnd > L) inEnd = L;
+    pids[k] = runShard(k, inStart, inEnd, outStart, (k==n-1) ? -1 : outEnd, &p, maxtick);
+    if (pids[k] < 0) { SMILE_ERR(1,"failed to start process for shard %i",k); ret = 0; }
+  }
+
+#ifndef __WINDOWS
+  for (k=0; k<n; k++) {
+    if (pids[k] <= 0) continue;
+    int status = 0;
+    if ((waitpid((pid_t)pids[k], &status, 0) < 0)||(!WIFEXITED(status))||(WEXITSTATUS(status) != EXIT_SUCCESS)) {
+      SMILE_ERR(1,"processing of shard %i failed",k);
+      ret = 0;
+    }
+  }
+#endif
+  free(pids);
+
+  if (ret) ret = joinShards(n);
+  removeShards(n);
+  return ret;
+}
+
+cShardRunner::~cShardRunner()
+{
+  int i;
+  if (sinkFile != NULL) {
+    for (i=0; i<nSinks; i++) if (sinkFile[i] != NULL) free(sinkFile[i]);
+    free(sinkFile);
+  }
+  if (sinkInst != NULL) free(sinkInst);
+  if (sinkType != NULL) free(sinkType);
+}
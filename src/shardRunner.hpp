@@ -0,0 +1,108 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  cShardRunner
+    ============
+
+sharded processing of one long input (SMILExtract -shards N):
+
+the input of the (only) cWaveSource is split into N time shards, each
+shard is processed by a separate process with its own component manager.
+Each shard reads an overlap margin before and after its output range,
+the margin is the accumulated read context (window/delta/framer) of all
+data memory levels, aligned to the period of all levels. Thus all frames
+a shard writes are computed from exactly the same input as in a serial
+run. The shards' cCsvSink, cArffSink, and cHtkSink outputs are joined
+in frame order by the parent process.
+
+Graphs with whole-input or unbounded state (e.g. cFullinputMean, turn
+detection, non-ringbuffer levels) and other sources or sinks cannot be
+sharded, these are processed serially.
+
+*/
+
+
+#ifndef __SHARD_RUNNER_HPP
+#define __SHARD_RUNNER_HPP
+
+#include <smileCommon.hpp>
+#include <configManager.hpp>
+#include <componentManager.hpp>
+
+#define SHARD_SINK_CSV   0
+#define SHARD_SINK_ARFF  1
+#define SHARD_SINK_HTK   2
+
+// result of the graph probe (configuration of the full graph in a child process)
+typedef struct {
+  int ok;
+  long sampleRate;
+  long startSamples, endSamples;  // input range of the wave source
+  long period;   // least common multiple of all level periods, in samples
+  long context;  // accumulated read context of all levels, in samples
+} sShardProbe;
+
+class cShardRunner {
+  private:
+    cConfigManager *confman;
+    cComponentManager *cman;
+    int nShards;
+
+    const char *waveInst;  // config instance name of the wave source
+    const char *waveName;  // component instance name of the wave source
+    int nSinks;
+    const char **sinkInst; // config instance names of the sinks
+    char **sinkFile;       // output filenames of the sinks
+    int *sinkType;         // SHARD_SINK_xxx
+
+    int checkGraph();
+    int probe(sShardProbe *p);
+    void setSinks(int k, int probeOnly=0);
+    int runShard(int k, long inStart, long inEnd, long outStart, long outEnd, const sShardProbe *p, long long maxtick);
+    int joinShards(int n);
+    void removeShards(int n);
+    char * shardFilename(int sink, int k);
+
+  public:
+    cShardRunner(cConfigManager *_confman, cComponentManager *_cman, int _nShards);
+
+    /* process the input in shards,
+       returns -1 if the graph or input cannot be sharded (nothing was done, process serially),
+       1 on success, 0 on failure */
+    int run(long long maxtick=-1);
+
+    ~cShardRunner();
+};
+
+
+#endif // __SHARD_RUNNER_HPP
@@ -222,12 +222,14 @@ typedef struct {
                                         clock_gettime(CLOCK_REALTIME, &__TOut); \
                                         __TOut.tv_sec += (long)MSEC/1000; \
                                         __TOut.tv_nsec += ( (long)MSEC-1000*((long)MSEC/1000) )*1000000; \
+                                        if (__TOut.tv_nsec >= 1000000000) { __TOut.tv_sec++; __TOut.tv_nsec -= 1000000000; } \
                                         pthread_cond_timedwait(&(COND.cond), &(COND.mtx), &__TOut); \
                                         pthread_mutex_unlock(&(COND.mtx)); }
 #define smileCondTimedWaitWMtx(COND,MSEC,MTX) { struct timespec __TOut; \
                                         clock_gettime(CLOCK_REALTIME, &__TOut); \
                                         __TOut.tv_sec += (long)MSEC/1000; \
                                         __TOut.tv_nsec += ( (long)MSEC-1000*((long)MSEC/1000) )*1000000; \
+                                        if (__TOut.tv_nsec >= 1000000000) { __TOut.tv_sec++; __TOut.tv_nsec -= 1000000000; } \
                                         pthread_cond_timedwait(&(COND.cond), &(MTX), &__TOut); \
                                          }
 
@@ -243,6 +245,8 @@ typedef struct {
 
 #define smileSleep(msec)  usleep((msec)*1000)
 #define smileYield()      sched_yield()
+// full memory barrier (for lock-free single producer / single consumer queues)
+#define smileMemoryBarrier() __sync_synchronize()
 
 #else //not HAVE_PTHREAD
 
@@ -685,6 +689,7 @@ pthread_cond_destroy (pthread_cond_t *cv)
 #define smileSleep(msec)  Sleep( msec )
 //#define smileYield()      sched_yield()
 #define smileYield()  //Sleep( 0 )
+#define smileMemoryBarrier() MemoryBarrier()
 
 
 
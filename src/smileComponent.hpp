@@ -42,6 +42,8 @@
 
 class cComponentManager;
 class cSmileComponent;
+class cDataReader;
+class cDataWriter;
 
 #define CMSG_textLen      64
 #define CMSG_typenameLen  32
@@ -379,6 +381,15 @@ class cSmileComponent {
 
     virtual void setEOI() { EOI = 1; } // not.. used by component manager to signal End-of-Input to components
 
+    /* dead output elimination (see cComponentManager::pruneDeadOutputs):
+       the reader of the component's input levels and the writer of its output level (NULL if it has none) */
+    virtual cDataReader * getInputReader() { return NULL; }
+    virtual cDataWriter * getOutputWriter() { return NULL; }
+    /* mark in inNeed (the concatenated input frame of the reader) the input elements required to compute the output
+       elements flagged in outNeed (NULL: all outputs are needed, or the component has no output level).
+       the default marks all input elements, components that map outputs to inputs element-wise should override this */
+    virtual void markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn) { memset(inNeed, 1, nIn); }
+
     // this function is called externally by the component manager if another component calls sendComponentMessage:
     int receiveComponentMessage( cComponentMessage *_msg ) {
       int ret = 0;
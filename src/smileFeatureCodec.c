@@ -0,0 +1,512 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+/*
+
+smileFeatureCodec: lossless compression of float feature vector streams,
+see smileFeatureCodec.h for the coding and the file layout
+
+*/
+
+#include <smileFeatureCodec.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/*******************************************************************************************
+ ***********************=====   Frame codec   ===== ****************************************
+ *******************************************************************************************/
+
+#define FC_SCALE_BITS  12               /* rANS frequency resolution */
+#define FC_SCALE       (1<<FC_SCALE_BITS)
+#define FC_RANS_L      (1u<<23)         /* lower bound of the rANS state */
+
+/* plane coding modes */
+#define FC_PLANE_RAW    0
+#define FC_PLANE_CONST  1
+#define FC_PLANE_RANS   2
+
+/* prediction residual of the bit pattern c, given the bit pattern p of the previous vector */
+static uint32_t fcResidual(uint32_t c, uint32_t p, int predictor)
+{
+  uint32_t d;
+  switch (predictor) {
+    case SMILEFC_PRED_XOR:
+      return c ^ p;
+    case SMILEFC_PRED_DELTA:
+      d = c - p;
+      return (d << 1) ^ (uint32_t)((int32_t)d >> 31);  /* zigzag: small negative deltas become small numbers */
+    default:
+      return c;
+  }
+}
+
+static uint32_t fcUnResidual(uint32_t r, uint32_t p, int predictor)
+{
+  switch (predictor) {
+    case SMILEFC_PRED_XOR:
+      return r ^ p;
+    case SMILEFC_PRED_DELTA:
+      return ((r >> 1) ^ (uint32_t)(-(int32_t)(r & 1))) + p;
+    default:
+      return r;
+  }
+}
+
+static void fcPut32(unsigned char *p, uint32_t v)
+{
+  p[0] = (unsigned char)v; p[1] = (unsigned char)(v>>8); p[2] = (unsigned char)(v>>16); p[3] = (unsigned char)(v>>24);
+}
+
+static uint32_t fcGet32(const unsigned char *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24);
+}
+
+/* normalise the byte counts cnt[] of n bytes to frequencies summing up to FC_SCALE (every occurring byte gets >= 1) */
+static void fcNormFreq(const long *cnt, long n, uint32_t *freq)
+{
+  long sum = 0;
+  int i, maxI = 0;
+  for (i=0; i<256; i++) {
+    if (cnt[i] > 0) {
+      freq[i] = (uint32_t)(((uint64_t)cnt[i] * FC_SCALE) / n);
+      if (freq[i] == 0) freq[i] = 1;
+      if (cnt[i] > cnt[maxI]) maxI = i;
+    } else {
+      freq[i] = 0;
+    }
+    sum += freq[i];
+  }
+  if (sum < FC_SCALE) freq[maxI] += FC_SCALE - sum;
+  while (sum > FC_SCALE) {
+    /* take from the largest frequency */
+    int m = 0;
+    for (i=1; i<256; i++) if (freq[i] > freq[m]) m = i;
+    freq[m]--; sum--;
+  }
+}
+
+/* code n bytes, returns the number of bytes written to out (at most n+1), work must hold 2*n+8 bytes */
+static long fcEncodePlane(const unsigned char *in, long n, unsigned char *out, unsigned char *work)
+{
+  long cnt[256];
+  uint32_t freq[256], cum[257];
+  long i, tabLen;
+  int nSym = 0;
+  double bits = 0.0;
+  unsigned char *o;
+
+  memset(cnt, 0, sizeof(cnt));
+  for (i=0; i<n; i++) cnt[in[i]]++;
+  for (i=0; i<256; i++) {
+    if (cnt[i] > 0) { nSym++; bits -= (double)cnt[i] * log((double)cnt[i]/(double)n); }
+  }
+  if (nSym == 1) {
+    out[0] = FC_PLANE_CONST; out[1] = in[0];
+    return 2;
+  }
+  /* frequency table: 32 byte bitmap of the occurring bytes, and one or two bytes per frequency */
+  tabLen = 32 + 2*nSym;
+  if (bits / (8.0*log(2.0)) + (double)tabLen + 4.0 >= (double)n * 0.98) {
+    out[0] = FC_PLANE_RAW;
+    memcpy(out+1, in, n);
+    return n+1;
+  }
+
+  fcNormFreq(cnt, n, freq);
+  cum[0] = 0;
+  for (i=0; i<256; i++) cum[i+1] = cum[i] + freq[i];
+
+  o = out;
+  *(o++) = FC_PLANE_RANS;
+  memset(o, 0, 32);
+  for (i=0; i<256; i++) if (freq[i]) o[i>>3] |= (unsigned char)(1 << (i&7));
+  o += 32;
+  for (i=0; i<256; i++) {
+    if (freq[i]) {
+      /* f-1 < 128: one byte, else two bytes with the msb of the first byte set */
+      uint32_t f = freq[i] - 1;
+      if (f < 128) *(o++) = (unsigned char)f;
+      else { *(o++) = (unsigned char)(0x80 | (f >> 8)); *(o++) = (unsigned char)f; }
+    }
+  }
+
+  {
+    /* rANS, the symbols are coded in reverse order into the end of the work buffer */
+    uint32_t x = FC_RANS_L;
+    unsigned char *end = work + 2*n + 8, *p = end;
+    for (i=n-1; i>=0; i--) {
+      uint32_t f = freq[in[i]];
+      uint32_t xMax = ((FC_RANS_L >> FC_SCALE_BITS) << 8) * f;
+      while (x >= xMax) { *(--p) = (unsigned char)x; x >>= 8; }
+      x = ((x / f) << FC_SCALE_BITS) + (x % f) + cum[in[i]];
+    }
+    p -= 4;
+    fcPut32(p, x);
+    if ((o - out) + (end - p) >= n+1) {
+      /* no gain (should not happen due to the estimate above) */
+      out[0] = FC_PLANE_RAW;
+      memcpy(out+1, in, n);
+      return n+1;
+    }
+    memcpy(o, p, end - p);
+    o += end - p;
+  }
+  return (long)(o - out);
+}
+
+/* decode n bytes from inLen bytes of coded data, returns the number of coded bytes consumed, or 0 on error */
+static long fcDecodePlane(const unsigned char *in, long inLen, long n, unsigned char *out)
+{
+  const unsigned char *p = in, *end = in + inLen;
+  uint32_t freq[256], cum[256];
+  unsigned char slot[FC_SCALE];
+  uint32_t x, c = 0;
+  long i;
+
+  if (inLen < 1) return 0;
+  switch (*(p++)) {
+    case FC_PLANE_CONST:
+      if (inLen < 2) return 0;
+      memset(out, *p, n);
+      return 2;
+    case FC_PLANE_RAW:
+      if (inLen < n+1) return 0;
+      memcpy(out, p, n);
+      return n+1;
+    case FC_PLANE_RANS:
+      break;
+    default:
+      return 0;
+  }
+
+  if (end - p < 32) return 0;
+  {
+    const unsigned char *bitmap = p;
+    p += 32;
+    for (i=0; i<256; i++) {
+      freq[i] = 0;
+      if (bitmap[i>>3] & (1 << (i&7))) {
+        if (p >= end) return 0;
+        if (*p & 0x80) {
+          if (p+1 >= end) return 0;
+          freq[i] = (((uint32_t)(p[0] & 0x7f) << 8) | p[1]) + 1;
+          p += 2;
+        } else {
+          freq[i] = (uint32_t)(*(p++)) + 1;
+        }
+      }
+      cum[i] = c;
+      if (c + freq[i] > FC_SCALE) return 0;
+      memset(slot + c, (int)i, freq[i]);
+      c += freq[i];
+    }
+  }
+  if ((c != FC_SCALE)||(end - p < 4)) return 0;
+
+  x = fcGet32(p);
+  p += 4;
+  for (i=0; i<n; i++) {
+    uint32_t s = x & (FC_SCALE-1);
+    unsigned char sym = slot[s];
+    out[i] = sym;
+    x = freq[sym] * (x >> FC_SCALE_BITS) + s - cum[sym];
+    while (x < FC_RANS_L) {
+      if (p >= end) return 0;
+      x = (x << 8) | *(p++);
+    }
+  }
+  return (long)(p - in);
+}
+
+long smileFc_bound(long nVec, long vecSize)
+{
+  /* 4 byte planes, each one is at most stored uncoded with a one byte header */
+  return 4*(nVec*vecSize + 1);
+}
+
+long smileFc_encode(const float *in, long nVec, long vecSize, int predictor, unsigned char *out)
+{
+  const uint32_t *x = (const uint32_t *)in;
+  long n = nVec*vecSize;
+  unsigned char *plane, *work, *o = out;
+  long t, i;
+  int k;
+
+  plane = (unsigned char *)malloc(3*n + 8);
+  if (plane == NULL) return 0;
+  work = plane + n;
+
+  /* byte plane k of all residuals, element by element (a contour of one feature after the other) */
+  for (k=3; k>=0; k--) {
+    unsigned char *pl = plane;
+    for (i=0; i<vecSize; i++) {
+      uint32_t prev = 0;
+      for (t=0; t<nVec; t++) {
+        uint32_t c = x[t*vecSize+i];
+        *(pl++) = (unsigned char)(fcResidual(c, prev, predictor) >> (8*k));
+        prev = c;
+      }
+    }
+    o += fcEncodePlane(plane, n, o, work);
+  }
+
+  free(plane);
+  return (long)(o - out);
+}
+
+int smileFc_decode(const unsigned char *in, long inLen, long nVec, long vecSize, int predictor, float *out)
+{
+  uint32_t *x = (uint32_t *)out;
+  long n = nVec*vecSize;
+  unsigned char *plane;
+  const unsigned char *p = in, *end = in + inLen;
+  long t, i;
+  int k;
+
+  plane = (unsigned char *)malloc(n + 1);
+  if (plane == NULL) return 0;
+
+  memset(x, 0, sizeof(uint32_t)*n);
+  for (k=3; k>=0; k--) {
+    const unsigned char *pl = plane;
+    long len = fcDecodePlane(p, (long)(end - p), n, plane);
+    if (len == 0) { free(plane); return 0; }
+    p += len;
+    for (i=0; i<vecSize; i++) {
+      for (t=0; t<nVec; t++) x[t*vecSize+i] |= (uint32_t)(*(pl++)) << (8*k);
+    }
+  }
+  free(plane);
+
+  /* undo the prediction */
+  if (predictor != SMILEFC_PRED_NONE) {
+    for (i=0; i<vecSize; i++) {
+      uint32_t prev = 0;
+      for (t=0; t<nVec; t++) {
+        x[t*vecSize+i] = fcUnResidual(x[t*vecSize+i], prev, predictor);
+        prev = x[t*vecSize+i];
+      }
+    }
+  }
+  return 1;
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Container writer   ===== ***********************************
+ *******************************************************************************************/
+
+sSmileFcEncoder * smileFc_encoderCreate(int format, int flags, long vecSize, long frameVectors, int predictor, double period)
+{
+  sSmileFcEncoder *e;
+  if ((vecSize <= 0)||(frameVectors <= 0)) return NULL;
+  e = (sSmileFcEncoder *)calloc(1, sizeof(sSmileFcEncoder));
+  if (e == NULL) return NULL;
+  strcpy(e->h.magic, SMILEFC_MAGIC);
+  e->h.version = SMILEFC_VERSION;
+  e->h.format = (uint32_t)format;
+  e->h.flags = (uint32_t)flags;
+  e->h.vecSize = (uint32_t)vecSize;
+  e->h.frameVectors = (uint32_t)frameVectors;
+  e->h.predictor = (uint32_t)predictor;
+  e->h.period = period;
+  e->buf = (float *)malloc(sizeof(float)*vecSize*frameVectors);
+  e->out = (unsigned char *)malloc(smileFc_bound(frameVectors, vecSize) + 8 + sizeof(sSmileFcHeader) + SMILEFC_MAX_ORIGHEADER);
+  if ((e->buf == NULL)||(e->out == NULL)) { smileFc_encoderFree(e); return NULL; }
+  return e;
+}
+
+long smileFc_encoderHeader(sSmileFcEncoder *e, const void *origHeader, long origHeaderLen, const unsigned char **out)
+{
+  if ((origHeaderLen < 0)||(origHeaderLen > SMILEFC_MAX_ORIGHEADER)) return 0;
+  if (origHeaderLen > 0) memcpy(e->origHeader, origHeader, origHeaderLen);
+  e->h.origHeaderLen = (uint32_t)origHeaderLen;
+  memcpy(e->out, &(e->h), sizeof(sSmileFcHeader));
+  memcpy(e->out + sizeof(sSmileFcHeader), e->origHeader, origHeaderLen);
+  *out = e->out;
+  return (long)sizeof(sSmileFcHeader) + origHeaderLen;
+}
+
+long smileFc_encoderFlush(sSmileFcEncoder *e, const unsigned char **out)
+{
+  uint32_t fh[2];
+  long n;
+  if (e->nBuf == 0) return 0;
+  n = smileFc_encode(e->buf, e->nBuf, e->h.vecSize, e->h.predictor, e->out + 8);
+  fh[0] = (uint32_t)e->nBuf;
+  fh[1] = (uint32_t)n;
+  memcpy(e->out, fh, 8);
+  e->nBuf = 0;
+  *out = e->out;
+  return n + 8;
+}
+
+long smileFc_encoderAdd(sSmileFcEncoder *e, const float *vec, const unsigned char **out)
+{
+  memcpy(e->buf + e->nBuf*e->h.vecSize, vec, sizeof(float)*e->h.vecSize);
+  e->nBuf++;
+  e->h.nVec++;
+  if (e->nBuf >= (long)e->h.frameVectors) return smileFc_encoderFlush(e, out);
+  return 0;
+}
+
+void smileFc_encoderFree(sSmileFcEncoder *e)
+{
+  if (e == NULL) return;
+  if (e->buf != NULL) free(e->buf);
+  if (e->out != NULL) free(e->out);
+  free(e);
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Container reader   ===== ***********************************
+ *******************************************************************************************/
+
+sSmileFcReader * smileFc_open(const char *filename)
+{
+  sSmileFcReader *r;
+  FILE *f = fopen(filename, "rb");
+  if (f == NULL) return NULL;
+  r = (sSmileFcReader *)calloc(1, sizeof(sSmileFcReader));
+  if (r == NULL) { fclose(f); return NULL; }
+  r->f = f;
+  if ((fread(&(r->h), sizeof(sSmileFcHeader), 1, f) != 1)
+      ||(strncmp(r->h.magic, SMILEFC_MAGIC, 8))||(r->h.version != SMILEFC_VERSION)
+      ||(r->h.vecSize == 0)||(r->h.frameVectors == 0)||(r->h.origHeaderLen > SMILEFC_MAX_ORIGHEADER)
+      ||((r->h.origHeaderLen > 0)&&(fread(r->origHeader, r->h.origHeaderLen, 1, f) != 1))) {
+    smileFc_close(r);
+    return NULL;
+  }
+  r->inAlloc = smileFc_bound(r->h.frameVectors, r->h.vecSize);
+  r->in = (unsigned char *)malloc(r->inAlloc);
+  r->frame = (float *)malloc(sizeof(float)*r->h.vecSize*r->h.frameVectors);
+  if ((r->in == NULL)||(r->frame == NULL)) { smileFc_close(r); return NULL; }
+  return r;
+}
+
+/* read and decode the next frame, returns 0 at the end of the file, -1 on error */
+static int fcReadFrame(sSmileFcReader *r)
+{
+  uint32_t fh[2];
+  r->frameN = 0; r->framePos = 0;
+  if (fread(fh, 8, 1, r->f) != 1) return 0;
+  if ((fh[0] == 0)||(fh[0] > r->h.frameVectors)||((long)fh[1] > r->inAlloc)) { r->err = 1; return -1; }
+  if (fread(r->in, 1, fh[1], r->f) != fh[1]) { r->err = 1; return -1; }
+  if (!smileFc_decode(r->in, fh[1], fh[0], r->h.vecSize, r->h.predictor, r->frame)) { r->err = 1; return -1; }
+  r->frameN = fh[0];
+  return 1;
+}
+
+long smileFc_read(sSmileFcReader *r, float *out, long maxVec)
+{
+  long n = 0;
+  if (r->err) return -1;
+  while (n < maxVec) {
+    long m;
+    if (r->framePos >= r->frameN) {
+      int ret = fcReadFrame(r);
+      if (ret < 0) return -1;
+      if (ret == 0) break;
+    }
+    m = r->frameN - r->framePos;
+    if (m > maxVec - n) m = maxVec - n;
+    memcpy(out + n*r->h.vecSize, r->frame + r->framePos*r->h.vecSize, sizeof(float)*m*r->h.vecSize);
+    r->framePos += m;
+    n += m;
+  }
+  r->nRead += n;
+  return n;
+}
+
+void smileFc_close(sSmileFcReader *r)
+{
+  if (r == NULL) return;
+  if (r->f != NULL) fclose(r->f);
+  if (r->in != NULL) free(r->in);
+  if (r->frame != NULL) free(r->frame);
+  free(r);
+}
+
+int smileFc_decompressFile(const char *infile, const char *outfile)
+{
+  sSmileFcReader *r;
+  FILE *f;
+  float *buf;
+  long n, i;
+  int ok = 1, swap;
+  uint32_t one = 1;
+
+  r = smileFc_open(infile);
+  if (r == NULL) return 0;
+  f = fopen(outfile, "wb");
+  if (f == NULL) { smileFc_close(r); return 0; }
+  buf = (float *)malloc(sizeof(float)*r->h.vecSize*r->h.frameVectors);
+  if (buf == NULL) { fclose(f); smileFc_close(r); return 0; }
+  /* the values are stored in host byte order */
+  swap = ((r->h.flags & SMILEFC_FLAG_BIGENDIAN) && (*(unsigned char *)&one == 1));
+  if ((r->h.origHeaderLen > 0)&&(fwrite(r->origHeader, r->h.origHeaderLen, 1, f) != 1)) ok = 0;
+  while (ok) {
+    n = smileFc_read(r, buf, r->h.frameVectors);
+    if (n < 0) ok = 0;
+    if (n <= 0) break;
+    if (swap) {
+      uint32_t *x = (uint32_t *)buf;
+      for (i=0; i<n*(long)r->h.vecSize; i++) {
+        x[i] = (x[i] >> 24) | ((x[i] >> 8) & 0xff00) | ((x[i] << 8) & 0xff0000) | (x[i] << 24);
+      }
+    }
+    if (fwrite(buf, sizeof(float)*r->h.vecSize, n, f) != (size_t)n) ok = 0;
+  }
+  free(buf);
+  fclose(f);
+  smileFc_close(r);
+  return ok;
+}
+
+#ifdef SMILEFC_MAIN
+int main(int argc, char **argv)
+{
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <compressed file> <output file>\n  converts a compressed feature file back to the original HTK, datadump or raw float file\n", argv[0]);
+    return 1;
+  }
+  if (!smileFc_decompressFile(argv[1], argv[2])) {
+    fprintf(stderr, "error converting '%s' to '%s'\n", argv[1], argv[2]);
+    return 1;
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,186 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  smileFeatureCodec
+    =================
+
+lossless compression of float feature vector streams (LLD contours etc.),
+and the compressed feature file container used by cHtkSink, cDatadumpSink
+(option 'compress') and cCompressedFeatureSource.
+
+The vectors are coded in frames of up to 'frameVectors' vectors, each frame
+can be decoded independently. Within a frame each value is optionally
+predicted by the same element of the previous vector (the difference or XOR
+of the float bit patterns, smooth contours leave small residuals in the sign,
+exponent and upper mantissa bits). The residuals are split into 4 byte planes
+(each plane holds the contour of one feature after the other), each plane is
+stored as a constant, uncoded (if it does not compress, as the noisy low
+mantissa bytes usually do), or coded with a static order-0 rANS entropy coder
+(frequency table stored in the frame).
+
+This file has no openSMILE dependencies, it can be compiled into offline
+tools; compile with -DSMILEFC_MAIN to get a command line tool which converts
+compressed files back to the original HTK or datadump file.
+
+file layout (header fields in native byte order):
+  sSmileFcHeader
+  origHeaderLen bytes: header of the original file format (as it would be in the uncompressed file)
+  frames: uint32 nVec, uint32 nBytes, nBytes bytes of coded data
+
+*/
+
+
+#ifndef __SMILE_FEATURE_CODEC_H
+#define __SMILE_FEATURE_CODEC_H
+
+#if !defined(__SMILE_COMMON_H) && !defined(DLLEXPORT)
+
+#ifdef _MSC_VER // Visual Studio specific macro
+  #ifdef BUILDING_DLL
+    #define DLLEXPORT __declspec(dllexport)
+  #else
+    #define DLLEXPORT __declspec(dllimport)
+  #endif
+#else 
+    #define DLLEXPORT 
+#endif
+
+#endif  // __SMILE_COMMON_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SMILEFC_MAGIC    "SMILEFC"
+#define SMILEFC_VERSION  1
+
+/* format of the original (uncompressed) file */
+#define SMILEFC_FORMAT_RAW       0   /* float values only */
+#define SMILEFC_FORMAT_HTK       1   /* HTK feature file */
+#define SMILEFC_FORMAT_DATADUMP  2   /* cDatadumpSink file */
+
+/* flags */
+#define SMILEFC_FLAG_BIGENDIAN   1   /* the original file stores the float values in big endian byte order */
+
+/* predictors */
+#define SMILEFC_PRED_NONE  0   /* values are coded as they are */
+#define SMILEFC_PRED_XOR   1   /* values are XORed with the same element of the previous vector */
+#define SMILEFC_PRED_DELTA 2   /* difference of the bit patterns (as integers) to the same element of the previous vector */
+
+#define SMILEFC_MAX_ORIGHEADER  64
+
+typedef struct {
+  char magic[8];           /* SMILEFC_MAGIC, 0 terminated */
+  uint32_t version;
+  uint32_t format;         /* SMILEFC_FORMAT_* */
+  uint32_t flags;          /* SMILEFC_FLAG_* */
+  uint32_t vecSize;        /* number of values in one vector */
+  uint32_t frameVectors;   /* max. number of vectors in one frame */
+  uint32_t predictor;      /* SMILEFC_PRED_* */
+  uint32_t nVec;           /* total number of vectors (set when the file is closed) */
+  uint32_t origHeaderLen;  /* length of the original file header following this header */
+  double period;           /* frame period in seconds (0.0 = unknown / aperiodic) */
+} sSmileFcHeader;
+
+
+  /***** frame codec *****/
+
+/* max. number of bytes of a coded frame of nVec vectors with vecSize values */
+DLLEXPORT long smileFc_bound(long nVec, long vecSize);
+
+/* code nVec vectors in[t*vecSize+i] into out (at least smileFc_bound bytes), returns the number of bytes written */
+DLLEXPORT long smileFc_encode(const float *in, long nVec, long vecSize, int predictor, unsigned char *out);
+
+/* decode a frame of nVec vectors from inLen bytes, returns 0 if the data is corrupt, 1 on success */
+DLLEXPORT int smileFc_decode(const unsigned char *in, long inLen, long nVec, long vecSize, int predictor, float *out);
+
+
+  /***** container writer (no I/O, the caller writes the returned data) *****/
+
+typedef struct {
+  sSmileFcHeader h;
+  unsigned char origHeader[SMILEFC_MAX_ORIGHEADER];
+  float *buf;              /* vectors of the current frame */
+  long nBuf;
+  unsigned char *out;      /* coded frame (8 byte frame header + data), or file header */
+} sSmileFcEncoder;
+
+/* create an encoder, returns NULL on invalid parameters or out of memory */
+DLLEXPORT sSmileFcEncoder * smileFc_encoderCreate(int format, int flags, long vecSize, long frameVectors, int predictor, double period);
+
+/* get the file header incl. the original file header (origHeaderLen bytes, may be updated at any time),
+   returns the length of the data in *out */
+DLLEXPORT long smileFc_encoderHeader(sSmileFcEncoder *e, const void *origHeader, long origHeaderLen, const unsigned char **out);
+
+/* add one vector, when a frame is complete, the coded frame is returned in *out and its length is returned, else 0 */
+DLLEXPORT long smileFc_encoderAdd(sSmileFcEncoder *e, const float *vec, const unsigned char **out);
+
+/* code the remaining vectors (if any) as last frame, returns its length (0 if no vectors were left) */
+DLLEXPORT long smileFc_encoderFlush(sSmileFcEncoder *e, const unsigned char **out);
+
+DLLEXPORT void smileFc_encoderFree(sSmileFcEncoder *e);
+
+
+  /***** container reader *****/
+
+typedef struct {
+  FILE *f;
+  sSmileFcHeader h;
+  unsigned char origHeader[SMILEFC_MAX_ORIGHEADER];
+  unsigned char *in;       /* coded frame data */
+  long inAlloc;
+  float *frame;            /* decoded frame */
+  long frameN, framePos;   /* vectors in the decoded frame, vectors returned from it */
+  long nRead;              /* total vectors returned */
+  int err;
+} sSmileFcReader;
+
+/* open a compressed feature file, returns NULL if the file cannot be opened or is not a valid file */
+DLLEXPORT sSmileFcReader * smileFc_open(const char *filename);
+
+/* read up to maxVec vectors into out[t*vecSize+i], returns the number of vectors read (0 = end of file), -1 on error */
+DLLEXPORT long smileFc_read(sSmileFcReader *r, float *out, long maxVec);
+
+DLLEXPORT void smileFc_close(sSmileFcReader *r);
+
+/* write the original (uncompressed) file, returns 0 on failure */
+DLLEXPORT int smileFc_decompressFile(const char *infile, const char *outfile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __SMILE_FEATURE_CODEC_H
@@ -0,0 +1,266 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  cSmileFileWriter
+
+buffered output file for the file sinks, see smileFileWriter.hpp
+
+*/
+
+
+#include <smileFileWriter.hpp>
+
+#define MODULE "cSmileFileWriter"
+
+
+cSmileFileWriter::cSmileFileWriter(size_t _bufsize, int _flushThread) :
+  fh(NULL), filename(NULL),
+  cur(0), bufsize(_bufsize), fill(0), pos(0), err(0),
+  useThread(_flushThread), threadRunning(0), stop(0),
+  pending(NULL), pendingLen(0)
+{
+  if (bufsize < 4096) bufsize = 4096;
+  buf[0] = (char *)malloc(bufsize);
+  buf[1] = NULL;
+  if (useThread) buf[1] = (char *)malloc(bufsize);
+  if ((buf[0] == NULL)||((useThread)&&(buf[1] == NULL))) OUT_OF_MEMORY;
+}
+
+int cSmileFileWriter::open(const char *_filename, const char *mode)
+{
+  close();
+  if (_filename == NULL) return 0;
+  fh = fopen(_filename, mode);
+  if (fh == NULL) return 0;
+  // we do our own buffering
+  setvbuf(fh, NULL, _IONBF, 0);
+  filename = strdup(_filename);
+  fseek(fh, 0, SEEK_END);
+  pos = (long long)ftell(fh);
+  fill = 0; cur = 0; err = 0;
+
+  if (useThread) {
+    stop = 0; pendingLen = 0;
+    smileMutexCreate(mtx);
+    smileCondCreate(condWork);
+    smileCondCreate(condDone);
+    if (smileThreadCreate(thread, threadMain, this)) {
+      threadRunning = 1;
+    } else {
+      SMILE_WRN(2,"failed to create flush thread for '%s', writing from the calling thread",filename);
+      smileMutexDestroy(mtx);
+      smileCondDestroy(condWork);
+      smileCondDestroy(condDone);
+    }
+  }
+  return 1;
+}
+
+SMILE_THREAD_RETVAL cSmileFileWriter::threadMain(void *_obj)
+{
+  cSmileFileWriter *w = (cSmileFileWriter *)_obj;
+  smileMutexLock(w->mtx);
+  while (1) {
+    while ((w->pendingLen == 0)&&(!w->stop)) smileCondWaitWMtx(w->condWork, w->mtx);
+    if (w->pendingLen == 0) break; // stop requested and nothing left to write
+    const char *data = w->pending;
+    size_t len = w->pendingLen;
+    smileMutexUnlock(w->mtx);
+    int ok = w->writeOut(data, len);
+    smileMutexLock(w->mtx);
+    if (!ok) w->err = 1;
+    w->pendingLen = 0;
+    smileCondSignalRaw(w->condDone);
+  }
+  smileMutexUnlock(w->mtx);
+  SMILE_THREAD_RET;
+}
+
+int cSmileFileWriter::writeOut(const char *data, size_t len)
+{
+  return (fwrite(data, 1, len, fh) == len);
+}
+
+void cSmileFileWriter::setError()
+{
+  if (!threadRunning) { err = 1; return; }
+  smileMutexLock(mtx);
+  err = 1;
+  smileMutexUnlock(mtx);
+}
+
+int cSmileFileWriter::hasError()
+{
+  int e;
+  if (!threadRunning) return err;
+  smileMutexLock(mtx);
+  e = err;
+  smileMutexUnlock(mtx);
+  return e;
+}
+
+// write out the current buffer (or pass it to the flush thread and continue with the other buffer)
+int cSmileFileWriter::handOff()
+{
+  int e;
+  if (fill == 0) return !hasError();
+  if (!threadRunning) {
+    if (!writeOut(buf[cur], fill)) err = 1;
+    fill = 0;
+    return !err;
+  }
+  smileMutexLock(mtx);
+  while (pendingLen > 0) smileCondWaitWMtx(condDone, mtx);
+  pending = buf[cur];
+  pendingLen = fill;
+  smileCondSignalRaw(condWork);
+  e = err;
+  smileMutexUnlock(mtx);
+  cur = !cur;
+  fill = 0;
+  return !e;
+}
+
+void cSmileFileWriter::waitPending()
+{
+  if (!threadRunning) return;
+  smileMutexLock(mtx);
+  while (pendingLen > 0) smileCondWaitWMtx(condDone, mtx);
+  smileMutexUnlock(mtx);
+}
+
+int cSmileFileWriter::write(const void *data, size_t len)
+{
+  if (fh == NULL) return 0;
+  if (fill + len > bufsize) {
+    handOff();
+    if (len >= bufsize) {
+      // large blocks are written directly
+      waitPending();
+      pos += (long long)len;
+      if (!writeOut((const char *)data, len)) { setError(); return 0; }
+      return 1;
+    }
+  }
+  memcpy(buf[cur]+fill, data, len);
+  fill += len;
+  pos += (long long)len;
+  return !hasError();
+}
+
+int cSmileFileWriter::printf(const char *fmt, ...)
+{
+  if (fh == NULL) return -1;
+  va_list ap;
+  size_t avail = bufsize - fill;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf[cur]+fill, avail, fmt, ap);
+  va_end(ap);
+  if (n < 0) return -1;
+  if ((size_t)n < avail) { commit((size_t)n); return n; }
+
+  // did not fit in the remaining buffer space
+  handOff();
+  if ((size_t)n < bufsize) {
+    va_start(ap, fmt);
+    vsnprintf(buf[cur], bufsize, fmt, ap);
+    va_end(ap);
+    commit((size_t)n);
+  } else {
+    char *tmp = (char *)malloc((size_t)n+1);
+    if (tmp == NULL) OUT_OF_MEMORY;
+    va_start(ap, fmt);
+    vsnprintf(tmp, (size_t)n+1, fmt, ap);
+    va_end(ap);
+    write(tmp, (size_t)n);
+    free(tmp);
+  }
+  return n;
+}
+
+char * cSmileFileWriter::reserve(size_t len)
+{
+  if ((fh == NULL)||(len > bufsize)) return NULL;
+  if (fill + len > bufsize) handOff();
+  return buf[cur]+fill;
+}
+
+int cSmileFileWriter::writeAt(long _pos, const void *data, size_t len)
+{
+  if (fh == NULL) return 0;
+  flush();
+  fseek(fh, _pos, SEEK_SET);
+  int ret = writeOut((const char *)data, len);
+  if (!ret) setError();
+  fseek(fh, 0, SEEK_END);
+  if ((long long)_pos + (long long)len > pos) pos = (long long)_pos + (long long)len;
+  return ret;
+}
+
+int cSmileFileWriter::flush()
+{
+  if (fh == NULL) return 0;
+  handOff();
+  waitPending();
+  fflush(fh);
+  return !hasError();
+}
+
+int cSmileFileWriter::close()
+{
+  if (fh == NULL) return 1;
+  flush();
+  if (threadRunning) {
+    smileMutexLock(mtx);
+    stop = 1;
+    smileCondSignalRaw(condWork);
+    smileMutexUnlock(mtx);
+    smileThreadJoin(thread);
+    smileMutexDestroy(mtx);
+    smileCondDestroy(condWork);
+    smileCondDestroy(condDone);
+    threadRunning = 0;
+  }
+  if (fclose(fh) != 0) err = 1;
+  fh = NULL;
+  if (err) SMILE_ERR(1,"error writing to file '%s'! Disk full or read-only filesystem?",filename);
+  if (filename != NULL) { free(filename); filename = NULL; }
+  return !err;
+}
+
+cSmileFileWriter::~cSmileFileWriter()
+{
+  close();
+  if (buf[0] != NULL) free(buf[0]);
+  if (buf[1] != NULL) free(buf[1]);
+}
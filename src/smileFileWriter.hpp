@@ -0,0 +1,116 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  cSmileFileWriter
+    ================
+
+buffered output file for the file sinks:
+
+data is collected in a large user-space buffer and written with one
+fwrite per buffer (the stdio buffer of the file is disabled), thus
+many small per-frame or per-value writes become a few large writes.
+Optionally a background thread writes out full buffers (double
+buffering), so the component's tick does not block on the disk.
+
+Sinks either write() complete blocks, or reserve() space in the buffer,
+fill it (e.g. convert samples directly into the buffer), and commit()
+the number of bytes actually filled.
+
+*/
+
+
+#ifndef __SMILE_FILE_WRITER_HPP
+#define __SMILE_FILE_WRITER_HPP
+
+#include <smileCommon.hpp>
+
+#define SMILE_FILEWRITER_BUFSIZE  (1<<20)   // default buffer size in bytes
+
+class cSmileFileWriter {
+  private:
+    FILE *fh;
+    char *filename;
+    char *buf[2];        // buf[cur] is filled, buf[!cur] is written by the flush thread
+    int cur;
+    size_t bufsize, fill;
+    long long pos;       // logical file position (incl. buffered data)
+    int err;             // set by the flush thread, access under mtx while the thread is running
+
+    // background flush thread
+    int useThread, threadRunning, stop;
+    const char *pending; size_t pendingLen;
+    smileThread thread;
+    smileMutex mtx;
+    smileCond condWork, condDone;
+
+    static SMILE_THREAD_RETVAL threadMain(void *_obj);
+    int writeOut(const char *data, size_t len);
+    void setError();
+    int hasError();
+    int handOff();
+    void waitPending();
+
+  public:
+    cSmileFileWriter(size_t _bufsize=SMILE_FILEWRITER_BUFSIZE, int _flushThread=0);
+
+    // open a file, mode is a fopen mode ("wb", "ab", "w", "a", ...), returns 0 on failure
+    int open(const char *_filename, const char *mode);
+    int isOpen() { return (fh != NULL); }
+    const char * getFilename() { return filename; }
+
+    // append len bytes, returns 0 on failure
+    int write(const void *data, size_t len);
+    // formatted output (like fprintf), returns number of characters written, or -1 on error
+    int printf(const char *fmt, ...);
+
+    /* get a pointer to len bytes of free buffer space (len <= buffer size),
+       the bytes are appended by commit(n) (n <= len) */
+    char * reserve(size_t len);
+    void commit(size_t len) { fill += len; pos += (long long)len; }
+
+    // overwrite data at absolute position _pos (e.g. a header), all buffered data is written first
+    int writeAt(long _pos, const void *data, size_t len);
+    // write all buffered data to the file
+    int flush();
+    // flush and close the file, returns 0 if any write failed
+    int close();
+
+    long long tell() { return pos; }
+    size_t getBufferSize() { return bufsize; }
+    int error() { return hasError(); }
+
+    ~cSmileFileWriter();
+};
+
+
+#endif // __SMILE_FILE_WRITER_HPP
@@ -0,0 +1,793 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ ******************************************************************************E*/
+
+/*
+
+smileNn: dependency free MLP / LSTM inference,
+see smileNn.h for the network model and the file formats
+
+*/
+
+#include <smileNn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/*******************************************************************************************
+ ***********************=====   Kernels   ===== ********************************************
+ *******************************************************************************************/
+
+/* y[r] = W[r] . x for all rows r (x padded to colsPad with zeros), four rows at a time with
+   SMILENN_LANES partial sums each */
+static void nnGemvFloat(const sSmileNnMatrix *m, const float *x, float *y)
+{
+  const int n = m->colsPad;
+  int r = 0, i, l;
+  for (; r+4 <= m->rows; r += 4) {
+    const float *s0 = m->w + (size_t)r*n;
+    const float *s1 = s0 + n, *s2 = s1 + n, *s3 = s2 + n;
+    float a0[SMILENN_LANES], a1[SMILENN_LANES], a2[SMILENN_LANES], a3[SMILENN_LANES];
+    float d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+    for (l=0; l<SMILENN_LANES; l++) { a0[l] = 0; a1[l] = 0; a2[l] = 0; a3[l] = 0; }
+    for (i=0; i<n; i+=SMILENN_LANES) {
+      for (l=0; l<SMILENN_LANES; l++) {
+        float xv = x[i+l];
+        a0[l] += xv * s0[i+l];
+        a1[l] += xv * s1[i+l];
+        a2[l] += xv * s2[i+l];
+        a3[l] += xv * s3[i+l];
+      }
+    }
+    for (l=0; l<SMILENN_LANES; l++) { d0 += a0[l]; d1 += a1[l]; d2 += a2[l]; d3 += a3[l]; }
+    y[r] = d0; y[r+1] = d1; y[r+2] = d2; y[r+3] = d3;
+  }
+  for (; r < m->rows; r++) {
+    const float *s0 = m->w + (size_t)r*n;
+    float a0[SMILENN_LANES];
+    float d0 = 0;
+    for (l=0; l<SMILENN_LANES; l++) a0[l] = 0;
+    for (i=0; i<n; i+=SMILENN_LANES)
+      for (l=0; l<SMILENN_LANES; l++)
+        a0[l] += x[i+l] * s0[i+l];
+    for (l=0; l<SMILENN_LANES; l++) d0 += a0[l];
+    y[r] = d0;
+  }
+}
+
+/* as nnGemvFloat for int8 weights, the row sums are multiplied with the row scales */
+static void nnGemvInt8(const sSmileNnMatrix *m, const float *x, float *y)
+{
+  const int n = m->colsPad;
+  int r = 0, i, l;
+  for (; r+4 <= m->rows; r += 4) {
+    const signed char *s0 = m->q + (size_t)r*n;
+    const signed char *s1 = s0 + n, *s2 = s1 + n, *s3 = s2 + n;
+    float a0[SMILENN_LANES], a1[SMILENN_LANES], a2[SMILENN_LANES], a3[SMILENN_LANES];
+    float d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+    for (l=0; l<SMILENN_LANES; l++) { a0[l] = 0; a1[l] = 0; a2[l] = 0; a3[l] = 0; }
+    for (i=0; i<n; i+=SMILENN_LANES) {
+      for (l=0; l<SMILENN_LANES; l++) {
+        float xv = x[i+l];
+        a0[l] += xv * (float)s0[i+l];
+        a1[l] += xv * (float)s1[i+l];
+        a2[l] += xv * (float)s2[i+l];
+        a3[l] += xv * (float)s3[i+l];
+      }
+    }
+    for (l=0; l<SMILENN_LANES; l++) { d0 += a0[l]; d1 += a1[l]; d2 += a2[l]; d3 += a3[l]; }
+    y[r] = d0 * m->scale[r]; y[r+1] = d1 * m->scale[r+1];
+    y[r+2] = d2 * m->scale[r+2]; y[r+3] = d3 * m->scale[r+3];
+  }
+  for (; r < m->rows; r++) {
+    const signed char *s0 = m->q + (size_t)r*n;
+    float a0[SMILENN_LANES];
+    float d0 = 0;
+    for (l=0; l<SMILENN_LANES; l++) a0[l] = 0;
+    for (i=0; i<n; i+=SMILENN_LANES)
+      for (l=0; l<SMILENN_LANES; l++)
+        a0[l] += x[i+l] * (float)s0[i+l];
+    for (l=0; l<SMILENN_LANES; l++) d0 += a0[l];
+    y[r] = d0 * m->scale[r];
+  }
+}
+
+static void nnGemv(const sSmileNnMatrix *m, const float *x, float *y)
+{
+  if (m->q != NULL) nnGemvInt8(m, x, y);
+  else nnGemvFloat(m, x, y);
+}
+
+static float nnSigmoid(float x)
+{
+  return (float)(1.0 / (1.0 + exp(-x)));
+}
+
+static void nnActivate(float *y, int n, int act)
+{
+  int i;
+  switch (act) {
+    case SMILENN_ACT_SIGMOID:
+      for (i=0; i<n; i++) y[i] = nnSigmoid(y[i]);
+      break;
+    case SMILENN_ACT_TANH:
+      for (i=0; i<n; i++) y[i] = (float)tanh(y[i]);
+      break;
+    case SMILENN_ACT_RELU:
+      for (i=0; i<n; i++) if (y[i] < 0.0f) y[i] = 0.0f;
+      break;
+    case SMILENN_ACT_SOFTMAX: {
+      float mx = y[0];
+      double sum = 0.0;
+      for (i=1; i<n; i++) if (y[i] > mx) mx = y[i];
+      for (i=0; i<n; i++) { y[i] = (float)exp(y[i]-mx); sum += y[i]; }
+      if (sum > 0.0) for (i=0; i<n; i++) y[i] = (float)(y[i]/sum);
+      break;
+    }
+    default: break;
+  }
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Forward pass   ===== ***************************************
+ *******************************************************************************************/
+
+static void nnLstm(sSmileNnLayer *L, const float *x)
+{
+  const int n = (int)L->h.nOut;
+  float *g = L->gates;
+  float *gi = g, *gf = g+n, *gc = g+2*n, *go = g+3*n;
+  float *h = L->out, *c = L->c;
+  const float *p = L->p;
+  int i;
+
+  /* the recurrent part uses h of the previous frame, thus all gates are computed before h is updated */
+  nnGemv(&(L->W), x, g);
+  nnGemv(&(L->U), h, L->gates + 4*n);
+  for (i=0; i<4*n; i++) g[i] += L->gates[4*n+i] + L->b[i];
+
+  for (i=0; i<n; i++) {
+    float ig, fg, og;
+    if (p != NULL) {
+      ig = nnSigmoid(gi[i] + p[i]*c[i]);
+      fg = nnSigmoid(gf[i] + p[n+i]*c[i]);
+      c[i] = fg*c[i] + ig*(float)tanh(gc[i]);
+      og = nnSigmoid(go[i] + p[2*n+i]*c[i]);
+    } else {
+      ig = nnSigmoid(gi[i]);
+      fg = nnSigmoid(gf[i]);
+      c[i] = fg*c[i] + ig*(float)tanh(gc[i]);
+      og = nnSigmoid(go[i]);
+    }
+    h[i] = og*(float)tanh(c[i]);
+  }
+}
+
+const float * smileNn_forward(sSmileNn *nn, const float *x)
+{
+  const float *in = nn->in;
+  int i, k;
+  if (nn->mean != NULL) {
+    for (i=0; i<nn->inputDim; i++) nn->in[i] = (x[i] - nn->mean[i]) * nn->istd[i];
+  } else {
+    for (i=0; i<nn->inputDim; i++) nn->in[i] = x[i];
+  }
+
+  for (k=0; k<nn->nLayers; k++) {
+    sSmileNnLayer *L = nn->layer + k;
+    if (L->h.type == SMILENN_LAYER_LSTM) {
+      nnLstm(L, in);
+    } else {
+      nnGemv(&(L->W), in, L->out);
+      for (i=0; i<(int)L->h.nOut; i++) L->out[i] += L->b[i];
+      nnActivate(L->out, (int)L->h.nOut, (int)L->h.act);
+    }
+    in = L->out;
+  }
+  return in;
+}
+
+void smileNn_reset(sSmileNn *nn)
+{
+  int k;
+  for (k=0; k<nn->nLayers; k++) {
+    sSmileNnLayer *L = nn->layer + k;
+    if (L->h.type == SMILENN_LAYER_LSTM) {
+      memset(L->c, 0, sizeof(float)*L->h.nOut);
+      memset(L->out, 0, sizeof(float)*L->h.nOut);
+    }
+  }
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Network setup   ===== **************************************
+ *******************************************************************************************/
+
+static int nnPad(int n)
+{
+  return (n + SMILENN_LANES-1) / SMILENN_LANES * SMILENN_LANES;
+}
+
+static int nnMatrixInit(sSmileNnMatrix *m, int rows, int cols)
+{
+  m->rows = rows; m->cols = cols; m->colsPad = nnPad(cols);
+  m->w = (float *)calloc(1, sizeof(float)*(size_t)rows*m->colsPad + 1);
+  m->q = NULL; m->scale = NULL;
+  return (m->w != NULL);
+}
+
+static int nnMatrixInitInt8(sSmileNnMatrix *m, int rows, int cols)
+{
+  m->rows = rows; m->cols = cols; m->colsPad = nnPad(cols);
+  m->w = NULL;
+  m->q = (signed char *)calloc(1, (size_t)rows*m->colsPad + 1);
+  m->scale = (float *)calloc(1, sizeof(float)*rows + 1);
+  return ((m->q != NULL)&&(m->scale != NULL));
+}
+
+static void nnMatrixFree(sSmileNnMatrix *m)
+{
+  if (m->w != NULL) free(m->w);
+  if (m->q != NULL) free(m->q);
+  if (m->scale != NULL) free(m->scale);
+  m->w = NULL; m->q = NULL; m->scale = NULL;
+}
+
+static int nnMatrixQuantise(sSmileNnMatrix *m)
+{
+  int r, i;
+  float *w = m->w;
+  if ((w == NULL)||(m->rows == 0)) return 0;
+  if (!nnMatrixInitInt8(m, m->rows, m->cols)) { m->w = w; return 0; }
+  for (r=0; r<m->rows; r++) {
+    const float *s = w + (size_t)r*m->colsPad;
+    float mx = 0.0f;
+    for (i=0; i<m->cols; i++) if (fabs(s[i]) > mx) mx = (float)fabs(s[i]);
+    m->scale[r] = (mx > 0.0f) ? mx / 127.0f : 1.0f;
+    for (i=0; i<m->cols; i++) {
+      long v = (long)floor(s[i] / m->scale[r] + 0.5);
+      if (v > 127) v = 127;
+      if (v < -127) v = -127;
+      m->q[(size_t)r*m->colsPad + i] = (signed char)v;
+    }
+  }
+  free(w);
+  return 1;
+}
+
+/* allocates the matrices and buffers of a layer for the layer header L->h, the weights are zero */
+static int nnLayerInit(sSmileNnLayer *L)
+{
+  int nIn = (int)L->h.nIn, n = (int)L->h.nOut;
+  int int8 = (L->h.wtype == SMILENN_WEIGHT_INT8);
+  int ok;
+  if (L->h.type == SMILENN_LAYER_LSTM) {
+    ok = int8 ? nnMatrixInitInt8(&(L->W), 4*n, nIn) : nnMatrixInit(&(L->W), 4*n, nIn);
+    ok = ok && (int8 ? nnMatrixInitInt8(&(L->U), 4*n, n) : nnMatrixInit(&(L->U), 4*n, n));
+    L->b = (float *)calloc(1, sizeof(float)*4*n);
+    if (L->h.flags & SMILENN_LFLAG_PEEPHOLE) L->p = (float *)calloc(1, sizeof(float)*3*n);
+    L->c = (float *)calloc(1, sizeof(float)*n);
+    L->gates = (float *)calloc(1, sizeof(float)*8*n);  /* W x and U h */
+    ok = ok && (L->b != NULL) && (L->c != NULL) && (L->gates != NULL);
+    ok = ok && ((L->p != NULL)||(!(L->h.flags & SMILENN_LFLAG_PEEPHOLE)));
+  } else {
+    ok = int8 ? nnMatrixInitInt8(&(L->W), n, nIn) : nnMatrixInit(&(L->W), n, nIn);
+    L->b = (float *)calloc(1, sizeof(float)*n);
+    ok = ok && (L->b != NULL);
+  }
+  L->out = (float *)calloc(1, sizeof(float)*nnPad(n));
+  return ok && (L->out != NULL);
+}
+
+static void nnLayerFree(sSmileNnLayer *L)
+{
+  nnMatrixFree(&(L->W));
+  nnMatrixFree(&(L->U));
+  if (L->b != NULL) free(L->b);
+  if (L->p != NULL) free(L->p);
+  if (L->out != NULL) free(L->out);
+  if (L->c != NULL) free(L->c);
+  if (L->gates != NULL) free(L->gates);
+}
+
+void smileNn_free(sSmileNn *nn)
+{
+  int k;
+  if (nn == NULL) return;
+  if (nn->layer != NULL) {
+    for (k=0; k<nn->nLayers; k++) nnLayerFree(nn->layer + k);
+    free(nn->layer);
+  }
+  if (nn->mean != NULL) free(nn->mean);
+  if (nn->istd != NULL) free(nn->istd);
+  if (nn->in != NULL) free(nn->in);
+  free(nn);
+}
+
+static sSmileNn * nnCreate(int inputDim, int nLayers, int norm)
+{
+  sSmileNn *nn = (sSmileNn *)calloc(1, sizeof(sSmileNn));
+  if (nn == NULL) return NULL;
+  nn->inputDim = inputDim;
+  nn->nLayers = nLayers;
+  nn->in = (float *)calloc(1, sizeof(float)*nnPad(inputDim));
+  nn->layer = (sSmileNnLayer *)calloc(1, sizeof(sSmileNnLayer)*(nLayers > 0 ? nLayers : 1));
+  if (norm) {
+    nn->mean = (float *)calloc(1, sizeof(float)*inputDim);
+    nn->istd = (float *)calloc(1, sizeof(float)*inputDim);
+  }
+  if ((nn->in == NULL)||(nn->layer == NULL)||(norm && ((nn->mean == NULL)||(nn->istd == NULL)))) {
+    smileNn_free(nn);
+    return NULL;
+  }
+  return nn;
+}
+
+/* stddev values are stored, the inverse is used at runtime */
+static void nnSetStddev(sSmileNn *nn, const float *sd)
+{
+  int i;
+  for (i=0; i<nn->inputDim; i++) nn->istd[i] = (sd[i] > 0.0f) ? 1.0f/sd[i] : 1.0f;
+}
+
+int smileNn_quantise(sSmileNn *nn)
+{
+  int k, n = 0;
+  for (k=0; k<nn->nLayers; k++) {
+    sSmileNnLayer *L = nn->layer + k;
+    n += nnMatrixQuantise(&(L->W));
+    n += nnMatrixQuantise(&(L->U));
+    if (L->W.q != NULL) L->h.wtype = SMILENN_WEIGHT_INT8;
+  }
+  nn->quantised += n;
+  return n;
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Binary file   ===== ****************************************
+ *******************************************************************************************/
+
+typedef struct {
+  const unsigned char *p;
+  long len, pos;
+} sNnCursor;
+
+/* copy n bytes from the cursor (and skip the padding to 4 bytes), returns 0 at the end of the data */
+static int nnGet(sNnCursor *c, void *dst, long n)
+{
+  long np = (n + 3) & ~3L;
+  if (c->pos + n > c->len) return 0;
+  if (dst != NULL) memcpy(dst, c->p + c->pos, n);
+  c->pos += np;
+  if (c->pos > c->len) c->pos = c->len;
+  return 1;
+}
+
+static int nnGetMatrix(sNnCursor *c, sSmileNnMatrix *m)
+{
+  int r;
+  if (m->q != NULL) {
+    if (!nnGet(c, m->scale, sizeof(float)*m->rows)) return 0;
+    for (r=0; r<m->rows; r++) {
+      if (c->pos + m->cols > c->len) return 0;
+      memcpy(m->q + (size_t)r*m->colsPad, c->p + c->pos, m->cols);
+      c->pos += m->cols;
+    }
+    return 1;
+  }
+  for (r=0; r<m->rows; r++) {
+    if (c->pos + (long)sizeof(float)*m->cols > c->len) return 0;
+    memcpy(m->w + (size_t)r*m->colsPad, c->p + c->pos, sizeof(float)*m->cols);
+    c->pos += sizeof(float)*m->cols;
+  }
+  return 1;
+}
+
+static void nnAlign4(sNnCursor *c)
+{
+  c->pos = (c->pos + 3) & ~3L;
+}
+
+static void nnError(char *err, int errLen, const char *msg, int k)
+{
+  if ((err != NULL)&&(errLen > 0)) {
+    char tmp[256];
+    if (k >= 0) sprintf(tmp, "%.200s (layer %i)", msg, k);
+    else sprintf(tmp, "%.250s", msg);
+    strncpy(err, tmp, errLen-1);
+    err[errLen-1] = 0;
+  }
+}
+
+/* checks the layer dimensions and sets the output dimension, returns 0 if the layers do not match */
+static int nnCheck(sSmileNn *nn, char *err, int errLen)
+{
+  int k, dim = nn->inputDim;
+  for (k=0; k<nn->nLayers; k++) {
+    const sSmileNnLayerHeader *h = &(nn->layer[k].h);
+    if ((int)h->nIn != dim) {
+      nnError(err, errLen, "input dimension of the layer does not match the output dimension of the previous layer", k);
+      return 0;
+    }
+    dim = (int)h->nOut;
+  }
+  nn->outputDim = dim;
+  return 1;
+}
+
+static sSmileNn * nnLoadBinary(const unsigned char *buf, long len, char *err, int errLen)
+{
+  sNnCursor c;
+  sSmileNnHeader h;
+  sSmileNn *nn;
+  int k;
+  c.p = buf; c.len = len; c.pos = 0;
+  if (!nnGet(&c, &h, sizeof(h))) {
+    nnError(err, errLen, "file is truncated", -1);
+    return NULL;
+  }
+  if (h.version != SMILENN_VERSION) {
+    nnError(err, errLen, "unsupported file version", -1);
+    return NULL;
+  }
+  if ((h.inputDim == 0)||(h.nLayers == 0)||(h.inputDim > (1<<24))||(h.nLayers > 4096)) {
+    nnError(err, errLen, "invalid header", -1);
+    return NULL;
+  }
+  nn = nnCreate((int)h.inputDim, (int)h.nLayers, h.flags & SMILENN_FLAG_NORM);
+  if (nn == NULL) {
+    nnError(err, errLen, "out of memory", -1);
+    return NULL;
+  }
+  if (h.flags & SMILENN_FLAG_NORM) {
+    float *sd = (float *)malloc(sizeof(float)*h.inputDim);
+    int ok = (sd != NULL) && nnGet(&c, nn->mean, sizeof(float)*h.inputDim) && nnGet(&c, sd, sizeof(float)*h.inputDim);
+    if (ok) nnSetStddev(nn, sd);
+    if (sd != NULL) free(sd);
+    if (!ok) { nnError(err, errLen, "file is truncated", -1); smileNn_free(nn); return NULL; }
+  }
+  for (k=0; k<nn->nLayers; k++) {
+    sSmileNnLayer *L = nn->layer + k;
+    int n, ok;
+    if (!nnGet(&c, &(L->h), sizeof(L->h))) { nnError(err, errLen, "file is truncated", k); smileNn_free(nn); return NULL; }
+    if ((L->h.type > SMILENN_LAYER_LSTM)||(L->h.act > SMILENN_ACT_SOFTMAX)||(L->h.wtype > SMILENN_WEIGHT_INT8)||
+        (L->h.nIn == 0)||(L->h.nOut == 0)||(L->h.nIn > (1<<24))||(L->h.nOut > (1<<20))) {
+      nnError(err, errLen, "invalid layer header", k);
+      smileNn_free(nn);
+      return NULL;
+    }
+    if (!nnLayerInit(L)) { nnError(err, errLen, "out of memory", k); smileNn_free(nn); return NULL; }
+    n = (int)L->h.nOut;
+    ok = nnGetMatrix(&c, &(L->W));
+    nnAlign4(&c);
+    if (L->h.type == SMILENN_LAYER_LSTM) {
+      ok = ok && nnGetMatrix(&c, &(L->U));
+      nnAlign4(&c);
+      ok = ok && nnGet(&c, L->b, sizeof(float)*4*n);
+      if (L->p != NULL) ok = ok && nnGet(&c, L->p, sizeof(float)*3*n);
+    } else {
+      ok = ok && nnGet(&c, L->b, sizeof(float)*n);
+    }
+    if (L->h.wtype == SMILENN_WEIGHT_INT8) nn->quantised += (L->h.type == SMILENN_LAYER_LSTM) ? 2 : 1;
+    if (!ok) { nnError(err, errLen, "file is truncated", k); smileNn_free(nn); return NULL; }
+  }
+  if (!nnCheck(nn, err, errLen)) { smileNn_free(nn); return NULL; }
+  return nn;
+}
+
+/* padding to 4 bytes after n bytes of data */
+static int nnPutPad(FILE *f, long n)
+{
+  static const char zero[4] = {0,0,0,0};
+  long np = ((n + 3) & ~3L) - n;
+  return (np == 0)||(fwrite(zero, 1, np, f) == (size_t)np);
+}
+
+static int nnPut(FILE *f, const void *src, long n)
+{
+  if ((n > 0)&&(fwrite(src, 1, n, f) != (size_t)n)) return 0;
+  return nnPutPad(f, n);
+}
+
+static int nnPutMatrix(FILE *f, const sSmileNnMatrix *m)
+{
+  int r;
+  long n = 0;
+  if (m->q != NULL) {
+    if (!nnPut(f, m->scale, sizeof(float)*m->rows)) return 0;
+    for (r=0; r<m->rows; r++) {
+      if (fwrite(m->q + (size_t)r*m->colsPad, 1, m->cols, f) != (size_t)m->cols) return 0;
+      n += m->cols;
+    }
+    return nnPutPad(f, n);
+  }
+  for (r=0; r<m->rows; r++) {
+    if (fwrite(m->w + (size_t)r*m->colsPad, sizeof(float), m->cols, f) != (size_t)m->cols) return 0;
+  }
+  return 1;
+}
+
+int smileNn_save(const sSmileNn *nn, const char *filename)
+{
+  sSmileNnHeader h;
+  FILE *f;
+  int k, ok;
+  float *sd = NULL;
+  memset(&h, 0, sizeof(h));
+  strcpy(h.magic, SMILENN_MAGIC);
+  h.version = SMILENN_VERSION;
+  h.flags = (nn->mean != NULL) ? SMILENN_FLAG_NORM : 0;
+  h.inputDim = (uint32_t)nn->inputDim;
+  h.nLayers = (uint32_t)nn->nLayers;
+  f = fopen(filename, "wb");
+  if (f == NULL) return 0;
+  ok = nnPut(f, &h, sizeof(h));
+  if (ok && (nn->mean != NULL)) {
+    int i;
+    sd = (float *)malloc(sizeof(float)*nn->inputDim);
+    ok = (sd != NULL);
+    if (ok) for (i=0; i<nn->inputDim; i++) sd[i] = 1.0f/nn->istd[i];
+    ok = ok && nnPut(f, nn->mean, sizeof(float)*nn->inputDim) && nnPut(f, sd, sizeof(float)*nn->inputDim);
+    if (sd != NULL) free(sd);
+  }
+  for (k=0; (k<nn->nLayers)&&(ok); k++) {
+    const sSmileNnLayer *L = nn->layer + k;
+    int n = (int)L->h.nOut;
+    ok = nnPut(f, &(L->h), sizeof(L->h)) && nnPutMatrix(f, &(L->W));
+    if (L->h.type == SMILENN_LAYER_LSTM) {
+      ok = ok && nnPutMatrix(f, &(L->U)) && nnPut(f, L->b, sizeof(float)*4*n);
+      if (L->p != NULL) ok = ok && nnPut(f, L->p, sizeof(float)*3*n);
+    } else {
+      ok = ok && nnPut(f, L->b, sizeof(float)*n);
+    }
+  }
+  if (fclose(f) != 0) ok = 0;
+  return ok;
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Text file   ===== ******************************************
+ *******************************************************************************************/
+
+/* next whitespace separated token (skipping comments), returns 0 at the end of the file */
+static int nnToken(FILE *f, char *buf, int len)
+{
+  int ch, n = 0;
+  do {
+    ch = fgetc(f);
+    if (ch == '#') {
+      while ((ch != EOF)&&(ch != '\n')) ch = fgetc(f);
+    }
+  } while ((ch != EOF)&&((ch == ' ')||(ch == '\t')||(ch == '\r')||(ch == '\n')));
+  while ((ch != EOF)&&(ch != ' ')&&(ch != '\t')&&(ch != '\r')&&(ch != '\n')&&(ch != '#')) {
+    if (n < len-1) buf[n++] = (char)ch;
+    ch = fgetc(f);
+  }
+  if (ch == '#') ungetc(ch, f);
+  buf[n] = 0;
+  return (n > 0);
+}
+
+static int nnTokenFloats(FILE *f, float *dst, long n)
+{
+  char tok[64];
+  char *end;
+  long i;
+  for (i=0; i<n; i++) {
+    if (!nnToken(f, tok, sizeof(tok))) return 0;
+    dst[i] = (float)strtod(tok, &end);
+    if (*end != 0) return 0;
+  }
+  return 1;
+}
+
+static int nnTokenMatrix(FILE *f, sSmileNnMatrix *m)
+{
+  int r;
+  for (r=0; r<m->rows; r++) {
+    if (!nnTokenFloats(f, m->w + (size_t)r*m->colsPad, m->cols)) return 0;
+  }
+  return 1;
+}
+
+static const char *nnActNames[] = { "linear", "sigmoid", "tanh", "relu", "softmax" };
+
+/* the layers are read into a list of up to nAlloc layers, which is grown as needed */
+static sSmileNn * nnLoadText(FILE *f, char *err, int errLen)
+{
+  char tok[64];
+  int inputDim = 0, norm = 0, nLayers = 0, nAlloc = 16, k, dim, ok = 1;
+  float *mean = NULL, *sd = NULL;
+  sSmileNnLayer *layers;
+  sSmileNn *nn;
+
+  if ((!nnToken(f, tok, sizeof(tok)))||(strcmp(tok, "input"))||(!nnToken(f, tok, sizeof(tok)))||((inputDim = atoi(tok)) <= 0)) {
+    nnError(err, errLen, "text format: 'input <dim>' expected", -1);
+    return NULL;
+  }
+  layers = (sSmileNnLayer *)calloc(1, sizeof(sSmileNnLayer)*nAlloc);
+  if (layers == NULL) { nnError(err, errLen, "out of memory", -1); return NULL; }
+  dim = inputDim;
+  while (ok && nnToken(f, tok, sizeof(tok))) {
+    sSmileNnLayer *L;
+    if (!strcmp(tok, "norm")) {
+      if ((norm)||(nLayers > 0)) { nnError(err, errLen, "text format: 'norm' must follow 'input'", -1); ok = 0; break; }
+      norm = 1;
+      mean = (float *)malloc(sizeof(float)*inputDim);
+      sd = (float *)malloc(sizeof(float)*inputDim);
+      ok = (mean != NULL) && (sd != NULL) && nnTokenFloats(f, mean, inputDim) && nnTokenFloats(f, sd, inputDim);
+      if (!ok) nnError(err, errLen, "text format: error reading 'norm' values", -1);
+      continue;
+    }
+    if (nLayers == nAlloc) {
+      sSmileNnLayer *tmp = (sSmileNnLayer *)realloc(layers, sizeof(sSmileNnLayer)*nAlloc*2);
+      if (tmp == NULL) { nnError(err, errLen, "out of memory", -1); ok = 0; break; }
+      layers = tmp;
+      memset(layers + nAlloc, 0, sizeof(sSmileNnLayer)*nAlloc);
+      nAlloc *= 2;
+    }
+    L = layers + nLayers;
+    L->h.nIn = (uint32_t)dim;
+    if (!strcmp(tok, "dense")) {
+      L->h.type = SMILENN_LAYER_DENSE;
+    } else if (!strcmp(tok, "lstm")) {
+      L->h.type = SMILENN_LAYER_LSTM;
+    } else {
+      nnError(err, errLen, "text format: unknown keyword", nLayers);
+      ok = 0; break;
+    }
+    if ((!nnToken(f, tok, sizeof(tok)))||(atoi(tok) <= 0)) {
+      nnError(err, errLen, "text format: number of outputs expected", nLayers);
+      ok = 0; break;
+    }
+    L->h.nOut = (uint32_t)atoi(tok);
+    if (L->h.type == SMILENN_LAYER_DENSE) {
+      int a;
+      if (!nnToken(f, tok, sizeof(tok))) tok[0] = 0;
+      for (a=0; a<=SMILENN_ACT_SOFTMAX; a++) if (!strcmp(tok, nnActNames[a])) break;
+      if (a > SMILENN_ACT_SOFTMAX) {
+        nnError(err, errLen, "text format: unknown activation function", nLayers);
+        ok = 0; break;
+      }
+      L->h.act = (uint32_t)a;
+    } else {
+      long pos = ftell(f);
+      if (nnToken(f, tok, sizeof(tok)) && (!strcmp(tok, "peephole"))) L->h.flags |= SMILENN_LFLAG_PEEPHOLE;
+      else fseek(f, pos, SEEK_SET);
+    }
+    nLayers++;
+    if (!nnLayerInit(L)) { nnError(err, errLen, "out of memory", nLayers-1); ok = 0; break; }
+    ok = nnTokenMatrix(f, &(L->W));
+    if (L->h.type == SMILENN_LAYER_LSTM) {
+      ok = ok && nnTokenMatrix(f, &(L->U)) && nnTokenFloats(f, L->b, 4*L->h.nOut);
+      if (L->p != NULL) ok = ok && nnTokenFloats(f, L->p, 3*L->h.nOut);
+    } else {
+      ok = ok && nnTokenFloats(f, L->b, L->h.nOut);
+    }
+    if (!ok) nnError(err, errLen, "text format: error reading the weights", nLayers-1);
+    dim = (int)L->h.nOut;
+  }
+  if (ok && (nLayers == 0)) { nnError(err, errLen, "text format: no layers", -1); ok = 0; }
+
+  nn = NULL;
+  if (ok) {
+    nn = nnCreate(inputDim, 0, norm);
+    if (nn == NULL) nnError(err, errLen, "out of memory", -1);
+  }
+  if (nn != NULL) {
+    free(nn->layer);
+    nn->layer = layers;
+    nn->nLayers = nLayers;
+    if (norm) {
+      memcpy(nn->mean, mean, sizeof(float)*inputDim);
+      nnSetStddev(nn, sd);
+    }
+    if (!nnCheck(nn, err, errLen)) { smileNn_free(nn); nn = NULL; }
+  } else {
+    for (k=0; k<nLayers; k++) nnLayerFree(layers + k);
+    free(layers);
+  }
+  if (mean != NULL) free(mean);
+  if (sd != NULL) free(sd);
+  return nn;
+}
+
+
+sSmileNn * smileNn_load(const char *filename, char *err, int errLen)
+{
+  FILE *f;
+  char magic[8];
+  unsigned char *buf;
+  long len;
+  sSmileNn *nn;
+
+  f = fopen(filename, "rb");
+  if (f == NULL) {
+    nnError(err, errLen, "cannot open file", -1);
+    return NULL;
+  }
+  if ((fread(magic, 1, 8, f) != 8)||(memcmp(magic, SMILENN_MAGIC, 8))) {
+    fseek(f, 0, SEEK_SET);
+    nn = nnLoadText(f, err, errLen);
+    fclose(f);
+    return nn;
+  }
+  fseek(f, 0, SEEK_END);
+  len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = (unsigned char *)malloc(len > 0 ? len : 1);
+  if ((buf == NULL)||(fread(buf, 1, len, f) != (size_t)len)) {
+    if (buf != NULL) free(buf);
+    fclose(f);
+    nnError(err, errLen, "error reading file", -1);
+    return NULL;
+  }
+  fclose(f);
+  nn = nnLoadBinary(buf, len, err, errLen);
+  free(buf);
+  return nn;
+}
+
+
+#ifdef SMILENN_MAIN
+int main(int argc, char **argv)
+{
+  char err[256];
+  sSmileNn *nn;
+  int q = 0;
+  if ((argc == 4)&&(!strcmp(argv[3], "-q"))) q = 1;
+  if ((argc != 3)&&(!q)) {
+    fprintf(stderr, "usage: %s <network file (text or binary)> <binary output file> [-q]\n  converts a network to the binary smileNn format, -q quantises the weights to int8\n", argv[0]);
+    return 1;
+  }
+  nn = smileNn_load(argv[1], err, sizeof(err));
+  if (nn == NULL) {
+    fprintf(stderr, "error loading '%s': %s\n", argv[1], err);
+    return 1;
+  }
+  if (q) smileNn_quantise(nn);
+  if (!smileNn_save(nn, argv[2])) {
+    fprintf(stderr, "error writing '%s'\n", argv[2]);
+    smileNn_free(nn);
+    return 1;
+  }
+  printf("%i layers, %i inputs, %i outputs, %i int8 matrices\n", nn->nLayers, nn->inputDim, nn->outputDim, nn->quantised);
+  smileNn_free(nn);
+  return 0;
+}
+#endif
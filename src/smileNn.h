@@ -0,0 +1,196 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ ******************************************************************************E*/
+
+
+/*  smileNn
+    =======
+
+dependency free inference of feed-forward (MLP) and LSTM networks, used by
+the cNnProcessor and cNnSink components.
+
+The network is a stack of layers, each layer gets the output of the previous
+layer (the first one the input vector). All buffers, incl. the LSTM states,
+are allocated when the network is loaded, smileNn_forward does not allocate
+any memory. The weight matrices are multiplied with portable lane blocked
+kernels (SMILENN_LANES partial sums per row, four rows at a time), which the
+compiler maps to SIMD instructions. Weights can be stored (or quantised after
+loading) as int8 values with one float scale per matrix row (4x smaller, the
+products are accumulated in float).
+
+This file has no openSMILE dependencies; compile with -DSMILENN_MAIN to get a
+command line tool which converts the text format to the binary format:
+  cc -O2 -DSMILENN_MAIN -Isrc src/smileNn.c -lm -o smilenn
+
+binary file layout (native byte order, all sections padded to 4 bytes):
+  sSmileNnHeader
+  if (flags & SMILENN_FLAG_NORM): float mean[inputDim], float stddev[inputDim]
+     (input standardisation: x' = (x-mean)/stddev)
+  nLayers times:
+    sSmileNnLayerHeader
+    SMILENN_LAYER_DENSE: matrix W[nOut][nIn], float b[nOut]
+                         y = act(W x + b)
+    SMILENN_LAYER_LSTM:  matrix W[4*nOut][nIn], matrix U[4*nOut][nOut], float b[4*nOut],
+                         if (flags & SMILENN_LFLAG_PEEPHOLE): float p[3*nOut]
+                         the 4 row blocks of W, U, b are the input gate, forget gate,
+                         cell input, and output gate; peepholes p: input, forget, output gate
+                         i = sig(Wi x + Ui h + bi + pi.c)    f = sig(Wf x + Uf h + bf + pf.c)
+                         c = f.c + i.tanh(Wc x + Uc h + bc)  o = sig(Wo x + Uo h + bo + po.c)
+                         h = o.tanh(c)   (act is ignored for LSTM layers)
+  a matrix[rows][cols] is stored as float[rows*cols] (wtype SMILENN_WEIGHT_FLOAT),
+  or as float scale[rows] followed by int8 q[rows*cols] (SMILENN_WEIGHT_INT8, w = q*scale)
+
+text format (whitespace separated tokens, '#' starts a comment up to the end of the line):
+  input <inputDim>
+  [norm <mean x inputDim> <stddev x inputDim>]
+  dense <nOut> <linear|sigmoid|tanh|relu|softmax> <W values> <b values>
+  lstm <nOut> [peephole] <W values> <U values> <b values> [<p values>]
+  (layers repeat, the matrices are given row by row)
+
+*/
+
+
+#ifndef __SMILE_NN_H
+#define __SMILE_NN_H
+
+#if !defined(__SMILE_COMMON_H) && !defined(DLLEXPORT)
+
+#ifdef _MSC_VER // Visual Studio specific macro
+  #ifdef BUILDING_DLL
+    #define DLLEXPORT __declspec(dllexport)
+  #else
+    #define DLLEXPORT __declspec(dllimport)
+  #endif
+#else 
+    #define DLLEXPORT 
+#endif
+
+#endif  // __SMILE_COMMON_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SMILENN_MAGIC    "SMILENN"
+#define SMILENN_VERSION  1
+
+/* header flags */
+#define SMILENN_FLAG_NORM  1   /* input mean and stddev follow the header */
+
+/* layer types */
+#define SMILENN_LAYER_DENSE  0
+#define SMILENN_LAYER_LSTM   1
+
+/* activation functions (dense layers) */
+#define SMILENN_ACT_LINEAR   0
+#define SMILENN_ACT_SIGMOID  1
+#define SMILENN_ACT_TANH     2
+#define SMILENN_ACT_RELU     3
+#define SMILENN_ACT_SOFTMAX  4
+
+/* weight storage */
+#define SMILENN_WEIGHT_FLOAT 0
+#define SMILENN_WEIGHT_INT8  1
+
+/* layer flags */
+#define SMILENN_LFLAG_PEEPHOLE  1
+
+#define SMILENN_LANES 8
+
+typedef struct {
+  char magic[8];           /* SMILENN_MAGIC, 0 terminated */
+  uint32_t version;
+  uint32_t flags;          /* SMILENN_FLAG_* */
+  uint32_t inputDim;
+  uint32_t nLayers;
+} sSmileNnHeader;
+
+typedef struct {
+  uint32_t type;           /* SMILENN_LAYER_* */
+  uint32_t nIn, nOut;
+  uint32_t act;            /* SMILENN_ACT_* */
+  uint32_t wtype;          /* SMILENN_WEIGHT_* */
+  uint32_t flags;          /* SMILENN_LFLAG_* */
+} sSmileNnLayerHeader;
+
+/* weight matrix, the rows are padded to a multiple of SMILENN_LANES (with zeros) */
+typedef struct {
+  int rows, cols, colsPad;
+  float *w;                /* rows x colsPad, or NULL if quantised */
+  signed char *q;          /* int8 weights rows x colsPad */
+  float *scale;            /* scale of each row of q */
+} sSmileNnMatrix;
+
+typedef struct {
+  sSmileNnLayerHeader h;
+  sSmileNnMatrix W, U;     /* U: LSTM only */
+  float *b;
+  float *p;                /* peepholes (LSTM only) or NULL */
+  float *out;              /* output (h of LSTM layers), padded */
+  float *c;                /* LSTM cell state */
+  float *gates;            /* LSTM gate activations, 4*nOut */
+} sSmileNnLayer;
+
+typedef struct {
+  int inputDim, outputDim, nLayers;
+  int quantised;           /* number of int8 matrices */
+  float *mean, *istd;      /* input standardisation (inverse stddev), or NULL */
+  float *in;               /* (standardised) padded input */
+  sSmileNnLayer *layer;
+} sSmileNn;
+
+/* load a network from a binary (or, if it does not start with SMILENN_MAGIC, a text) file,
+   returns NULL on error (with a message in err, if err != NULL, of max. errLen chars) */
+DLLEXPORT sSmileNn * smileNn_load(const char *filename, char *err, int errLen);
+
+/* save the network in the binary format, the int8 matrices are saved as int8, returns 0 on failure */
+DLLEXPORT int smileNn_save(const sSmileNn *nn, const char *filename);
+
+/* quantise all float weight matrices to int8 (one scale per row), returns the number of quantised matrices */
+DLLEXPORT int smileNn_quantise(sSmileNn *nn);
+
+/* clear the state of all recurrent layers (e.g. at the start of a new turn) */
+DLLEXPORT void smileNn_reset(sSmileNn *nn);
+
+/* run the network on the next input vector x (inputDim values), returns the output (outputDim values),
+   which is valid until the next call; the LSTM states are updated */
+DLLEXPORT const float * smileNn_forward(sSmileNn *nn, const float *x);
+
+DLLEXPORT void smileNn_free(sSmileNn *nn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __SMILE_NN_H
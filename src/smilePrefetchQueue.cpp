@@ -0,0 +1,174 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  cSmilePrefetchQueue
+
+asynchronous block input for the sources, see smilePrefetchQueue.hpp
+
+*/
+
+
+#include <smilePrefetchQueue.hpp>
+
+#define MODULE "cSmilePrefetchQueue"
+
+
+cSmilePrefetchQueue::cSmilePrefetchQueue(smilePrefetchReadFunc _readFunc, void *_obj, long N, long _blockSize, int _nBlocks, int _useThread) :
+  readFunc(_readFunc), obj(_obj),
+  blockSize(_blockSize), nBlocks(_nBlocks),
+  head(0), eoi(0),
+  useThread(_useThread), threadRunning(0), stop(0)
+{
+  int i;
+  if (blockSize < 1) blockSize = 1;
+  if (nBlocks < 1) nBlocks = 1;
+  // without the thread one block is enough
+  if (!useThread) nBlocks = 1;
+  block = (cMatrix **)calloc(1, sizeof(cMatrix *)*nBlocks);
+  blockFrames = (long *)malloc(sizeof(long)*nBlocks);
+  if ((block == NULL)||(blockFrames == NULL)) OUT_OF_MEMORY;
+  for (i=0; i<nBlocks; i++) {
+    block[i] = new cMatrix(N, blockSize);
+    blockFrames[i] = -1;
+  }
+}
+
+int cSmilePrefetchQueue::start()
+{
+  if ((!useThread)||(threadRunning)) return threadRunning;
+  smileMutexCreate(mtx);
+  smileCondCreate(condFilled);
+  smileCondCreate(condFree);
+  if (smileThreadCreate(thread, threadMain, this)) {
+    threadRunning = 1;
+  } else {
+    SMILE_WRN(2,"failed to create prefetch thread, reading in the tick function");
+    smileMutexDestroy(mtx);
+    smileCondDestroy(condFilled);
+    smileCondDestroy(condFree);
+  }
+  return threadRunning;
+}
+
+SMILE_THREAD_RETVAL cSmilePrefetchQueue::threadMain(void *_obj)
+{
+  cSmilePrefetchQueue *q = (cSmilePrefetchQueue *)_obj;
+  int k = 0;
+  while (1) {
+    smileMutexLock(q->mtx);
+    while ((q->blockFrames[k] >= 0)&&(!q->stop)) smileCondWaitWMtx(q->condFree, q->mtx);
+    int stop = q->stop;
+    smileMutexUnlock(q->mtx);
+    if (stop) break;
+
+    q->block[k]->nT = q->blockSize;
+    long n = q->readFunc(q->obj, q->block[k]);
+    if (n < 0) n = 0;
+
+    smileMutexLock(q->mtx);
+    q->blockFrames[k] = n;
+    if (n == 0) q->eoi = 1;
+    smileCondSignalRaw(q->condFilled);
+    smileMutexUnlock(q->mtx);
+    if (n == 0) break;  // end of input
+    k = (k+1) % q->nBlocks;
+  }
+  SMILE_THREAD_RET;
+}
+
+cMatrix * cSmilePrefetchQueue::front()
+{
+  long n;
+  if (threadRunning) {
+    smileMutexLock(mtx);
+    while (blockFrames[head] < 0) smileCondWaitWMtx(condFilled, mtx);
+    n = blockFrames[head];
+    smileMutexUnlock(mtx);
+  } else {
+    if (blockFrames[head] < 0) {
+      if (eoi) {
+        n = 0;
+      } else {
+        block[head]->nT = blockSize;
+        n = readFunc(obj, block[head]);
+        if (n < 0) n = 0;
+        if (n == 0) eoi = 1;
+      }
+      blockFrames[head] = n;
+    }
+    n = blockFrames[head];
+  }
+  if (n == 0) return NULL;
+  block[head]->nT = n;
+  return block[head];
+}
+
+void cSmilePrefetchQueue::pop()
+{
+  if (threadRunning) {
+    smileMutexLock(mtx);
+    blockFrames[head] = -1;
+    smileCondSignalRaw(condFree);
+    smileMutexUnlock(mtx);
+  } else {
+    blockFrames[head] = -1;
+  }
+  head = (head+1) % nBlocks;
+}
+
+void cSmilePrefetchQueue::stopThread()
+{
+  if (!threadRunning) return;
+  smileMutexLock(mtx);
+  stop = 1;
+  smileCondSignalRaw(condFree);
+  smileMutexUnlock(mtx);
+  smileThreadJoin(thread);
+  smileMutexDestroy(mtx);
+  smileCondDestroy(condFilled);
+  smileCondDestroy(condFree);
+  threadRunning = 0;
+  // front() returns the blocks already read, then the end of the input
+  eoi = 1;
+}
+
+cSmilePrefetchQueue::~cSmilePrefetchQueue()
+{
+  int i;
+  stopThread();
+  for (i=0; i<nBlocks; i++) {
+    if (block[i] != NULL) delete block[i];
+  }
+  free(block);
+  free(blockFrames);
+}
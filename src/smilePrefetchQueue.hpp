@@ -0,0 +1,101 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*  cSmilePrefetchQueue
+    ===================
+
+asynchronous block input for the sources:
+
+a background thread reads (and converts) the input block by block into a
+bounded queue of matrices ahead of the consumer, so file I/O and parsing
+overlap with the feature computation. The source provides a read function
+which fills one matrix, and in its tick only takes the next ready block from
+the queue (front()), writes it to the data memory and hands it back for
+refilling (pop()).
+
+Without the thread (or if it cannot be created), front() calls the read
+function directly.
+
+*/
+
+
+#ifndef __SMILE_PREFETCH_QUEUE_HPP
+#define __SMILE_PREFETCH_QUEUE_HPP
+
+#include <smileCommon.hpp>
+#include <dataMemory.hpp>
+
+/* reads the next block into m (at most m->nT frames, m->nT is restored before each call),
+   returns the number of frames read, 0 at the end of the input */
+typedef long (*smilePrefetchReadFunc)(void *obj, cMatrix *m);
+
+class cSmilePrefetchQueue {
+  private:
+    smilePrefetchReadFunc readFunc;
+    void *obj;
+    cMatrix **block;
+    long *blockFrames;   // frames in each block, -1 = empty (to be read)
+    long blockSize;
+    int nBlocks;
+    int head;            // next block to return to the consumer
+    int eoi;             // the reader thread has reached the end of the input
+
+    int useThread, threadRunning, stop;
+    smileThread thread;
+    smileMutex mtx;
+    smileCond condFilled, condFree;
+
+    static SMILE_THREAD_RETVAL threadMain(void *_obj);
+
+  public:
+    /* queue of _nBlocks blocks of _blockSize frames with N elements each,
+       _useThread = 0: no prefetching, the blocks are read in front() */
+    cSmilePrefetchQueue(smilePrefetchReadFunc _readFunc, void *_obj, long N, long _blockSize, int _nBlocks=2, int _useThread=1);
+
+    // start the reader thread (call when the source is ready to read), returns 0 if no thread is used
+    int start();
+
+    /* get the next block (its nT is the number of frames read), waits until it is ready,
+       returns NULL at the end of the input; the block is valid until pop() is called */
+    cMatrix * front();
+    // hand the block returned by front() back to the reader
+    void pop();
+
+    // stop the reader thread (e.g. before the input file is closed)
+    void stopThread();
+
+    ~cSmilePrefetchQueue();
+};
+
+
+#endif // __SMILE_PREFETCH_QUEUE_HPP
@@ -40,6 +40,9 @@ and other utility functions
 */
 
 #include <smileUtil.h>
+#include <string.h>
+#include <stdio.h>
+#include <fftXg.h>
 
 
 /*******************************************************************************************
@@ -336,3 +339,722 @@ double * smileDsp_winBlH(long _N, double alpha0, double alpha1, double alpha2, d
   }
   return ret;
 }
+
+
+  /*======= discrete cosine transform (DCT-II) ==========*/
+
+/* Ooura's dct, part of fftsg.c, not exported by fftXg.h */
+void ddct(int n, int isgn, FLOAT_TYPE_FFT *a, int *ip, FLOAT_TYPE_FFT *w);
+
+/* phase pi*(n^2 mod 2N)/N of the Bluestein chirp exp(i*pi*n^2/N), modulo taken in integer arithmetic for precision */
+static double smileDsp_dctChirpPhase(long n, long N)
+{
+  long long n2 = ((long long)n * (long long)n) % (long long)(2*N);
+  return M_PI * (double)n2 / (double)N;
+}
+
+/* fill the nCoeff x N cosine table, each row is generated by a complex rotation in double precision,
+   which is much cheaper than calling cos() for each element (this matters when N changes frequently) */
+static void smileDsp_dctInitCostable(sSmileDspDct *p)
+{
+  long k, m;
+  for (k=0; k<p->nCoeff; k++) {
+    float *row = p->costable + k*p->N;
+    double th = M_PI * (double)(k+p->firstCoeff) / (double)p->N;
+    double cr = cos(th), ci = sin(th);
+    double zr = cos(0.5*th), zi = sin(0.5*th);
+    double t;
+    for (m=0; m<p->N; m++) {
+      row[m] = (float)zr;
+      t = zr*cr - zi*ci;
+      zi = zr*ci + zi*cr;
+      zr = t;
+      if ((m&63)==63) { /* re-anchor the rotation to avoid error accumulation on long inputs */
+        zr = cos(th*((double)m+1.5)); zi = sin(th*((double)m+1.5));
+      }
+    }
+  }
+}
+
+/* estimated cost of the direct method: multiply-adds, the blocked kernel processes 4 of them per instruction */
+static double smileDsp_dctCostDirect(long N, long nCoeff)
+{
+  return (double)N * (double)nCoeff / 4.0;
+}
+
+/* estimated cost of the fft method, including the Bluestein overhead for N != power of 2 */
+static double smileDsp_dctCostFft(long N, long nCoeff)
+{
+  double L;
+  if (smileMath_isPowerOf2(N)) {
+    L = (double)N;
+    return 2.5 * L * log(L)/log(2.0) + 2.0*L;
+  }
+  L = (double)smileMath_ceilToNextPowOf2(2*N-1);
+  /* two complex ffts of length L plus pre/post chirp multiplication */
+  return 2.0 * 5.0 * L * log(L)/log(2.0) / 2.0 + 6.0*L + 4.0*(double)nCoeff;
+}
+
+sSmileDspDct * smileDsp_dctCreate(long N, long firstCoeff, long nCoeff, int method)
+{
+  sSmileDspDct *p;
+  long i;
+
+  if ((N<1)||(nCoeff<1)||(firstCoeff<0)) return NULL;
+  p = (sSmileDspDct *)calloc(1,sizeof(sSmileDspDct));
+  if (p==NULL) return NULL;
+  p->N = N;
+  p->firstCoeff = firstCoeff;
+  p->nCoeff = nCoeff;
+
+  if (method == DCT_AUTO) {
+    /* the fft method needs at least 4 points, the direct method wins for small N or few coefficients */
+    if ((N >= 16)&&(firstCoeff+nCoeff <= N)&&(smileDsp_dctCostFft(N,nCoeff) < smileDsp_dctCostDirect(N,nCoeff))) method = DCT_FFT;
+    else method = DCT_DIRECT;
+  }
+  /* coefficients >= N are aliases, only the direct method computes them */
+  if ((method == DCT_FFT)&&((N < 4)||(firstCoeff+nCoeff > N))) method = DCT_DIRECT;
+  p->method = method;
+
+  if (method == DCT_DIRECT) {
+    p->costable = (float *)malloc(sizeof(float)*N*nCoeff);
+    if (p->costable == NULL) { smileDsp_dctFree(p); return NULL; }
+    smileDsp_dctInitCostable(p);
+    return p;
+  }
+
+  if (smileMath_isPowerOf2(N)) {
+    /* real input, ddct computes all N coefficients in place */
+    p->L = N;
+    p->work = (float *)malloc(sizeof(float)*N);
+    p->ip = (int *)calloc(1,sizeof(int)*(3+(long)sqrt((double)N)));
+    p->w = (float *)calloc(1,sizeof(float)*(N*5/4+2));
+    if ((p->work==NULL)||(p->ip==NULL)||(p->w==NULL)) { smileDsp_dctFree(p); return NULL; }
+    return p;
+  }
+
+  /* Bluestein: the DCT-II is computed from an N-point complex DFT of the reordered input
+     v[m] = in[2m], v[N-1-m] = in[2m+1]  (Makhoul 1980),  C[k] = Re( exp(-i*pi*k/(2N)) * V[k] ),
+     the N-point DFT is evaluated as a circular convolution with the chirp exp(i*pi*n^2/N) of length L */
+  p->L = smileMath_ceilToNextPowOf2(2*N-1);
+  p->work = (float *)malloc(sizeof(float)*2*p->L);
+  p->chirpF = (float *)calloc(1,sizeof(float)*2*p->L);
+  p->preTw = (float *)malloc(sizeof(float)*2*N);
+  p->postTw = (float *)malloc(sizeof(float)*2*nCoeff);
+  p->ip = (int *)calloc(1,sizeof(int)*(3+(long)sqrt((double)p->L)));
+  p->w = (float *)calloc(1,sizeof(float)*(p->L/2+2));
+  if ((p->work==NULL)||(p->chirpF==NULL)||(p->preTw==NULL)||(p->postTw==NULL)||(p->ip==NULL)||(p->w==NULL)) {
+    smileDsp_dctFree(p); return NULL;
+  }
+  for (i=0; i<N; i++) {
+    double ph = smileDsp_dctChirpPhase(i,N);
+    p->preTw[2*i] = (float)cos(ph);
+    p->preTw[2*i+1] = (float)(-sin(ph));
+    p->chirpF[2*i] = (float)cos(ph);
+    p->chirpF[2*i+1] = (float)sin(ph);
+    if (i>0) {
+      p->chirpF[2*(p->L-i)] = (float)cos(ph);
+      p->chirpF[2*(p->L-i)+1] = (float)sin(ph);
+    }
+  }
+  cdft((int)(2*p->L), -1, p->chirpF, p->ip, p->w);
+  for (i=0; i<nCoeff; i++) {
+    long k = i + firstCoeff;
+    double ph = smileDsp_dctChirpPhase(k,N) + M_PI*(double)k/(double)(2*N);
+    p->postTw[2*i] = (float)(cos(ph)/(double)p->L);
+    p->postTw[2*i+1] = (float)(-sin(ph)/(double)p->L);
+  }
+  return p;
+}
+
+/* DCT_DIRECT kernel: 4 coefficient rows per input pass with 4 partial sums each,
+   the independent accumulators let the compiler map the inner loops onto SIMD registers */
+static void smileDsp_dctDirect(const sSmileDspDct *p, const float *in, float *out)
+{
+  long N = p->N;
+  long k=0, m, j;
+  const float *r0, *r1, *r2, *r3;
+
+  for (k=0; k+4 <= p->nCoeff; k+=4) {
+    float a0[4] = {0.0,0.0,0.0,0.0};
+    float a1[4] = {0.0,0.0,0.0,0.0};
+    float a2[4] = {0.0,0.0,0.0,0.0};
+    float a3[4] = {0.0,0.0,0.0,0.0};
+    r0 = p->costable + k*N; r1 = r0+N; r2 = r1+N; r3 = r2+N;
+    for (m=0; m+4 <= N; m+=4) {
+      for (j=0; j<4; j++) {
+        a0[j] += in[m+j]*r0[m+j];
+        a1[j] += in[m+j]*r1[m+j];
+        a2[j] += in[m+j]*r2[m+j];
+        a3[j] += in[m+j]*r3[m+j];
+      }
+    }
+    for (; m<N; m++) {
+      a0[0] += in[m]*r0[m];
+      a1[0] += in[m]*r1[m];
+      a2[0] += in[m]*r2[m];
+      a3[0] += in[m]*r3[m];
+    }
+    out[k]   = (a0[0]+a0[1])+(a0[2]+a0[3]);
+    out[k+1] = (a1[0]+a1[1])+(a1[2]+a1[3]);
+    out[k+2] = (a2[0]+a2[1])+(a2[2]+a2[3]);
+    out[k+3] = (a3[0]+a3[1])+(a3[2]+a3[3]);
+  }
+  for (; k < p->nCoeff; k++) {
+    float a[4] = {0.0,0.0,0.0,0.0};
+    r0 = p->costable + k*N;
+    for (m=0; m+4 <= N; m+=4) {
+      for (j=0; j<4; j++) a[j] += in[m+j]*r0[m+j];
+    }
+    for (; m<N; m++) a[0] += in[m]*r0[m];
+    out[k] = (a[0]+a[1])+(a[2]+a[3]);
+  }
+}
+
+void smileDsp_dct(sSmileDspDct *p, const float *in, float *out)
+{
+  long i, N;
+  float *x;
+  if ((p==NULL)||(in==NULL)||(out==NULL)) return;
+  if (p->method == DCT_DIRECT) {
+    smileDsp_dctDirect(p,in,out);
+    return;
+  }
+
+  N = p->N;
+  x = p->work;
+  if (p->L == N) {
+    memcpy(x, in, sizeof(float)*N);
+    ddct((int)N, -1, x, p->ip, p->w);
+    memcpy(out, x+p->firstCoeff, sizeof(float)*p->nCoeff);
+    return;
+  }
+
+  /* Bluestein: reorder and multiply by the input chirp */
+  for (i=0; 2*i<N; i++) {
+    long m = i;
+    x[2*m] = in[2*i] * p->preTw[2*m];
+    x[2*m+1] = in[2*i] * p->preTw[2*m+1];
+  }
+  for (i=0; 2*i+1<N; i++) {
+    long m = N-1-i;
+    x[2*m] = in[2*i+1] * p->preTw[2*m];
+    x[2*m+1] = in[2*i+1] * p->preTw[2*m+1];
+  }
+  memset(x+2*N, 0, sizeof(float)*2*(p->L-N));
+  cdft((int)(2*p->L), -1, x, p->ip, p->w);
+  for (i=0; i<p->L; i++) {
+    float re = x[2*i]*p->chirpF[2*i] - x[2*i+1]*p->chirpF[2*i+1];
+    float im = x[2*i]*p->chirpF[2*i+1] + x[2*i+1]*p->chirpF[2*i];
+    x[2*i] = re; x[2*i+1] = im;
+  }
+  cdft((int)(2*p->L), 1, x, p->ip, p->w);
+  /* real part of the output chirp times the convolution result */
+  for (i=0; i<p->nCoeff; i++) {
+    long k = i + p->firstCoeff;
+    out[i] = x[2*k]*p->postTw[2*i] - x[2*k+1]*p->postTw[2*i+1];
+  }
+}
+
+void smileDsp_dctFree(sSmileDspDct *p)
+{
+  if (p==NULL) return;
+  if (p->costable != NULL) free(p->costable);
+  if (p->work != NULL) free(p->work);
+  if (p->chirpF != NULL) free(p->chirpF);
+  if (p->preTw != NULL) free(p->preTw);
+  if (p->postTw != NULL) free(p->postTw);
+  if (p->ip != NULL) free(p->ip);
+  if (p->w != NULL) free(p->w);
+  free(p);
+}
+
+  /*======= chroma ==========*/
+
+void smileDsp_chromaFold(const float *in, float *out, long nOctaves, long octaveSize)
+{
+  long i,j;
+  const float *s = in;
+  double sum = 0.0;
+
+  if ((nOctaves < 1)||(octaveSize < 1)) return;
+
+  /* sum up the octaves row by row (contiguous, vectorisable inner loop) */
+  for (i=0; i<octaveSize; i++) out[i] = s[i];
+  for (j=1; j<nOctaves; j++) {
+    s += octaveSize;
+    for (i=0; i<octaveSize; i++) out[i] += s[i];
+  }
+
+  /* normalise to unit length */
+  for (i=0; i<octaveSize; i++) sum += out[i]*out[i];
+  if (sum != 0.0) {
+    double scale = 1.0/sqrt(sum);
+    for (i=0; i<octaveSize; i++) out[i] = (float)(out[i]*scale);
+  }
+}
+
+  /*======= PCM sample conversion ==========*/
+
+/* store (add==0) or add (add!=0) the value of EXPR for t = 0..n-1 to out[t*outStride],
+   EXPR may use the input sample index i = t*stride */
+#define SMILEPCM_LOOP(EXPR) \
+  if (add) { for (t=0; t<n; t++) { i = t*stride; out[t*outStride] += (EXPR); } } \
+  else     { for (t=0; t<n; t++) { i = t*stride; out[t*outStride] = (EXPR); } }
+
+/* convert n samples, starting at in with a stride of 'stride' samples, to (unscaled) float */
+static int smilePcm_fetch(const unsigned char *in, float *out, long n, long stride, long outStride, int nBPS, int nBits, int isFloat, int add)
+{
+  long t, i;
+  switch (nBPS) {
+    case 1: { /* 8-bit PCM is unsigned */
+      const unsigned char *s = in;
+      SMILEPCM_LOOP( (float)((int)s[i] - 128) )
+      break; }
+    case 2: {
+      const short *s = (const short *)in;
+      SMILEPCM_LOOP( (float)s[i] )
+      break; }
+    case 3: { /* 24-bit, 3 bytes, sign is in the most significant byte */
+      const unsigned char *s = in;
+      SMILEPCM_LOOP( (float)( (int)s[3*i] | ((int)s[3*i+1] << 8) | ((int)(signed char)s[3*i+2] << 16) ) )
+      break; }
+    case 4:
+      if (isFloat) {
+        const float *s = (const float *)in;
+        SMILEPCM_LOOP( s[i] )
+      } else if (nBits == 24) { /* 24-bit in the lower 3 bytes of 4 */
+        const int *s = (const int *)in;
+        SMILEPCM_LOOP( (float)( ((int)((unsigned int)s[i] << 8)) >> 8 ) )
+      } else if (nBits == 32) {
+        const int *s = (const int *)in;
+        SMILEPCM_LOOP( (float)s[i] )
+      } else return 0;
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+int smilePcm_toFloat(const void *in, float *out, long nFrames, int nChan, int nBPS, int nBits, int isFloat, int chanSel)
+{
+  const unsigned char *b = (const unsigned char *)in;
+  double scale;
+  long t, nOut;
+  int c;
+
+  if ((nChan < 1)||(nFrames < 0)||(chanSel >= nChan)) return 0;
+
+  if (isFloat) scale = 1.0;
+  else if (nBPS == 1) scale = 1.0/127.0;
+  else if (nBPS == 2) scale = 1.0/32767.0;
+  else if ((nBPS == 3)||(nBits == 24)) scale = 1.0/(32767.0*256.0);
+  else scale = 1.0/(32767.0*32767.0*2.0);
+
+  if (chanSel == SMILEPCM_MIXDOWN) {
+    /* sum up the channels one by one, then scale the mean */
+    for (c=0; c<nChan; c++) {
+      if (!smilePcm_fetch(b + c*nBPS, out, nFrames, nChan, 1, nBPS, nBits, isFloat, c>0)) return 0;
+    }
+    if (nChan > 1) {
+      float fn = (float)nChan;
+      for (t=0; t<nFrames; t++) out[t] = (float)((double)(out[t]/fn) * scale);
+      return 1;
+    }
+    nOut = nFrames;
+  } else if (chanSel >= 0) {
+    if (!smilePcm_fetch(b + chanSel*nBPS, out, nFrames, nChan, 1, nBPS, nBits, isFloat, 0)) return 0;
+    nOut = nFrames;
+  } else {
+    /* all channels: the interleaved input layout is kept */
+    nOut = nFrames*nChan;
+    if (!smilePcm_fetch(b, out, nOut, 1, 1, nBPS, nBits, isFloat, 0)) return 0;
+  }
+
+  if (scale != 1.0) {
+    for (t=0; t<nOut; t++) out[t] = (float)((double)out[t] * scale);
+  }
+  return 1;
+}
+
+
+/* samples per block in smilePcm_fromFloat */
+#define SMILEPCM_BLOCK 256
+
+/* next value of the TPDF dither noise: difference of two uniform random numbers, -1 .. +1 (LSB) */
+static double smilePcm_tpdf(unsigned int *state)
+{
+  unsigned int a, b;
+  *state = *state * 1664525U + 1013904223U;  a = *state >> 8;
+  *state = *state * 1664525U + 1013904223U;  b = *state >> 8;
+  return ((double)a - (double)b) * (1.0/16777216.0);
+}
+
+int smilePcm_fromFloat(const float *in, long frameStride, long chanStride, void *out, long nFrames, int nChan, int nBPS, int nBits, int isFloat, unsigned int *ditherState)
+{
+  unsigned char *b = (unsigned char *)out;
+  double scale, lo, hi;
+  double y[SMILEPCM_BLOCK];
+  long t, t0, n, k;
+  int c;
+
+  if ((nChan < 1)||(nFrames < 0)) return 0;
+
+  if (isFloat) {
+    float *o = (float *)out;
+    if (nBPS != 4) return 0;
+    for (c=0; c<nChan; c++) {
+      const float *x = in + c*chanStride;
+      for (t=0; t<nFrames; t++) o[t*nChan+c] = x[t*frameStride];
+    }
+    return 1;
+  }
+
+  if (nBPS == 1) { scale = 127.0; lo = -128.0; hi = 127.0; }
+  else if (nBPS == 2) { scale = 32767.0; lo = -32768.0; hi = 32767.0; }
+  else if ((nBPS == 3)||((nBPS == 4)&&(nBits == 24))) { scale = 32767.0*256.0; lo = -8388608.0; hi = 8388607.0; }
+  else if ((nBPS == 4)&&(nBits == 32)) { scale = 32767.0*32767.0*2.0; lo = -2147483648.0; hi = 2147483647.0; }
+  else return 0;
+
+  /* one channel at a time, in blocks: scale, saturate, and round in a contiguous (vectorisable) buffer, then store */
+  for (c=0; c<nChan; c++) {
+    const float *x = in + c*chanStride;
+    for (t0=0; t0<nFrames; t0+=SMILEPCM_BLOCK) {
+      n = nFrames - t0;
+      if (n > SMILEPCM_BLOCK) n = SMILEPCM_BLOCK;
+      for (k=0; k<n; k++) y[k] = (double)x[(t0+k)*frameStride] * scale;
+      if (ditherState != NULL) {
+        for (k=0; k<n; k++) y[k] += smilePcm_tpdf(ditherState);
+      }
+      for (k=0; k<n; k++) {
+        double v = y[k] < lo ? lo : (y[k] > hi ? hi : y[k]);
+        y[k] = v >= 0.0 ? v + 0.5 : v - 0.5;  /* round half away from zero by truncation below */
+      }
+      switch (nBPS) {
+        case 1: {
+          unsigned char *o = b + c;
+          for (k=0; k<n; k++) o[(t0+k)*nChan] = (unsigned char)((int)y[k] + 128);
+          break; }
+        case 2: {
+          short *o = (short *)b + c;
+          for (k=0; k<n; k++) o[(t0+k)*nChan] = (short)y[k];
+          break; }
+        case 3: {
+          unsigned char *o = b + 3*c;
+          for (k=0; k<n; k++) {
+            int v = (int)y[k];
+            unsigned char *p = o + 3*(t0+k)*nChan;
+            p[0] = (unsigned char)(v & 0xFF);
+            p[1] = (unsigned char)((v >> 8) & 0xFF);
+            p[2] = (unsigned char)((v >> 16) & 0xFF);
+          }
+          break; }
+        default: {
+          int *o = (int *)b + c;
+          for (k=0; k<n; k++) o[(t0+k)*nChan] = (int)y[k];
+          break; }
+      }
+    }
+  }
+  return 1;
+}
+
+void smilePcm_remapChannels(const float *in, int nChanIn, float *out, int nChanOut, long nFrames, int mixdown)
+{
+  long t;
+  int c;
+  if (mixdown) {
+    for (t=0; t<nFrames; t++) {
+      float s = 0.0f;
+      for (c=0; c<nChanIn; c++) s += in[t*nChanIn+c];
+      for (c=0; c<nChanOut; c++) out[t*nChanOut+c] = s;
+    }
+  } else if (nChanIn == nChanOut) {
+    memcpy(out, in, sizeof(float)*nFrames*nChanIn);
+  } else {
+    int nc = nChanIn < nChanOut ? nChanIn : nChanOut;
+    for (t=0; t<nFrames; t++) {
+      for (c=0; c<nc; c++) out[t*nChanOut+c] = in[t*nChanIn+c];
+      for (; c<nChanOut; c++) out[t*nChanOut+c] = 0.0f;
+    }
+  }
+}
+
+
+/*******************************************************************************************
+ ***********************=====   Number formatting   ===== ***********************************
+ *******************************************************************************************/
+
+/* powers of 10, exact up to 1e22 and correctly rounded beyond */
+static const double smileUtil_pow10tab[64] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+  1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22, 1e23,
+  1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31,
+  1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38, 1e39,
+  1e40, 1e41, 1e42, 1e43, 1e44, 1e45, 1e46, 1e47,
+  1e48, 1e49, 1e50, 1e51, 1e52, 1e53, 1e54, 1e55,
+  1e56, 1e57, 1e58, 1e59, 1e60, 1e61, 1e62, 1e63
+};
+
+/* x * 10^n for -63 <= n <= 63, with a single rounding */
+static double smileUtil_scale10(double x, int n)
+{
+  if (n >= 0) return x * smileUtil_pow10tab[n];
+  return x / smileUtil_pow10tab[-n];
+}
+
+/* 1 if D * 10^e equals v exactly (D > 0, v > 0) */
+static int smileUtil_decimalEquals(long long D, int e, double v)
+{
+  long long N, P5 = 1;
+  int B, t = 0, i;
+  /* v = N * 2^B with odd N, D = D * 2^t with odd D */
+  N = (long long)ldexp(frexp(v, &B), 53); B -= 53;
+  while (!(N & 1)) { N >>= 1; B++; }
+  while (!(D & 1)) { D >>= 1; t++; }
+  /* odd parts have to match: D * 5^e == N for e >= 0, D == N * 5^-e for e < 0 */
+  if ((e > 13)||(e < -13)) return 0;
+  for (i=0; i<(e<0?-e:e); i++) P5 *= 5;
+  if (e >= 0) return (D * P5 == N)&&(t + e == B);
+  if (N >= 1000000000) return 0;
+  return (D == N * P5)&&(t == B - e);
+}
+
+/* print the nDig digits of D (leading zeros included) to buf */
+static void smileUtil_printDigits(char *buf, long long D, int nDig)
+{
+  int i;
+  for (i=nDig-1; i>=0; i--) { buf[i] = (char)('0' + (int)(D % 10)); D /= 10; }
+}
+
+/* print exponent k as printf does for %e (sign and at least two digits), returns the number of characters */
+static int smileUtil_printExponent(char *buf, int k)
+{
+  int n = 0;
+  buf[n++] = 'e';
+  if (k < 0) { buf[n++] = '-'; k = -k; }
+  else buf[n++] = '+';
+  if (k >= 100) { buf[n++] = (char)('0' + k/100); k %= 100; }
+  buf[n++] = (char)('0' + k/10);
+  buf[n++] = (char)('0' + k%10);
+  return n;
+}
+
+int smileUtil_formatLong(char *buf, long x)
+{
+  char tmp[24];
+  int n = 0, i = 0;
+  unsigned long u = (unsigned long)x;
+  if (x < 0) { buf[n++] = '-'; u = 0UL - u; }
+  do { tmp[i++] = (char)('0' + (int)(u % 10)); u /= 10; } while (u > 0);
+  while (i > 0) buf[n++] = tmp[--i];
+  buf[n] = 0;
+  return n;
+}
+
+int smileUtil_formatFloat(char *buf, float x, int precision)
+{
+  unsigned int u;
+  int n = 0, neg, k, e2, p;
+  double ax, s, f, r;
+  long long D;
+
+  memcpy(&u, &x, sizeof(u));
+  neg = (int)(u >> 31);
+  u &= 0x7FFFFFFF;
+  if (neg) buf[n++] = '-';
+
+  /* special values */
+  if (u >= 0x7F800000) {
+    if (u > 0x7F800000) memcpy(buf+n, "nan", 4);
+    else memcpy(buf+n, "inf", 4);
+    return n+3;
+  }
+
+  if (precision > 0) {
+    if (precision > 15) {
+      /* beyond the precision of the fast path, let printf do the exact conversion */
+      return sprintf(buf, "%.*e", (precision > 17 ? 16 : precision-1), (double)x);
+    }
+    p = precision;
+    if (u == 0) { D = 0; k = 0; }
+    else {
+      ax = neg ? -(double)x : (double)x;
+      /* decimal exponent of the first significant digit */
+      frexp(ax, &e2);
+      k = (int)floor((double)(e2-1) * 0.30102999566398120);
+      s = smileUtil_scale10(ax, p-1-k);
+      if (s >= smileUtil_pow10tab[p]) { k++; s = smileUtil_scale10(ax, p-1-k); }
+      else if (s < smileUtil_pow10tab[p-1]) { k--; s = smileUtil_scale10(ax, p-1-k); }
+      f = floor(s); r = s - f;
+      if (fabs(r - 0.5) < s * 1e-15) {
+        /* too close to a rounding tie for the double precision estimate, use the exact conversion */
+        return n + sprintf(buf+n, "%.*e", p-1, ax);
+      }
+      D = (long long)f + (r > 0.5 ? 1 : 0);
+      if (D >= (long long)smileUtil_pow10tab[p]) { D /= 10; k++; }
+    }
+    /* digits behind the first one are shifted by one for the decimal point */
+    smileUtil_printDigits(buf+n+1, D, p);
+    buf[n] = buf[n+1];
+    if (p > 1) {
+      buf[n+1] = '.';
+      n += p+1;
+    } else n++;
+    n += smileUtil_printExponent(buf+n, k);
+    buf[n] = 0;
+    return n;
+
+  } else {
+    double lo, hi, margin;
+    float fl, fh;
+    unsigned int ul, uh;
+
+    if (u == 0) { buf[n++] = '0'; buf[n] = 0; return n; }
+    ax = neg ? -(double)x : (double)x;
+
+    /* interval of values that round to x: midpoints to the neighbouring floats */
+    ul = u - 1; uh = u + 1;
+    memcpy(&fl, &ul, sizeof(fl));
+    memcpy(&fh, &uh, sizeof(fh));
+    lo = ((double)fl + ax) * 0.5;
+    if (uh >= 0x7F800000) hi = ax + (ax - (double)fl) * 0.5;  /* largest float, above hi values round to inf */
+    else hi = ((double)fh + ax) * 0.5;
+    margin = ax * 1e-15;
+
+    /* 9 significant digits, these always identify a float uniquely */
+    frexp(ax, &e2);
+    k = (int)floor((double)(e2-1) * 0.30102999566398120);
+    s = smileUtil_scale10(ax, 8-k);
+    if (s >= 1e9) { k++; s = smileUtil_scale10(ax, 8-k); }
+    else if (s < 1e8) { k--; s = smileUtil_scale10(ax, 8-k); }
+
+    /* binary search for the smallest number of digits that still reads back as x
+       (if a p digit value does, the same value with p+1 digits does as well).
+       If any p digit value lies in the interval, the value below or above x at p digits does,
+       as the interval contains x, so these two candidates are tested (the closer one first).
+       The interval bounds themselves read back as x for an even mantissa (round half to even) */
+    {
+      int pLo = 1, pHi = 9, kp;
+      long long Dp, Dc[2];
+      double y, sp;
+      int c;
+      D = (long long)floor(s + 0.5);
+      kp = k;
+      if (D >= 1000000000) { D /= 10; kp++; }
+      while (pLo < pHi) {
+        int pm = (pLo + pHi) / 2;
+        int km, found = 0;
+        sp = s / smileUtil_pow10tab[9-pm];
+        Dc[0] = (long long)floor(sp + 0.5);
+        Dc[1] = (Dc[0] > (long long)floor(sp)) ? Dc[0]-1 : Dc[0]+1;
+        for (c=0; (c<2)&&(!found); c++) {
+          Dp = Dc[c]; km = k;
+          if (Dp >= (long long)smileUtil_pow10tab[pm]) { Dp /= 10; km++; }
+          y = smileUtil_scale10((double)Dp, km-pm+1);
+          if (((y > lo + margin)&&(y < hi - margin))
+              || (!(u & 1)&&(smileUtil_decimalEquals(Dp, km-pm+1, lo)||smileUtil_decimalEquals(Dp, km-pm+1, hi)))) {
+            found = 1; D = Dp; kp = km;
+          }
+        }
+        if (found) pHi = pm;
+        else pLo = pm + 1;
+      }
+      p = pHi; k = kp;
+    }
+    /* strip trailing zeros */
+    while ((p > 1)&&(D % 10 == 0)) { D /= 10; p--; }
+
+    if ((k >= -5)&&(k < 9)) {
+      /* fixed point notation */
+      if (k < 0) {
+        buf[n++] = '0'; buf[n++] = '.';
+        memset(buf+n, '0', -k-1); n += -k-1;
+        smileUtil_printDigits(buf+n, D, p); n += p;
+      } else if (k+1 >= p) {
+        smileUtil_printDigits(buf+n, D, p); n += p;
+        memset(buf+n, '0', k+1-p); n += k+1-p;
+      } else {
+        smileUtil_printDigits(buf+n, D, p);
+        memmove(buf+n+k+2, buf+n+k+1, p-k-1);
+        buf[n+k+1] = '.';
+        n += p+1;
+      }
+    } else {
+      /* exponent notation */
+      smileUtil_printDigits(buf+n, D, p);
+      if (p > 1) {
+        memmove(buf+n+2, buf+n+1, p-1);
+        buf[n+1] = '.';
+        n += p+1;
+      } else n++;
+      n += smileUtil_printExponent(buf+n, k);
+    }
+    buf[n] = 0;
+    return n;
+  }
+}
+
+double smileUtil_parseDouble(const char *s, const char **end)
+{
+  const char *p = s;
+  unsigned long long m = 0;
+  int nDig = 0, e = 0, neg = 0, any = 0;
+  double v;
+
+  while ((*p == ' ')||(*p == '\t')) p++;
+  if (*p == '-') { neg = 1; p++; }
+  else if (*p == '+') p++;
+
+  /* mantissa: up to 19 significant digits fit into 64 bits */
+  while (*p == '0') { p++; any = 1; }
+  while ((*p >= '0')&&(*p <= '9')) {
+    if (nDig < 19) { m = m*10 + (unsigned long long)(*p - '0'); nDig++; }
+    else goto slow;
+    p++; any = 1;
+  }
+  if (*p == '.') {
+    p++;
+    if (nDig == 0) { while (*p == '0') { p++; e--; any = 1; } }
+    while ((*p >= '0')&&(*p <= '9')) {
+      if (nDig < 19) { m = m*10 + (unsigned long long)(*p - '0'); nDig++; e--; }
+      else goto slow;
+      p++; any = 1;
+    }
+  }
+  if (!any) goto slow;  /* no digits: inf, nan, hex, or no number at all */
+  if ((*p == 'e')||(*p == 'E')) {
+    const char *q = p+1;
+    int eneg = 0, ex = 0;
+    if (*q == '-') { eneg = 1; q++; }
+    else if (*q == '+') q++;
+    if ((*q >= '0')&&(*q <= '9')) {
+      while ((*q >= '0')&&(*q <= '9')) {
+        if (ex < 10000) ex = ex*10 + (*q - '0');
+        q++;
+      }
+      e += eneg ? -ex : ex;
+      p = q;
+    }
+  }
+
+  /* exact if the mantissa fits into a double and 10^|e| is exact: a single correctly rounded operation */
+  if (m == 0) v = 0.0;
+  else if ((m <= (1ULL<<53))&&(e >= -22)&&(e <= 22)) {
+    if (e >= 0) v = (double)m * smileUtil_pow10tab[e];
+    else v = (double)m / smileUtil_pow10tab[-e];
+  } else goto slow;
+
+  if (end != NULL) *end = p;
+  return neg ? -v : v;
+
+slow:
+  {
+    char *ep = NULL;
+    v = strtod(s, &ep);
+    if (end != NULL) *end = ep;
+    return v;
+  }
+}
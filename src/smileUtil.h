@@ -189,6 +189,104 @@ DLLEXPORT double * smileDsp_winBaH(long _N, double alpha0, double alpha1, double
 /* Blackman-Harris window */
 DLLEXPORT double * smileDsp_winBlH(long _N, double alpha0, double alpha1, double alpha2, double alpha3);
 
+
+  /***** discrete cosine transform (DCT-II) *****/
+
+/* computation methods for smileDsp_dctCreate */
+#define DCT_AUTO    0   /* choose the cheaper of DCT_DIRECT and DCT_FFT from N and nCoeff */
+#define DCT_DIRECT  1   /* blocked matrix-vector product with a precomputed cosine table */
+#define DCT_FFT     2   /* fft based: ddct for N = power of 2, Bluestein chirp-z fft otherwise */
+
+/* DCT-II plan, computes the unscaled coefficients
+     C[k] = sum_m=0^N-1 in[m]*cos(pi*k*(m+0.5)/N), k = firstCoeff .. firstCoeff+nCoeff-1
+   a plan holds its own work area, thus it must not be shared between threads */
+typedef struct {
+  long N;            /* number of input values */
+  long firstCoeff;   /* index of first coefficient to compute */
+  long nCoeff;       /* number of coefficients to compute */
+  int method;        /* DCT_DIRECT or DCT_FFT (DCT_AUTO is resolved at plan creation) */
+  float *costable;   /* DCT_DIRECT: nCoeff x N cosine table, row-major */
+  long L;            /* DCT_FFT: fft length (N if N is a power of 2, else complex Bluestein length >= 2N-1) */
+  float *work;       /* DCT_FFT: fft work buffer */
+  float *chirpF;     /* DCT_FFT, Bluestein: fft of the chirp filter (L complex values) */
+  float *preTw;      /* DCT_FFT, Bluestein: complex input chirp (N values) */
+  float *postTw;     /* DCT_FFT, Bluestein: complex output chirp incl. DCT twiddle and 1/L (nCoeff values) */
+  int *ip;           /* DCT_FFT: fft bit reversal work area */
+  float *w;          /* DCT_FFT: fft cos/sin table */
+} sSmileDspDct;
+
+/* create a DCT-II plan for N inputs and nCoeff output coefficients starting at firstCoeff,
+   method is one of DCT_AUTO, DCT_DIRECT, DCT_FFT; returns NULL on invalid parameters or out of memory */
+DLLEXPORT sSmileDspDct * smileDsp_dctCreate(long N, long firstCoeff, long nCoeff, int method);
+
+/* compute the DCT-II of in[0..N-1] (unscaled, see sSmileDspDct) and store nCoeff values in out */
+DLLEXPORT void smileDsp_dct(sSmileDspDct *p, const float *in, float *out);
+
+/* free a plan created by smileDsp_dctCreate */
+DLLEXPORT void smileDsp_dctFree(sSmileDspDct *p);
+
+
+  /***** chroma *****/
+
+/* fold a spectrum of nOctaves*octaveSize semi-tone bins to one octave (out[i] = sum over octaves of in[o*octaveSize+i])
+   and normalise out[0..octaveSize-1] to unit euclidean length (unless all values are 0) */
+DLLEXPORT void smileDsp_chromaFold(const float *in, float *out, long nOctaves, long octaveSize);
+
+
+/*******************************************************************************************
+ ***********************=====   PCM sample conversion   ===== *******************************
+ *******************************************************************************************/
+
+/* channel selection for smilePcm_toFloat */
+#define SMILEPCM_ALLCHANNELS  -1   /* all channels, interleaved (out[t*nChan+c]) */
+#define SMILEPCM_MIXDOWN      -2   /* mean of all channels (out[t]) */
+
+/* convert nFrames sample frames of interleaved little endian PCM data with nChan channels to float
+     nBPS:    bytes per sample (1 = unsigned 8-bit, 2 = 16-bit, 3 = 24-bit, 4 = 32-bit, 24-bit in 4 bytes, or float)
+     nBits:   bits per sample (precision)
+     isFloat: 1 = IEEE float samples (nBPS = 4)
+     chanSel: SMILEPCM_ALLCHANNELS, SMILEPCM_MIXDOWN, or the index of the one channel to return (out[t])
+   integer samples are scaled to -1..+1 (divided by 127, 32767, 32767*256, or 2*32767^2)
+   returns 0 if the sample format is not supported, 1 otherwise */
+DLLEXPORT int smilePcm_toFloat(const void *in, float *out, long nFrames, int nChan, int nBPS, int nBits, int isFloat, int chanSel);
+
+/* convert nFrames sample frames of float samples to interleaved little endian PCM data with nChan channels,
+   the inverse of smilePcm_toFloat (same sample formats and scaling, 8-bit output is unsigned)
+     in:          sample c of frame t is read from in[t*frameStride + c*chanStride]
+                  (interleaved input: frameStride = nChan, chanStride = 1; one block per channel: frameStride = 1, chanStride = block length)
+     ditherState: NULL = round to the nearest integer, else add triangular (TPDF) dither noise of +-1 LSB before rounding,
+                  *ditherState is the state of the noise generator (initialise with any seed, it is updated)
+   integer samples are saturated to the range of the output format, float samples are copied unchanged
+   returns 0 if the sample format is not supported, 1 otherwise */
+DLLEXPORT int smilePcm_fromFloat(const float *in, long frameStride, long chanStride, void *out, long nFrames, int nChan, int nBPS, int nBits, int isFloat, unsigned int *ditherState);
+
+/* copy nFrames frames of interleaved float samples with nChanIn channels to nChanOut interleaved channels,
+   input channels >= nChanOut are dropped, output channels >= nChanIn are set to 0,
+   mixdown = 1: each output channel is the sum of all input channels */
+DLLEXPORT void smilePcm_remapChannels(const float *in, int nChanIn, float *out, int nChanOut, long nFrames, int mixdown);
+
+
+/*******************************************************************************************
+ ***********************=====   Number formatting   ===== ***********************************
+ *******************************************************************************************/
+
+/* buffer size required by smileUtil_formatFloat and smileUtil_formatLong (incl. terminating 0) */
+#define SMILEUTIL_NUMSTR_MAX  32
+
+/* format x as text into buf (at least SMILEUTIL_NUMSTR_MAX bytes), returns the number of characters written (w/o terminating 0)
+     precision > 0:  precision significant digits in exponent notation, same output as printf("%.<precision-1>e",x)
+     precision <= 0: the shortest text that reads back as exactly x (e.g. with strtof/atof), in fixed point notation
+                     for 1e-5 <= |x| < 1e9, and in exponent notation (as printf "%e") otherwise */
+DLLEXPORT int smileUtil_formatFloat(char *buf, float x, int precision);
+
+/* format the integer x as text into buf (same output as printf("%ld",x)), returns the number of characters written */
+DLLEXPORT int smileUtil_formatLong(char *buf, long x);
+
+/* parse a decimal floating point number at s (like strtod, same result), *end is set to the first character after the number,
+   or to s if no number was found; numbers with up to 19 digits and decimal exponents within +-22 are converted
+   without calling strtod */
+DLLEXPORT double smileUtil_parseDouble(const char *s, const char **end);
+
 #ifdef __cplusplus
 }
 #endif
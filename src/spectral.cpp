@@ -39,6 +39,7 @@ compute spectral features such as flux, roll-off, centroid, etc.
 
 
 #include <spectral.hpp>
+#include <componentManager.hpp>
 #include <math.h>
 
 #define MODULE "cSpectral"
@@ -173,6 +174,47 @@ void cSpectral::fetchConfig()
 }
 
 
+int cSpectral::isOutputNeeded(const sDeadOutputInfo *pr, const char *suffix)
+{
+  int i, need=0;
+  for (i=0; (i<reader->getLevelNf())&&(!need); i++) {
+    char *xx = myvprint("%s_%s",reader->getFieldName(i),suffix);
+    need = pr->isNeeded(xx);
+    free(xx);
+  }
+  return need;
+}
+
+// dead output elimination: do not compute the bands, roll-off points and other features which are not consumed
+int cSpectral::dataProcessorCustomFinalise()
+{
+  const sDeadOutputInfo *pr = getCompMan()->getPrunedLevel(writer->getLevelName());
+  if (pr != NULL) {
+    int ii, n=0;
+    char *xx;
+    for (ii=0; ii<nBands; ii++) {
+      if (isBandValid(bandsL[ii],bandsH[ii])) {
+        xx = myvprint("fband%i-%i",bandsL[ii],bandsH[ii]);
+        if (!isOutputNeeded(pr,xx)) { bandsL[ii] = -1; bandsH[ii] = -1; }
+        free(xx);
+      }
+    }
+    // the roll-off points are computed in one pass over the spectrum, and depend on the number of roll-off points,
+    // so they are only removed if none of them is consumed
+    for (ii=0; ii<nRollOff; ii++) {
+      xx = myvprint("spectralRollOff%.1f",rollOff[ii]*100.0);
+      if (isOutputNeeded(pr,xx)) n++;
+      free(xx);
+    }
+    if (n == 0) nRollOff = 0;
+    if ((flux)&&(!isOutputNeeded(pr,"spectralFlux"))) flux = 0;
+    if ((centroid)&&(!isOutputNeeded(pr,"spectralCentroid"))) centroid = 0;
+    if ((maxPos)&&(!isOutputNeeded(pr,"spectralMaxPos"))) maxPos = 0;
+    if ((minPos)&&(!isOutputNeeded(pr,"spectralMinPos"))) minPos = 0;
+  }
+  return cVectorProcessor::dataProcessorCustomFinalise();
+}
+
 int cSpectral::setupNamesForField(int i, const char*name, long nEl)
 {
   int newNEl = 0;
@@ -60,11 +60,14 @@ class cSpectral : public cVectorProcessor {
       if ((start>=0)&&(end>0)) return 1;
       else return 0;
     }
+    // 1 if the output "<field>_<suffix>" of any input field is consumed (dead output elimination)
+    int isOutputNeeded(const sDeadOutputInfo *pr, const char *suffix);
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
 
     virtual void fetchConfig();
+    virtual int dataProcessorCustomFinalise();
 
     virtual int setupNamesForField(int i, const char*name, long nEl);
     virtual int processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi);
@@ -0,0 +1,130 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+/*
+
+svm-compile: compiles a LibSVM text model, its scale file, class map, and feature selection
+into one binary model file, which cLibsvmLiveSink loads (memory mapped) without parsing
+
+*/
+
+#include <smileCommon.hpp>
+
+#include <commandlineParser.hpp>
+#include <libsvmliveSink.hpp>
+
+#define MODULE "svm-compile"
+
+
+int main(int argc, char *argv[])
+{
+  try {
+
+    // set up the smile logger
+    LOGGER.setLogLevel(1);
+    LOGGER.enableConsoleOutput();
+
+    cCommandlineParser cmdline(argc,argv,"svm-compile");
+    cmdline.addStr( "model", 'm', "LibSVM model file (text format) to compile", NULL );
+    cmdline.addStr( "scale", 's', "LibSVM scale file to include", NULL );
+    cmdline.addStr( "classes", 'c', "class name lookup file to include", NULL );
+    cmdline.addStr( "fselection", 'f', "feature selection file to include", NULL );
+    cmdline.addStr( "output", 'o', "binary model file to write", "svm.bmodel" );
+    cmdline.addInt( "loglevel", 'l', "Verbosity level (0-9)", 2 );
+
+    if (cmdline.doParse() == -1) return -1;
+    LOGGER.setLogFile((const char *)NULL,0,1);
+    LOGGER.setLogLevel(cmdline.getInt("loglevel"));
+
+    if (!cmdline.isSet("model")) {
+      SMILE_ERR(0,"no model file given! Please run ' svm-compile -h ' to see some usage information!");
+      return EXIT_ERROR;
+    }
+    const char *modelfile = cmdline.getStr("model");
+    const char *output = cmdline.getStr("output");
+
+    struct svm_model *model = svm_load_model(modelfile);
+    if (model == NULL) {
+      SMILE_ERR(0,"can't open libSVM model file '%s'",modelfile);
+      return EXIT_ERROR;
+    }
+
+    struct svm_scale *scale = NULL;
+    if (cmdline.isSet("scale")) {
+      scale = svm_load_scale(cmdline.getStr("scale"));
+      if (scale == NULL) {
+        SMILE_ERR(0,"can't open libSVM scale file '%s'",cmdline.getStr("scale"));
+        svm_destroy_model(model);
+        return EXIT_ERROR;
+      }
+    }
+
+    long nCls = 0;
+    char **classNames = NULL;
+    if (cmdline.isSet("classes")) {
+      nCls = svm_load_classes(cmdline.getStr("classes"), &classNames);
+    }
+
+    sOutputSelectionStr selStr;
+    sOutputSelectionIdx selIdx;
+    memset(&selStr, 0, sizeof(selStr));
+    memset(&selIdx, 0, sizeof(selIdx));
+    int fselType = 0;
+    if (cmdline.isSet("fselection")) {
+      fselType = svm_load_selection(cmdline.getStr("fselection"), &selStr, &selIdx);
+      if (fselType < 0) fselType = 0;
+    }
+
+    int ok = svm_save_bundle(output, model, scale, nCls, classNames, fselType, &selStr, &selIdx);
+    if (ok) {
+      SMILE_MSG(1,"wrote binary model '%s' (%i classes, %li class names, feature selection type %i)",
+        output, svm_get_nr_class(model), nCls, fselType);
+    }
+
+    long i;
+    for (i=0; i<nCls; i++) free(classNames[i]);
+    if (classNames != NULL) free(classNames);
+    for (i=0; i<selStr.n; i++) free(selStr.names[i]);
+    if (selStr.names != NULL) free(selStr.names);
+    if (selIdx.enabled != NULL) free(selIdx.enabled);
+    svm_destroy_scale(scale);
+    svm_destroy_model(model);
+
+    if (!ok) return EXIT_ERROR;
+
+  } catch(cSMILException *c) { 
+    return EXIT_ERROR; 
+  } 
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+
+/*  openSMILE component:
+
+fused time domain low-level descriptors, see timeLld.hpp
+
+*/
+
+
+#include <timeLld.hpp>
+
+#define MODULE "cTimeLld"
+
+SMILECOMPONENT_STATICS(cTimeLld)
+
+SMILECOMPONENT_REGCOMP(cTimeLld)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CTIMELLD;
+  sdescription = COMPONENT_DESCRIPTION_CTIMELLD;
+
+  // we inherit cVectorProcessor configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cVectorProcessor")
+  
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->setField("nameAppend","suffix for the energy field names (as in cEnergy), all other field names are fixed","energy");
+    ct->setField("htkcompatible","htk compatible log-energy output (this will disable rms energy output, see cEnergy)",0);
+    ct->setField("rms","1/0 = on/off   output RMS energy",1);
+    ct->setField("log","1/0 = on/off   output LOG energy",1);
+    ct->setField("intensity","1/0 = on/off   output simplified intensity (hamming window weighted mean square, see cIntensity)",1);
+    ct->setField("loudness","1/0 = on/off   output loudness (intensity^0.3)",1);
+    ct->setField("fullFrameIntensity","1 = compute intensity and loudness over the whole frame instead of the first 2 samples as cIntensity does (the values are then not compatible with cIntensity)",0);
+    ct->setField("zcr","(1/0=yes/no) compute zero-crossing rate",1);
+    ct->setField("mcr","(1/0=yes/no) compute mean crossing rate (requires a second pass over the frame)",0);
+    ct->setField("amax","(1/0=yes/no) compute maximum absolute sample value",0);
+    ct->setField("maxmin","(1/0=yes/no) compute maximum and minimum sample value",0);
+  )
+  SMILECOMPONENT_MAKEINFO(cTimeLld);
+}
+
+SMILECOMPONENT_CREATE(cTimeLld)
+
+//-----
+
+cTimeLld::cTimeLld(const char *_name) :
+  cVectorProcessor(_name),
+  htkcompatible(0),
+  erms(0), elog(0),
+  intensity(0), loudness(0), fullFrameIntensity(0),
+  zcr(0), mcr(0), amax(0), maxmin(0),
+  I0(0.000001),
+  hamWin(NULL), winSum(NULL), nWin(NULL)
+{
+
+}
+
+void cTimeLld::fetchConfig()
+{
+  cVectorProcessor::fetchConfig();
+  
+  htkcompatible = getInt("htkcompatible");
+  erms = getInt("rms");
+  elog = getInt("log");
+  if (htkcompatible) { elog=1; erms=0; SMILE_DBG(2,"htkcompatible log-energy is enabled"); }
+
+  intensity = getInt("intensity");
+  loudness = getInt("loudness");
+  fullFrameIntensity = getInt("fullFrameIntensity");
+  zcr = getInt("zcr");
+  mcr = getInt("mcr");
+  amax = getInt("amax");
+  maxmin = getInt("maxmin");
+
+  if (!(erms||elog||intensity||loudness||zcr||mcr||amax||maxmin)) {
+    SMILE_IWRN(1,"all outputs are disabled in the config, this component will not produce any output!");
+  }
+}
+
+int cTimeLld::dataProcessorCustomFinalise()
+{
+  // allocate for multiple configurations..
+  if (hamWin == NULL) hamWin = (double**)multiConfAlloc();
+  if (winSum == NULL) winSum = (double*)calloc(1,sizeof(double)*getNf());
+  if (nWin == NULL) nWin = (long*)calloc(1,sizeof(long)*getNf());
+
+  return cVectorProcessor::dataProcessorCustomFinalise();
+}
+
+int cTimeLld::setupNamesForField(int i, const char*name, long nEl)
+{
+  int n=0;
+  char * xx=NULL;
+
+  // the same names as cEnergy, cIntensity, and cMZcr produce
+  if (erms) { addNameAppendFieldAuto(name, "RMS", 1); n++; }
+  if (elog) { addNameAppendFieldAuto(name, "LOG", 1); n++; }
+  if (intensity) { addNameAppendField(name, "intensity", 1); n++; }
+  if (loudness) { addNameAppendField(name, "loudness", 1); n++; }
+  if (zcr) {
+    xx = myvprint("%s_zcr",name);
+    writer->addField( xx, 1 );
+    free(xx); n++;
+  }
+  if (mcr) {
+    xx = myvprint("%s_mcr",name);
+    writer->addField( xx, 1 );
+    free(xx); n++;
+  }
+  if (amax) {
+    xx = myvprint("%s_absmax",name);
+    writer->addField( xx, 1 );
+    free(xx); n++;
+  }
+  if (maxmin) {
+    xx = myvprint("%s_max",name);
+    writer->addField( xx, 1 );
+    free(xx);
+    xx = myvprint("%s_min",name);
+    writer->addField( xx, 1 );
+    free(xx); n += 2;
+  }
+
+  // hamming window for the intensity
+  if (intensity || loudness) {
+    int idxc = getFconf(i);
+    long j;
+    if (hamWin[idxc] != NULL) free(hamWin[idxc]);
+    hamWin[idxc] = smileDsp_winHam( nEl );
+    if (hamWin[idxc] == NULL) OUT_OF_MEMORY;
+    nWin[idxc] = nEl;
+    winSum[idxc] = 0.0;
+    for (j=0; j<nEl; j++) {
+      winSum[idxc] += hamWin[idxc][j];
+    }
+    if (winSum[idxc] <= 0.0) winSum[idxc] = 1.0;
+  }
+
+  return n;
+}
+
+// a derived class should override this method, in order to implement the actual processing
+int cTimeLld::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
+{
+  if (Nsrc < 2) return 0;
+  int idxc = getFconf(idxi);
+
+  long i;
+  double e=0.0, Im=0.0;
+  FLOAT_DMEM mean=src[0];
+  FLOAT_DMEM nzc=0.0, nmc=4.0;
+  FLOAT_DMEM max=src[0], min=src[0], absmax;
+
+  /* single pass over the frame, the accumulations are independent of the enabled outputs,
+     so the loop body has no branches on the config and only uses data-dependent selects */
+  const double *w = NULL;
+  long nW = 0;
+  if ((intensity||loudness)&&(hamWin[idxc]!=NULL)) {
+    w = hamWin[idxc];
+    nW = MIN(Nsrc,nWin[idxc]);
+    // cIntensity bounds its window loop by its number of outputs (2)
+    if (!fullFrameIntensity) nW = MIN(nW,2);
+  }
+
+  FLOAT_DMEM x0 = src[0], x0sq = x0*x0;
+  e = x0sq;
+  if (nW > 0) Im = w[0] * (double)x0sq;
+  for (i=1; i<Nsrc-1; i++) {
+    FLOAT_DMEM xp = src[i-1], x = src[i], xn = src[i+1];
+    FLOAT_DMEM xsq = x*x;
+    e += xsq;
+    if (i < nW) Im += w[i] * (double)xsq;
+    mean += x;
+    nzc += (FLOAT_DMEM)( ((xp*xn <= 0.0)&&(x==0.0)) || (xp*x < 0.0) );
+    min = (x < min) ? x : min;
+    max = (x > max) ? x : max;
+  }
+  // last sample (Nsrc >= 2)
+  {
+    FLOAT_DMEM x = src[Nsrc-1];
+    FLOAT_DMEM xsq = x*x;
+    e += xsq;
+    if (Nsrc-1 < nW) Im += w[Nsrc-1] * (double)xsq;
+    min = (x < min) ? x : min;
+    max = (x > max) ? x : max;
+  }
+  // cMZcr compatible normalisation
+  nzc /= (FLOAT_DMEM)Nsrc;
+  mean /= (FLOAT_DMEM)Nsrc;
+
+  if (mcr) {
+    for (i=1; i<Nsrc-1; i++) {
+      FLOAT_DMEM xp = src[i-1]-mean, x = src[i]-mean, xn = src[i+1]-mean;
+      nmc += (FLOAT_DMEM)( ((xp*xn <= 0.0)&&(x==0.0)) || (xp*x < 0.0) );
+    }
+    nmc /= (FLOAT_DMEM)Nsrc;
+  }
+  if (fabs(min) > fabs(max)) absmax = (FLOAT_DMEM)fabs(min);
+  else absmax = (FLOAT_DMEM)fabs(max);
+
+  int n=0;
+  if (erms) {
+    dst[n++] = (FLOAT_DMEM)sqrt(e/(FLOAT_DMEM)Nsrc);
+  }
+  if (elog) {
+    double minE = 8.674676e-019;
+    double d = e;
+    if (!htkcompatible) {
+      d /= (FLOAT_DMEM)Nsrc;
+      if (d<minE) d = minE;
+    } else {
+      d *= 32767.0*32767.0;
+      if (d<=1.0) d = 1.0;
+    }
+    dst[n++] = (FLOAT_DMEM)log(d);
+  }
+  if (intensity||loudness) {
+    Im /= winSum[idxc];
+    if (intensity) dst[n++] = (FLOAT_DMEM)Im;
+    if (loudness) dst[n++] = (FLOAT_DMEM)pow( Im/I0 , 0.3 );
+  }
+  if (zcr) dst[n++] = nzc;
+  if (mcr) dst[n++] = nmc;
+  if (amax) dst[n++] = absmax;
+  if (maxmin) {
+    dst[n++] = max;
+    dst[n++] = min;
+  }
+
+  return n;
+}
+
+cTimeLld::~cTimeLld()
+{
+  multiConfFree(hamWin);
+  if (winSum != NULL) free(winSum);
+  if (nWin != NULL) free(nWin);
+}
@@ -0,0 +1,90 @@
+/*F******************************************************************************
+ *
+ * openSMILE - open Speech and Music Interpretation by Large-space Extraction
+ *       the open-source Munich Audio Feature Extraction Toolkit
+ * Copyright (C) 2008-2009  Florian Eyben, Martin Woellmer, Bjoern Schuller
+ *
+ *
+ * Institute for Human-Machine Communication
+ * Technische Universitaet Muenchen (TUM)
+ * D-80333 Munich, Germany
+ *
+ *
+ * If you use openSMILE or any code from openSMILE in your research work,
+ * you are kindly asked to acknowledge the use of openSMILE in your publications.
+ * See the file CITING.txt for details.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ ******************************************************************************E*/
+
+
+
+/*  openSMILE component:
+
+fused time domain low-level descriptors:
+energy (cEnergy), intensity and loudness (cIntensity), zero- and mean-crossing rate, max/min (cMZcr)
+computed in a single pass over each frame, with the same field names as the individual components
+
+*/
+
+
+#ifndef __CTIMELLD_HPP
+#define __CTIMELLD_HPP
+
+#include <smileCommon.hpp>
+#include <vectorProcessor.hpp>
+
+#define COMPONENT_DESCRIPTION_CTIMELLD "computes time domain LLD (rms/log energy, intensity/loudness, zcr/mcr, max/min/absmax) in a single pass per frame, field names are compatible with cEnergy, cIntensity, and cMZcr"
+#define COMPONENT_NAME_CTIMELLD "cTimeLld"
+
+class cTimeLld : public cVectorProcessor {
+  private:
+    int htkcompatible;
+    int erms, elog;
+    int intensity, loudness, fullFrameIntensity;
+    int zcr, mcr, amax, maxmin;
+    double I0;
+    double **hamWin;
+    double *winSum;
+    long *nWin;
+
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+
+    virtual void fetchConfig();
+    //virtual int myConfigureInstance();
+    //virtual int myFinaliseInstance();
+    //virtual int myTick(long long t);
+
+    //virtual int configureWriter(const sDmLevelConfig *c);
+
+    virtual int dataProcessorCustomFinalise();
+    virtual int setupNamesForField(int i, const char*name, long nEl);
+    //virtual int processVectorInt(const INT_DMEM *src, INT_DMEM *dst, long Nsrc, long Ndst, int idxi);
+    virtual int processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi);
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+    
+    cTimeLld(const char *_name);
+
+    virtual ~cTimeLld();
+};
+
+
+
+
+#endif // __CTIMELLD_HPP
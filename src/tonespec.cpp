@@ -76,6 +76,7 @@ SMILECOMPONENT_REGCOMP(cTonespec)
     ct->setField("filterType","note filter type:\n   tri (triangular)\n   trp (triangular-powered)\n   gau (gaussian)","gau");
     ct->setField("usePower","use power spectrum instead of magnitude (=square input values)",0);
     ct->setField("dbA","apply built-in dbA to (power) spectrum (1/0 = yes/no)",1);
+    ct->setField("chroma","1 = output the 12 element chroma vector (field 'chroma', octaves of the semi-tone spectrum summed up and normalised as by cChroma) instead of the semi-tone spectrum",0);
   #ifdef DEBUG
     ct->setField("printBinMap","print mapping of fft bins to semi-tone intervals",0);
   #endif
@@ -97,11 +98,13 @@ cTonespec::cTonespec(const char *_name) :
   distance2key(NULL),
   pitchClassNbins(NULL),
   filterMap(NULL),
+  toneBuf(NULL),
   flBin(NULL),
   db(NULL),
   nOctaves(1),
   nNotes(8),
   usePower(0),
+  chroma(0),
   printBinMap(0),
   filterType(WINF_GAUSS),
   dbA(0)
@@ -127,6 +130,9 @@ void cTonespec::fetchConfig()
   dbA = getInt("dbA");
   if (dbA) SMILE_DBG(2,"dbA weighting for tonespec enabled");
 
+  chroma = getInt("chroma");
+  if (chroma) SMILE_DBG(2,"chroma output enabled");
+
   const char *f = getStr("filterType");
   if ( (!strcmp(f,"gau"))||(!strcmp(f,"Gau"))||(!strcmp(f,"gauss"))||(!strcmp(f,"Gauss"))||(!strcmp(f,"gaussian"))||(!strcmp(f,"Gaussian")) ) filterType = WINF_GAUSS;
   else if ( (!strcmp(f,"tri"))||(!strcmp(f,"Tri"))||(!strcmp(f,"triangular"))||(!strcmp(f,"Triangular")) ) filterType = WINF_TRIANGULAR;
@@ -152,6 +158,7 @@ int cTonespec::dataProcessorCustomFinalise()
   if (pitchClassNbins == NULL) pitchClassNbins = (int**)multiConfAlloc();
   if (flBin == NULL) flBin = (int**)multiConfAlloc();
   if ((dbA)&&(db==NULL)) db = (FLOAT_DMEM**)multiConfAlloc();
+  if ((chroma)&&(toneBuf==NULL)) toneBuf = (FLOAT_DMEM**)multiConfAlloc();
 
   return cVectorProcessor::dataProcessorCustomFinalise();
 }
@@ -355,6 +362,11 @@ int cTonespec::setupNamesForField(int i, const char*name, long nEl)
   setPitchclassFreq(getFconf(i));
   computeFilters(nEl, c->frameSizeSec, getFconf(i));
 
+  if (chroma) {
+    if (toneBuf[getFconf(i)] == NULL) toneBuf[getFconf(i)] = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*nNotes);
+    addNameAppendField(NULL, "chroma", 12);
+    return 12;
+  }
   return cVectorProcessor::setupNamesForField(i,"tone",nNotes);
 }
 
@@ -393,35 +405,40 @@ int cTonespec::processVectorFloat(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long N
   int lastBin = *(flBin[idxi]+1);
 
 
-  // copy & square the fft magnitude
-  FLOAT_DMEM *_src;
-  if (usePower) {
-    _src = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*Nsrc);
-    if (src==NULL) OUT_OF_MEMORY;
-    for (i=0; i<Nsrc; i++) {
-      _src[i] = src[i]*src[i];
-    }
-    src = _src;
-  }
+  // with chroma output the semi-tone spectrum is only an intermediate result
+  FLOAT_DMEM *tone = dst;
+  if (chroma) tone = toneBuf[idxi];
 
   // do the tone filtering by multiplying with the filters and summing up
-  bzero(dst, Ndst*sizeof(FLOAT_DMEM));
+  bzero(tone, nNotes*sizeof(FLOAT_DMEM));
 
-  // Sum the FFT bins for each pitch class and compute mean value
-  for (i=firstBin; i <= lastBin; i++) {
-    if (_binKey[i] >= 0) {
-      dst[_binKey[i]] += *(src++) * _filterMap[i];
+  // Sum the FFT bins (squared fft magnitudes if usePower) for each pitch class and compute mean value
+  if (usePower) {
+    for (i=firstBin; i <= lastBin; i++) {
+      if (_binKey[i] >= 0) {
+        tone[_binKey[i]] += (src[i]*src[i]) * _filterMap[i];
+      }
+    }
+  } else {
+    for (i=firstBin; i <= lastBin; i++) {
+      if (_binKey[i] >= 0) {
+        tone[_binKey[i]] += src[i] * _filterMap[i];
+      }
     }
   }
 
   for (i = 0; i < nNotes; i++) {
     if (_pitchClassNbins[i] > 0) {
-      dst[i] /= (FLOAT_DMEM)(_pitchClassNbins[i]);
-      if (usePower) if (dst[i]>=0.0) dst[i] = sqrt(dst[i]); else dst[i] = 0.0; // FIXME ????
-    } else dst[i] = 0.0;
+      tone[i] /= (FLOAT_DMEM)(_pitchClassNbins[i]);
+      if (usePower) if (tone[i]>=0.0) tone[i] = sqrt(tone[i]); else tone[i] = 0.0; // FIXME ????
+    } else tone[i] = 0.0;
   }
 
-  if ((usePower)&&(_src!=NULL)) free((void *)_src);
+  if (chroma) {
+    // sum up the octaves and normalise (as cChroma)
+    bzero(dst, Ndst*sizeof(FLOAT_DMEM));
+    smileDsp_chromaFold(tone, dst, nOctaves, 12);
+  }
 
   return 1;
 }
@@ -435,5 +452,6 @@ cTonespec::~cTonespec()
   multiConfFree(flBin);
   multiConfFree(filterMap);
   if (dbA) multiConfFree(db);
+  if (chroma) multiConfFree(toneBuf);
 }
 
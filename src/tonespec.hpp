@@ -52,6 +52,7 @@ class cTonespec : public cVectorProcessor {
   private:
     int nOctaves, nNotes;
     int usePower, dbA;
+    int chroma;
   #ifdef DEBUG
     int printBinMap;
   #endif
@@ -63,6 +64,7 @@ class cTonespec : public cVectorProcessor {
     FLOAT_DMEM **distance2key;
     FLOAT_DMEM **filterMap;
     FLOAT_DMEM **db;
+    FLOAT_DMEM **toneBuf;  // semi-tone spectrum, if chroma output is enabled
     
     int **binKey;
     int **pitchClassNbins;
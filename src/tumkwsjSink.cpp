@@ -83,6 +83,10 @@ SMILECOMPONENT_REGCOMP(cTumkwsjSink)
   ct->setField("printResult","print output to console (1/0=yes/no)",1);
 
   ct->setField("resultRecp","component(s) to send 'asrKeywordOutput' messages to (use , to separate multiple recepients), leave blank (NULL) to not send any messages",(const char *) NULL);
+
+  ct->setField("streaming","1 = streaming handoff: feed every frame to the decoder as it arrives, instead of buffering turns (turnStart/turnEnd messages only end a segment then); the decoder runs on its own thread and reads from a bounded lock-free queue, so the tick thread never waits for the recogniser. Partial hypotheses are sent as 'asrKeywordOutputPartial' messages to resultRecp",0);
+  ct->setField("queueSize","streaming mode: number of frames the queue to the decoder can hold; if the decoder falls further behind, frames are dropped (with a warning)",1000);
+  ct->setField("partialInterval","streaming mode: interval in ms at which partial hypotheses are output",300);
   SMILECOMPONENT_IFNOTREGAGAIN_END
 
     SMILECOMPONENT_MAKEINFO(cTumkwsjSink);
@@ -104,11 +108,15 @@ turnEnd(0), turnStart(0), isTurn(0), endWait(-1),
 lag(0), nPre(0), nPost(0),
 curVidx(0), vIdxStart(0), vIdxEnd(0), wst(0), writelen(0), resultRecp(NULL), period(0.0),
 turnStartSmileTimeLast(0.0), turnStartSmileTime(0.0), turnStartSmileTimeCur(0.0),
-decoderThread(NULL), wlenWeight(0.2)
+decoderThread(NULL), wlenWeight(0.2),
+streaming(0), queueSize(0), veclen(0), qData(NULL), qTime(NULL), qSegEnd(NULL),
+qHead(0), qTail(0), decoderIdle(0), nDropped(0), lastVidx(-1), nSegFrames(0),
+segStart(1), eoiFlushed(0), partialInterval(300)
 {
   smileMutexCreate(terminatedMtx);
   smileMutexCreate(dataFlgMtx);
   smileCondCreate(tickCond);
+  smileCondCreate(frameCond);
 }
 
 void cTumkwsjSink::fetchConfig()
@@ -134,6 +142,12 @@ void cTumkwsjSink::fetchConfig()
 
   wlenWeight = getDouble("wlenWeight");
   SMILE_IDBG(2,"wlenWeight = %f",wlenWeight);
+
+  streaming = getInt("streaming");
+  SMILE_IDBG(2,"streaming = %i",streaming);
+  queueSize = getInt("queueSize");
+  if (queueSize < 2) queueSize = 2;
+  partialInterval = getInt("partialInterval");
 }
 
 /*
@@ -372,13 +386,17 @@ void cTumkwsjSink::cbResultPass1Current(Recog *recog, void *dummy)
     Kresult k;
     fillKresult(&k, seq, num, winfo, s->confidence, r->result.num_frame, s->align);
     if (resultRecp != NULL) {
-      cComponentMessage msg("asrKeywordOutput");
+      // in streaming mode the interim results are marked as partial, the final result of a segment follows as 'asrKeywordOutput'
+      const char *mtype = "asrKeywordOutput";
+      if (streaming) mtype = "asrKeywordOutputPartial";
+      cComponentMessage msg(mtype);
       msg.custData = &k;
       msg.userTime1 = turnStartSmileTimeCur;
       msg.userTime2 = turnStartSmileTimeCur + ((double)(k.turnDuration))*period;
       sendComponentMessage( resultRecp, &msg );
-      SMILE_IDBG(3,"sending 'asrKeywordOutput' message to '%s'",resultRecp);
+      SMILE_IDBG(3,"sending '%s' message to '%s'",mtype,resultRecp);
     }
+    if ((streaming)&&(!printResult)) return;
    //output content of k:
     int kc = 0;
     printf("----------current hypothesis:------------\n");
@@ -725,6 +743,14 @@ int cTumkwsjSink::setupJulius()
     jconf->ext.veclen = reader->getLevelN();
     jconf->ext.userptr = (void *)this;
     jconf->ext.fv_read = external_fv_read_loader;
+    if (streaming) {
+      // output the interim results of the 1st pass (partial hypotheses, see cbResultPass1Current)
+      JCONF_SEARCH *s;
+      for (s=jconf->search_root; s!=NULL; s=s->next) {
+        s->output.progout_flag = TRUE;
+        s->output.progout_interval = partialInterval;
+      }
+    }
 
     /* Fixate jconf parameters: it checks whether the jconf parameters
     are suitable for recognition or not, and set some internal
@@ -804,6 +830,14 @@ int cTumkwsjSink::myFinaliseInstance()
 
   period = _T;
 
+  if (streaming) {
+    veclen = reader->getLevelN();
+    qData = (float *)calloc(1,sizeof(float)*queueSize*veclen);
+    qTime = (double *)calloc(1,sizeof(double)*queueSize);
+    qSegEnd = (char *)calloc(1,sizeof(char)*queueSize);
+    if ((qData == NULL)||(qTime == NULL)||(qSegEnd == NULL)) OUT_OF_MEMORY;
+  }
+
   // setup julius, if not already set up
   if (!juliusIsSetup) ret *= setupJulius();
 
@@ -843,6 +877,8 @@ int cTumkwsjSink::getFv(float *vec, int n)
 { 
   int ret=0;
 
+  if (streaming) return getFvStreaming(vec, n);
+
   smileMutexLock(dataFlgMtx);
 
   if (terminated) { 
@@ -949,6 +985,50 @@ int cTumkwsjSink::getFv(float *vec, int n)
 }
 
 
+// this is called from julius decoder thread in streaming mode: takes the next frame from the queue, waits if the queue is empty
+int cTumkwsjSink::getFvStreaming(float *vec, int n)
+{
+  int i, ret = 0;
+  bool term;
+  while (1) {
+    smileMutexLock(dataFlgMtx);
+    term = terminated;
+    smileMutexUnlock(dataFlgMtx);
+    if (term) {
+      recog->process_want_terminate = TRUE;
+      return -1;
+    }
+    long h = qHead;
+    smileMemoryBarrier();
+    if (qTail < h) break;
+    decoderIdle = 1;
+    smileCondTimedWait(frameCond, 20);
+  }
+  decoderIdle = 0;
+
+  long s = qTail % queueSize;
+  if (qSegEnd[s]) {
+    // end of segment: julius outputs the final result of the segment and starts a new one with the next frame
+    for (i=0; i<n; i++) vec[i] = 0.0;
+    segStart = 1;
+    ret = -3;
+  } else {
+    if (segStart) {
+      turnStartSmileTimeCur = qTime[s];
+      segStart = 0;
+    }
+    const float *d = qData + s*veclen;
+    for (i=0; i<n; i++) {
+      if (i < veclen) vec[i] = d[i];
+      else vec[i] = 0.0;
+    }
+  }
+  smileMemoryBarrier();
+  qTail++;
+
+  return ret;
+}
+
 SMILE_THREAD_RETVAL juliusThreadRunner(void *_obj)
 {
   cTumkwsjSink * __obj = (cTumkwsjSink *)_obj;
@@ -981,6 +1061,7 @@ void cTumkwsjSink::juliusDecoderThread()
         } else {
           fprintf(stderr, "failed to begin input stream\n");
         }
+        decoderIdle = 2;
         return;
   }
   /*
@@ -993,12 +1074,97 @@ void cTumkwsjSink::juliusDecoderThread()
 
   /* start recognizing the stream */
   ret = j_recognize_stream(recog);
+  decoderIdle = 2;
 }
 
 int cTumkwsjSink::startJuliusDecoder()
 {
   juliusIsRunning = 1;
-  smileThreadCreate( decoderThread, juliusThreadRunner, this );
+  return smileThreadCreate( decoderThread, juliusThreadRunner, this );
+}
+
+// streaming mode, tick thread: copies a frame to the queue, returns 0 if the queue is full
+int cTumkwsjSink::queueFrame(const cVector *vec)
+{
+  long t = qTail;
+  smileMemoryBarrier();
+  if (qHead - t >= queueSize) return 0;
+
+  long i, s = qHead % queueSize;
+  float *d = qData + s*veclen;
+  for (i=0; i<veclen; i++) {
+    if (i < vec->N) d[i] = (float)(vec->dataF[i]);
+    else d[i] = 0.0;
+  }
+  qTime[s] = vec->tmeta->smileTime;
+  qSegEnd[s] = 0;
+  smileMemoryBarrier();
+  qHead++;
+  nSegFrames++;
+  return 1;
+}
+
+// streaming mode, tick thread: ends the current segment, returns 0 if the queue is full
+int cTumkwsjSink::queueSegmentEnd()
+{
+  if (nSegFrames == 0) return 1;
+  long t = qTail;
+  smileMemoryBarrier();
+  if (qHead - t >= queueSize) return 0;
+
+  qSegEnd[qHead % queueSize] = 1;
+  smileMemoryBarrier();
+  qHead++;
+  nSegFrames = 0;
+  return 1;
+}
+
+// streaming mode: hands the next frame to the decoder thread, never waits for the decoder
+int cTumkwsjSink::tickStreaming(long long t)
+{
+  int res = 0;
+
+  cVector *vec = reader->getNextFrame();
+  if (vec != NULL) {
+    if (queueFrame(vec)) {
+      if (nDropped > 0) {
+        SMILE_IWRN(2,"the decoder has caught up again, %li frames were dropped",nDropped);
+        nDropped = 0;
+      }
+    } else {
+      if (nDropped == 0) SMILE_IWRN(2,"the decoder is falling behind, frame queue is full (queueSize = %li), dropping frames",queueSize);
+      nDropped++;
+    }
+    lastVidx = vec->tmeta->vIdx;
+    res = 1;
+  }
+
+  // a turnEnd message only ends the current segment (postSil frames after the turn end), at the end of the input the last segment is ended
+  lockMessageMemory();
+  turnStart = 0;
+  int segEnd = ((turnEnd)&&(lastVidx >= vIdxEnd+postSil));
+  unlockMessageMemory();
+  if ((isEOI())&&(!eoiFlushed)) segEnd = 1;
+  if ((segEnd)&&(queueSegmentEnd())) {
+    lockMessageMemory();
+    turnEnd = 0;
+    unlockMessageMemory();
+    if (isEOI()) eoiFlushed = 1;
+    res = 1;
+  }
+
+  // keep the processing loop alive until the decoder has consumed all frames and output the final result
+  if ((isEOI())&&(decoderIdle != 2)) {
+    long h = qTail;
+    smileMemoryBarrier();
+    if ((h < qHead)||(!decoderIdle)) {
+      smileYield();
+      res = 1;
+    }
+  }
+
+  if (res) smileCondSignal(frameCond);
+  return res;
 }
 
 int cTumkwsjSink::myTick(long long t)
@@ -1006,6 +1172,8 @@ int cTumkwsjSink::myTick(long long t)
   if (!juliusIsRunning) {
     if (!startJuliusDecoder()) return 0;
   }
+  if (streaming) return tickStreaming(t);
+
   smileCondSignal( tickCond );
   reader->catchupCurR();
 
@@ -1028,6 +1196,7 @@ cTumkwsjSink::~cTumkwsjSink()
   terminated = TRUE;
   smileCondSignal( tickCond );
   smileMutexUnlock(dataFlgMtx);
+  smileCondSignal( frameCond );
   
   if (decoderThread != NULL) smileThreadJoin(decoderThread);
 
@@ -1039,6 +1208,11 @@ cTumkwsjSink::~cTumkwsjSink()
   smileMutexDestroy(terminatedMtx);
   smileMutexDestroy(dataFlgMtx);
   smileCondDestroy(tickCond);
+  smileCondDestroy(frameCond);
+
+  if (qData != NULL) free(qData);
+  if (qTime != NULL) free(qTime);
+  if (qSegEnd != NULL) free(qSegEnd);
 }
 
 
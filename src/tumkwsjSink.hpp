@@ -102,6 +102,24 @@ class cTumkwsjSink : public cDataSink {
     int turnEnd; int turnStart; int isTurn;
     const cVector *curVec;
 
+    // streaming handoff: the tick thread copies each frame into a bounded lock-free
+    // single producer / single consumer queue, the decoder thread feeds them to julius
+    int streaming;
+    long queueSize, veclen;
+    float *qData;     // queueSize * veclen feature values
+    double *qTime;    // smile time of each frame
+    char *qSegEnd;    // 1 = slot is a segment end marker (no data)
+    volatile long qHead, qTail;  // written only by the tick thread / the decoder thread
+    volatile int decoderIdle;
+    smileCond frameCond;
+    long nDropped, lastVidx;
+    long nSegFrames;
+    int segStart, eoiFlushed, partialInterval;
+
+    int queueFrame(const cVector *vec);
+    int queueSegmentEnd();
+    int tickStreaming(long long t);
+
     double turnStartSmileTime, turnStartSmileTimeLast, turnStartSmileTimeCur;
 
     /*
@@ -162,6 +180,7 @@ int prevSpeakingIndex;
       /* callbacks for julius : */
 
     int getFv(float *vec, int n);
+    int getFvStreaming(float *vec, int n);
 
     LOGPROB cbUserlmUni(WORD_INFO *winfo, WORD_ID w, LOGPROB ngram_prob);
     LOGPROB cbUserlmBi(WORD_INFO *winfo, WORD_ID context, WORD_ID w, LOGPROB ngram_prob);
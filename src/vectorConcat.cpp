@@ -71,6 +71,12 @@ cVectorConcat::cVectorConcat(const char *_name) :
 }
 
 
+void cVectorConcat::markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn)
+{
+  if ((outNeed != NULL)&&(nOut == nIn)) memcpy(inNeed, outNeed, nIn);
+  else memset(inNeed, 1, nIn);
+}
+
 int cVectorConcat::processVectorInt(const INT_DMEM *src, INT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
 {
   if (dst!=src)
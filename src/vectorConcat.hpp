@@ -70,6 +70,9 @@ class cVectorConcat : public cVectorProcessor {
     
     cVectorConcat(const char *_name);
 
+    // the output is a copy of the input
+    virtual void markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn);
+
     virtual ~cVectorConcat();
 };
 
@@ -281,6 +281,17 @@ int cVectorProcessor::myTick(long long t)
 {
   SMILE_IDBG(4,"tick # %i, running vector processor",t);
 
+  // process up to blocksizeR frames per tick (one frame per tick, if no blocksize is set)
+  int ret = processNextFrame();
+  long n;
+  for (n=1; (ret)&&(n<blocksizeR); n++) {
+    if (!processNextFrame()) break;
+  }
+  return ret;
+}
+
+int cVectorProcessor::processNextFrame()
+{
   if (!(writer->checkWrite(1))) return 0;
 // printf("'%s' checkwrite ok\n",getInstName());
 
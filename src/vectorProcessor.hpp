@@ -63,6 +63,7 @@ class cVectorProcessor : public cDataProcessor {
     long *confBs;  // blocksize for configurations
 
     int addFconf(long bs, int field); // return value is index of assigned configuration
+    int processNextFrame(); // process one input frame (or flush), called blocksizeR times per tick
 
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
@@ -44,14 +44,14 @@ writes data to an uncompressed PCM WAVE file
 #define MODULE "cWaveSink"
 
 
-#define SMILE_SFSTR_8BIT        "8bit"     // 8-bit signed
+#define SMILE_SFSTR_8BIT        "8bit"     // 8-bit unsigned
 #define SMILE_SFSTR_16BIT       "16bit"    // 16-bit signed
 #define SMILE_SFSTR_24BIT       "24bit"    // 24-bit signed sample in 4byte dword
 #define SMILE_SFSTR_24BITp      "24bitp"   // 3-byte packed 24-bit signed value
 #define SMILE_SFSTR_32BIT       "32bit"    // 32-bit signed integer
 #define SMILE_SFSTR_32BIT_FLOAT "float"    // 32-bit float
 
-#define SMILE_SF_8BIT        0    // 8-bit signed
+#define SMILE_SF_8BIT        0    // 8-bit unsigned
 #define SMILE_SF_16BIT       1    // 16-bit signed
 #define SMILE_SF_24BIT       2    // 24-bit signed sample in 4byte dword
 #define SMILE_SF_24BITp      3    // 3-byte packed 24-bit signed value
@@ -74,9 +74,10 @@ SMILECOMPONENT_REGCOMP(cWaveSink)
     ct->makeMandatory(ct->setField("filename","filename of PCM wave file to write data to",(const char *)NULL));
     //ct->setField("buffersize","size of data to write at once",2048);
     //ct->setField("frameRead","1 = read frames (vectors) instead of windows, buffersize will be then ignored (default 0 = read windows of size buffersize)",0);
-    char * sfdesc = myvprint("sample format: one of the following:\n   '%s' : 8-bit signed \n   '%s' : 16-bit signed\n   '%s' : 24-bit signed\n   '%s' : 24-bit signed packed in 3 bytes\n   '%s' : 32-bit signed integer\n   '%s' : 32-bit float",SMILE_SFSTR_8BIT,SMILE_SFSTR_16BIT,SMILE_SFSTR_24BIT,SMILE_SFSTR_24BITp,SMILE_SFSTR_32BIT,SMILE_SFSTR_32BIT_FLOAT);
+    char * sfdesc = myvprint("sample format: one of the following:\n   '%s' : 8-bit unsigned \n   '%s' : 16-bit signed\n   '%s' : 24-bit signed\n   '%s' : 24-bit signed packed in 3 bytes\n   '%s' : 32-bit signed integer\n   '%s' : 32-bit float",SMILE_SFSTR_8BIT,SMILE_SFSTR_16BIT,SMILE_SFSTR_24BIT,SMILE_SFSTR_24BITp,SMILE_SFSTR_32BIT,SMILE_SFSTR_32BIT_FLOAT);
     ct->setField("sampleFormat",sfdesc,SMILE_SFSTR_16BIT);
     free(sfdesc);
+    ct->setField("dither","1 = add triangular (TPDF) dither noise of +-1 LSB before quantising the samples to integer sample formats (ignored for 'float')",0);
     //ct->setField("lag","output data <lag> frames behind",0);
 
     // overwrite cDataSink's default:
@@ -92,9 +93,7 @@ SMILECOMPONENT_CREATE(cWaveSink)
 
 cWaveSink::cWaveSink(const char *_name) :
   cDataSink(_name),
-  fHandle(NULL),
-  sampleBuffer(NULL),
-  sampleBufferLen(NULL)
+  writer(NULL), dither(0), ditherState(1)
 {
   // ...
 }
@@ -158,6 +157,8 @@ void cWaveSink::fetchConfig()
     }
   }
 
+  dither = getInt("dither");
+  SMILE_IDBG(2,"dither = %i",dither);
 }
 
 int cWaveSink::configureReader()
@@ -184,9 +185,9 @@ int cWaveSink::myFinaliseInstance()
   if (!ret) return 0;
 
   // open wave file for writing
-  if (fHandle == NULL) {
-    fHandle = fopen(filename, "wb");  // TODO: support append mode
-    if (fHandle == NULL) COMP_ERR("failed to open output file '%s'",filename);
+  if (writer == NULL) {
+    writer = createFileWriter();
+    if (!writer->open(filename, "wb")) COMP_ERR("failed to open output file '%s'",filename);  // TODO: support append mode
   }
 
   nBlocks = 0;
@@ -229,11 +230,10 @@ int cWaveSink::myTick(long long t)
 
 cWaveSink::~cWaveSink()
 {
-  if (sampleBuffer!=NULL) free(sampleBuffer);
-  if (fHandle != NULL) {
+  if (writer != NULL) {
     // write final wave header
     writeWaveHeader();
-    fclose(fHandle);
+    delete writer;
   }
 }
 
@@ -269,7 +269,7 @@ typedef struct {
 
 int cWaveSink::writeWaveHeader()
 {
-  if (fHandle == NULL) return 0;
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
 
   // use reader parameters to determine
   //   nChannels
@@ -286,77 +286,45 @@ int cWaveSink::writeWaveHeader()
   head.SampleRate = sampleRate;
   head.BitsPerSample = nBitsPerSample;
   head.ByteRate = sampleRate * nChannels * nBytesPerSample;
-  head.AudioFormat = 1; // !!! ??
+  head.AudioFormat = (sampleFormat == SMILE_SF_32BIT_FLOAT) ? 3 : 1; // 3 = IEEE float, 1 = PCM
   head.NumChannels = nChannels;
   head.BlockAlign = nChannels * nBytesPerSample;
   head.Subchunk2ID = 0x61746164; // data
   head.Subchunk2Size = nBlocks * nChannels * nBytesPerSample;  // size of wave data chunk
   head.FileSize = sizeof(sRiffPcmWaveHeader)  + head.Subchunk2Size;
 
-  fseek(fHandle, 0, SEEK_SET);
-  return (fwrite(&head, sizeof(sRiffPcmWaveHeader), 1, fHandle) == 1 ? sizeof(sRiffPcmWaveHeader) : 0 );
+  return (writer->writeAt(0, &head, sizeof(sRiffPcmWaveHeader)) ? sizeof(sRiffPcmWaveHeader) : 0 );
 }
 
 int cWaveSink::writeData(cMatrix *m) 
 {
   if (m!=NULL) {
-	  if (m->fmeta->N != nChannels) { SMILE_IERR(1,"number of chanels is inconsistent! %i <-> %i",m->fmeta->N,nChannels); return 0; }
-	else {
-//      if ((m->type==DMEM_FLOAT)&&(sampleFormat==SMILE_DF_32BIT_FLOAT)) { // write raw data...
-//		  fwrite(m->dataF, sizeof(DMEM_FLOAT
-//	  } else { 
-
-  	  // convert data
-      long i;
-	  if ((m->nT > sampleBufferLen)&&(sampleBuffer!=NULL)) free(sampleBuffer);
-	  sampleBufferLen = m->nT;
-    
-	  if (sampleBuffer == NULL) sampleBuffer = malloc(nBytesPerSample*nChannels*m->nT);
-
-	  int8_t *b8;
-	  int16_t *b16;
-	  int32_t *b32;
-	  float *b32f;
-
-	  switch(sampleFormat) {
-        case SMILE_SF_8BIT: 
-			b8 = (int8_t*)sampleBuffer;
-			for (i=0; i<m->nT*nChannels; i++) { b8[i] = (int8_t)round(m->dataF[i] * 127.0); }
-			break;
-        case SMILE_SF_16BIT: 
-			b16 = (int16_t*)sampleBuffer;
-			for (i=0; i<m->nT*nChannels; i++) { b16[i] = (int16_t)round(m->dataF[i] * 32767.0); }
-			break;
-        case SMILE_SF_24BIT: 
-			b32 = (int32_t*)sampleBuffer;
-			for (i=0; i<m->nT*nChannels; i++) { b32[i] = (int32_t)round(m->dataF[i] * 32767.0 * 256.0); }
-			break;
-        case SMILE_SF_24BITp: 
-			COMP_ERR("24-bit wave file with 3 bytes per sample encoding not yet supported!");
-			//int16_t *b16 = buf;
-			//for (i=0; i<m->nT*nChannels; i++) { b16[i] = (int16_t)round(m->dataF[i] * 32767.0); }
-			//break;
-        case SMILE_SF_32BIT: 
-			b32 = (int32_t*)sampleBuffer;
-			for (i=0; i<m->nT*nChannels; i++) { b32[i] = (int32_t)round(m->dataF[i] * 32767.0 * 32767.0 * 2.0); }
-			break;
-        case SMILE_SF_32BIT_FLOAT: 
-			b32f = (float*)sampleBuffer;
-			for (i=0; i<m->nT*nChannels; i++) { b32f[i] = (float)(m->dataF[i]); }
-			break;
-		default:
-			SMILE_IERR(1,"unknown sampleFormat encountered in writeData(): %i",sampleFormat);
-	  }
-
-	  long written = (long)fwrite(sampleBuffer, nBytesPerSample*nChannels, m->nT, fHandle);
-	  //printf("written: %i of %i\n",written,m->nT);
-    if (written > 0) {
-	    nBlocks += written;
-		curWritePos += nBytesPerSample*nChannels * written;
-	    return written;
-	  }
+    if (m->fmeta->N != nChannels) { SMILE_IERR(1,"number of chanels is inconsistent! %i <-> %i",m->fmeta->N,nChannels); return 0; }
+
+    // convert the samples directly into the write buffer, in chunks of at most one buffer
+    long blockSize = nBytesPerSample*nChannels;
+    long maxBlocks = (long)(writer->getBufferSize() / blockSize);
+    long written = 0;
+    while (written < m->nT) {
+      long n = m->nT - written;
+      if (n > maxBlocks) n = maxBlocks;
+      char *buf = writer->reserve(n*blockSize);
+      if (buf == NULL) break;
+
+      if (!smilePcm_fromFloat(m->dataF + written*nChannels, nChannels, 1, buf, n, nChannels, nBytesPerSample, nBitsPerSample, 
+                              (sampleFormat == SMILE_SF_32BIT_FLOAT), (dither ? &ditherState : NULL))) {
+        SMILE_IERR(1,"unknown sampleFormat encountered in writeData(): %i",sampleFormat);
+        return written;
+      }
+      writer->commit(n*blockSize);
+      written += n;
+    }
 
-	}
+    if (written > 0) {
+      nBlocks += written;
+      curWritePos += blockSize * written;
+      return written;
+    }
   }
   return 0;
 }
@@ -52,16 +52,17 @@ writes data to an uncompressed PCM WAVE file
 class cWaveSink : public cDataSink {
 private:
   const char *filename;
-  FILE * fHandle;
+  cSmileFileWriter * writer;
   //int lag;
   int frameRead;
   int buffersize;
-  void *sampleBuffer; long sampleBufferLen;
 
   int nBitsPerSample;
   int nBytesPerSample;
   int sampleFormat;
   int nChannels;
+  int dither;
+  unsigned int ditherState;
 
   //double start, end, endrel;
   //long startSamples, endSamples, endrelSamples;
@@ -45,6 +45,9 @@ writes data to an uncompressed PCM WAVE file
  if isTurn: write data to current file frame by frame
  @turnEnd: close file
  @turnStart: open new file, increase file number counter
+
+ with writerThreads > 0 the frames of a turn are only collected (interleaved) in the tick,
+ the file is opened, encoded and written by one of the writer threads at turn end
 */
 
 
@@ -55,14 +58,14 @@ writes data to an uncompressed PCM WAVE file
 #define MODULE "cWaveSinkCut"
 
 
-#define SMILE_SFSTR_8BIT        "8bit"     // 8-bit signed
+#define SMILE_SFSTR_8BIT        "8bit"     // 8-bit unsigned
 #define SMILE_SFSTR_16BIT       "16bit"    // 16-bit signed
 #define SMILE_SFSTR_24BIT       "24bit"    // 24-bit signed sample in 4byte dword
 #define SMILE_SFSTR_24BITp      "24bitp"   // 3-byte packed 24-bit signed value
 #define SMILE_SFSTR_32BIT       "32bit"    // 32-bit signed integer
 #define SMILE_SFSTR_32BIT_FLOAT "float"    // 32-bit float
 
-#define SMILE_SF_8BIT        0    // 8-bit signed
+#define SMILE_SF_8BIT        0    // 8-bit unsigned
 #define SMILE_SF_16BIT       1    // 16-bit signed
 #define SMILE_SF_24BIT       2    // 24-bit signed sample in 4byte dword
 #define SMILE_SF_24BITp      3    // 3-byte packed 24-bit signed value
@@ -90,9 +93,12 @@ SMILECOMPONENT_REGCOMP(cWaveSinkCut)
     ct->setField("postSil","amount of silence at turn end in seconds",0.3);
     ct->setField("startIndex","start index for consecutive numbering of output files",1);
 	  ct->setField("multiOut","1 = output multiple files segmented by turnStart/turnEnd messages ; 0 = write all frames concatenated to one file",1);
-   	char * sfdesc = myvprint("sample format: one of the following:\n   '%s' : 8-bit signed \n   '%s' : 16-bit signed\n   '%s' : 24-bit signed\n   '%s' : 24-bit signed packed in 3 bytes\n   '%s' : 32-bit signed integer\n   '%s' : 32-bit float",SMILE_SFSTR_8BIT,SMILE_SFSTR_16BIT,SMILE_SFSTR_24BIT,SMILE_SFSTR_24BITp,SMILE_SFSTR_32BIT,SMILE_SFSTR_32BIT_FLOAT);
+   	char * sfdesc = myvprint("sample format: one of the following:\n   '%s' : 8-bit unsigned \n   '%s' : 16-bit signed\n   '%s' : 24-bit signed\n   '%s' : 24-bit signed packed in 3 bytes\n   '%s' : 32-bit signed integer\n   '%s' : 32-bit float",SMILE_SFSTR_8BIT,SMILE_SFSTR_16BIT,SMILE_SFSTR_24BIT,SMILE_SFSTR_24BITp,SMILE_SFSTR_32BIT,SMILE_SFSTR_32BIT_FLOAT);
 	  ct->setField("sampleFormat",sfdesc,SMILE_SFSTR_16BIT);
 	  free(sfdesc);
+    ct->setField("dither","1 = add triangular (TPDF) dither noise of +-1 LSB before quantising the samples to integer sample formats (ignored for 'float')",0);
+    ct->setField("writerThreads","(multiOut=1 only) number of threads which open, encode and write the turn files, the tick only collects the samples of a turn and hands the complete turn over at turn end. 0 = open and write the files in the tick (no threads)",1);
+    ct->setField("writerQueueSize","maximum number of complete turns waiting to be written by the writer threads, when the queue is full the tick blocks until a turn has been written",16);
   )
 
   SMILECOMPONENT_MAKEINFO(cWaveSinkCut);
@@ -104,7 +110,6 @@ SMILECOMPONENT_CREATE(cWaveSinkCut)
 
 cWaveSinkCut::cWaveSinkCut(const char *_name) :
   cDataSink(_name),
-  fHandle(NULL),
   filebase(NULL),
   fileExtension(NULL),
   multiOut(0),
@@ -112,7 +117,11 @@ cWaveSinkCut::cWaveSinkCut(const char *_name) :
   turnEnd(0), turnStart(0),
   curFileNr(0), fieldSize(0),
   curVidx(0), vIdxStart(0), vIdxEnd(0), endWait(-1),
-  sampleBuffer(NULL), sampleBufferLen(0),
+  writer(NULL), sampleBuffer(NULL), sampleBufferLen(0), dither(0), ditherState(1),
+  nWriterThreads(0), writerQueueSize(16), writerThreads(NULL),
+  writerThreadsRunning(0), writerStop(0),
+  queueHead(NULL), queueTail(NULL), queueLen(0), curSegment(NULL),
+  sampleRate(0),
   nOvl(0), preSil(0), postSil(0)
 {
   // ...
@@ -138,6 +147,21 @@ void cWaveSinkCut::fetchConfig()
   curFileNr = getInt("startIndex");
   SMILE_IDBG(2,"startIndex = %i",curFileNr);
 
+  dither = getInt("dither");
+  SMILE_IDBG(2,"dither = %i",dither);
+
+  nWriterThreads = getInt("writerThreads");
+  if (nWriterThreads < 0) nWriterThreads = 0;
+#ifndef HAVE_PTHREAD
+#ifndef __WINDOWS
+  nWriterThreads = 0;
+#endif
+#endif
+  if (!multiOut) nWriterThreads = 0;
+  SMILE_IDBG(2,"writerThreads = %i",nWriterThreads);
+  writerQueueSize = getInt("writerQueueSize");
+  if (writerQueueSize < 1) writerQueueSize = 1;
+
   const char * sampleFormatStr = getStr("sampleFormat");
   if (sampleFormatStr != NULL) {
     SMILE_DBG(2,"sampleFormat = '%s'",sampleFormatStr);
@@ -217,16 +241,44 @@ int cWaveSinkCut::myFinaliseInstance()
   nChannels = reader->getLevelNf();
   fieldSize = reader->getLevelN() / nChannels;
 
+  // use reader parameters to determine overlap and sampleRate
+  // TODO: detect overlap!!
+  double fss = reader->getFrameSizeSec();
+  double ft  = reader->getLevelT();
+  nOvl = (long)ceil( (double)fieldSize * (1.0 - (ft/fss)) );
+  sampleRate = (long)( 1.0 / (fss / (double)fieldSize) );
+
+  // start the writer threads
+  if ((nWriterThreads > 0)&&(writerThreads == NULL)) {
+    smileMutexCreate(writerMtx);
+    smileCondCreate(writerCondWork);
+    smileCondCreate(writerCondFree);
+    writerThreads = (smileThread *)calloc(1,sizeof(smileThread)*nWriterThreads);
+    for (writerThreadsRunning=0; writerThreadsRunning<nWriterThreads; writerThreadsRunning++) {
+      if (!smileThreadCreate(writerThreads[writerThreadsRunning], writerThreadMain, this)) {
+        SMILE_IERR(1,"error creating writer thread #%i",writerThreadsRunning);
+        break;
+      }
+    }
+    if (writerThreadsRunning == 0) {
+      SMILE_IWRN(1,"no writer thread could be started, writing turns in the tick");
+      free(writerThreads); writerThreads = NULL;
+      smileCondDestroy(writerCondWork);
+      smileCondDestroy(writerCondFree);
+      smileMutexDestroy(writerMtx);
+    }
+  }
+
   // open wave file for writing
+  if (writer == NULL) writer = createFileWriter();
   if (multiOut == 0) {
-    if (fHandle == NULL) {
-      fHandle = fopen(getCurFileName(), "wb");  // TODO: support append mode
-      if (fHandle == NULL) COMP_ERR("failed to open output file '%s'",getCurFileName());
+    if (!writer->isOpen()) {
+      if (!writer->open(getCurFileName(), "wb")) COMP_ERR("failed to open output file '%s'",getCurFileName());  // TODO: support append mode
     }
   }
 
   nBlocks = 0;
-  if (fHandle != NULL) {
+  if (writer->isOpen()) {
     // write dummy header...
     curWritePos = writeWaveHeader();
     if (curWritePos == 0) COMP_ERR("failed writing initial wave header to file '%s'! Disk full or read-only filesystem?",getCurFileName());
@@ -268,6 +320,9 @@ int cWaveSinkCut::myTick(long long t)
   //if (fieldSize == 0) fieldSize = reader->getLevelN() / reader->getLevelNf(); //vec->fmeta->field[0].N;
 
   if (multiOut == 1) {
+    // turns finished in this tick, handed to the writer threads after the message memory is unlocked
+    sWaveSinkCutSegment *done[2];
+    int i, nDone = 0;
 
     lockMessageMemory();
 
@@ -278,16 +333,27 @@ int cWaveSinkCut::myTick(long long t)
       isTurn = 1;
       SMILE_IDBG(2,"received turn start at vIdx %i!",vIdxStart); 
 
-      // just to be sure...
-      if (fHandle != NULL) fclose(fHandle);
-      fHandle = fopen(getCurFileName(), "wb");  // TODO: support append mode
-      if (fHandle == NULL) SMILE_IERR(1,"failed to open output file '%s', no wave output will be written",getCurFileName());
-
       nBlocks=0;
-      curWritePos = writeWaveHeader();
-      if (curWritePos == 0) {
-        SMILE_IERR(1,"failed writing initial wave header to file '%s'! Disk full or read-only filesystem?",getCurFileName());
-        fclose(fHandle); fHandle=NULL;
+      if (writerThreads != NULL) {
+        // collect the turn in a new segment, the writer threads open and write the file at turn end
+        if (curSegment != NULL) {
+          // the previous turn has not ended yet: hand it to the writer threads, the new turn goes to the next file
+          done[nDone++] = curSegment;
+          curFileNr++;
+        }
+        curSegment = (sWaveSinkCutSegment *)calloc(1,sizeof(sWaveSinkCutSegment));
+        curSegment->filename = getCurFileName();
+        curSegment->ditherState = (unsigned int)curFileNr;
+      } else {
+        // just to be sure...
+        if (!writer->open(getCurFileName(), "wb"))  // TODO: support append mode
+          SMILE_IERR(1,"failed to open output file '%s', no wave output will be written",getCurFileName());
+
+        curWritePos = writeWaveHeader();
+        if (curWritePos == 0) {
+          SMILE_IERR(1,"failed writing initial wave header to file '%s'! Disk full or read-only filesystem?",getCurFileName());
+          writer->close();
+        }
       }
     }
     if (turnEnd) { 
@@ -298,12 +364,17 @@ int cWaveSinkCut::myTick(long long t)
         turnEnd=0; isTurn=0;
       }
       if (!turnEnd) {
-        if (fHandle != NULL) { 
+        if (curSegment != NULL) {
+          SMILE_IDBG(2,"processed turn end, handing turn '%s' (%i frames) to the writer threads",curSegment->filename,curSegment->nFrames);
+          done[nDone++] = curSegment;
+          curSegment = NULL;
+          nBlocks=0;
+          curFileNr++;
+        } else if (writer->isOpen()) { 
           SMILE_IDBG(2,"processed turn end, file '%s' was closed!",getCurFileName()); 
           writeWaveHeader();
-          fclose(fHandle); 
+          writer->close(); 
           nBlocks=0;
-          fHandle=NULL;
           curFileNr++;
         }
       }
@@ -312,10 +383,13 @@ int cWaveSinkCut::myTick(long long t)
     //if (!isTurn) { ret=-3; isTurn = 1; }
     unlockMessageMemory();
 
+    // this may block while the writer queue is full, so it must not hold the message memory lock
+    for (i=0; i<nDone; i++) queueSegment(done[i]);
+
   }
 
   // read next buffer from memory:
-  if ((fHandle != NULL)&&(isTurn)) {
+  if ((isTurn)&&((curSegment != NULL)||((writer != NULL)&&(writer->isOpen())))) {
     cVector *vec = reader->getFrame(curVidx);
     if (vec == NULL) return 0;
     curVidx++;
@@ -332,11 +406,26 @@ int cWaveSinkCut::myTick(long long t)
 
 cWaveSinkCut::~cWaveSinkCut()
 {
+  if (writerThreads != NULL) {
+    // write a turn which has not ended yet, then wait for the writer threads to finish the queue
+    if (curSegment != NULL) queueSegment(curSegment);
+    curSegment = NULL;
+    smileMutexLock(writerMtx);
+    writerStop = 1;
+    smileCondBroadcastRaw(writerCondWork);
+    smileMutexUnlock(writerMtx);
+    int i;
+    for (i=0; i<writerThreadsRunning; i++) smileThreadJoin(writerThreads[i]);
+    free(writerThreads);
+    smileCondDestroy(writerCondWork);
+    smileCondDestroy(writerCondFree);
+    smileMutexDestroy(writerMtx);
+  }
   if (sampleBuffer!=NULL) free(sampleBuffer);
-  if (fHandle != NULL) {
+  if (writer != NULL) {
     // write final wave header
     writeWaveHeader();
-    fclose(fHandle);
+    delete writer;
   }
 }
 
@@ -370,40 +459,32 @@ typedef struct {
   uint32_t SubchunkSize;
 } sRiffChunkHeader;
 
-int cWaveSinkCut::writeWaveHeader()
+void cWaveSinkCut::fillWaveHeader(void *_head, long _nBlocks)
 {
-  if (fHandle == NULL) return 0;
-
-  // use reader parameters to determine
-  //   nChannels
-  //   sampleRate
-  long sampleRate;
-  // TODO: detect overlap!!
-  double fss = reader->getFrameSizeSec();
-  double ft  = reader->getLevelT();
-
-  nOvl = (long)ceil( (double)fieldSize * (1.0 - (ft/fss)) );
+  sRiffPcmWaveHeader *head = (sRiffPcmWaveHeader *)_head;
+  head->Riff = 0x46464952;  // RIFF
+  head->Format = 0x45564157; // WAVE
+  head->Subchunk1ID = 0x20746D66; // fmt
+  head->Subchunk1Size = 4*4; // size of format chunk
+  head->SampleRate = sampleRate;
+  head->BitsPerSample = nBitsPerSample;
+  head->ByteRate = sampleRate * nChannels * nBytesPerSample;
+  head->AudioFormat = (sampleFormat == SMILE_SF_32BIT_FLOAT) ? 3 : 1; // 3 = IEEE float, 1 = PCM
+  head->NumChannels = nChannels;
+  head->BlockAlign = nChannels * nBytesPerSample;
+  head->Subchunk2ID = 0x61746164; // data
+  head->Subchunk2Size = _nBlocks * nChannels * nBytesPerSample;  // size of wave data chunk
+  head->FileSize = sizeof(sRiffPcmWaveHeader)  + head->Subchunk2Size;
+}
 
-  sampleRate = (long)( 1.0 / (fss / (double)fieldSize) );
-  // get sample format from config options
+int cWaveSinkCut::writeWaveHeader()
+{
+  if ((writer == NULL)||(!writer->isOpen())) return 0;
 
   sRiffPcmWaveHeader head; 
-  head.Riff = 0x46464952;  // RIFF
-  head.Format = 0x45564157; // WAVE
-  head.Subchunk1ID = 0x20746D66; // fmt
-  head.Subchunk1Size = 4*4; // size of format chunk
-  head.SampleRate = sampleRate;
-  head.BitsPerSample = nBitsPerSample;
-  head.ByteRate = sampleRate * nChannels * nBytesPerSample;
-  head.AudioFormat = 1; // !!! ??
-  head.NumChannels = nChannels;
-  head.BlockAlign = nChannels * nBytesPerSample;
-  head.Subchunk2ID = 0x61746164; // data
-  head.Subchunk2Size = nBlocks * nChannels * nBytesPerSample;  // size of wave data chunk
-  head.FileSize = sizeof(sRiffPcmWaveHeader)  + head.Subchunk2Size;
-
-  fseek(fHandle, 0, SEEK_SET);
-  return (fwrite(&head, sizeof(sRiffPcmWaveHeader), 1, fHandle) == 1 ? sizeof(sRiffPcmWaveHeader) : 0 );
+  fillWaveHeader(&head, nBlocks);
+
+  return (writer->writeAt(0, &head, sizeof(sRiffPcmWaveHeader)) ? sizeof(sRiffPcmWaveHeader) : 0 );
 }
 
 int cWaveSinkCut::writeDataFrame(cVector *m) 
@@ -411,8 +492,6 @@ int cWaveSinkCut::writeDataFrame(cVector *m)
   if (m!=NULL) {
     if (m->fmeta->N != nChannels) { SMILE_IERR(1,"number of chanels is inconsistent! %i <-> %i",m->fmeta->N,nChannels); return 0; }
     else {
-      // convert data
-      long i,j;
       if (( (m->fmeta->field[0].N - nOvl) > sampleBufferLen)&&(sampleBuffer!=NULL)) { free(sampleBuffer); sampleBuffer = NULL; }
       sampleBufferLen = m->fmeta->field[0].N - nOvl;
       if (sampleBufferLen<=0) {
@@ -420,64 +499,31 @@ int cWaveSinkCut::writeDataFrame(cVector *m)
         return 0;
       }
 
-      if (sampleBuffer == NULL) sampleBuffer = malloc(nBytesPerSample*nChannels*sampleBufferLen);
+      if (curSegment != NULL) {
+        // conversion from separate channels to interleaved float channels, directly into the current segment 
+        if (curSegment->nFrames + sampleBufferLen > curSegment->nAlloc) {
+          long na = curSegment->nAlloc*2 + sampleBufferLen;
+          FLOAT_DMEM *d = (FLOAT_DMEM *)realloc(curSegment->data, sizeof(FLOAT_DMEM)*na*nChannels);
+          if (d == NULL) OUT_OF_MEMORY;
+          curSegment->data = d;
+          curSegment->nAlloc = na;
+        }
+        smilePcm_fromFloat(m->dataF, 1, sampleBufferLen, curSegment->data + curSegment->nFrames*nChannels, sampleBufferLen, nChannels, 4, 32, 1, NULL);
+        curSegment->nFrames += sampleBufferLen;
+        nBlocks += sampleBufferLen;
+        return sampleBufferLen;
+      }
 
-      int8_t *b8;
-      int16_t *b16;
-      int32_t *b32;
-      float *b32f;
-
-      switch(sampleFormat) {
-        case SMILE_SF_8BIT: 
-          b8 = (int8_t*)sampleBuffer;
-          for (i=0; i<sampleBufferLen; i++) { 
-            for (j=0; j<nChannels; j++) { // conversion from separate channels to interleaved channels
-              b8[i*nChannels+j] = (int8_t)round(m->dataF[i+sampleBufferLen*j] * 127.0);
-            }
-          }
-          break;
-        case SMILE_SF_16BIT: 
-          b16 = (int16_t*)sampleBuffer;
-          for (i=0; i<sampleBufferLen; i++) { 
-            for (j=0; j<nChannels; j++) { // conversion from separate channels to interleaved channels
-              b16[i*nChannels+j] = (int16_t)round(m->dataF[i+sampleBufferLen*j] * 32767.0); 
-            }
-          }
-          break;
-        case SMILE_SF_24BIT: 
-          b32 = (int32_t*)sampleBuffer;
-          for (i=0; i<sampleBufferLen; i++) { 
-            for (j=0; j<nChannels; j++) { // conversion from separate channels to interleaved channels
-              b32[i*nChannels+j] = (int32_t)round(m->dataF[i+sampleBufferLen*j] * 32767.0 * 256.0);
-            }
-          }
-          break;
-        case SMILE_SF_24BITp: 
-          COMP_ERR("24-bit wave file with 3 bytes per sample encoding not yet supported!");
-          //int16_t *b16 = buf;
-          //for (i=0; i<m->nT*nChannels; i++) { b16[i] = (int16_t)round(m->dataF[i] * 32767.0); }
-          //break;
-        case SMILE_SF_32BIT: 
-          b32 = (int32_t*)sampleBuffer;
-          for (i=0; i<sampleBufferLen; i++) { 
-            for (j=0; j<nChannels; j++) { // conversion from separate channels to interleaved channels
-              b32[i*nChannels+j] = (int32_t)round(m->dataF[i+sampleBufferLen*j] * 32767.0 * 32767.0 * 2.0); 
-            }
-          }
-          break;
-        case SMILE_SF_32BIT_FLOAT: 
-          b32f = (float*)sampleBuffer;
-          for (i=0; i<sampleBufferLen; i++) { 
-            for (j=0; j<nChannels; j++) { // conversion from separate channels to interleaved channels
-              b32f[i*nChannels+j] = (float)(m->dataF[i+sampleBufferLen*j]); 
-            }
-          }
-          break;
-        default:
-          SMILE_IERR(1,"unknown sampleFormat encountered in writeData(): %i",sampleFormat);
+      // convert data, from separate channels to interleaved channels
+      if (sampleBuffer == NULL) sampleBuffer = malloc(nBytesPerSample*nChannels*sampleBufferLen);
+      if (!smilePcm_fromFloat(m->dataF, 1, sampleBufferLen, sampleBuffer, sampleBufferLen, nChannels, nBytesPerSample, nBitsPerSample, 
+                              (sampleFormat == SMILE_SF_32BIT_FLOAT), (dither ? &ditherState : NULL))) {
+        SMILE_IERR(1,"unknown sampleFormat encountered in writeData(): %i",sampleFormat);
+        return 0;
       }
 
-      long written = (long)fwrite(sampleBuffer, nBytesPerSample*nChannels, sampleBufferLen, fHandle);
+      long written = 0;
+      if (writer->write(sampleBuffer, nBytesPerSample*nChannels*sampleBufferLen)) written = sampleBufferLen;
       //printf("written: %i of %i\n",written,m->nT);
       if (written > 0) {
         nBlocks += written;
@@ -489,3 +535,83 @@ int cWaveSinkCut::writeDataFrame(cVector *m)
   }
   return 0;
 }
+
+//----------------------------------------------------------------------------------
+
+// append a complete turn to the queue of the writer threads, blocks while the queue is full
+void cWaveSinkCut::queueSegment(sWaveSinkCutSegment *s)
+{
+  smileMutexLock(writerMtx);
+  while (queueLen >= writerQueueSize) smileCondWaitWMtx(writerCondFree, writerMtx);
+  s->next = NULL;
+  if (queueTail != NULL) queueTail->next = s;
+  else queueHead = s;
+  queueTail = s;
+  queueLen++;
+  smileCondSignalRaw(writerCondWork);
+  smileMutexUnlock(writerMtx);
+}
+
+SMILE_THREAD_RETVAL cWaveSinkCut::writerThreadMain(void *_obj)
+{
+  cWaveSinkCut *obj = (cWaveSinkCut *)_obj;
+  while (1) {
+    smileMutexLock(obj->writerMtx);
+    while ((obj->queueHead == NULL)&&(!obj->writerStop)) smileCondWaitWMtx(obj->writerCondWork, obj->writerMtx);
+    sWaveSinkCutSegment *s = obj->queueHead;
+    if (s != NULL) {
+      obj->queueHead = s->next;
+      if (obj->queueHead == NULL) obj->queueTail = NULL;
+      obj->queueLen--;
+      smileCondSignalRaw(obj->writerCondFree);
+    }
+    smileMutexUnlock(obj->writerMtx);
+    if (s == NULL) break;  // stopped and queue is empty
+
+    obj->writeSegment(s);
+    if (s->data != NULL) free(s->data);
+    if (s->filename != NULL) free(s->filename);
+    free(s);
+  }
+  SMILE_THREAD_RET;
+}
+
+// write one turn to a new wave file (called by the writer threads)
+int cWaveSinkCut::writeSegment(sWaveSinkCutSegment *s)
+{
+  cSmileFileWriter *w = new cSmileFileWriter((size_t)writeBufferSize, 0);
+  if (!w->open(s->filename, "wb")) {
+    SMILE_IERR(1,"failed to open output file '%s', no wave output will be written",s->filename);
+    delete w;
+    return 0;
+  }
+
+  int ret = 1;
+  sRiffPcmWaveHeader head; 
+  fillWaveHeader(&head, s->nFrames);
+  if (!w->write(&head, sizeof(sRiffPcmWaveHeader))) {
+    SMILE_IERR(1,"failed writing wave header to file '%s'! Disk full or read-only filesystem?",s->filename);
+    ret = 0;
+  }
+
+  // convert and write in chunks of up to 4096 sample frames
+  long chunk = 4096;
+  char *buf = (char *)malloc(nBytesPerSample*nChannels*chunk);
+  long i, n = s->nFrames;
+  for (i=0; (i<n)&&ret; i+=chunk) {
+    long len = n-i < chunk ? n-i : chunk;
+    if (!smilePcm_fromFloat(s->data+i*nChannels, nChannels, 1, buf, len, nChannels, nBytesPerSample, nBitsPerSample, 
+                            (sampleFormat == SMILE_SF_32BIT_FLOAT), (dither ? &s->ditherState : NULL))) {
+      SMILE_IERR(1,"sampleFormat %i is not supported, no wave output will be written to '%s'",sampleFormat,s->filename);
+      ret = 0;
+    } else if (!w->write(buf, nBytesPerSample*nChannels*len)) {
+      SMILE_IERR(1,"failed writing wave data to file '%s'! Disk full or read-only filesystem?",s->filename);
+      ret = 0;
+    }
+  }
+  free(buf);
+  w->close();
+  delete w;
+  if (ret) SMILE_IDBG(2,"turn file '%s' was written (%i frames)",s->filename,s->nFrames);
+  return ret;
+}
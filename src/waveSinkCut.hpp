@@ -49,6 +49,15 @@ writes data to an uncompressed PCM WAVE file
 #define COMPONENT_DESCRIPTION_CWAVESINKCUT "waveSink, writes data to an uncompressed PCM WAVE file"
 #define COMPONENT_NAME_CWAVESINKCUT "cWaveSinkCut"
 
+// one turn (segment) to be written by the writer threads: interleaved float samples
+typedef struct sWaveSinkCutSegment {
+  char *filename;
+  FLOAT_DMEM *data;
+  long nFrames, nAlloc;   // sample frames (one sample per channel) in data / allocated
+  unsigned int ditherState;
+  struct sWaveSinkCutSegment *next;
+} sWaveSinkCutSegment;
+
 class cWaveSinkCut : public cDataSink {
   private:
     const char *fileExtension;
@@ -62,8 +71,26 @@ class cWaveSinkCut : public cDataSink {
     long curStart, curEnd;
     int isTurn, endWait;
 
-    FILE * fHandle;
+    cSmileFileWriter * writer;
     void *sampleBuffer; long sampleBufferLen;
+    int dither;
+    unsigned int ditherState;
+
+    // writer threads (multiOut=1): the samples of a turn are collected in a segment, which is written when the turn ends
+    int nWriterThreads, writerQueueSize;
+    smileThread *writerThreads;
+    int writerThreadsRunning, writerStop;
+    smileMutex writerMtx;
+    smileCond writerCondWork, writerCondFree;
+    sWaveSinkCutSegment *queueHead, *queueTail;
+    int queueLen;
+    sWaveSinkCutSegment *curSegment;
+
+    static SMILE_THREAD_RETVAL writerThreadMain(void *_obj);
+    void queueSegment(sWaveSinkCutSegment *s);
+    int writeSegment(sWaveSinkCutSegment *s);
+    void fillWaveHeader(void *head, long _nBlocks);
+    long sampleRate;
 
   	int nBitsPerSample;
 	  int nBytesPerSample;
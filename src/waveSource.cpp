@@ -55,6 +55,9 @@ SMILECOMPONENT_REGCOMP(cWaveSource)
   SMILECOMPONENT_IFNOTREGAGAIN(
     ct->makeMandatory(ct->setField("filename","filename of PCM wave file to load",""));
     ct->setField("monoMixdown","mix down all channels to 1 mono channel",0);
+    ct->setField("channel","read only this channel (0 = first channel) and output it as mono signal, -1 = read all channels (ignored if monoMixdown = 1)",-1);
+    ct->setField("mmap","1 = memory map the wave file (if supported by the OS), 0 = read the file block by block",1);
+    ct->setField("prefetch","number of blocks read and converted ahead by a background thread, while the previous blocks are processed (0 = read in the tick function)",0);
     ct->setField("start","read start in seconds from beginning of file",0.0);
     ct->setField("end","read end in seconds from beginning of file (-1 = read to EoF)",-1.0);
     ct->setField("endrel","read end in seconds from END of file (only if 'end' = -1)",0.0);
@@ -81,7 +84,14 @@ cWaveSource::cWaveSource(const char *_name) :
   pcmDataBegin(0),
   curReadPos(0),
   eof(0),
-  monoMixdown(0)
+  monoMixdown(0),
+  channel(-1),
+  useMmap(1),
+  mapData(NULL),
+  mapSize(0),
+  readBuf(NULL),
+  prefetch(0),
+  queue(NULL)
 {
   // ...
 }
@@ -102,6 +112,11 @@ void cWaveSource::fetchConfig()
 
   monoMixdown = getInt("monoMixdown");
   if (monoMixdown) SMILE_DBG(2,"monoMixdown enabled!");
+  channel = getInt("channel");
+  if (monoMixdown) channel = -1;
+  if (channel >= 0) SMILE_DBG(2,"reading only channel %i",channel);
+  useMmap = getInt("mmap");
+  prefetch = getInt("prefetch");
 
   start = getDouble("start");
   endrel = getDouble("endrel");
@@ -128,6 +143,10 @@ int cWaveSource::configureWriter(sDmLevelConfig &c)
 {
   int ret = readWaveHeader();
   if (ret == 0) COMP_ERR("failed reading wave header from file '%s'! Maybe this is not a WAVE file?",filename);
+  if (channel >= pcmParam.nChan) COMP_ERR("channel %i requested, but wave file '%s' has only %i channel(s)!",channel,filename,pcmParam.nChan);
+  if ((useMmap)&&(mapData == NULL)) {
+    if (!mapFile()) SMILE_IMSG(3,"cannot memory map '%s', reading with fread",filename);
+  }
 
   double srate = (double)(pcmParam.sampleRate);
   if (srate==0.0) srate = 1.0;
@@ -171,7 +190,7 @@ int cWaveSource::configureWriter(sDmLevelConfig &c)
 
   if (startSamples > 0) { // seek to start pos!
     curReadPos = startSamples;
-    fseek( filehandle, curReadPos*pcmParam.blockSize, SEEK_SET );
+    if (mapData == NULL) fseek( filehandle, pcmDataBegin + curReadPos*pcmParam.blockSize, SEEK_SET );
   }
 
     // TODO:: AUTO buffersize.. maximum length of wave data to store (depends on config of windower components)
@@ -196,16 +215,14 @@ int cWaveSource::myConfigureInstance()
 
   int ret = cDataSource::myConfigureInstance();
   
-  if (!ret) {
-    fclose(filehandle); filehandle = NULL;
-  }
+  if (!ret) closeFile();
   return ret;
 }
 
 int cWaveSource::setupNewNames(long nEl) 
 {
   // configure dataMemory level, names, etc.
-  if (monoMixdown) {
+  if ((monoMixdown)||(channel >= 0)) {
     writer->addField("pcm",1);
     allocMat(1, blocksizeW);
   } else {
@@ -217,18 +234,33 @@ int cWaveSource::setupNewNames(long nEl)
   return 1;
 }
 
-/*
 int cWaveSource::myFinaliseInstance()
 {
- 
-  return cDataSource::myFinaliseInstance();
+  int ret = cDataSource::myFinaliseInstance();
+  if ((ret)&&(prefetch > 0)) {
+    queue = new cSmilePrefetchQueue(readBlock, this, mat->N, blocksizeW, prefetch, 1);
+    queue->start();
+  }
+  return ret;
 }
-*/
 
 int cWaveSource::myTick(long long t)
 {
   if (isEOI()) return 0; //XXX ????
   
+  if (queue != NULL) {
+    // blocks are read by the prefetch thread
+    if (!writer->checkWrite(blocksizeW)) return 0;
+    cMatrix *m = queue->front();
+    if (m == NULL) return 0;
+    if (!writer->setNextMatrix(m)) {
+      SMILE_IERR(1,"can't write, level full... (strange, level space was checked using checkWrite(bs=%i)",blocksizeW);
+      return 0;
+    }
+    queue->pop();
+    return 1;
+  }
+
   // TODO: check if there is space in dmLevel for this write...!
   if (writer->checkWrite(blocksizeW)) {
     if (readData()) { // read new data from wave file!
@@ -245,7 +277,10 @@ int cWaveSource::myTick(long long t)
 
 cWaveSource::~cWaveSource()
 {
-  if (filehandle != NULL) fclose(filehandle);
+  // stop the prefetch thread before the file is closed
+  if (queue != NULL) delete queue;
+  closeFile();
+  if (readBuf != NULL) free(readBuf);
 }
 
 //--------------------------------------------------  wave specific
@@ -254,6 +289,17 @@ cWaveSource::~cWaveSource()
 #include <unistd.h>
 #endif
 
+#ifndef __WINDOWS
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+/* format codes in the fmt chunk */
+#define RIFF_FMT_PCM         0x0001
+#define RIFF_FMT_FLOAT       0x0003
+#define RIFF_FMT_EXTENSIBLE  0xFFFE
+
 /* WAVE Header struct, valid only for PCM Files */
 typedef struct {
   uint32_t	Riff;    /* Must be little endian 0x46464952 (RIFF) */
@@ -278,6 +324,44 @@ typedef struct {
   uint32_t SubchunkSize;
 } sRiffChunkHeader;
 
+// map the whole wave file into memory, returns 0 if this is not possible (then fread is used)
+int cWaveSource::mapFile()
+{
+#ifndef __WINDOWS
+  struct stat st;
+  if (filehandle == NULL) return 0;
+  if (fstat(fileno(filehandle), &st) != 0) return 0;
+  if ((long)st.st_size <= pcmDataBegin) return 0;
+  void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(filehandle), 0);
+  if (p == MAP_FAILED) return 0;
+#ifdef MADV_SEQUENTIAL
+  madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+  mapData = (unsigned char *)p;
+  mapSize = (long)st.st_size;
+  // the mapping stays valid after the file is closed
+  fclose(filehandle); filehandle = NULL;
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+void cWaveSource::closeFile()
+{
+  if (filehandle != NULL) { fclose(filehandle); filehandle = NULL; }
+#ifndef __WINDOWS
+  if (mapData != NULL) { munmap((void *)mapData, (size_t)mapSize); mapData = NULL; }
+#endif
+}
+
+// prefetch queue read function: reads the next block into m, returns the number of frames read
+long cWaveSource::readBlock(void *_obj, cMatrix *m)
+{
+  if (!((cWaveSource *)_obj)->readData(m)) return 0;
+  return m->nT;
+}
+
 // reads data into matix m, size is determined by m, also performs format conversion to float samples and matrix format
 int cWaveSource::readData(cMatrix *m)
 {
@@ -286,150 +370,63 @@ int cWaveSource::readData(cMatrix *m)
     return 0;
   }
   
-  // TODO: mono-mixdown...
-  
   if (m==NULL) {
     if (mat == NULL) {
-      if (monoMixdown) allocMat(1, blocksizeW);
+      if ((monoMixdown)||(channel >= 0)) allocMat(1, blocksizeW);
       else allocMat(pcmParam.nChan, blocksizeW);
     }
     m=mat;
   }
-  if ( (m->N != pcmParam.nChan)&&((!monoMixdown) && (m->N == 1)) ) {
-    SMILE_ERR(1,"readData: incompatible read! nChan=%i <-> matrix N=%i (these numbers must match!)\n",pcmParam.nChan,m->N);
+  long nOut = ((monoMixdown)||(channel >= 0)) ? 1 : pcmParam.nChan;
+  if (m->N != nOut) {
+    SMILE_ERR(1,"readData: incompatible read! nChan=%i <-> matrix N=%i (these numbers must match!)\n",nOut,m->N);
     return 0;
   }
-  // now convert the sample types to float or int (specified by cMatrix)
-    // TODO: support int, by now only float is supported!
+  // TODO: support int, by now only float is supported!
+
+  long nFrames = blocksizeW;
+  if (endSamples - curReadPos < nFrames) nFrames = endSamples - curReadPos;
+  if (nFrames < 0) nFrames = 0;
+
+  // the samples are converted directly from the file mapping (or the block buffer) into the output matrix
+  const unsigned char *buf = NULL;
+  if (mapData != NULL) {
+    long nAvail = (mapSize - pcmDataBegin) / pcmParam.blockSize - curReadPos;  // the header might promise more data than there is
+    if (nFrames > nAvail) nFrames = (nAvail > 0) ? nAvail : 0;
+    buf = mapData + pcmDataBegin + curReadPos*pcmParam.blockSize;
+  } else if (filehandle != NULL) {
+    if (readBuf == NULL) {
+      readBuf = (unsigned char *)malloc(pcmParam.blockSize * blocksizeW);
+      if (readBuf==NULL) OUT_OF_MEMORY;
+    }
+    nFrames = (long)fread(readBuf, 1, nFrames*pcmParam.blockSize, filehandle) / pcmParam.blockSize;
+    buf = readBuf;
+  } else {
+    nFrames = 0;
+  }
 
-  int bs = pcmParam.blockSize * blocksizeW;
-  if (endSamples - curReadPos < blocksizeW) { bs = (endSamples - curReadPos)*pcmParam.blockSize; }
-  
-  uint8_t *buf = (uint8_t *)malloc(bs);
-  if (buf==NULL) OUT_OF_MEMORY;
-  int nRead = (int)fread(buf, 1, bs, filehandle);
-  if (nRead != pcmParam.blockSize * blocksizeW) {
+  if (nFrames > 0) {
+    int chanSel = SMILEPCM_ALLCHANNELS;
+    if (monoMixdown) chanSel = SMILEPCM_MIXDOWN;
+    else if (channel >= 0) chanSel = channel;
+    if (!smilePcm_toFloat(buf, m->dataF, nFrames, pcmParam.nChan, pcmParam.nBPS, pcmParam.nBits, (pcmParam.sampleType == RIFF_FMT_FLOAT), chanSel)) {
+      SMILE_ERR(1,"readData: cannot convert unknown sample format to float! (nBPS=%i, nBits=%i)",pcmParam.nBPS,pcmParam.nBits);
+      nFrames = 0;
+    }
+    curReadPos += nFrames;
+  }
+
+  if (nFrames < blocksizeW) {
     // EOF (or Error..?):
-    SMILE_IWRN(5,"nRead (%i) < size to read (%i) ==> assuming EOF!",nRead,bs);
+    SMILE_IWRN(5,"nRead (%i) < size to read (%i) ==> assuming EOF!",nFrames,blocksizeW);
     eof=1;
     // TODO: signal EOF to component manager !
     
-    m->nT = nRead / pcmParam.blockSize; // int div rounds down..!? it should better do so...
-    fclose(filehandle); filehandle = NULL;
+    m->nT = nFrames;
+    closeFile();
   }
 
-  if (nRead > 0) {
-    curReadPos += nRead/pcmParam.blockSize;
-    
-    int i,c;
-    int8_t *b8=(int8_t*)buf;
-    int16_t *b16 = (int16_t*)buf;
-    int32_t *b32 = (int32_t*)buf;
-
-    if (monoMixdown) {
-
-      switch(pcmParam.nBPS) {
-        case 1: // 8-bit int
-          for (i=0; i<m->nT; i++) {
-            FLOAT_DMEM tmp = 0.0;
-            for (c=0; c<pcmParam.nChan; c++) {
-              tmp += (FLOAT_DMEM)b8[i*pcmParam.nChan+c];
-            }
-            m->setF(0,i,(tmp/(FLOAT_DMEM)pcmParam.nChan)/127.0);
-          }
-          break;
-        case 2: // 16-bit int
-          for (i=0; i<m->nT; i++) {
-            FLOAT_DMEM tmp = 0.0;
-            for (c=0; c<pcmParam.nChan; c++) {
-              tmp += (FLOAT_DMEM)b16[i*pcmParam.nChan+c];
-            }
-            m->setF(0,i,(tmp/(FLOAT_DMEM)pcmParam.nChan)/32767.0);
-          }
-          break;
-        case 3: // 24-bit int
-          COMP_ERR("24-bit wave file with 3 bytes per sample encoding not yet supported!");
-        /*
-        int24_t *b24 = (int24_t*)buf;
-        for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-          m->setF(c,i,((FLOAT_DMEM)b24[i*pcmParam.nChan+c])/(32767.0*256.0));
-        } break;
-        */
-          break;
-        case 4: // 32-bit int or 24-bit packed int
-          if (pcmParam.nBits == 24) {
-            for (i=0; i<m->nT; i++) {
-              FLOAT_DMEM tmp = 0.0;
-              for (c=0; c<pcmParam.nChan; c++) {
-                tmp += (FLOAT_DMEM)(b32[i*pcmParam.nChan+c]&0xFFFFFF);
-              }
-              m->setF(0,i,(tmp/(FLOAT_DMEM)pcmParam.nChan)/(32767.0*256.0));
-            }
-            break;
-          } else if (pcmParam.nBits == 32) {
-            for (i=0; i<m->nT; i++) {
-              FLOAT_DMEM tmp = 0.0;
-              for (c=0; c<pcmParam.nChan; c++) {
-                tmp += (FLOAT_DMEM)(b32[i*pcmParam.nChan+c]);
-              }
-              m->setF(0,i,(tmp/(FLOAT_DMEM)pcmParam.nChan)/(32767.0*32767.0*2.0));
-            }
-            break;
-
-      /*      for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-              m->setF(c,i,((FLOAT_DMEM)b32[i*pcmParam.nChan+c])/(32767.0*32767.0*2.0));
-            } break;*/
-        }
-        default:
-          SMILE_ERR(1,"readData: cannot convert unknown sample format to float! (nBPS=%i, nBits=%i)",pcmParam.nBPS,pcmParam.nBits);
-          nRead=0;
-      }
-    
-    } else { // no mixdown, multi-channel matrix output
-
-      switch(pcmParam.nBPS) {
-        case 1: // 8-bit int
-          for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-            m->setF(c,i,((FLOAT_DMEM)b8[i*pcmParam.nChan+c])/127.0);
-          } break;
-        case 2: // 16-bit int
-          for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-            m->setF(c,i,((FLOAT_DMEM)b16[i*pcmParam.nChan+c])/32767.0);
-          } break;
-        case 3: // 24-bit int
-          COMP_ERR("24-bit wave file with 3 bytes per sample encoding not yet supported!");
-        /*
-        int24_t *b24 = (int24_t*)buf;
-        for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-          m->setF(c,i,((FLOAT_DMEM)b24[i*pcmParam.nChan+c])/(32767.0*256.0));
-        } break;
-        */
-          break;
-        case 4: // 32-bit int or 24-bit packed int
-          if (pcmParam.nBits == 24) {
-            for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-              m->setF(c,i,((FLOAT_DMEM)(b32[i*pcmParam.nChan+c]&0xFFFFFF))/(32767.0*32767.0*2.0));
-            } break;
-          } else if (pcmParam.nBits == 32) {
-            for (i=0; i<m->nT; i++) for (c=0; c<pcmParam.nChan; c++) {
-              m->setF(c,i,((FLOAT_DMEM)b32[i*pcmParam.nChan+c])/(32767.0*32767.0*2.0));
-            } break;
-          }
-
-        default:
-          SMILE_ERR(1,"readData: cannot convert unknown sample format to float! (nBPS=%i, nBits=%i)",pcmParam.nBPS,pcmParam.nBits);
-          nRead=0;
-      }
-
-
-    }
-    
-    // TODO: copy above code and change for DMEM_INT!
-    
-  }
-
-  free(buf);
-  return (nRead>0);
+  return (nFrames>0);
 }
 
 int cWaveSource::readWaveHeader()
@@ -453,14 +450,40 @@ int cWaveSource::readWaveHeader()
 		(head.Format != 0x45564157) ||
 		(head.Subchunk1ID != 0x20746D66) ||
 //		(head.Subchunk2ID != 0x61746164) ||
-		(head.AudioFormat != 1) ||
-		(head.Subchunk1Size != 16)) {
+		(head.Subchunk1Size < 16)) {
                             SMILE_ERR(1,"\n  Riff: %x\n  Format: %x\n  Subchunk1ID: %x\n  Subchunk2ID: %x\n  AudioFormat: %x\n  Subchunk1Size: %x",
                                         head.Riff, head.Format, head.Subchunk1ID, head.Subchunk2ID, head.AudioFormat, head.Subchunk1Size);
                             SMILE_ERR(1,"bogus wave/riff header or file in wrong format!");
                             return 0;
         }
 
+    int format = head.AudioFormat;
+    if (head.Subchunk1Size > 16) {
+      // extended fmt chunk (float or WAVE_FORMAT_EXTENSIBLE files), the next chunk header follows after the extension
+      if ((format == RIFF_FMT_EXTENSIBLE)&&(head.Subchunk1Size >= 40)) {
+        // the first two bytes of the sub-format GUID (at offset 24 in the fmt chunk) are the actual format code
+        uint16_t subFormat = 0;
+        fseek(filehandle, 20+24, SEEK_SET);
+        if (fread(&subFormat, 1, 2, filehandle) != 2) {
+          SMILE_ERR(1,"error reading the extensible fmt chunk of wave file '%s'!",filename);
+          return 0;
+        }
+        format = subFormat;
+      }
+      fseek(filehandle, 20 + head.Subchunk1Size + (head.Subchunk1Size&1), SEEK_SET);
+      nRead = (int)fread(&chunkhead, 1, sizeof(chunkhead), filehandle);
+      if (nRead != sizeof(chunkhead)) {
+        SMILE_ERR(1,"less bytes read (%i) from wave file '%s' than there should be (%i) while reading sub-chunk header! File seems broken!\n",nRead,filename,sizeof(chunkhead));
+        return 0;
+      }
+      head.Subchunk2ID = chunkhead.SubchunkID;
+      head.Subchunk2Size = chunkhead.SubchunkSize;
+    }
+    if ( ((format != RIFF_FMT_PCM)&&(format != RIFF_FMT_FLOAT)) || ((format == RIFF_FMT_FLOAT)&&(head.BitsPerSample != 32)) ) {
+      SMILE_ERR(1,"unsupported sample format in wave file '%s' (format code %x, %i bits per sample), only integer PCM and 32-bit float samples are supported!",filename,format,head.BitsPerSample);
+      return 0;
+    }
+
     while ((head.Subchunk2ID != 0x61746164)&&(safetytimeout>0)) { // 0x61746164 = 'data'
       // keep searching for 'data' chunk:
       if (head.Subchunk2Size < 99999) {
@@ -489,6 +512,7 @@ int cWaveSource::readWaveHeader()
       return 0;
     }
     
+    pcmParam.sampleType = format;
     pcmParam.sampleRate = head.SampleRate;
     pcmParam.nChan = head.NumChannels;
     pcmParam.nBPS = head.BlockAlign/head.NumChannels;
@@ -43,6 +43,7 @@ waveSource : reads PCM WAVE files (RIFF format)
 
 #include <smileCommon.hpp>
 #include <dataSource.hpp>
+#include <smilePrefetchQueue.hpp>
 
 #define COMPONENT_DESCRIPTION_CWAVESOURCE "dataSource which reads an uncompressed RIFF (PCM-WAVE) file"
 #define COMPONENT_NAME_CWAVESOURCE "cWaveSource"
@@ -54,7 +55,7 @@ waveSource : reads PCM WAVE files (RIFF format)
 
 typedef struct {
   long sampleRate;
-  int sampleType;
+  int sampleType;  // format code from the fmt chunk (1 = integer PCM, 3 = IEEE float)
   int nChan;
   int blockSize;
   int nBPS;       // actual bytes per sample
@@ -75,19 +76,29 @@ class cWaveSource : public cDataSource {
     long startSamples, endSamples, endrelSamples;
     
     int monoMixdown;    // if set to 1, multi-channel files will be mixed down to 1 channel
+    int channel;        // if >= 0, only this channel is read
+    int useMmap;
+    unsigned char *mapData;   // memory mapped wave file (or NULL, if fread is used)
+    long mapSize;
+    unsigned char *readBuf;   // block buffer for fread, if the file is not memory mapped
     long pcmDataBegin;  // in bytes
     long curReadPos;   // in samples
     int eof;
+    int prefetch;      // number of blocks read ahead by the prefetch thread (0 = read in the tick)
+    cSmilePrefetchQueue *queue;
 
     int readWaveHeader();
+    int mapFile();
+    void closeFile();
     int readData(cMatrix *m=NULL);
+    static long readBlock(void *_obj, cMatrix *m);
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
     
     virtual void fetchConfig();
     virtual int myConfigureInstance();
-    //virtual int myFinaliseInstance();
+    virtual int myFinaliseInstance();
     virtual int myTick(long long t);
 
     virtual int configureWriter(sDmLevelConfig &c);
@@ -98,6 +109,11 @@ class cWaveSource : public cDataSource {
     
     cWaveSource(const char *_name);
 
+    // range of samples read from the file [startSamples, endSamples) and the sample rate, valid after configuration
+    long getStartSamples() { return startSamples; }
+    long getEndSamples() { return endSamples; }
+    long getSampleRate() { return pcmParam.sampleRate; }
+
     virtual ~cWaveSource();
 };
 
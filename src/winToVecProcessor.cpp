@@ -100,8 +100,10 @@ cWinToVecProcessor::cWinToVecProcessor(const char *_name) :
   tmpFrameI(NULL),
   tmpVec(NULL),
   noPostEOIprocessing(0),
+  virtualLevel(0),
   nQ(0),
-  frameMode(FRAMEMODE_FIXED)
+  frameMode(FRAMEMODE_FIXED),
+  zeroCopy(0)
 {
 }
 
@@ -266,6 +268,15 @@ int cWinToVecProcessor::configureWriter(sDmLevelConfig &c)
   if (frameMode != FRAMEMODE_VAR) 
     reader->setupSequentialMatrixReading(frameStepFrames, frameSizeFrames, pre);
 
+  if (zeroCopy) {
+    // the frames are exactly the matrices getNextMatrix() would return, unless incomplete frames are processed at the end
+    if ((frameMode == FRAMEMODE_FIXED)&&(noPostEOIprocessing)&&(dtype == DMEM_FLOAT)&&(!c.growDyn)&&(reader->getNLevels() == 1)&&(!reader->isPruned())) {
+      virtualLevel = 1;
+    } else {
+      SMILE_IMSG(3,"zeroCopy is only possible for fixed size frames from a single float input level with noPostEOIprocessing=1, frames will be copied.");
+    }
+  }
+
   // this is now handled by cDataProcessor myConfigureInstance
   //writer->setConfig( 1, len, frameStep, 0.0, frameSize, 0, DMEM_FLOAT);
 
@@ -287,6 +298,21 @@ int cWinToVecProcessor::setupNamesForField(int idxi, const char*name, long nEl)
 }
 */
 
+void cWinToVecProcessor::markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn)
+{
+  if ((outNeed == NULL)||(Mult <= 0)||(nOut != nIn*Mult)) {
+    memset(inNeed, 1, nIn);
+    return;
+  }
+  long e,j;
+  for (e=0; e<nIn; e++) {
+    inNeed[e] = 0;
+    for (j=0; j<Mult; j++) {
+      if (outNeed[e*Mult+j]) { inNeed[e] = 1; break; }
+    }
+  }
+}
+
 // this must return the multiplier, i.e. the vector size returned for each input element (e.g. number of functionals, etc.)
 int cWinToVecProcessor::getMultiplier()
 {
@@ -338,6 +364,15 @@ int cWinToVecProcessor::dataProcessorCustomFinalise()
   if (tmpFrameF==NULL) tmpFrameF=(FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*Mult);
   if (tmpFrameI==NULL) tmpFrameI=(INT_DMEM*)calloc(1,sizeof(INT_DMEM)*Mult);
 
+  if (virtualLevel) {
+    if (!writer->setVirtualSource(reader->getDmObj(), reader->getLevelIdx(), reader->getReaderId(), frameStepFrames, frameSizeFrames, pre)) {
+      SMILE_IMSG(3,"cannot set up output level '%s' as virtual level on '%s', frames will be copied.",writer->getLevelName(),reader->getLevelName());
+      virtualLevel = 0;
+    } else {
+      SMILE_IDBG(2,"output level '%s' is a virtual level on input level '%s'",writer->getLevelName(),reader->getLevelName());
+    }
+  }
+
   return 1;
 }
 
@@ -528,6 +563,9 @@ int cWinToVecProcessor::myTick(long long t)
     return 0;
   }
 
+  // the frames of a virtual output level are read directly from the input level by our readers
+  if (virtualLevel) return writer->syncVirtual();
+
   if (!(writer->checkWrite(1))) return 0;
 
   // get next frame from dataMemory
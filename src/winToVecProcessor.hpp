@@ -61,6 +61,7 @@ class cWinToVecProcessor : public cDataProcessor {
     int   fstfGiven;   // flag that indicates whether frameStepFrame, etc. was specified directly (to override frameStep in seconds)
     int   dtype;     // data type (DMEM_FLOAT, DMEM_INT)
     int   noPostEOIprocessing;
+    int   virtualLevel; // output level is a virtual level on the input level (see zeroCopy)
     
     long Ni, Nfi;
     long No; //, Nfo;
@@ -89,6 +90,7 @@ class cWinToVecProcessor : public cDataProcessor {
     int queNextFrameData(double start, double end);
 
   protected:
+    int zeroCopy;  // set by derived classes whose output frames are plain copies of the input (cFramer): publish the output as virtual level
     double frameSize, frameStep, frameCenter;
     long  frameSizeFrames, frameStepFrames, frameCenterFrames, pre;
 
@@ -127,6 +129,9 @@ class cWinToVecProcessor : public cDataProcessor {
     
     cWinToVecProcessor(const char *_name);
 
+    // the Mult output elements of input element e are computed from e only
+    virtual void markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn);
+
     virtual ~cWinToVecProcessor();
 };
 
@@ -173,6 +173,12 @@ int cWindowProcessor::myFinaliseInstance()
 }
 */
 
+void cWindowProcessor::markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn)
+{
+  if ((outNeed != NULL)&&(nOut == nIn)) memcpy(inNeed, outNeed, nIn);
+  else memset(inNeed, 1, nIn);
+}
+
 int cWindowProcessor::myTick(long long t)
 {
   SMILE_IDBG(4,"tick # %i, running window processor",t);
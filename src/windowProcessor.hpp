@@ -91,6 +91,9 @@ class cWindowProcessor : public cDataProcessor {
     
     cWindowProcessor(const char *_name, int _pre=0, int _post=0);
 
+    // each output row is computed from the same input row only
+    virtual void markInputDemand(const char *outNeed, long nOut, char *inNeed, long nIn);
+
     virtual ~cWindowProcessor();
 };
 
@@ -1679,6 +1679,9 @@ struct svm_model
 	// XXX
 	int free_sv;		// 1 if svm_model is created by svm_load_model
 				// 0 if svm_model is created by svm_train
+				// 2 if svm_model is created by svm_load_model_binary (sv_coef and dense_sv point into the file buffer)
+	const float *dense_sv;	// binary models only: SVs as dense rows (dense_sv[l*dense_dim]), SV is NULL
+	int dense_dim;
 };
 
 // Platt's binary SVM Probablistic Output: an improvement from Lin et al.
@@ -2055,6 +2058,8 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 	svm_model *model = Malloc(svm_model,1);
 	model->param = *param;
 	model->free_sv = 0;	// XXX
+	model->dense_sv = NULL;
+	model->dense_dim = 0;
 
 	if(param->svm_type == ONE_CLASS ||
 	   param->svm_type == EPSILON_SVR ||
@@ -2487,6 +2492,54 @@ void svm_predict_values(const svm_model *model, const svm_node *x, double* dec_v
 	}
 }
 
+// one-against-one voting on the decision values of a classification model, vote[nr_class] is a work area
+static double svm_predict_vote(const svm_model *model, const double *dec_values, int *vote)
+{
+	int i;
+	int nr_class = model->nr_class;
+	for(i=0;i<nr_class;i++)
+		vote[i] = 0;
+	int pos=0;
+	for(i=0;i<nr_class;i++)
+		for(int j=i+1;j<nr_class;j++)
+		{
+			if(dec_values[pos++] > 0)
+				++vote[i];
+			else
+				++vote[j];
+		}
+
+	int vote_max_idx = 0;
+	for(i=1;i<nr_class;i++)
+		if(vote[i] > vote[vote_max_idx])
+			vote_max_idx = i;
+	return model->label[vote_max_idx];
+}
+
+// class probabilities from the decision values of a classification model with probability information,
+// pairwise_prob[nr_class][nr_class] is a work area
+static double svm_predict_probability_dec(const svm_model *model, const double *dec_values, double *prob_estimates, double **pairwise_prob)
+{
+	int i;
+	int nr_class = model->nr_class;
+	double min_prob=1e-7;
+	int k=0;
+	for(i=0;i<nr_class;i++)
+		for(int j=i+1;j<nr_class;j++)
+		{
+			pairwise_prob[i][j]=min(max(sigmoid_predict(dec_values[k],model->probA[k],model->probB[k]),min_prob),1-min_prob);
+			pairwise_prob[j][i]=1-pairwise_prob[i][j];
+			k++;
+		}
+	multiclass_probability(nr_class,pairwise_prob,prob_estimates);
+
+	int prob_max_idx = 0;
+	for(i=1;i<nr_class;i++)
+		if(prob_estimates[i] > prob_estimates[prob_max_idx])
+			prob_max_idx = i;
+	return model->label[prob_max_idx];
+}
+
 double svm_predict(const svm_model *model, const svm_node *x)
 {
 	if(model->param.svm_type == ONE_CLASS ||
@@ -2503,31 +2556,15 @@ double svm_predict(const svm_model *model, const svm_node *x)
 	}
 	else
 	{
-		int i;
 		int nr_class = model->nr_class;
 		double *dec_values = Malloc(double, nr_class*(nr_class-1)/2);
 		svm_predict_values(model, x, dec_values);
 
 		int *vote = Malloc(int,nr_class);
-		for(i=0;i<nr_class;i++)
-			vote[i] = 0;
-		int pos=0;
-		for(i=0;i<nr_class;i++)
-			for(int j=i+1;j<nr_class;j++)
-			{
-				if(dec_values[pos++] > 0)
-					++vote[i];
-				else
-					++vote[j];
-			}
-
-		int vote_max_idx = 0;
-		for(i=1;i<nr_class;i++)
-			if(vote[i] > vote[vote_max_idx])
-				vote_max_idx = i;
+		double ret = svm_predict_vote(model, dec_values, vote);
 		free(vote);
 		free(dec_values);
-		return model->label[vote_max_idx];
+		return ret;
 	}
 }
 
@@ -2542,29 +2579,15 @@ double svm_predict_probability(
 		double *dec_values = Malloc(double, nr_class*(nr_class-1)/2);
 		svm_predict_values(model, x, dec_values);
 
-		double min_prob=1e-7;
 		double **pairwise_prob=Malloc(double *,nr_class);
 		for(i=0;i<nr_class;i++)
 			pairwise_prob[i]=Malloc(double,nr_class);
-		int k=0;
-		for(i=0;i<nr_class;i++)
-			for(int j=i+1;j<nr_class;j++)
-			{
-				pairwise_prob[i][j]=min(max(sigmoid_predict(dec_values[k],model->probA[k],model->probB[k]),min_prob),1-min_prob);
-				pairwise_prob[j][i]=1-pairwise_prob[i][j];
-				k++;
-			}
-		multiclass_probability(nr_class,pairwise_prob,prob_estimates);
-
-		int prob_max_idx = 0;
-		for(i=1;i<nr_class;i++)
-			if(prob_estimates[i] > prob_estimates[prob_max_idx])
-				prob_max_idx = i;
+		double ret = svm_predict_probability_dec(model, dec_values, prob_estimates, pairwise_prob);
 		for(i=0;i<nr_class;i++)
 			free(pairwise_prob[i]);
 		free(dec_values);
                 free(pairwise_prob);	     
-		return model->label[prob_max_idx];
+		return ret;
 	}
 	else 
 		return svm_predict(model, x);
@@ -2681,6 +2704,8 @@ svm_model *svm_load_model(const char *model_file_name)
 	model->probB = NULL;
 	model->label = NULL;
 	model->nSV = NULL;
+	model->dense_sv = NULL;
+	model->dense_dim = 0;
 
 	char cmd[81];
 	while(1)
@@ -2858,10 +2883,11 @@ out2:
 
 void svm_destroy_model(svm_model* model)
 {
-	if(model->free_sv && model->l > 0)
+	if(model->free_sv == 1 && model->l > 0)
 		free((void *)(model->SV[0]));
-	for(int i=0;i<model->nr_class-1;i++)
-		free(model->sv_coef[i]);
+	if(model->free_sv != 2)
+		for(int i=0;i<model->nr_class-1;i++)
+			free(model->sv_coef[i]);
 	free(model->SV);
 	free(model->sv_coef);
 	free(model->rho);
@@ -3003,3 +3029,720 @@ int svm_check_probability_model(const svm_model *model)
 		((model->param.svm_type == EPSILON_SVR || model->param.svm_type == NU_SVR) &&
 		 model->probA!=NULL);
 }
+
+//
+// Dense inference (openSMILE addon)
+//
+// The support vectors are unpacked at load time to the rows of a dense float matrix (32 byte aligned,
+// row length padded to a multiple of SVM_DENSE_LANES), the kernel values of all SVs are then computed
+// from one blocked matrix-vector product with the input. A linear input scaling x' = a*x + b is folded
+// into the model: x'.s = x.(a*s) + b.s, and |x'-s|^2 = |x'|^2 + |s|^2 - 2 x'.s for the RBF kernel.
+// For the linear kernel the SVs of each decision function are collapsed into one weight vector.
+//
+// Several models on the same input (same dimension and scaling) can share one matrix (svm_dense_pool):
+// identical rows are stored once, and the dot products are computed once per input for all models.
+//
+#define SVM_DENSE_LANES 8
+#define SVM_DENSE_ALIGN 32
+
+struct svm_dense_pool
+{
+	int dim;		// number of input values (feature indices 1..dim)
+	int dimPad;		// length of a row, multiple of SVM_DENSE_LANES
+	int nRows;		// number of (unique) rows
+	int nAlloc;
+	float *rows;		// nRows x dimPad
+	void *mem;		// memory of rows
+	float *x;		// padded input
+	void *xmem;
+	double *rowOffset;	// b.s (SVs), or w.b - rho (linear)
+	double *rowNorm;	// |s|^2 (SVs)
+	double *dot;		// dot products of the rows with the last input
+	unsigned int *rowHash;
+	int *bucket, *next;	// hash chains for the row lookup
+	int nBuckets;
+	double *scale_a, *scale_b;	// input scaling, NULL = none
+	double xx;		// |x'|^2 of the last input
+	int nModels;		// number of models using this pool
+};
+
+struct svm_dense_model
+{
+	const svm_model *model;
+	svm_dense_pool *pool;
+	int ownPool;		// 1: the pool was created by svm_dense_create
+	int linear;		// 1: rows are weight vectors, decision value = row.x + rowOffset
+	int nDec;		// number of decision functions
+	int nRows;		// number of SVs, or number of decision functions (linear)
+	int *rowIdx;		// pool row of each SV / decision function
+	int *start;		// index of the first SV of each class
+	double *kvalue;		// work area: kernel values
+	double *dec_values;	// work area: decision values
+	int *vote;		// work area: votes
+	double **pairwise_prob;	// work area: nr_class x nr_class
+};
+
+static int svm_dense_is_class(const svm_model *model)
+{
+	return !(model->param.svm_type == ONE_CLASS ||
+		 model->param.svm_type == EPSILON_SVR ||
+		 model->param.svm_type == NU_SVR);
+}
+
+svm_dense_pool *svm_dense_pool_create(int dim, const double *scale_a, const double *scale_b)
+{
+	if (dim < 1) return NULL;
+	svm_dense_pool *pool = (svm_dense_pool *)calloc(1, sizeof(svm_dense_pool));
+	pool->dim = dim;
+	pool->dimPad = (dim + SVM_DENSE_LANES-1) / SVM_DENSE_LANES * SVM_DENSE_LANES;
+	pool->xmem = calloc(1, sizeof(float)*pool->dimPad + SVM_DENSE_ALIGN);
+	pool->x = (float *)(((size_t)pool->xmem + SVM_DENSE_ALIGN-1) & ~(size_t)(SVM_DENSE_ALIGN-1));
+	if (scale_a != NULL && scale_b != NULL) {
+		pool->scale_a = Malloc(double, dim);
+		pool->scale_b = Malloc(double, dim);
+		memcpy(pool->scale_a, scale_a, sizeof(double)*dim);
+		memcpy(pool->scale_b, scale_b, sizeof(double)*dim);
+	}
+	return pool;
+}
+
+void svm_dense_pool_destroy(svm_dense_pool *pool)
+{
+	if (pool == NULL) return;
+	free(pool->mem);
+	free(pool->xmem);
+	free(pool->rowOffset);
+	free(pool->rowNorm);
+	free(pool->dot);
+	free(pool->rowHash);
+	free(pool->bucket);
+	free(pool->next);
+	if (pool->scale_a != NULL) free(pool->scale_a);
+	if (pool->scale_b != NULL) free(pool->scale_b);
+	free(pool);
+}
+
+int svm_dense_pool_get_nr_rows(const svm_dense_pool *pool)
+{
+	return pool->nRows;
+}
+
+static void svm_dense_pool_grow(svm_dense_pool *pool)
+{
+	int i;
+	int nAlloc = pool->nAlloc > 0 ? pool->nAlloc*2 : 64;
+	void *mem = calloc(1, sizeof(float)*(size_t)nAlloc*pool->dimPad + SVM_DENSE_ALIGN);
+	float *rows = (float *)(((size_t)mem + SVM_DENSE_ALIGN-1) & ~(size_t)(SVM_DENSE_ALIGN-1));
+	if (pool->nRows > 0)
+		memcpy(rows, pool->rows, sizeof(float)*(size_t)pool->nRows*pool->dimPad);
+	free(pool->mem);
+	pool->mem = mem;
+	pool->rows = rows;
+	pool->rowOffset = (double *)realloc(pool->rowOffset, sizeof(double)*nAlloc);
+	pool->rowNorm = (double *)realloc(pool->rowNorm, sizeof(double)*nAlloc);
+	pool->dot = (double *)realloc(pool->dot, sizeof(double)*nAlloc);
+	pool->rowHash = (unsigned int *)realloc(pool->rowHash, sizeof(unsigned int)*nAlloc);
+	pool->next = (int *)realloc(pool->next, sizeof(int)*nAlloc);
+	pool->nAlloc = nAlloc;
+	// rebuild the hash chains
+	pool->nBuckets = nAlloc*2;
+	free(pool->bucket);
+	pool->bucket = Malloc(int, pool->nBuckets);
+	for (i=0; i<pool->nBuckets; i++) pool->bucket[i] = -1;
+	for (i=0; i<pool->nRows; i++) {
+		int b = (int)(pool->rowHash[i] & (unsigned int)(pool->nBuckets-1));
+		pool->next[i] = pool->bucket[b];
+		pool->bucket[b] = i;
+	}
+}
+
+// add a row (dim values, the padding is zero), returns the index of an identical existing row, if there is one
+static int svm_dense_pool_add_row(svm_dense_pool *pool, const float *row, double offset, double norm)
+{
+	int i;
+	unsigned int h = 2166136261u;
+	const unsigned char *bytes = (const unsigned char *)row;
+	for (i=0; i<(int)sizeof(float)*pool->dim; i++)
+		h = (h ^ bytes[i]) * 16777619u;
+
+	if (pool->nBuckets > 0) {
+		for (int r = pool->bucket[h & (unsigned int)(pool->nBuckets-1)]; r >= 0; r = pool->next[r]) {
+			if (pool->rowHash[r] == h && pool->rowOffset[r] == offset && pool->rowNorm[r] == norm &&
+			    memcmp(pool->rows + (size_t)r*pool->dimPad, row, sizeof(float)*pool->dim) == 0)
+				return r;
+		}
+	}
+
+	if (pool->nRows >= pool->nAlloc) svm_dense_pool_grow(pool);
+	int r = pool->nRows++;
+	memcpy(pool->rows + (size_t)r*pool->dimPad, row, sizeof(float)*pool->dim);
+	pool->rowOffset[r] = offset;
+	pool->rowNorm[r] = norm;
+	pool->rowHash[r] = h;
+	int b = (int)(h & (unsigned int)(pool->nBuckets-1));
+	pool->next[r] = pool->bucket[b];
+	pool->bucket[b] = r;
+	return r;
+}
+
+svm_dense_model *svm_dense_pool_add(svm_dense_pool *pool, const svm_model *model)
+{
+	int i, j, k, p;
+	if (pool == NULL || model == NULL || model->param.kernel_type == PRECOMPUTED) return NULL;
+
+	int dim = pool->dim;
+	svm_dense_model *dm = (svm_dense_model *)calloc(1, sizeof(svm_dense_model));
+	int nr_class = model->nr_class;
+	int isClass = svm_dense_is_class(model);
+	dm->model = model;
+	dm->pool = pool;
+	dm->linear = (model->param.kernel_type == LINEAR);
+	dm->nDec = isClass ? nr_class*(nr_class-1)/2 : 1;
+	dm->nRows = dm->linear ? dm->nDec : model->l;
+	dm->rowIdx = Malloc(int, dm->nRows > 0 ? dm->nRows : 1);
+	dm->kvalue = Malloc(double, model->l > 0 ? model->l : 1);
+	dm->dec_values = Malloc(double, dm->nDec);
+	dm->vote = Malloc(int, nr_class);
+	dm->pairwise_prob = Malloc(double *, nr_class);
+	for (i=0; i<nr_class; i++)
+		dm->pairwise_prob[i] = Malloc(double, nr_class);
+	dm->start = Malloc(int, nr_class);
+	dm->start[0] = 0;
+	for (i=1; i<nr_class; i++)
+		dm->start[i] = isClass ? dm->start[i-1]+model->nSV[i-1] : 0;
+
+	// dense (unscaled) SVs in double precision
+	double *sv = Malloc(double, (size_t)model->l * dim);
+	double *norms = Malloc(double, model->l > 0 ? model->l : 1);
+	memset(sv, 0, sizeof(double)*(size_t)model->l*dim);
+	for (k=0; k<model->l; k++) {
+		double norm = 0;
+		if (model->dense_sv != NULL) {
+			const float *s = model->dense_sv + (size_t)k*model->dense_dim;
+			for (i=0; i<model->dense_dim; i++) {
+				if (i < dim) sv[(size_t)k*dim + i] = s[i];
+				norm += (double)s[i] * s[i];
+			}
+		} else {
+			for (const svm_node *n = model->SV[k]; n->index != -1; n++) {
+				if (n->index >= 1 && n->index <= dim) sv[(size_t)k*dim + n->index-1] = n->value;
+				norm += n->value * n->value;
+			}
+		}
+		norms[k] = norm;
+	}
+
+	float *r = Malloc(float, dim);
+	if (dm->linear) {
+		// one weight vector w per decision function, w = sum_k coef_k * s_k
+		double *w = Malloc(double, dim);
+		for (p=0; p<dm->nDec; p++) {
+			memset(w, 0, sizeof(double)*dim);
+			if (isClass) {
+				// decision function p is the pair of classes (ci,cj), in the order of svm_predict_values
+				int ci=0, cj=1, q=0;
+				for (i=0; i<nr_class; i++)
+					for (j=i+1; j<nr_class; j++)
+						if (q++ == p) { ci = i; cj = j; }
+				for (k=0; k<model->nSV[ci]; k++) {
+					double c = model->sv_coef[cj-1][dm->start[ci]+k];
+					const double *s = sv + (size_t)(dm->start[ci]+k)*dim;
+					for (i=0; i<dim; i++) w[i] += c * s[i];
+				}
+				for (k=0; k<model->nSV[cj]; k++) {
+					double c = model->sv_coef[ci][dm->start[cj]+k];
+					const double *s = sv + (size_t)(dm->start[cj]+k)*dim;
+					for (i=0; i<dim; i++) w[i] += c * s[i];
+				}
+			} else {
+				for (k=0; k<model->l; k++) {
+					double c = model->sv_coef[0][k];
+					const double *s = sv + (size_t)k*dim;
+					for (i=0; i<dim; i++) w[i] += c * s[i];
+				}
+			}
+			double off = -model->rho[p];
+			for (i=0; i<dim; i++) {
+				if (pool->scale_a != NULL) {
+					r[i] = (float)(w[i] * pool->scale_a[i]);
+					off += w[i] * pool->scale_b[i];
+				} else {
+					r[i] = (float)w[i];
+				}
+			}
+			dm->rowIdx[p] = svm_dense_pool_add_row(pool, r, off, 0.0);
+		}
+		free(w);
+	} else {
+		for (k=0; k<model->l; k++) {
+			const double *s = sv + (size_t)k*dim;
+			double off = 0;
+			for (i=0; i<dim; i++) {
+				if (pool->scale_a != NULL) {
+					r[i] = (float)(s[i] * pool->scale_a[i]);
+					off += s[i] * pool->scale_b[i];
+				} else {
+					r[i] = (float)s[i];
+				}
+			}
+			dm->rowIdx[k] = svm_dense_pool_add_row(pool, r, off, norms[k]);
+		}
+	}
+	free(r);
+	free(norms);
+	free(sv);
+	pool->nModels++;
+	return dm;
+}
+
+svm_dense_model *svm_dense_create(const svm_model *model, int dim, const double *scale_a, const double *scale_b)
+{
+	if (model == NULL || dim < 1 || model->param.kernel_type == PRECOMPUTED) return NULL;
+	svm_dense_pool *pool = svm_dense_pool_create(dim, scale_a, scale_b);
+	svm_dense_model *dm = svm_dense_pool_add(pool, model);
+	if (dm == NULL) {
+		svm_dense_pool_destroy(pool);
+		return NULL;
+	}
+	dm->ownPool = 1;
+	return dm;
+}
+
+void svm_dense_destroy(svm_dense_model *dm)
+{
+	if (dm == NULL) return;
+	for (int i=0; i<dm->model->nr_class; i++)
+		free(dm->pairwise_prob[i]);
+	free(dm->pairwise_prob);
+	free(dm->rowIdx);
+	free(dm->kvalue);
+	free(dm->dec_values);
+	free(dm->vote);
+	free(dm->start);
+	dm->pool->nModels--;
+	if (dm->ownPool) svm_dense_pool_destroy(dm->pool);
+	free(dm);
+}
+
+void svm_dense_pool_set_input(svm_dense_pool *pool, const float *x)
+{
+	// padded input, and |x'|^2 of the scaled input for the RBF kernel
+	double xx = 0;
+	for (int i=0; i<pool->dim; i++) {
+		pool->x[i] = x[i];
+		double v = (pool->scale_a != NULL) ? pool->scale_a[i]*x[i] + pool->scale_b[i] : x[i];
+		xx += v*v;
+	}
+	pool->xx = xx;
+}
+
+// dot products of the padded input x with the rows r0..r1-1 (row length n), four rows at a time with SVM_DENSE_LANES partial sums each
+static void svm_dense_dot_rows(const float *rows, int n, const float *x, int r0, int r1, double *dot)
+{
+	int r = r0, i, l;
+	for (; r+4 <= r1; r += 4) {
+		const float *s0 = rows + (size_t)r*n;
+		const float *s1 = s0 + n, *s2 = s1 + n, *s3 = s2 + n;
+		float a0[SVM_DENSE_LANES], a1[SVM_DENSE_LANES], a2[SVM_DENSE_LANES], a3[SVM_DENSE_LANES];
+		for (l=0; l<SVM_DENSE_LANES; l++) { a0[l] = 0; a1[l] = 0; a2[l] = 0; a3[l] = 0; }
+		for (i=0; i<n; i+=SVM_DENSE_LANES) {
+			for (l=0; l<SVM_DENSE_LANES; l++) {
+				float xv = x[i+l];
+				a0[l] += xv * s0[i+l];
+				a1[l] += xv * s1[i+l];
+				a2[l] += xv * s2[i+l];
+				a3[l] += xv * s3[i+l];
+			}
+		}
+		double d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+		for (l=0; l<SVM_DENSE_LANES; l++) { d0 += a0[l]; d1 += a1[l]; d2 += a2[l]; d3 += a3[l]; }
+		dot[r] = d0; dot[r+1] = d1; dot[r+2] = d2; dot[r+3] = d3;
+	}
+	for (; r < r1; r++) {
+		const float *s0 = rows + (size_t)r*n;
+		float a0[SVM_DENSE_LANES];
+		for (l=0; l<SVM_DENSE_LANES; l++) a0[l] = 0;
+		for (i=0; i<n; i+=SVM_DENSE_LANES)
+			for (l=0; l<SVM_DENSE_LANES; l++)
+				a0[l] += x[i+l] * s0[i+l];
+		double d0 = 0;
+		for (l=0; l<SVM_DENSE_LANES; l++) d0 += a0[l];
+		dot[r] = d0;
+	}
+}
+
+// dot products of the padded input pool->x with the rows r0..r1-1
+void svm_dense_pool_dot(svm_dense_pool *pool, int r0, int r1)
+{
+	if (r1 > pool->nRows) r1 = pool->nRows;
+	svm_dense_dot_rows(pool->rows, pool->dimPad, pool->x, r0, r1, pool->dot);
+}
+
+// decision values from the dot products of one input with the pool rows (dot) and |x'|^2 (xx)
+static void svm_dense_decision(const svm_dense_model *dm, const double *dot, double xx, double *kvalue, double *dec_values)
+{
+	const svm_model *model = dm->model;
+	const svm_parameter &param = model->param;
+	const svm_dense_pool *pool = dm->pool;
+	int i, k;
+
+	if (dm->linear) {
+		for (k=0; k<dm->nDec; k++) {
+			int r = dm->rowIdx[k];
+			dec_values[k] = dot[r] + pool->rowOffset[r];
+		}
+		return;
+	}
+
+	for (k=0; k<model->l; k++) {
+		int r = dm->rowIdx[k];
+		double xs = dot[r] + pool->rowOffset[r];
+		switch (param.kernel_type) {
+			case POLY:
+				kvalue[k] = powi(param.gamma*xs+param.coef0,param.degree);
+				break;
+			case RBF: {
+				double d = xx + pool->rowNorm[r] - 2.0*xs;
+				kvalue[k] = exp(-param.gamma*(d > 0 ? d : 0));
+				break; }
+			case SIGMOID:
+				kvalue[k] = tanh(param.gamma*xs+param.coef0);
+				break;
+			default:
+				kvalue[k] = 0;
+		}
+	}
+
+	if (!svm_dense_is_class(model)) {
+		double *sv_coef = model->sv_coef[0];
+		double sum = 0;
+		for (k=0; k<model->l; k++)
+			sum += sv_coef[k] * kvalue[k];
+		dec_values[0] = sum - model->rho[0];
+		return;
+	}
+
+	int nr_class = model->nr_class;
+	int p = 0;
+	for (i=0; i<nr_class; i++)
+		for (int j=i+1; j<nr_class; j++)
+		{
+			double sum = 0;
+			int si = dm->start[i];
+			int sj = dm->start[j];
+			int ci = model->nSV[i];
+			int cj = model->nSV[j];
+			double *coef1 = model->sv_coef[j-1];
+			double *coef2 = model->sv_coef[i];
+			for (k=0; k<ci; k++)
+				sum += coef1[si+k] * kvalue[si+k];
+			for (k=0; k<cj; k++)
+				sum += coef2[sj+k] * kvalue[sj+k];
+			dec_values[p] = sum - model->rho[p];
+			p++;
+		}
+}
+
+void svm_dense_predict_values(svm_dense_model *dm, const float *x, double *dec_values)
+{
+	if (x != NULL) {
+		svm_dense_pool_set_input(dm->pool, x);
+		svm_dense_pool_dot(dm->pool, 0, dm->pool->nRows);
+	}
+	svm_dense_decision(dm, dm->pool->dot, dm->pool->xx, dm->kvalue, dec_values);
+}
+
+double svm_dense_predict(svm_dense_model *dm, const float *x)
+{
+	const svm_model *model = dm->model;
+	svm_dense_predict_values(dm, x, dm->dec_values);
+	if (!svm_dense_is_class(model)) {
+		if (model->param.svm_type == ONE_CLASS)
+			return (dm->dec_values[0]>0)?1:-1;
+		return dm->dec_values[0];
+	}
+	return svm_predict_vote(model, dm->dec_values, dm->vote);
+}
+
+double svm_dense_predict_probability(svm_dense_model *dm, const float *x, double *prob_estimates)
+{
+	const svm_model *model = dm->model;
+	if ((model->param.svm_type == C_SVC || model->param.svm_type == NU_SVC) &&
+	    model->probA!=NULL && model->probB!=NULL)
+	{
+		svm_dense_predict_values(dm, x, dm->dec_values);
+		return svm_predict_probability_dec(model, dm->dec_values, prob_estimates, dm->pairwise_prob);
+	}
+	return svm_dense_predict(dm, x);
+}
+
+// dot products of the n padded inputs xp (n x dimPad) with all pool rows, dot[j*nRows + r]:
+// the rows are processed in tiles of SVM_DENSE_TILE_ROWS, which stay in the cache while they are
+// multiplied with all inputs of the batch (instead of streaming all SVs from memory for every input)
+#define SVM_DENSE_TILE_ROWS 64
+
+static void svm_dense_pool_gemm(const svm_dense_pool *pool, const float *xp, int n, double *dot)
+{
+	const int dp = pool->dimPad;
+	const int nRows = pool->nRows;
+	// one flat loop over (tile, input): gcc does not vectorize the inlined kernel inside a loop nest
+	long k, nK = (long)((nRows + SVM_DENSE_TILE_ROWS-1) / SVM_DENSE_TILE_ROWS) * n;
+	for (k=0; k<nK; k++) {
+		int r0 = (int)(k / n) * SVM_DENSE_TILE_ROWS, j = (int)(k % n);
+		int r1 = r0 + SVM_DENSE_TILE_ROWS;
+		if (r1 > nRows) r1 = nRows;
+		svm_dense_dot_rows(pool->rows, dp, xp + (size_t)j*dp, r0, r1, dot + (size_t)j*nRows);
+	}
+}
+
+void svm_dense_predict_batch(const svm_dense_model *dm, const float *X, int n, int ldx, double *results, double *prob_estimates)
+{
+	const svm_model *model = dm->model;
+	const svm_dense_pool *pool = dm->pool;
+	int i, j;
+	if (n < 1) return;
+	int nr_class = model->nr_class;
+	int dim = pool->dim, dp = pool->dimPad;
+	int isClass = svm_dense_is_class(model);
+	int doProb = (prob_estimates != NULL) &&
+		(model->param.svm_type == C_SVC || model->param.svm_type == NU_SVC) &&
+		model->probA!=NULL && model->probB!=NULL;
+
+	// padded inputs, and |x'|^2 of the scaled inputs for the RBF kernel
+	void *xmem = calloc(1, sizeof(float)*(size_t)n*dp + SVM_DENSE_ALIGN);
+	float *xp = (float *)(((size_t)xmem + SVM_DENSE_ALIGN-1) & ~(size_t)(SVM_DENSE_ALIGN-1));
+	double *xx = Malloc(double, n);
+	for (j=0; j<n; j++) {
+		const float *x = X + (size_t)j*ldx;
+		float *d = xp + (size_t)j*dp;
+		double s = 0;
+		for (i=0; i<dim; i++) {
+			d[i] = x[i];
+			double v = (pool->scale_a != NULL) ? pool->scale_a[i]*x[i] + pool->scale_b[i] : x[i];
+			s += v*v;
+		}
+		xx[j] = s;
+	}
+	double *dot = Malloc(double, (size_t)n*(pool->nRows > 0 ? pool->nRows : 1));
+	svm_dense_pool_gemm(pool, xp, n, dot);
+
+	// local work areas, dm is only read
+	double *kvalue = Malloc(double, model->l > 0 ? model->l : 1);
+	double *dec_values = Malloc(double, dm->nDec);
+	int *vote = Malloc(int, nr_class);
+	double **pairwise_prob = Malloc(double *, nr_class);
+	for (i=0; i<nr_class; i++)
+		pairwise_prob[i] = Malloc(double, nr_class);
+
+	for (j=0; j<n; j++) {
+		svm_dense_decision(dm, dot + (size_t)j*pool->nRows, xx[j], kvalue, dec_values);
+		if (!isClass) {
+			if (model->param.svm_type == ONE_CLASS)
+				results[j] = (dec_values[0]>0)?1:-1;
+			else
+				results[j] = dec_values[0];
+		} else if (doProb) {
+			results[j] = svm_predict_probability_dec(model, dec_values, prob_estimates + (size_t)j*nr_class, pairwise_prob);
+		} else {
+			results[j] = svm_predict_vote(model, dec_values, vote);
+		}
+	}
+
+	for (i=0; i<nr_class; i++)
+		free(pairwise_prob[i]);
+	free(pairwise_prob);
+	free(vote);
+	free(dec_values);
+	free(kvalue);
+	free(dot);
+	free(xx);
+	free(xmem);
+}
+
+//
+// binary model files (openSMILE addon)
+//
+// Layout: svm_binary_header, followed by the arrays rho, probA, probB (if present), label, nSV (classification),
+// sv_coef[nr_class-1][l] (double), and the SVs as dense rows SV[l][dim] (float). Every array is padded to a
+// multiple of 8 bytes, thus all arrays are aligned if the buffer passed to svm_load_model_binary is.
+// The byte order is the native one of the machine which wrote the file.
+//
+#define SVM_BINARY_MAGIC "LSVMBIN"
+#define SVM_BINARY_VERSION 1
+#define SVM_BINARY_PROBA 1
+#define SVM_BINARY_PROBB 2
+#define SVM_BINARY_LABEL 4
+
+struct svm_binary_header
+{
+	char magic[8];
+	int version;
+	int svm_type;
+	int kernel_type;
+	int degree;
+	double gamma;
+	double coef0;
+	int nr_class;
+	int l;
+	int dim;
+	int flags;
+	int reserved[2];
+};
+
+// writes len bytes of data (data = NULL: only the padding) and pads to a multiple of 8 bytes
+static int svm_binary_write(FILE *fp, const void *data, size_t len)
+{
+	static const char zero[8] = {0,0,0,0,0,0,0,0};
+	if (data != NULL && len > 0 && fwrite(data, 1, len, fp) != len) return 0;
+	size_t pad = (8 - len % 8) % 8;
+	if (pad > 0 && fwrite(zero, 1, pad, fp) != pad) return 0;
+	return 1;
+}
+
+// returns a pointer to the next len bytes of buf (and advances pos), or NULL if the buffer is too short
+static const char *svm_binary_take(const char *buf, long len, long *pos, size_t n)
+{
+	size_t padded = (n + 7) / 8 * 8;
+	if (*pos < 0 || (size_t)(len - *pos) < padded) return NULL;
+	const char *p = buf + *pos;
+	*pos += (long)padded;
+	return p;
+}
+
+int svm_save_model_binary(FILE *fp, const svm_model *model)
+{
+	int i, k;
+	if (fp == NULL || model == NULL || model->param.kernel_type == PRECOMPUTED) return -1;
+
+	int nr_class = model->nr_class;
+	int l = model->l;
+	int nDec = nr_class*(nr_class-1)/2;
+	int dim = model->dense_dim;
+	if (model->dense_sv == NULL) {
+		dim = 0;
+		for (k=0; k<l; k++)
+			for (const svm_node *n = model->SV[k]; n->index != -1; n++)
+				if (n->index > dim) dim = n->index;
+	}
+
+	svm_binary_header h;
+	memset(&h, 0, sizeof(h));
+	strcpy(h.magic, SVM_BINARY_MAGIC);
+	h.version = SVM_BINARY_VERSION;
+	h.svm_type = model->param.svm_type;
+	h.kernel_type = model->param.kernel_type;
+	h.degree = model->param.degree;
+	h.gamma = model->param.gamma;
+	h.coef0 = model->param.coef0;
+	h.nr_class = nr_class;
+	h.l = l;
+	h.dim = dim;
+	if (model->probA != NULL) h.flags |= SVM_BINARY_PROBA;
+	if (model->probB != NULL) h.flags |= SVM_BINARY_PROBB;
+	if (model->label != NULL && model->nSV != NULL) h.flags |= SVM_BINARY_LABEL;
+
+	int ok = svm_binary_write(fp, &h, sizeof(h));
+	ok = ok && svm_binary_write(fp, model->rho, sizeof(double)*nDec);
+	if (model->probA != NULL) ok = ok && svm_binary_write(fp, model->probA, sizeof(double)*nDec);
+	if (model->probB != NULL) ok = ok && svm_binary_write(fp, model->probB, sizeof(double)*nDec);
+	if (h.flags & SVM_BINARY_LABEL) {
+		ok = ok && svm_binary_write(fp, model->label, sizeof(int)*nr_class);
+		ok = ok && svm_binary_write(fp, model->nSV, sizeof(int)*nr_class);
+	}
+	for (i=0; i<nr_class-1; i++)
+		ok = ok && svm_binary_write(fp, model->sv_coef[i], sizeof(double)*l);
+
+	float *row = Malloc(float, dim > 0 ? dim : 1);
+	for (k=0; ok && k<l; k++) {
+		if (model->dense_sv != NULL) {
+			memcpy(row, model->dense_sv + (size_t)k*dim, sizeof(float)*dim);
+		} else {
+			memset(row, 0, sizeof(float)*dim);
+			for (const svm_node *n = model->SV[k]; n->index != -1; n++)
+				if (n->index >= 1) row[n->index-1] = (float)n->value;
+		}
+		if (fwrite(row, sizeof(float), dim, fp) != (size_t)dim) ok = 0;
+	}
+	free(row);
+	// pad the SV matrix
+	ok = ok && svm_binary_write(fp, NULL, (size_t)l*dim*sizeof(float));
+	return ok ? 0 : -1;
+}
+
+svm_model *svm_load_model_binary(const char *buf, long len, long *used)
+{
+	int i;
+	long pos = 0;
+	const svm_binary_header *h = (const svm_binary_header *)svm_binary_take(buf, len, &pos, sizeof(svm_binary_header));
+	if (h == NULL || strcmp(h->magic, SVM_BINARY_MAGIC) != 0) {
+		fprintf(stderr,"not a binary LibSVM model.\n");
+		return NULL;
+	}
+	if (h->version != SVM_BINARY_VERSION) {
+		fprintf(stderr,"unsupported binary LibSVM model version %i (or different byte order).\n",h->version);
+		return NULL;
+	}
+	if (h->nr_class < 1 || h->l < 0 || h->dim < 0) return NULL;
+
+	int nr_class = h->nr_class;
+	int l = h->l;
+	int nDec = nr_class*(nr_class-1)/2;
+	const char *rho = svm_binary_take(buf, len, &pos, sizeof(double)*nDec);
+	const char *probA = NULL, *probB = NULL, *label = NULL, *nSV = NULL;
+	if (h->flags & SVM_BINARY_PROBA) probA = svm_binary_take(buf, len, &pos, sizeof(double)*nDec);
+	if (h->flags & SVM_BINARY_PROBB) probB = svm_binary_take(buf, len, &pos, sizeof(double)*nDec);
+	if (h->flags & SVM_BINARY_LABEL) {
+		label = svm_binary_take(buf, len, &pos, sizeof(int)*nr_class);
+		nSV = svm_binary_take(buf, len, &pos, sizeof(int)*nr_class);
+	}
+	const char *sv_coef = svm_binary_take(buf, len, &pos, sizeof(double)*(size_t)(nr_class-1)*l);
+	const char *sv = svm_binary_take(buf, len, &pos, sizeof(float)*(size_t)l*h->dim);
+	if (rho == NULL || sv_coef == NULL || sv == NULL ||
+	    ((h->flags & SVM_BINARY_PROBA) && probA == NULL) || ((h->flags & SVM_BINARY_PROBB) && probB == NULL) ||
+	    ((h->flags & SVM_BINARY_LABEL) && nSV == NULL)) {
+		fprintf(stderr,"binary LibSVM model is truncated.\n");
+		return NULL;
+	}
+
+	svm_model *model = Malloc(svm_model,1);
+	svm_parameter& param = model->param;
+	memset(&param, 0, sizeof(param));
+	param.svm_type = h->svm_type;
+	param.kernel_type = h->kernel_type;
+	param.degree = h->degree;
+	param.gamma = h->gamma;
+	param.coef0 = h->coef0;
+	model->nr_class = nr_class;
+	model->l = l;
+
+	// the small arrays are copied, the coefficients and SVs stay in the buffer
+	model->rho = Malloc(double,nDec);
+	memcpy(model->rho, rho, sizeof(double)*nDec);
+	model->probA = NULL;
+	model->probB = NULL;
+	model->label = NULL;
+	model->nSV = NULL;
+	if (probA != NULL) { model->probA = Malloc(double,nDec); memcpy(model->probA, probA, sizeof(double)*nDec); }
+	if (probB != NULL) { model->probB = Malloc(double,nDec); memcpy(model->probB, probB, sizeof(double)*nDec); }
+	if (label != NULL) {
+		model->label = Malloc(int,nr_class);
+		model->nSV = Malloc(int,nr_class);
+		memcpy(model->label, label, sizeof(int)*nr_class);
+		memcpy(model->nSV, nSV, sizeof(int)*nr_class);
+	}
+	model->sv_coef = Malloc(double *,nr_class-1 > 0 ? nr_class-1 : 1);
+	for (i=0; i<nr_class-1; i++)
+		model->sv_coef[i] = (double *)(sv_coef + sizeof(double)*(size_t)i*l);
+	model->SV = NULL;
+	model->dense_sv = (const float *)sv;
+	model->dense_dim = h->dim;
+	model->free_sv = 2;
+
+	if (used != NULL) *used = pos;
+	return model;
+}
+
+int svm_get_dense_dim(const svm_model *model)
+{
+	return model->dense_sv != NULL ? model->dense_dim : 0;
+}
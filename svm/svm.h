@@ -67,6 +67,42 @@ DLLEXPORT void svm_destroy_param(struct svm_parameter *param);
 DLLEXPORT const char *svm_check_parameter(const struct svm_problem *prob, const struct svm_parameter *param);
 DLLEXPORT int svm_check_probability_model(const struct svm_model *model);
 
+/* dense inference (openSMILE addon): the SVs are unpacked to a dense float matrix once, the input x is a dense
+   float vector of dim values (feature indices 1..dim), x is scaled to scale_a[i]*x[i]+scale_b[i] (if scale_a and
+   scale_b are not NULL). svm_dense_create returns NULL for precomputed kernels.
+   A dense model holds its own work area, thus it must not be shared between threads. */
+struct svm_dense_model;
+DLLEXPORT struct svm_dense_model *svm_dense_create(const struct svm_model *model, int dim, const double *scale_a, const double *scale_b);
+DLLEXPORT void svm_dense_predict_values(struct svm_dense_model *dm, const float *x, double* dec_values);
+DLLEXPORT double svm_dense_predict(struct svm_dense_model *dm, const float *x);
+DLLEXPORT double svm_dense_predict_probability(struct svm_dense_model *dm, const float *x, double* prob_estimates);
+DLLEXPORT void svm_dense_destroy(struct svm_dense_model *dm);
+/* batch prediction of n inputs (X[j*ldx + i], i < dim), the SV matrix is multiplied with tiles of inputs (for
+   cache reuse). results[j]: label or regression value, prob_estimates[j*nr_class + c] (if not NULL and the model
+   supports probabilities). The work areas of dm are not used, thus several threads may call this for one model. */
+DLLEXPORT void svm_dense_predict_batch(const struct svm_dense_model *dm, const float *X, int n, int ldx, double *results, double *prob_estimates);
+
+/* shared dense SV matrix for several models on the same input (same dim and scaling): rows which are identical in
+   several models are stored once. For each input call svm_dense_pool_set_input and svm_dense_pool_dot (for disjoint
+   row ranges, these may run in parallel threads), then svm_dense_predict* with x = NULL for each model.
+   Destroy the pool after all models added to it. */
+struct svm_dense_pool;
+DLLEXPORT struct svm_dense_pool *svm_dense_pool_create(int dim, const double *scale_a, const double *scale_b);
+DLLEXPORT struct svm_dense_model *svm_dense_pool_add(struct svm_dense_pool *pool, const struct svm_model *model);
+DLLEXPORT int svm_dense_pool_get_nr_rows(const struct svm_dense_pool *pool);
+DLLEXPORT void svm_dense_pool_set_input(struct svm_dense_pool *pool, const float *x);
+DLLEXPORT void svm_dense_pool_dot(struct svm_dense_pool *pool, int r0, int r1);
+DLLEXPORT void svm_dense_pool_destroy(struct svm_dense_pool *pool);
+
+/* binary model files (openSMILE addon): the SVs are stored as dense float rows, svm_save_model_binary writes the
+   model at the current position of fp (returns 0 on success, -1 for precomputed kernels or write errors).
+   svm_load_model_binary reads a model from an 8-byte aligned buffer (e.g. a memory mapped file) and sets *used to
+   the number of bytes consumed. The coefficients and SVs are not copied, thus buf must stay valid until the
+   model is destroyed. Such a model can only be used with the svm_dense_* functions (svm_get_dense_dim > 0). */
+DLLEXPORT int svm_save_model_binary(FILE *fp, const struct svm_model *model);
+DLLEXPORT struct svm_model *svm_load_model_binary(const char *buf, long len, long *used);
+DLLEXPORT int svm_get_dense_dim(const struct svm_model *model);
+
 #ifdef __cplusplus
 }
 #endif